@@ -24,24 +24,57 @@ RCC_DIR = ./build
 #QMAKE_POST_LINK += cp v4l2capture.h ./libs/
 #QMAKE_POST_LINK += cp v4l2rendering.h ./libs/
 #QMAKE_POST_LINK += cp colortorgb24.h ./libs/
+#QMAKE_POST_LINK += cp colorlut3d.h ./libs/
+#QMAKE_POST_LINK += cp framestatistics.h ./libs/
+#QMAKE_POST_LINK += cp motiondetector.h ./libs/
+#QMAKE_POST_LINK += cp deinterlacer.h ./libs/
+#QMAKE_POST_LINK += cp framebufferpool.h ./libs/
+#QMAKE_POST_LINK += cp framemailbox.h ./libs/
+#QMAKE_POST_LINK += cp snapshotservice.h ./libs/
+#QMAKE_POST_LINK += cp mosaicrendering.h ./libs/
+#QMAKE_POST_LINK += cp offscreenrendering.h ./libs/
 
 SOURCES += v4l2capture.cpp \
     colortorgb24.cpp \
-    v4l2rendering.cpp
+    colorlut3d.cpp \
+    framestatistics.cpp \
+    motiondetector.cpp \
+    deinterlacer.cpp \
+    framebufferpool.cpp \
+    framemailbox.cpp \
+    snapshotservice.cpp \
+    v4l2rendering.cpp \
+    mosaicrendering.cpp \
+    offscreenrendering.cpp
 
 HEADERS  += v4l2capture.h \
     colortorgb24.h \
-    v4l2rendering.h
+    colorlut3d.h \
+    framestatistics.h \
+    motiondetector.h \
+    deinterlacer.h \
+    framebufferpool.h \
+    framemailbox.h \
+    snapshotservice.h \
+    v4l2rendering.h \
+    mosaicrendering.h \
+    offscreenrendering.h
 
 if(contains(TEMPLATE,app)){
 SOURCES += \
     main.cpp \
     pixmapwidget.cpp \
     openglwidget.cpp \
+    mosaicwidget.cpp \
+    threadedopenglwidget.cpp \
+    openglwindow.cpp \
     videodisplaywidget.cpp
 
 HEADERS += \
     pixmapwidget.h \
     openglwidget.h \
+    mosaicwidget.h \
+    threadedopenglwidget.h \
+    openglwindow.h \
     videodisplaywidget.h
 }
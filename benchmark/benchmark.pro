@@ -0,0 +1,35 @@
+#-------------------------------------------------
+#
+# 软解码(ColorToRgb24)性能测试程序
+# 统计各帧格式、分辨率、输出格式下的吞吐量(MPix/s)，以及每像素周期数和缓存未命中次数(perf计数器)，结果可保存为json对比
+# 注:需要使用Release模式编译，否则测试结果没有参考意义
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = convert_benchmark
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+#指定编译中间文件的目录
+MOC_DIR = ./build
+OBJECTS_DIR = ./build
+
+#被测试的软解码源码直接引用上级目录
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    convertbenchmark.cpp \
+    perfcounters.cpp \
+    ../colortorgb24.cpp \
+    ../colorlut3d.cpp \
+    ../framestatistics.cpp
+
+HEADERS += convertbenchmark.h \
+    perfcounters.h \
+    ../colortorgb24.h \
+    ../colorlut3d.h \
+    ../framestatistics.h
@@ -0,0 +1,633 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   软解码(ColorToRgb24)性能测试
+ */
+#include "convertbenchmark.h"
+#include "colorlut3d.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QFile>
+#include <QDir>
+#include <QStringList>
+#include <QSysInfo>
+#include <QThread>
+#include <QDateTime>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <math.h>
+
+namespace {
+/*支持测试的帧格式及名称*/
+struct FormatName
+{
+    uint pixelFormat;
+    const char *name;
+};
+const FormatName formatNames[] = {
+    {V4L2_PIX_FMT_YUYV,"YUYV"},{V4L2_PIX_FMT_UYVY,"UYVY"},{V4L2_PIX_FMT_YVYU,"YVYU"},
+    {V4L2_PIX_FMT_NV12,"NV12"},{V4L2_PIX_FMT_NV21,"NV21"},{V4L2_PIX_FMT_NV16,"NV16"},
+    {V4L2_PIX_FMT_NV61,"NV61"},{V4L2_PIX_FMT_YUV420,"YUV420"},{V4L2_PIX_FMT_YVU420,"YVU420"},
+    {V4L2_PIX_FMT_GREY,"GREY"},{V4L2_PIX_FMT_RGB32,"RGB32"},{V4L2_PIX_FMT_RGB565,"RGB565"}
+};
+//软解码使用的转换标准(摄像头常见的BT709 TV Range)
+const uint benchYcbcrEnc = V4L2_YCBCR_ENC_709;
+const bool benchTvRange = true;
+
+inline uchar clampByte(int value)
+{
+    return (value < 0)?0:((value > 255)?255:value);
+}
+/*部分查表法参考实现(BT601 Full Range)：uv分量与rgb的关系提前计算存表，y分量和范围校验仍需逐像素计算*/
+struct PartialLut
+{
+    int rv[256];
+    int gu[256];
+    int gv[256];
+    int bu[256];
+
+    PartialLut()
+    {
+        for(int i=0;i<256;i++)
+        {
+            rv[i] = qRound(1.402*(i-128));
+            gu[i] = qRound(0.344136*(i-128));
+            gv[i] = qRound(0.714136*(i-128));
+            bu[i] = qRound(1.772*(i-128));
+        }
+    }
+};
+void partialLutYuyvToRgb888(const uchar *yuyv,uchar *rgb,uint width,uint height)
+{
+    static const PartialLut lut;
+    const uint count = width*height/2;
+    for(uint i=0;i<count;i++,yuyv+=4,rgb+=6)
+    {
+        const int u = yuyv[1];
+        const int v = yuyv[3];
+        const int r_uv = lut.rv[v];
+        const int g_uv = lut.gu[u] + lut.gv[v];
+        const int b_uv = lut.bu[u];
+        rgb[0] = clampByte(yuyv[0] + r_uv);
+        rgb[1] = clampByte(yuyv[0] - g_uv);
+        rgb[2] = clampByte(yuyv[0] + b_uv);
+        rgb[3] = clampByte(yuyv[2] + r_uv);
+        rgb[4] = clampByte(yuyv[2] - g_uv);
+        rgb[5] = clampByte(yuyv[2] + b_uv);
+    }
+}
+/*完全查表法参考实现(BT601 Full Range)：rgb的所有可能值提前计算存表，g分量需要按y、u、v三维索引(16M)*/
+struct FullLut
+{
+    std::vector<uchar> r_yv;//[256][256]
+    std::vector<uchar> g_yuv;//[256][256][256]
+    std::vector<uchar> b_yu;//[256][256]
+
+    FullLut():r_yv(256*256),g_yuv(256*256*256),b_yu(256*256)
+    {
+        for(int y=0;y<256;y++)
+        {
+            for(int c=0;c<256;c++)
+            {
+                r_yv[(y<<8)|c] = clampByte(qRound(y + 1.402*(c-128)));
+                b_yu[(y<<8)|c] = clampByte(qRound(y + 1.772*(c-128)));
+            }
+            for(int u=0;u<256;u++)
+            {
+                uchar *g = &g_yuv[(y<<16)|(u<<8)];
+                for(int v=0;v<256;v++)
+                {
+                    g[v] = clampByte(qRound(y - 0.344136*(u-128) - 0.714136*(v-128)));
+                }
+            }
+        }
+    }
+};
+const FullLut &fullLut()
+{
+    static const FullLut lut;
+    return lut;
+}
+void fullLutYuyvToRgb888(const uchar *yuyv,uchar *rgb,uint width,uint height)
+{
+    const FullLut &lut = fullLut();
+    const uchar *r_yv = lut.r_yv.data();
+    const uchar *g_yuv = lut.g_yuv.data();
+    const uchar *b_yu = lut.b_yu.data();
+    const uint count = width*height/2;
+    for(uint i=0;i<count;i++,yuyv+=4,rgb+=6)
+    {
+        const uint y0 = yuyv[0];
+        const uint u = yuyv[1];
+        const uint y1 = yuyv[2];
+        const uint v = yuyv[3];
+        rgb[0] = r_yv[(y0<<8)|v];
+        rgb[1] = g_yuv[(y0<<16)|(u<<8)|v];
+        rgb[2] = b_yu[(y0<<8)|u];
+        rgb[3] = r_yv[(y1<<8)|v];
+        rgb[4] = g_yuv[(y1<<16)|(u<<8)|v];
+        rgb[5] = b_yu[(y1<<8)|u];
+    }
+}
+/*合成帧数据：缓慢变化的渐变叠加低位噪声，避免全零或周期很短的数据让分支预测和缓存表现失真*/
+void fillSyntheticFrame(uchar *frame,uint bytes,uint seed)
+{
+    quint32 lcg = 0x9e3779b9u ^ seed;
+    for(uint i=0;i<bytes;i++)
+    {
+        lcg = lcg*1664525u + 1013904223u;
+        frame[i] = uchar(((i>>6) + (i>>14)*29) ^ (lcg>>28));
+    }
+}
+}
+
+/*单个测试线程的数据(独立的转换对象、帧数据和性能计数器)*/
+struct ConvertBenchmark::Worker
+{
+    ColorToRgb24 converter;
+    uchar *frame = nullptr;
+    uchar *rgb = nullptr;
+    uint dstWidth = 0;
+    uint dstHeight = 0;
+    ColorToRgb24::FrameTransform transform;
+    FrameStatistics stats;
+    quint64 iterations = 0;
+    PerfCounters counters;
+    PerfCounters::Values perf;
+    bool perfOpened = false;
+
+    ~Worker()
+    {
+        qFreeAligned(frame);
+        qFreeAligned(rgb);
+    }
+};
+
+/*
+ *@brief:  测试用例的唯一标识，格式为"帧格式/宽x高/输出格式/转换接口/颜色处理/simd(scalar)/t线程数/实现"，开启帧统计时末尾加"/stats"
+ *@date:   2026.10.18
+ *@return: QString:标识
+ */
+QString ConvertBenchmark::Case::name() const
+{
+    return QString("%1/%2x%3/%4/%5/%6/%7/t%8/%9")
+            .arg(formatName(pixelFormat)).arg(width).arg(height)
+            .arg(outputName(output)).arg(modeName(mode)).arg(adjustName(adjust))
+            .arg(simd?"simd":"scalar").arg(threads).arg(kernelName(kernel)) + (statistics?"/stats":"");
+}
+double ConvertBenchmark::Result::pixels() const
+{
+    return double(testCase.width)*testCase.height*iterations*testCase.threads;
+}
+double ConvertBenchmark::Result::mpixPerSecond() const
+{
+    return (seconds > 0)?pixels()/seconds/1e6:0;
+}
+double ConvertBenchmark::Result::msPerFrame() const
+{
+    return (iterations > 0)?seconds*1000/iterations:0;
+}
+double ConvertBenchmark::Result::perPixel(PerfCounters::Counter counter) const
+{
+    return (perf.valid[counter] && pixels() > 0)?perf.value[counter]/pixels():-1;
+}
+/*
+ *@brief:  测试结果转换为json对象(计数器无效时对应字段为null)
+ *@date:   2026.10.18
+ *@return: QJsonObject:测试结果
+ */
+QJsonObject ConvertBenchmark::Result::toJson() const
+{
+    QJsonObject object;
+    object["name"] = testCase.name();
+    object["format"] = formatName(testCase.pixelFormat);
+    object["width"] = int(testCase.width);
+    object["height"] = int(testCase.height);
+    object["dst_width"] = int(dstWidth);
+    object["dst_height"] = int(dstHeight);
+    object["output"] = outputName(testCase.output);
+    object["mode"] = modeName(testCase.mode);
+    object["adjust"] = adjustName(testCase.adjust);
+    object["simd"] = testCase.simd;
+    object["threads"] = testCase.threads;
+    object["kernel"] = kernelName(testCase.kernel);
+    object["statistics"] = testCase.statistics;
+    object["iterations"] = double(iterations);
+    object["seconds"] = seconds;
+    object["mpix_per_s"] = mpixPerSecond();
+    object["ms_per_frame"] = msPerFrame();
+    QJsonObject counters;
+    for(int i=0;i<PerfCounters::CounterCount;i++)
+    {
+        PerfCounters::Counter counter = PerfCounters::Counter(i);
+        const QString name = PerfCounters::counterName(counter);
+        if(perf.valid[i])
+        {
+            counters[name] = double(perf.value[i]);
+            object[name + "_per_pixel"] = perPixel(counter);
+        }
+        else
+        {
+            counters[name] = QJsonValue();
+            object[name + "_per_pixel"] = QJsonValue();
+        }
+    }
+    object["counters"] = counters;
+    return object;
+}
+
+/*
+ *@brief:  构造函数
+ *@date:   2026.10.18
+ */
+ConvertBenchmark::ConvertBenchmark()
+{
+
+}
+/*
+ *@brief:  析构函数，恢复SIMD开关
+ *@date:   2026.10.18
+ */
+ConvertBenchmark::~ConvertBenchmark()
+{
+    ColorToRgb24::setSimdEnabled(true);
+}
+/*
+ *@brief:  设置3D LUT测试使用的.cube文件，不设置时使用内置生成的33点LUT
+ *@date:   2026.10.18
+ *@param:  fileName:.cube文件
+ *@return: bool:true=加载成功
+ */
+bool ConvertBenchmark::setLut3DFile(const QString &fileName)
+{
+    QSharedPointer<ColorLut3D> lut(new ColorLut3D);
+    if(!lut->loadCubeFile(fileName))
+    {
+        return false;
+    }
+    lut3D = lut;
+    return true;
+}
+/*
+ *@brief:  生成默认的3D LUT(33点，轻微的S曲线和暖色偏移，保证每个格点都不是恒等映射)
+ *@date:   2026.10.18
+ *@return: bool:true=生成成功
+ */
+bool ConvertBenchmark::createDefaultLut3D()
+{
+    QTemporaryFile file(QDir::tempPath() + "/benchmark_XXXXXX.cube");
+    if(!file.open())
+    {
+        return false;
+    }
+    const int size = 33;
+    QTextStream stream(&file);
+    stream<<"TITLE \"benchmark\"\nLUT_3D_SIZE "<<size<<"\n";
+    for(int b=0;b<size;b++)
+    {
+        for(int g=0;g<size;g++)
+        {
+            for(int r=0;r<size;r++)
+            {
+                const double in[3] = {double(r)/(size-1),double(g)/(size-1),double(b)/(size-1)};
+                double out[3];
+                for(int c=0;c<3;c++)
+                {
+                    out[c] = in[c] + 0.08*sin(2*M_PI*in[c]);//S曲线
+                }
+                out[0] = qMin(1.0,out[0]*1.04);
+                out[2] = qMax(0.0,out[2]*0.96);
+                stream<<out[0]<<" "<<out[1]<<" "<<out[2]<<"\n";
+            }
+        }
+    }
+    stream.flush();
+    file.close();
+    return setLut3DFile(file.fileName());
+}
+/*
+ *@brief:  运行一个测试用例
+ *注:先在当前线程预热两次(触发缺页并估算单帧耗时)，据此确定每个线程的转换次数，使总时间不少于minTime，然后所有线程同时开始转换。
+ *@date:   2026.10.18
+ *@param:  testCase:测试用例
+ *@return: Result:测试结果，参数不合法时iterations为0
+ */
+ConvertBenchmark::Result ConvertBenchmark::run(const Case &testCase)
+{
+    Result result;
+    result.testCase = testCase;
+    if(testCase.kernel != ShiftKernel &&
+            (testCase.pixelFormat != V4L2_PIX_FMT_YUYV || testCase.output != ColorToRgb24::RGB888 ||
+             testCase.mode != Convert || testCase.adjust != NoAdjust))
+    {
+        qDebug()<<"ConvertBenchmark:reference kernels only support YUYV->RGB888 without adjust:"<<testCase.name();
+        return result;
+    }
+    if(!ColorToRgb24::isSupportedFormat(testCase.pixelFormat) || testCase.threads < 1 ||
+            testCase.width < 16 || testCase.height < 16)
+    {
+        qDebug()<<"ConvertBenchmark:invalid case:"<<testCase.name();
+        return result;
+    }
+    if(testCase.adjust == Lut3DGrading && lut3D.isNull() && !createDefaultLut3D())
+    {
+        qDebug()<<"ConvertBenchmark:create 3D LUT failed.";
+        return result;
+    }
+    ColorToRgb24::setSimdEnabled(testCase.simd);
+
+    //准备每个线程的数据
+    std::vector<std::unique_ptr<Worker>> workers;
+    const uint frameBytes = ColorToRgb24::frameBytes(testCase.pixelFormat,testCase.width,testCase.height);
+    for(int i=0;i<testCase.threads;i++)
+    {
+        std::unique_ptr<Worker> worker(new Worker);
+        switch(testCase.mode)
+        {
+        case Scaled:
+            worker->dstWidth = testCase.width/2;
+            worker->dstHeight = testCase.height/2;
+            break;
+        case ScaledBilinear:
+            worker->dstWidth = testCase.width*2/5;
+            worker->dstHeight = testCase.height*2/5;
+            break;
+        case Transformed:
+            worker->transform.hMirror = true;
+            worker->transform.rotation = 90;
+            ColorToRgb24::transformedSize(worker->transform,testCase.width,testCase.height,
+                                          worker->dstWidth,worker->dstHeight);
+            break;
+        default:
+            worker->dstWidth = testCase.width;
+            worker->dstHeight = testCase.height;
+            break;
+        }
+        worker->frame = (uchar *)qMallocAligned(frameBytes,64);
+        worker->rgb = (uchar *)qMallocAligned(worker->dstWidth*worker->dstHeight*4,64);
+        fillSyntheticFrame(worker->frame,frameBytes,i);
+        if(testCase.adjust == ColorAdjust)
+        {
+            worker->converter.setColorAdjustment(1.1,1.2,1.3);
+        }
+        else if(testCase.adjust == Lut3DGrading)
+        {
+            worker->converter.setColorLut3D(lut3D);
+        }
+        workers.push_back(std::move(worker));
+    }
+    result.dstWidth = workers[0]->dstWidth;
+    result.dstHeight = workers[0]->dstHeight;
+
+    //预热并估算转换次数
+    QElapsedTimer timer;
+    qint64 warmupNs = 0;
+    for(size_t i=0;i<workers.size();i++)
+    {
+        convertOnce(workers[i].get(),testCase);
+        timer.start();
+        convertOnce(workers[i].get(),testCase);
+        warmupNs = qMax(warmupNs,timer.nsecsElapsed());
+    }
+    const quint64 iterations = qMax<quint64>(3,quint64(ceil(minTime*1e9/qMax<qint64>(warmupNs,1))));
+
+    //所有线程准备就绪后同时开始
+    std::atomic<int> readyCount(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for(size_t i=0;i<workers.size();i++)
+    {
+        Worker *worker = workers[i].get();
+        worker->iterations = iterations;
+        threads.push_back(std::thread([this,worker,&testCase,&readyCount,&go](){
+            if(usePerfCounters)
+            {
+                worker->perfOpened = worker->counters.open();
+            }
+            readyCount++;
+            while(!go.load())
+            {
+                std::this_thread::yield();
+            }
+            runWorker(worker,testCase);
+        }));
+    }
+    while(readyCount.load() < testCase.threads)
+    {
+        std::this_thread::yield();
+    }
+    timer.start();
+    go.store(true);
+    for(size_t i=0;i<threads.size();i++)
+    {
+        threads[i].join();
+    }
+    result.seconds = timer.nsecsElapsed()/1e9;
+    result.iterations = iterations;
+
+    //汇总计数器
+    result.perf = workers[0]->perf;
+    for(size_t i=1;i<workers.size();i++)
+    {
+        result.perf.accumulate(workers[i]->perf);
+    }
+    return result;
+}
+/*
+ *@brief:  测试线程的转换循环
+ *@date:   2026.10.18
+ *@param:  worker:线程数据  testCase:测试用例
+ */
+void ConvertBenchmark::runWorker(Worker *worker, const Case &testCase)
+{
+    if(worker->perfOpened)
+    {
+        worker->counters.start();
+    }
+    for(quint64 i=0;i<worker->iterations;i++)
+    {
+        convertOnce(worker,testCase);
+    }
+    if(worker->perfOpened)
+    {
+        worker->counters.stop();
+        worker->perf = worker->counters.read();
+    }
+}
+/*
+ *@brief:  按照测试用例转换一帧
+ *@date:   2026.10.18
+ *@param:  worker:线程数据  testCase:测试用例
+ */
+void ConvertBenchmark::convertOnce(Worker *worker, const Case &testCase)
+{
+    if(testCase.kernel == PartialLutKernel)
+    {
+        partialLutYuyvToRgb888(worker->frame,worker->rgb,testCase.width,testCase.height);
+        return;
+    }
+    else if(testCase.kernel == FullLutKernel)
+    {
+        fullLutYuyvToRgb888(worker->frame,worker->rgb,testCase.width,testCase.height);
+        return;
+    }
+
+    FrameStatistics *stats = NULL;
+    if(testCase.statistics)
+    {
+        stats = &worker->stats;
+        stats->reset();
+    }
+    switch(testCase.mode)
+    {
+    case Scaled:
+    case ScaledBilinear:
+        worker->converter.convertScaled(testCase.pixelFormat,worker->frame,worker->rgb,testCase.width,testCase.height,
+                                        worker->dstWidth,worker->dstHeight,testCase.output,benchYcbcrEnc,benchTvRange,
+                                        stats);
+        break;
+    case Transformed:
+        worker->converter.convertTransformed(testCase.pixelFormat,worker->frame,worker->rgb,testCase.width,testCase.height,
+                                             worker->transform,testCase.output,benchYcbcrEnc,benchTvRange,stats);
+        break;
+    default:
+        worker->converter.convert(testCase.pixelFormat,worker->frame,worker->rgb,testCase.width,testCase.height,
+                                  testCase.output,benchYcbcrEnc,benchTvRange,stats);
+        break;
+    }
+}
+/*
+ *@brief:  帧格式与名称的相互转换
+ *@date:   2026.10.18
+ */
+QString ConvertBenchmark::formatName(uint pixelFormat)
+{
+    for(const FormatName &format : formatNames)
+    {
+        if(format.pixelFormat == pixelFormat)
+        {
+            return format.name;
+        }
+    }
+    return QString::number(pixelFormat,16);
+}
+uint ConvertBenchmark::formatFromName(const QString &name)
+{
+    for(const FormatName &format : formatNames)
+    {
+        if(name.compare(format.name,Qt::CaseInsensitive) == 0)
+        {
+            return format.pixelFormat;
+        }
+    }
+    return 0;
+}
+QString ConvertBenchmark::outputName(ColorToRgb24::RgbOutputFormat output)
+{
+    switch(output)
+    {
+    case ColorToRgb24::RGB32:
+        return "RGB32";
+    case ColorToRgb24::ARGB32_Premultiplied:
+        return "ARGB32_Premultiplied";
+    case ColorToRgb24::RGBX8888:
+        return "RGBX8888";
+    case ColorToRgb24::BGRA8888:
+        return "BGRA8888";
+    default:
+        return "RGB888";
+    }
+}
+QString ConvertBenchmark::modeName(Mode mode)
+{
+    switch(mode)
+    {
+    case Scaled:
+        return "scaled";
+    case ScaledBilinear:
+        return "bilinear";
+    case Transformed:
+        return "transformed";
+    default:
+        return "convert";
+    }
+}
+QString ConvertBenchmark::adjustName(Adjust adjust)
+{
+    switch(adjust)
+    {
+    case ColorAdjust:
+        return "adjust";
+    case Lut3DGrading:
+        return "lut3d";
+    default:
+        return "none";
+    }
+}
+QString ConvertBenchmark::kernelName(Kernel kernel)
+{
+    switch(kernel)
+    {
+    case PartialLutKernel:
+        return "partial-lut";
+    case FullLutKernel:
+        return "full-lut";
+    default:
+        return "shift";
+    }
+}
+/*
+ *@brief:  测试环境信息(cpu、系统、编译器等)，与测试结果一起保存，便于对比不同硬件的结果
+ *@date:   2026.10.18
+ *@return: QJsonObject:环境信息
+ */
+QJsonObject ConvertBenchmark::hostInfo()
+{
+    QJsonObject object;
+    object["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    object["hostname"] = QSysInfo::machineHostName();
+    object["os"] = QSysInfo::prettyProductName();
+    object["kernel"] = QSysInfo::kernelVersion();
+    object["arch"] = QSysInfo::currentCpuArchitecture();
+    object["ideal_threads"] = QThread::idealThreadCount();
+    object["qt_version"] = QString(qVersion());
+#if defined(__VERSION__)
+    object["compiler"] = QString(__VERSION__);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    object["simd"] = ColorToRgb24::isSimdAvailable()?"NEON":"none";
+#elif defined(__SSE2__)
+    object["simd"] = ColorToRgb24::isSimdAvailable()?"SSE2":"none";
+#else
+    object["simd"] = "none";
+#endif
+    object["ycbcr_enc"] = "BT709";
+    object["tv_range"] = benchTvRange;
+    //cpu型号(x86为model name，arm为Hardware/CPU part)
+    QFile cpuinfo("/proc/cpuinfo");
+    if(cpuinfo.open(QIODevice::ReadOnly|QIODevice::Text))
+    {
+        const QStringList keys = QStringList()<<"model name"<<"Hardware"<<"CPU part";
+        QTextStream stream(&cpuinfo);
+        QString line;
+        while(!(line = stream.readLine()).isNull())
+        {
+            const QString key = line.section(':',0,0).trimmed();
+            if(keys.contains(key) && !object.contains("cpu"))
+            {
+                object["cpu"] = line.section(':',1).trimmed();
+            }
+        }
+    }
+    return object;
+}
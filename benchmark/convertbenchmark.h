@@ -0,0 +1,110 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   软解码(ColorToRgb24)性能测试
+ *
+ *使用合成的帧数据(渐变叠加伪随机噪声，避免全零数据掩盖访存开销)，对每个测试用例(帧格式、分辨率、rgb输出格式、转换接口、
+ *颜色调整、SIMD开关、线程数)反复转换，统计吞吐量(MPix/s，按源帧像素计算)以及每像素的周期数和缓存未命中次数(需要perf计数器)。
+ *多线程测试模拟多路摄像头：每个线程持有独立的转换对象和帧数据，同时转换，吞吐量为所有线程之和。
+ *另外提供了YUYV转RGB888的部分查表法和完全查表法参考实现(colortorgb24.h头部注释中提到的两种方案)，用来在新硬件上重新验证
+ *整形移位法的选择是否仍然成立。
+ */
+#ifndef CONVERTBENCHMARK_H
+#define CONVERTBENCHMARK_H
+
+#include "colortorgb24.h"
+#include "framestatistics.h"
+#include "perfcounters.h"
+#include <QString>
+#include <QJsonObject>
+
+class ConvertBenchmark
+{
+public:
+    //转换接口
+    enum Mode
+    {
+        Convert = 0,//convert()
+        Scaled,//convertScaled()，输出尺寸为源尺寸的一半(盒式滤波)
+        ScaledBilinear,//convertScaled()，输出尺寸为源尺寸的2/5(双线性插值)
+        Transformed//convertTransformed()，水平镜像+顺时针旋转90度
+    };
+    //颜色处理
+    enum Adjust
+    {
+        NoAdjust = 0,//不调整
+        ColorAdjust,//亮度、对比度、饱和度调整
+        Lut3DGrading//3D LUT颜色分级(不做基础调整)
+    };
+    //转换实现
+    enum Kernel
+    {
+        ShiftKernel = 0,//ColorToRgb24(整形移位)
+        PartialLutKernel,//部分查表法参考实现(仅YUYV->RGB888 BT601 Full Range)
+        FullLutKernel//完全查表法参考实现(同上，查表数据约16M)
+    };
+    struct Case
+    {
+        uint pixelFormat = V4L2_PIX_FMT_YUYV;
+        uint width = 1920;
+        uint height = 1080;
+        ColorToRgb24::RgbOutputFormat output = ColorToRgb24::RGB888;
+        Mode mode = Convert;
+        Adjust adjust = NoAdjust;
+        bool simd = true;
+        int threads = 1;
+        Kernel kernel = ShiftKernel;
+        bool statistics = false;//转换的同时累加帧统计(FrameStatistics)
+
+        QString name() const;//唯一标识，用于对比两次测试结果
+    };
+    struct Result
+    {
+        Case testCase;
+        uint dstWidth = 0;
+        uint dstHeight = 0;
+        quint64 iterations = 0;//每个线程的转换次数
+        double seconds = 0;//总耗时
+        PerfCounters::Values perf;//所有线程的计数之和
+
+        double pixels() const;//所有线程转换的源帧像素总数
+        double mpixPerSecond() const;
+        double msPerFrame() const;//单个线程转换一帧的平均耗时
+        double perPixel(PerfCounters::Counter counter) const;//每像素的计数，计数器无效时返回-1
+        QJsonObject toJson() const;
+    };
+
+    ConvertBenchmark();
+    ~ConvertBenchmark();
+
+    void setMinTime(double seconds){minTime = seconds;}
+    void setUsePerfCounters(bool on){usePerfCounters = on;}
+    bool setLut3DFile(const QString &fileName);
+    Result run(const Case &testCase);
+
+    static QString formatName(uint pixelFormat);
+    static uint formatFromName(const QString &name);
+    static QString outputName(ColorToRgb24::RgbOutputFormat output);
+    static QString modeName(Mode mode);
+    static QString adjustName(Adjust adjust);
+    static QString kernelName(Kernel kernel);
+    static QJsonObject hostInfo();
+
+private:
+    struct Worker;
+    void runWorker(Worker *worker,const Case &testCase);
+    void convertOnce(Worker *worker,const Case &testCase);
+    bool createDefaultLut3D();
+
+    double minTime = 0.2;//每个用例的最短测试时间(秒)
+    bool usePerfCounters = true;
+    QSharedPointer<const ColorLut3D> lut3D;
+};
+
+#endif // CONVERTBENCHMARK_H
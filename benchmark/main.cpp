@@ -0,0 +1,312 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   软解码性能测试程序入口
+ *
+ *示例:
+ *./convert_benchmark                                          按默认参数运行全部用例(单线程)
+ *./convert_benchmark -f YUYV,NV12 -s 1920x1080 -t 1,2,4        指定帧格式、分辨率和线程数
+ *./convert_benchmark -o new.json -c old.json                  保存结果并与上一次的结果对比
+ *./convert_benchmark -f YUYV -m convert --stats off,on        对比转换时累加帧统计的开销
+ *各个列表参数均以逗号分隔，perf计数器需要/proc/sys/kernel/perf_event_paranoid不大于2(或以root运行)。
+ */
+#include "convertbenchmark.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QFile>
+#include <QHash>
+#include <QSize>
+#include <QThread>
+#include <QDateTime>
+#include <stdio.h>
+
+namespace {
+QStringList splitList(const QString &value)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5,14,0)
+    return value.split(',',Qt::SkipEmptyParts);
+#else
+    return value.split(',',QString::SkipEmptyParts);
+#endif
+}
+/*每像素的计数格式化输出，计数器无效时输出"-"*/
+QString perPixelText(double value,double scale = 1.0)
+{
+    return (value < 0)?QString("-"):QString::number(value*scale,'f',2);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("convert_benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ColorToRgb24 software conversion benchmark");
+    parser.addHelpOption();
+    QCommandLineOption formatsOption(QStringList()<<"f"<<"formats","Pixel formats (YUYV,UYVY,YVYU,NV12,NV21,NV16,NV61,"
+                                     "YUV420,YVU420,GREY,RGB32,RGB565).","list",
+                                     "YUYV,UYVY,YVYU,NV12,NV21,NV16,NV61,YUV420,YVU420,GREY,RGB32,RGB565");
+    QCommandLineOption sizesOption(QStringList()<<"s"<<"sizes","Frame sizes.","list",
+                                   "640x480,1280x720,1920x1080,3840x2160");
+    QCommandLineOption outputsOption(QStringList()<<"r"<<"outputs","Rgb output formats (RGB888,RGB32,"
+                                     "ARGB32_Premultiplied,RGBX8888,BGRA8888).","list","RGB888,RGB32");
+    QCommandLineOption modesOption(QStringList()<<"m"<<"modes","Conversion modes (convert,scaled,bilinear,transformed).",
+                                   "list","convert,scaled,bilinear,transformed");
+    QCommandLineOption adjustOption(QStringList()<<"a"<<"adjust","Color processing (none,adjust,lut3d).",
+                                    "list","none,adjust,lut3d");
+    QCommandLineOption simdOption("simd","SIMD switch (on,off).","list","on,off");
+    QCommandLineOption statsOption("stats","Frame statistics (histograms) during conversion (on,off).","list","off");
+    QCommandLineOption threadsOption(QStringList()<<"t"<<"threads","Thread counts, each thread converts its own frame.",
+                                     "list","1");
+    QCommandLineOption noReferenceOption("no-reference","Skip the partial/full lookup table reference kernels.");
+    QCommandLineOption minTimeOption("min-time","Minimum measuring time per case in seconds.","seconds","0.05");
+    QCommandLineOption lutOption("lut","3D LUT (.cube) file for the lut3d cases.","file");
+    QCommandLineOption noPerfOption("no-perf","Do not use perf event counters.");
+    QCommandLineOption outputOption(QStringList()<<"o"<<"output","Save results to a JSON file.","file");
+    QCommandLineOption compareOption(QStringList()<<"c"<<"compare","Compare with a previously saved JSON file.","file");
+    parser.addOptions(QList<QCommandLineOption>()<<formatsOption<<sizesOption<<outputsOption<<modesOption
+                      <<adjustOption<<simdOption<<statsOption<<threadsOption<<noReferenceOption<<minTimeOption<<lutOption
+                      <<noPerfOption<<outputOption<<compareOption);
+    parser.process(a);
+
+    ConvertBenchmark benchmark;
+    benchmark.setMinTime(parser.value(minTimeOption).toDouble());
+    benchmark.setUsePerfCounters(!parser.isSet(noPerfOption));
+    if(parser.isSet(lutOption) && !benchmark.setLut3DFile(parser.value(lutOption)))
+    {
+        fprintf(stderr,"load 3D LUT failed:%s\n",qPrintable(parser.value(lutOption)));
+        return 1;
+    }
+
+    /*1.解析参数，生成测试用例*/
+    QList<uint> formats;
+    for(const QString &name : splitList(parser.value(formatsOption)))
+    {
+        uint format = ConvertBenchmark::formatFromName(name);
+        if(format == 0)
+        {
+            fprintf(stderr,"unknown format:%s\n",qPrintable(name));
+            return 1;
+        }
+        formats<<format;
+    }
+    QList<QSize> sizes;
+    for(const QString &size : splitList(parser.value(sizesOption)))
+    {
+        QStringList wh = size.toLower().split('x');
+        if(wh.size() != 2 || wh[0].toUInt() < 16 || wh[1].toUInt() < 16)
+        {
+            fprintf(stderr,"invalid size:%s\n",qPrintable(size));
+            return 1;
+        }
+        //yuv格式要求宽高为偶数
+        sizes<<QSize(wh[0].toUInt()&~1u,wh[1].toUInt()&~1u);
+    }
+    QList<ColorToRgb24::RgbOutputFormat> outputs;
+    for(const QString &name : splitList(parser.value(outputsOption)))
+    {
+        bool found = false;
+        for(int i=ColorToRgb24::RGB888;i<=ColorToRgb24::BGRA8888;i++)
+        {
+            if(name.compare(ConvertBenchmark::outputName(ColorToRgb24::RgbOutputFormat(i)),Qt::CaseInsensitive) == 0)
+            {
+                outputs<<ColorToRgb24::RgbOutputFormat(i);
+                found = true;
+            }
+        }
+        if(!found)
+        {
+            fprintf(stderr,"unknown output format:%s\n",qPrintable(name));
+            return 1;
+        }
+    }
+    QList<ConvertBenchmark::Mode> modes;
+    for(const QString &name : splitList(parser.value(modesOption)))
+    {
+        int count = modes.size();
+        for(int i=ConvertBenchmark::Convert;i<=ConvertBenchmark::Transformed;i++)
+        {
+            if(name == ConvertBenchmark::modeName(ConvertBenchmark::Mode(i)))
+            {
+                modes<<ConvertBenchmark::Mode(i);
+            }
+        }
+        if(modes.size() == count)
+        {
+            fprintf(stderr,"unknown mode:%s\n",qPrintable(name));
+            return 1;
+        }
+    }
+    QList<ConvertBenchmark::Adjust> adjusts;
+    for(const QString &name : splitList(parser.value(adjustOption)))
+    {
+        int count = adjusts.size();
+        for(int i=ConvertBenchmark::NoAdjust;i<=ConvertBenchmark::Lut3DGrading;i++)
+        {
+            if(name == ConvertBenchmark::adjustName(ConvertBenchmark::Adjust(i)))
+            {
+                adjusts<<ConvertBenchmark::Adjust(i);
+            }
+        }
+        if(adjusts.size() == count)
+        {
+            fprintf(stderr,"unknown adjust:%s\n",qPrintable(name));
+            return 1;
+        }
+    }
+    QList<bool> simds;
+    for(const QString &name : splitList(parser.value(simdOption)))
+    {
+        //编译时未启用SIMD，开关没有意义，只测试标量实现
+        bool simd = (name == "on") && ColorToRgb24::isSimdAvailable();
+        if(!simds.contains(simd))
+        {
+            simds<<simd;
+        }
+    }
+    QList<bool> statsSwitches;
+    for(const QString &name : splitList(parser.value(statsOption)))
+    {
+        bool statistics = (name == "on");
+        if(!statsSwitches.contains(statistics))
+        {
+            statsSwitches<<statistics;
+        }
+    }
+    QList<int> threadCounts;
+    for(const QString &count : splitList(parser.value(threadsOption)))
+    {
+        if(count.toInt() < 1)
+        {
+            fprintf(stderr,"invalid thread count:%s\n",qPrintable(count));
+            return 1;
+        }
+        threadCounts<<count.toInt();
+    }
+
+    QList<ConvertBenchmark::Case> cases;
+    for(int threads : threadCounts)
+    {
+        for(const QSize &size : sizes)
+        {
+            for(uint format : formats)
+            {
+                for(ColorToRgb24::RgbOutputFormat output : outputs)
+                {
+                    for(ConvertBenchmark::Mode mode : modes)
+                    {
+                        for(ConvertBenchmark::Adjust adjust : adjusts)
+                        {
+                            for(bool simd : simds)
+                            {
+                                for(bool statistics : statsSwitches)
+                                {
+                                    ConvertBenchmark::Case testCase;
+                                    testCase.pixelFormat = format;
+                                    testCase.width = size.width();
+                                    testCase.height = size.height();
+                                    testCase.output = output;
+                                    testCase.mode = mode;
+                                    testCase.adjust = adjust;
+                                    testCase.simd = simd;
+                                    testCase.statistics = statistics;
+                                    testCase.threads = threads;
+                                    cases<<testCase;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            //部分查表法、完全查表法参考实现(YUYV->RGB888)
+            if(!parser.isSet(noReferenceOption) && formats.contains(V4L2_PIX_FMT_YUYV))
+            {
+                for(int kernel=ConvertBenchmark::PartialLutKernel;kernel<=ConvertBenchmark::FullLutKernel;kernel++)
+                {
+                    ConvertBenchmark::Case testCase;
+                    testCase.width = size.width();
+                    testCase.height = size.height();
+                    testCase.simd = false;
+                    testCase.threads = threads;
+                    testCase.kernel = ConvertBenchmark::Kernel(kernel);
+                    cases<<testCase;
+                }
+            }
+        }
+    }
+
+    /*2.加载对比数据*/
+    QHash<QString,double> baseline;
+    if(parser.isSet(compareOption))
+    {
+        QFile file(parser.value(compareOption));
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            fprintf(stderr,"open compare file failed:%s\n",qPrintable(file.fileName()));
+            return 1;
+        }
+        const QJsonArray results = QJsonDocument::fromJson(file.readAll()).object().value("results").toArray();
+        for(const QJsonValue &value : results)
+        {
+            const QJsonObject object = value.toObject();
+            baseline.insert(object.value("name").toString(),object.value("mpix_per_s").toDouble());
+        }
+    }
+
+    /*3.运行测试并输出*/
+    const QJsonObject host = ConvertBenchmark::hostInfo();
+    printf("cpu:%s  arch:%s  simd:%s  threads:%d  cases:%d\n",qPrintable(host.value("cpu").toString()),
+           qPrintable(host.value("arch").toString()),qPrintable(host.value("simd").toString()),
+           host.value("ideal_threads").toInt(),cases.size());
+    printf("%-58s %10s %9s %8s %6s %10s %10s%s\n","case","MPix/s","ms/frame","cyc/px","IPC",
+           "LLCmiss/kpx","L1Dmiss/kpx",baseline.isEmpty()?"":"   speedup");
+    QJsonArray results;
+    for(const ConvertBenchmark::Case &testCase : cases)
+    {
+        const ConvertBenchmark::Result result = benchmark.run(testCase);
+        if(result.iterations == 0)
+        {
+            continue;
+        }
+        const double cycles = result.perPixel(PerfCounters::Cycles);
+        const double instructions = result.perPixel(PerfCounters::Instructions);
+        const QString ipc = (cycles > 0 && instructions >= 0)?QString::number(instructions/cycles,'f',2):QString("-");
+        QString speedup;
+        if(baseline.value(testCase.name()) > 0)
+        {
+            speedup = QString("   x%1").arg(result.mpixPerSecond()/baseline.value(testCase.name()),0,'f',2);
+        }
+        printf("%-58s %10.1f %9.3f %8s %6s %10s %10s%s\n",qPrintable(testCase.name()),result.mpixPerSecond(),
+               result.msPerFrame(),qPrintable(perPixelText(cycles)),qPrintable(ipc),
+               qPrintable(perPixelText(result.perPixel(PerfCounters::CacheMisses),1000)),
+               qPrintable(perPixelText(result.perPixel(PerfCounters::L1DReadMisses),1000)),qPrintable(speedup));
+        fflush(stdout);
+        results.append(result.toJson());
+    }
+
+    /*4.保存结果*/
+    if(parser.isSet(outputOption))
+    {
+        QJsonObject root;
+        root["host"] = host;
+        root["results"] = results;
+        QFile file(parser.value(outputOption));
+        if(!file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+        {
+            fprintf(stderr,"open output file failed:%s\n",qPrintable(file.fileName()));
+            return 1;
+        }
+        file.write(QJsonDocument(root).toJson());
+        printf("results saved to %s\n",qPrintable(file.fileName()));
+    }
+    return 0;
+}
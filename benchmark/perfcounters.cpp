@@ -0,0 +1,172 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   基于perf_event_open的硬件性能计数器(周期数、指令数、缓存未命中)
+ */
+#include "perfcounters.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+
+namespace {
+/*计数器对应的perf事件类型和配置，顺序与PerfCounters::Counter一致*/
+struct CounterEvent
+{
+    quint32 type;
+    quint64 config;
+    const char *name;
+};
+const CounterEvent counterEvents[PerfCounters::CounterCount] = {
+    {PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES,"cycles"},
+    {PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS,"instructions"},
+    {PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_REFERENCES,"cache_references"},
+    {PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_MISSES,"cache_misses"},
+    {PERF_TYPE_HW_CACHE,PERF_COUNT_HW_CACHE_L1D|(PERF_COUNT_HW_CACHE_OP_READ<<8)|
+     (PERF_COUNT_HW_CACHE_RESULT_MISS<<16),"l1d_read_misses"}
+};
+}
+
+/*
+ *@brief:  构造函数
+ *@date:   2026.10.18
+ */
+PerfCounters::PerfCounters()
+{
+    for(int i=0;i<CounterCount;i++)
+    {
+        fds[i] = -1;
+    }
+}
+/*
+ *@brief:  析构函数，关闭计数器
+ *@date:   2026.10.18
+ */
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+/*
+ *@brief:  为当前线程打开计数器(仅统计用户态)，打开后处于停止状态
+ *@date:   2026.10.18
+ *@return: bool:true=至少有一个计数器打开成功
+ */
+bool PerfCounters::open()
+{
+    close();
+    bool opened = false;
+    for(int i=0;i<CounterCount;i++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr,0,sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = counterEvents[i].type;
+        attr.config = counterEvents[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED|PERF_FORMAT_TOTAL_TIME_RUNNING;
+        //pid=0,cpu=-1:统计当前线程在任意cpu上的运行
+        fds[i] = syscall(__NR_perf_event_open,&attr,0,-1,-1,0);
+        if(fds[i] >= 0)
+        {
+            opened = true;
+        }
+    }
+    return opened;
+}
+/*
+ *@brief:  关闭计数器
+ *@date:   2026.10.18
+ */
+void PerfCounters::close()
+{
+    for(int i=0;i<CounterCount;i++)
+    {
+        if(fds[i] >= 0)
+        {
+            ::close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+/*
+ *@brief:  清零并开始计数
+ *@date:   2026.10.18
+ */
+void PerfCounters::start()
+{
+    for(int i=0;i<CounterCount;i++)
+    {
+        if(fds[i] >= 0)
+        {
+            ioctl(fds[i],PERF_EVENT_IOC_RESET,0);
+            ioctl(fds[i],PERF_EVENT_IOC_ENABLE,0);
+        }
+    }
+}
+/*
+ *@brief:  停止计数
+ *@date:   2026.10.18
+ */
+void PerfCounters::stop()
+{
+    for(int i=0;i<CounterCount;i++)
+    {
+        if(fds[i] >= 0)
+        {
+            ioctl(fds[i],PERF_EVENT_IOC_DISABLE,0);
+        }
+    }
+}
+/*
+ *@brief:  读取计数结果(计数器被分时复用时按照实际运行时间缩放)
+ *@date:   2026.10.18
+ *@return: Values:计数结果，未打开或未运行过的计数器无效
+ */
+PerfCounters::Values PerfCounters::read() const
+{
+    Values values;
+    for(int i=0;i<CounterCount;i++)
+    {
+        //value,time_enabled,time_running
+        quint64 data[3];
+        if(fds[i] < 0 || ::read(fds[i],data,sizeof(data)) != sizeof(data) || data[2] == 0)
+        {
+            continue;
+        }
+        values.valid[i] = true;
+        values.value[i] = (data[2] < data[1])?quint64(double(data[0])*data[1]/data[2]):data[0];
+    }
+    return values;
+}
+/*
+ *@brief:  计数器名称(用于输出)
+ *@date:   2026.10.18
+ *@param:  counter:计数器
+ *@return: const char*:名称
+ */
+const char *PerfCounters::counterName(Counter counter)
+{
+    return counterEvents[counter].name;
+}
+/*
+ *@brief:  累加另一组计数结果(多线程汇总)，任意一方无效则结果无效
+ *@date:   2026.10.18
+ *@param:  other:另一组计数结果
+ */
+void PerfCounters::Values::accumulate(const Values &other)
+{
+    for(int i=0;i<CounterCount;i++)
+    {
+        valid[i] = valid[i] && other.valid[i];
+        value[i] += other.value[i];
+    }
+}
@@ -0,0 +1,58 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   基于perf_event_open的硬件性能计数器(周期数、指令数、缓存未命中)
+ *
+ *计数器只统计调用open()的线程(用户态)，多线程测试时每个线程各自持有一个对象，结果相加即可。
+ *内核不支持或权限不足(/proc/sys/kernel/perf_event_paranoid)时open()返回false，对应计数器的结果视为无效，
+ *单个计数器(如部分ARM核不支持L1D事件)打开失败不影响其他计数器。计数器数量超过硬件寄存器时内核会分时复用，
+ *读取时按照实际运行时间进行缩放。
+ */
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include "qglobal.h"
+
+class PerfCounters
+{
+public:
+    enum Counter
+    {
+        Cycles = 0,//cpu周期数
+        Instructions,//指令数
+        CacheReferences,//最后一级缓存访问次数
+        CacheMisses,//最后一级缓存未命中次数
+        L1DReadMisses,//一级数据缓存读未命中次数
+        CounterCount
+    };
+    struct Values
+    {
+        bool valid[CounterCount] = {false,false,false,false,false};
+        quint64 value[CounterCount] = {0,0,0,0,0};
+
+        void accumulate(const Values &other);
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    bool open();//为当前线程打开计数器，至少有一个打开成功返回true
+    void close();
+    void start();
+    void stop();
+    Values read() const;
+
+    static const char *counterName(Counter counter);
+
+private:
+    Q_DISABLE_COPY(PerfCounters)
+    int fds[CounterCount];
+};
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,293 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   GPU计时(GL_TIME_ELAPSED查询)及GPU时间戳(GL_TIMESTAMP查询)
+ */
+#include "gputimer.h"
+#include <QOpenGLContext>
+#include <string.h>
+
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP 0x8E28
+#endif
+
+namespace {
+/*判断当前上下文是否支持计时查询，并取得64位结果的查询接口(GLES为EXT后缀)*/
+bool resolveTimerQuery(QOpenGLContext *context,bool &isDisjointExt,QFunctionPointer &getQueryObjectui64v)
+{
+    const QSurfaceFormat format = context->format();
+    bool supported = false;
+    if(context->isOpenGLES())
+    {
+        isDisjointExt = true;
+        supported = format.majorVersion() >= 3 && context->hasExtension("GL_EXT_disjoint_timer_query");
+        getQueryObjectui64v = context->getProcAddress("glGetQueryObjectui64vEXT");
+    }
+    else
+    {
+        isDisjointExt = false;
+        supported = format.version() >= qMakePair(3,3) || context->hasExtension("GL_ARB_timer_query");
+        getQueryObjectui64v = context->getProcAddress("glGetQueryObjectui64v");
+    }
+    return supported && getQueryObjectui64v;
+}
+}
+
+GpuTimer::GpuTimer()
+{
+    memset(queries,0,sizeof(queries));
+}
+/*
+ *@brief:  在当前上下文中创建查询对象
+ *注:OpenGL ES 2.0的GL_EXT_disjoint_timer_query需要使用EXT后缀的查询接口，这里不支持。
+ *@date:   2026.10.18
+ *@return: bool:true=支持GPU计时
+ */
+bool GpuTimer::create()
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if(!context)
+    {
+        return false;
+    }
+    initializeOpenGLFunctions();
+    rendererName = QString::fromLatin1((const char *)glGetString(GL_RENDERER));
+    QFunctionPointer getResult = nullptr;
+    valid = resolveTimerQuery(context,isDisjointExt,getResult);
+    getQueryObjectui64v = (GetQueryObjectui64v)getResult;
+    if(valid)
+    {
+        glGenQueries(QUERY_COUNT,queries);
+        if(isDisjointExt)
+        {
+            GLint disjoint = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT,&disjoint);//读取一次以清除标志
+        }
+    }
+    return valid;
+}
+/*
+ *@brief:  删除查询对象(上下文需要是当前的)
+ *@date:   2026.10.18
+ */
+void GpuTimer::destroy()
+{
+    if(valid)
+    {
+        glDeleteQueries(QUERY_COUNT,queries);
+        memset(queries,0,sizeof(queries));
+        valid = false;
+    }
+}
+/*
+ *@brief:  开始计时
+ *注:查询对象全部在使用中时先等待最早的一个完成(GPU落后CPU超过QUERY_COUNT帧时才会发生)。
+ *@date:   2026.10.18
+ */
+void GpuTimer::begin()
+{
+    if(!valid || isActive)
+    {
+        return;
+    }
+    if(issued - collected >= quint64(QUERY_COUNT))
+    {
+        collect(true);
+    }
+    glBeginQuery(GL_TIME_ELAPSED,queries[issued % QUERY_COUNT]);
+    isActive = true;
+}
+/*
+ *@brief:  结束计时
+ *@date:   2026.10.18
+ */
+void GpuTimer::end()
+{
+    if(!valid || !isActive)
+    {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    isActive = false;
+    issued++;
+}
+/*
+ *@brief:  按提交顺序取回已经完成的查询结果
+ *@date:   2026.10.18
+ *@param:  wait:true=等待所有已提交的查询完成  false=遇到尚未完成的查询即返回
+ */
+void GpuTimer::collect(bool wait)
+{
+    if(!valid)
+    {
+        return;
+    }
+    bool disjoint = false;
+    while(collected < issued)
+    {
+        const GLuint query = queries[collected % QUERY_COUNT];
+        if(!wait)
+        {
+            GLuint available = 0;
+            glGetQueryObjectuiv(query,GL_QUERY_RESULT_AVAILABLE,&available);
+            if(!available)
+            {
+                break;
+            }
+        }
+        quint64 elapsed = 0;
+        getQueryObjectui64v(query,GL_QUERY_RESULT,&elapsed);
+        if(isDisjointExt && !disjoint)
+        {
+            GLint value = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT,&value);
+            disjoint = value != 0;
+        }
+        //disjoint标志无法对应到具体的查询，这一批结果都丢弃
+        if(!disjoint && collected >= discardBefore)
+        {
+            totalNs += elapsed;
+            samples++;
+        }
+        collected++;
+    }
+}
+/*
+ *@brief:  清空统计
+ *@date:   2026.10.18
+ */
+void GpuTimer::reset()
+{
+    discardBefore = issued + (isActive?1:0);
+    totalNs = 0;
+    samples = 0;
+}
+
+GpuTimestamps::GpuTimestamps()
+{
+    memset(queries,0,sizeof(queries));
+    memset(serials,0,sizeof(serials));
+}
+/*
+ *@brief:  在当前上下文中创建查询对象
+ *@date:   2026.10.18
+ *@return: bool:true=支持时间戳查询
+ */
+bool GpuTimestamps::create()
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if(!context)
+    {
+        return false;
+    }
+    initializeOpenGLFunctions();
+    QFunctionPointer getResult = nullptr;
+    valid = resolveTimerQuery(context,isDisjointExt,getResult);
+    getQueryObjectui64v = (GetQueryObjectui64v)getResult;
+    queryCounter = (QueryCounter)context->getProcAddress(isDisjointExt?"glQueryCounterEXT":"glQueryCounter");
+    valid = valid && queryCounter;
+    if(valid)
+    {
+        glGenQueries(QUERY_COUNT,queries);
+        ownerContext = context;
+        if(isDisjointExt)
+        {
+            GLint disjoint = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT,&disjoint);//读取一次以清除标志
+        }
+    }
+    return valid;
+}
+/*
+ *@brief:  删除查询对象(创建时的上下文需要是当前的)
+ *@date:   2026.10.18
+ */
+void GpuTimestamps::destroy()
+{
+    if(valid)
+    {
+        glDeleteQueries(QUERY_COUNT,queries);
+        memset(queries,0,sizeof(queries));
+        valid = false;
+        ownerContext = nullptr;
+    }
+}
+/*
+ *@brief:  记录时间戳
+ *注:查询对象全部在使用中时先等待最早的一个完成，结果丢弃(调用者没有及时collect()时才会发生)。
+ *@date:   2026.10.18
+ *@param:  serial:时间戳的序号(例如帧号)
+ */
+void GpuTimestamps::mark(quint64 serial)
+{
+    if(!valid)
+    {
+        return;
+    }
+    if(issued - collected >= quint64(QUERY_COUNT))
+    {
+        QHash<quint64,quint64> dropped;
+        collect(dropped,true);
+    }
+    serials[issued % QUERY_COUNT] = serial;
+    queryCounter(queries[issued % QUERY_COUNT],GL_TIMESTAMP);
+    issued++;
+}
+/*
+ *@brief:  按提交顺序取回已经完成的时间戳
+ *@date:   2026.10.18
+ *@param:  stamps:取回的时间戳(serial->纳秒)
+ *@param:  wait:true=等待所有已提交的查询完成  false=遇到尚未完成的查询即返回
+ */
+void GpuTimestamps::collect(QHash<quint64,quint64> &stamps, bool wait)
+{
+    if(!valid)
+    {
+        return;
+    }
+    bool disjoint = false;
+    while(collected < issued)
+    {
+        const GLuint query = queries[collected % QUERY_COUNT];
+        if(!wait)
+        {
+            GLuint available = 0;
+            glGetQueryObjectuiv(query,GL_QUERY_RESULT_AVAILABLE,&available);
+            if(!available)
+            {
+                break;
+            }
+        }
+        quint64 timestamp = 0;
+        getQueryObjectui64v(query,GL_QUERY_RESULT,&timestamp);
+        if(isDisjointExt && !disjoint)
+        {
+            GLint value = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT,&value);
+            disjoint = value != 0;
+        }
+        if(!disjoint)
+        {
+            stamps.insert(serials[collected % QUERY_COUNT],timestamp);
+        }
+        collected++;
+    }
+}
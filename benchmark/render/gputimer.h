@@ -0,0 +1,97 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   GPU计时(GL_TIME_ELAPSED查询)及GPU时间戳(GL_TIMESTAMP查询)
+ *
+ *OpenGL 3.3/GL_ARB_timer_query以及OpenGL ES 3.0+GL_EXT_disjoint_timer_query支持GL_TIME_ELAPSED查询，统计begin()/end()
+ *之间提交的命令在GPU上的执行时间。查询对象轮流使用，结果在之后的帧中无等待地取回，不会让CPU与GPU同步。
+ *GLES上发生disjoint(频率变化、上下文切换等)的查询结果不可靠，直接丢弃。不支持时isValid()为false。
+ *GpuTimestamps在命令流中记录GPU执行到该位置的时间戳(GL_TIMESTAMP)，用于统计跨越多个上下文的时间段(例如组件的paintGL()
+ *开始到顶层窗口合成完成)。查询对象不在上下文之间共享，每个上下文各使用一个GpuTimestamps。
+ */
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include <QOpenGLExtraFunctions>
+#include <QString>
+#include <QHash>
+
+class QOpenGLContext;
+
+class GpuTimer : protected QOpenGLExtraFunctions
+{
+public:
+    GpuTimer();
+
+    //在当前上下文中创建查询对象，不支持计时查询时返回false
+    bool create();
+    void destroy();
+    bool isValid() const {return valid;}
+    QString renderer() const {return rendererName;}
+
+    void begin();
+    void end();
+    //取回已经完成的查询结果，wait=true时等待所有查询完成
+    void collect(bool wait=false);
+    //清空统计(尚未取回的查询结果也丢弃)
+    void reset();
+
+    quint64 sampleCount() const {return samples;}
+    double averageMs() const {return samples?(totalNs/1000000.0/samples):-1;}
+
+private:
+    typedef void (QOPENGLF_APIENTRYP GetQueryObjectui64v)(GLuint id,GLenum pname,quint64 *params);
+    static const int QUERY_COUNT = 8;
+
+    bool valid = false;
+    bool isDisjointExt = false;//GLES(GL_EXT_disjoint_timer_query)
+    bool isActive = false;
+    GetQueryObjectui64v getQueryObjectui64v = nullptr;
+    GLuint queries[QUERY_COUNT];
+    quint64 issued = 0;//已经提交的查询数
+    quint64 collected = 0;//已经取回(或丢弃)的查询数
+    quint64 discardBefore = 0;//reset()之前提交的查询只取回不统计
+    quint64 totalNs = 0;
+    quint64 samples = 0;
+    QString rendererName;
+};
+
+class GpuTimestamps : protected QOpenGLExtraFunctions
+{
+public:
+    GpuTimestamps();
+
+    //在当前上下文中创建查询对象，不支持时间戳查询时返回false
+    bool create();
+    void destroy();
+    bool isValid() const {return valid;}
+    QOpenGLContext *context() const {return ownerContext;}
+
+    //记录GPU执行到当前命令位置的时间戳，serial用于与其他上下文的时间戳对应
+    void mark(quint64 serial);
+    //按提交顺序取回已经完成的时间戳(serial->纳秒)，wait=true时等待全部完成
+    void collect(QHash<quint64,quint64> &stamps,bool wait=false);
+
+private:
+    typedef void (QOPENGLF_APIENTRYP GetQueryObjectui64v)(GLuint id,GLenum pname,quint64 *params);
+    typedef void (QOPENGLF_APIENTRYP QueryCounter)(GLuint id,GLenum target);
+    static const int QUERY_COUNT = 16;
+
+    bool valid = false;
+    bool isDisjointExt = false;
+    QOpenGLContext *ownerContext = nullptr;
+    GetQueryObjectui64v getQueryObjectui64v = nullptr;
+    QueryCounter queryCounter = nullptr;
+    GLuint queries[QUERY_COUNT];
+    quint64 serials[QUERY_COUNT];
+    quint64 issued = 0;
+    quint64 collected = 0;
+};
+
+#endif // GPUTIMER_H
@@ -0,0 +1,261 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   显示宿主渲染性能测试程序入口
+ *
+ *示例:
+ *./render_benchmark                                     全屏对比OpenGLWidget与OpenGLWindow(NV12 1920x1080)
+ *./render_benchmark -f YUYV,NV12 -n 1200                 指定帧格式和统计帧数
+ *./render_benchmark --window-size 1280x720 --vsync      窗口模式，开启垂直同步(只比较frame_gpu_ms)
+ *./render_benchmark -o new.json -c old.json             保存结果并与上一次的结果对比
+ *默认关闭垂直同步(QSurfaceFormat::setSwapInterval(0))，frame_ms才能反映GPU时间，需要在创建QApplication之前设置。
+ */
+#include "renderbenchmark.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QSurfaceFormat>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QFile>
+#include <QHash>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+QStringList splitList(const QString &value)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5,14,0)
+    return value.split(',',Qt::SkipEmptyParts);
+#else
+    return value.split(',',QString::SkipEmptyParts);
+#endif
+}
+QSize sizeFromText(const QString &text)
+{
+    QStringList wh = text.toLower().split('x');
+    if(wh.size() != 2 || wh[0].toUInt() < 16 || wh[1].toUInt() < 16)
+    {
+        return QSize();
+    }
+    return QSize(wh[0].toUInt(),wh[1].toUInt());
+}
+/*GPU计时不可用时输出"-"*/
+QString gpuMsText(double value)
+{
+    return (value < 0)?QString("-"):QString::number(value,'f',3);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    //交换间隔需要在创建任何窗口之前设置
+    bool vsync = false;
+    for(int i=1;i<argc;i++)
+    {
+        if(strcmp(argv[i],"--vsync") == 0)
+        {
+            vsync = true;
+        }
+    }
+    QSurfaceFormat surfaceFormat = QSurfaceFormat::defaultFormat();
+    surfaceFormat.setSwapInterval(vsync?1:0);
+    QSurfaceFormat::setDefaultFormat(surfaceFormat);
+
+    QApplication a(argc, argv);
+    QApplication::setApplicationName("render_benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("OpenGLWidget/OpenGLWindow rendering benchmark");
+    parser.addHelpOption();
+    QCommandLineOption hostsOption("hosts","Display hosts (widget,window).","list","widget,window");
+    QCommandLineOption formatsOption(QStringList()<<"f"<<"formats","Pixel formats (YUYV,YVYU,NV12,NV21,YUV420,YVU420).",
+                                     "list","NV12");
+    QCommandLineOption sizesOption(QStringList()<<"s"<<"sizes","Frame sizes.","list","1920x1080");
+    QCommandLineOption windowSizeOption("window-size","Window size, full screen if not set.","size");
+    QCommandLineOption framesOption(QStringList()<<"n"<<"frames","Measured frames per case.","count","600");
+    QCommandLineOption warmupOption("warmup","Warm-up frames per case.","count","60");
+    QCommandLineOption timeoutOption("timeout","Timeout per case in seconds.","seconds","30");
+    QCommandLineOption vsyncOption("vsync","Keep vertical sync on (frame_ms is then limited by the refresh rate).");
+    QCommandLineOption noPboOption("no-pbo","Upload frames directly instead of through PBOs.");
+    QCommandLineOption outputOption(QStringList()<<"o"<<"output","Save results to a JSON file.","file");
+    QCommandLineOption compareOption(QStringList()<<"c"<<"compare","Compare with a previously saved JSON file.","file");
+    parser.addOptions(QList<QCommandLineOption>()<<hostsOption<<formatsOption<<sizesOption<<windowSizeOption
+                      <<framesOption<<warmupOption<<timeoutOption<<vsyncOption<<noPboOption<<outputOption<<compareOption);
+    parser.process(a);
+
+    RenderBenchmark benchmark;
+    benchmark.setTimeout(qMax(parser.value(timeoutOption).toInt(),1));
+    benchmark.setPboUploadEnabled(!parser.isSet(noPboOption));
+
+    /*1.解析参数，生成测试用例*/
+    QList<RenderBenchmark::Host> hosts;
+    for(const QString &name : splitList(parser.value(hostsOption)))
+    {
+        if(name == RenderBenchmark::hostName(RenderBenchmark::WidgetHost))
+        {
+            hosts<<RenderBenchmark::WidgetHost;
+        }
+        else if(name == RenderBenchmark::hostName(RenderBenchmark::WindowHost))
+        {
+            hosts<<RenderBenchmark::WindowHost;
+        }
+        else
+        {
+            fprintf(stderr,"unknown host:%s\n",qPrintable(name));
+            return 1;
+        }
+    }
+    QList<uint> formats;
+    for(const QString &name : splitList(parser.value(formatsOption)))
+    {
+        uint format = RenderBenchmark::formatFromName(name);
+        if(format == 0)
+        {
+            fprintf(stderr,"unknown format:%s\n",qPrintable(name));
+            return 1;
+        }
+        formats<<format;
+    }
+    QList<QSize> sizes;
+    for(const QString &text : splitList(parser.value(sizesOption)))
+    {
+        QSize size = sizeFromText(text);
+        if(!size.isValid())
+        {
+            fprintf(stderr,"invalid size:%s\n",qPrintable(text));
+            return 1;
+        }
+        //yuv格式要求宽高为偶数
+        sizes<<QSize(size.width()&~1,size.height()&~1);
+    }
+    QSize windowSize;
+    if(parser.isSet(windowSizeOption))
+    {
+        windowSize = sizeFromText(parser.value(windowSizeOption));
+        if(!windowSize.isValid())
+        {
+            fprintf(stderr,"invalid window size:%s\n",qPrintable(parser.value(windowSizeOption)));
+            return 1;
+        }
+    }
+    const int frames = parser.value(framesOption).toInt();
+    if(frames < 1)
+    {
+        fprintf(stderr,"invalid frame count:%s\n",qPrintable(parser.value(framesOption)));
+        return 1;
+    }
+
+    QList<RenderBenchmark::Case> cases;
+    for(const QSize &size : sizes)
+    {
+        for(uint format : formats)
+        {
+            for(RenderBenchmark::Host host : hosts)
+            {
+                RenderBenchmark::Case testCase;
+                testCase.host = host;
+                testCase.pixelFormat = format;
+                testCase.frameSize = size;
+                testCase.windowSize = windowSize;
+                testCase.frames = frames;
+                testCase.warmup = parser.value(warmupOption).toInt();
+                cases<<testCase;
+            }
+        }
+    }
+
+    /*2.加载对比数据*/
+    QHash<QString,double> baseline;
+    if(parser.isSet(compareOption))
+    {
+        QFile file(parser.value(compareOption));
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            fprintf(stderr,"open compare file failed:%s\n",qPrintable(file.fileName()));
+            return 1;
+        }
+        const QJsonArray results = QJsonDocument::fromJson(file.readAll()).object().value("results").toArray();
+        for(const QJsonValue &value : results)
+        {
+            const QJsonObject object = value.toObject();
+            baseline.insert(object.value("name").toString(),object.value("ms_per_frame").toDouble());
+        }
+    }
+
+    /*3.运行测试并输出*/
+    printf("vsync:%s  pbo:%s  cases:%d\n",vsync?"on":"off",parser.isSet(noPboOption)?"off":"on",cases.size());
+    printf("%-36s %8s %10s %9s %13s %13s %7s%s\n","case","frames","frame_ms","fps","frame_gpu_ms","paint_gpu_ms",
+           "stale",baseline.isEmpty()?"":"   speedup");
+    QJsonArray results;
+    QHash<QString,double> widgetFrameMs;//同一帧格式和尺寸下OpenGLWidget的帧时间，用于计算合成开销
+    QHash<QString,double> widgetFrameGpuMs;//同上，整帧的GPU时间(不支持时间戳查询时为-1)
+    QString renderer;
+    for(const RenderBenchmark::Case &testCase : cases)
+    {
+        const RenderBenchmark::Result result = benchmark.run(testCase);
+        if(result.frames == 0)
+        {
+            fprintf(stderr,"%s: no frame measured\n",qPrintable(testCase.name()));
+            continue;
+        }
+        QString speedup;
+        if(baseline.value(testCase.name()) > 0)
+        {
+            speedup = QString("   x%1").arg(baseline.value(testCase.name())/result.msPerFrame(),0,'f',2);
+        }
+        printf("%-36s %8d %10.3f %9.1f %13s %13s %7llu%s\n",qPrintable(testCase.name()),result.frames,
+               result.msPerFrame(),result.fps(),qPrintable(gpuMsText(result.frameGpuMs)),
+               qPrintable(gpuMsText(result.paintGpuMs)),(unsigned long long)result.staleFrames,qPrintable(speedup));
+        fflush(stdout);
+        results.append(result.toJson());
+        renderer = result.renderer;
+
+        RenderBenchmark::Case widgetCase = testCase;
+        widgetCase.host = RenderBenchmark::WidgetHost;
+        if(testCase.host == RenderBenchmark::WidgetHost)
+        {
+            widgetFrameMs.insert(widgetCase.name(),result.msPerFrame());
+            widgetFrameGpuMs.insert(widgetCase.name(),result.frameGpuMs);
+        }
+        else if(widgetFrameMs.contains(widgetCase.name()))
+        {
+            const double widgetMs = widgetFrameMs.value(widgetCase.name());
+            printf("  composition overhead (widget - window): %.3f ms/frame (%.1f%%)\n",widgetMs - result.msPerFrame(),
+                   (widgetMs > 0)?(widgetMs - result.msPerFrame())*100/widgetMs:0.0);
+            const double widgetGpuMs = widgetFrameGpuMs.value(widgetCase.name());
+            if(widgetGpuMs > 0 && result.frameGpuMs > 0)
+            {
+                printf("  composition overhead on GPU (widget - window): %.3f ms/frame (%.1f%%)\n",
+                       widgetGpuMs - result.frameGpuMs,(widgetGpuMs - result.frameGpuMs)*100/widgetGpuMs);
+            }
+        }
+    }
+    printf("renderer:%s\n",qPrintable(renderer));
+
+    /*4.保存结果*/
+    if(parser.isSet(outputOption))
+    {
+        QJsonObject root;
+        QJsonObject host;
+        host["renderer"] = renderer;
+        host["vsync"] = vsync;
+        host["pbo"] = !parser.isSet(noPboOption);
+        root["host"] = host;
+        root["results"] = results;
+        QFile file(parser.value(outputOption));
+        if(!file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+        {
+            fprintf(stderr,"open output file failed:%s\n",qPrintable(file.fileName()));
+            return 1;
+        }
+        file.write(QJsonDocument(root).toJson());
+        printf("results saved to %s\n",qPrintable(file.fileName()));
+    }
+    return 0;
+}
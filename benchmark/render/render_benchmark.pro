@@ -0,0 +1,43 @@
+#-------------------------------------------------
+#
+# 显示宿主渲染性能测试程序
+# 对比OpenGLWidget(QOpenGLWidget，合成到顶层窗口)与OpenGLWindow(QOpenGLWindow，直接绘制到窗口表面)每帧的GPU时间
+# 注:需要在目标设备的图形环境(eglfs/xcb/wayland)下运行，使用Release模式编译
+#
+#-------------------------------------------------
+
+QT       += core gui widgets
+
+TARGET = render_benchmark
+TEMPLATE = app
+CONFIG += c++11
+CONFIG -= app_bundle
+
+#指定编译中间文件的目录
+MOC_DIR = ./build
+OBJECTS_DIR = ./build
+
+#被测试的渲染源码直接引用上上级目录
+INCLUDEPATH += ../..
+
+SOURCES += main.cpp \
+    renderbenchmark.cpp \
+    gputimer.cpp \
+    ../../v4l2rendering.cpp \
+    ../../openglwidget.cpp \
+    ../../openglwindow.cpp \
+    ../../framemailbox.cpp \
+    ../../colortorgb24.cpp \
+    ../../colorlut3d.cpp \
+    ../../framestatistics.cpp
+
+HEADERS += renderbenchmark.h \
+    gputimer.h \
+    ../../v4l2rendering.h \
+    ../../openglwidget.h \
+    ../../openglwindow.h \
+    ../../framemailbox.h \
+    ../../colortorgb24.h \
+    ../../colorlut3d.h \
+    ../../framestatistics.h \
+    ../../deinterlacer.h
@@ -0,0 +1,345 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   显示宿主(OpenGLWidget/OpenGLWindow)的渲染性能测试
+ */
+#include "renderbenchmark.h"
+#include "gputimer.h"
+#include "openglwidget.h"
+#include "openglwindow.h"
+#include "colortorgb24.h"
+#include <QWidget>
+#include <QOpenGLContext>
+#include <QVBoxLayout>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <stdio.h>
+
+namespace {
+/*支持测试的帧格式及名称(V4l2Rendering支持的格式)*/
+struct FormatName
+{
+    uint pixelFormat;
+    const char *name;
+};
+const FormatName formatNames[] = {
+    {V4L2_PIX_FMT_YUYV,"YUYV"},{V4L2_PIX_FMT_YVYU,"YVYU"},{V4L2_PIX_FMT_NV12,"NV12"},
+    {V4L2_PIX_FMT_NV21,"NV21"},{V4L2_PIX_FMT_YUV420,"YUV420"},{V4L2_PIX_FMT_YVU420,"YVU420"}
+};
+
+/*在宿主的paintGL()前后插入GPU计时查询，并统计整帧的GPU时间
+ *整帧:paintGL()开始时在宿主上下文中记录时间戳，frameSwapped()时在当前上下文中再记录一个。QOpenGLWidget的frameSwapped()
+ *在顶层窗口合成并交换缓冲之后发射，此时合成使用的上下文仍是当前的；QOpenGLWindow在自身上下文交换缓冲之后发射。所以两个
+ *时间戳之间包括了宿主的绘制以及(QOpenGLWidget的)合成，两种宿主可以直接比较。同一GPU上不同上下文的时间戳使用同一个时钟。*/
+template<class HostType>
+class TimedHost : public HostType
+{
+public:
+    template<typename... Args>
+    explicit TimedHost(Args... args)
+        : HostType(args...)
+    {
+        QObject::connect(this,&HostType::frameSwapped,this,[this](){markFrameEnd();});
+    }
+    ~TimedHost()
+    {
+        this->makeCurrent();
+        gpuTimer.destroy();
+        frameStartStamps.destroy();
+        //合成上下文的查询对象随该上下文释放
+    }
+
+    GpuTimer gpuTimer;
+
+    //清空整帧统计(尚未配对的时间戳也丢弃)
+    void resetFrameTimer()
+    {
+        frameDiscardBefore = frameSerial + 1;
+        frameTotalNs = 0;
+        frameSamples = 0;
+    }
+    quint64 frameSampleCount() const {return frameSamples;}
+    double frameAverageMs() const {return frameSamples?(frameTotalNs/1000000.0/frameSamples):-1;}
+
+protected:
+    virtual void initializeGL()
+    {
+        HostType::initializeGL();
+        gpuTimer.create();
+        frameStartStamps.create();
+    }
+    virtual void paintGL()
+    {
+        frameStartStamps.mark(++frameSerial);
+        gpuTimer.begin();
+        HostType::paintGL();
+        gpuTimer.end();
+        gpuTimer.collect();
+        frameStartStamps.collect(frameStarts);
+        matchFrames();
+    }
+
+private:
+    /*显示完成:在合成(或交换缓冲)所在的上下文中记录整帧结束的时间戳，同一帧只记录第一次合成*/
+    void markFrameEnd()
+    {
+        QOpenGLContext *context = QOpenGLContext::currentContext();
+        if(!context || frameSerial == lastEndSerial || !frameStartStamps.isValid())
+        {
+            return;
+        }
+        if(!frameEndStamps.isValid() && !frameEndCreated)
+        {
+            frameEndCreated = true;
+            frameEndStamps.create();
+        }
+        if(frameEndStamps.context() != context)
+        {
+            return;
+        }
+        lastEndSerial = frameSerial;
+        frameEndStamps.mark(frameSerial);
+        frameEndStamps.collect(frameEnds);
+        matchFrames();
+    }
+    /*开始和结束时间戳都已取回的帧计入统计*/
+    void matchFrames()
+    {
+        QHash<quint64,quint64>::iterator end = frameEnds.begin();
+        while(end != frameEnds.end())
+        {
+            QHash<quint64,quint64>::iterator start = frameStarts.find(end.key());
+            if(start == frameStarts.end())
+            {
+                ++end;
+                continue;
+            }
+            if(end.key() >= frameDiscardBefore && end.value() > start.value())
+            {
+                frameTotalNs += end.value() - start.value();
+                frameSamples++;
+            }
+            frameStarts.erase(start);
+            end = frameEnds.erase(end);
+        }
+        //没有合成的帧(被下一帧覆盖)或被丢弃的(disjoint)时间戳无法配对，只保留最近的
+        pruneStamps(frameStarts);
+        pruneStamps(frameEnds);
+    }
+    void pruneStamps(QHash<quint64,quint64> &stamps)
+    {
+        QHash<quint64,quint64>::iterator it = stamps.begin();
+        while(it != stamps.end())
+        {
+            it = (it.key() + 64 < frameSerial)?stamps.erase(it):(it + 1);
+        }
+    }
+
+    GpuTimestamps frameStartStamps;//宿主上下文
+    GpuTimestamps frameEndStamps;//合成(交换缓冲)上下文
+    bool frameEndCreated = false;
+    QHash<quint64,quint64> frameStarts;
+    QHash<quint64,quint64> frameEnds;
+    quint64 frameSerial = 0;
+    quint64 lastEndSerial = 0;
+    quint64 frameDiscardBefore = 0;
+    quint64 frameTotalNs = 0;
+    quint64 frameSamples = 0;
+};
+
+/*把宿主放入测试窗口:OpenGLWidget直接作为子控件，OpenGLWindow通过窗口容器嵌入(容器负责释放窗口)*/
+QWidget *embedHost(TimedHost<OpenGLWidget> *host,QWidget *)
+{
+    return host;
+}
+QWidget *embedHost(TimedHost<OpenGLWindow> *host,QWidget *parent)
+{
+    return QWidget::createWindowContainer(host,parent);
+}
+}
+
+RenderBenchmark::RenderBenchmark(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QString RenderBenchmark::Case::name() const
+{
+    return QString("%1/%2/%3x%4/%5").arg(hostName(host)).arg(formatName(pixelFormat))
+            .arg(frameSize.width()).arg(frameSize.height())
+            .arg(windowSize.isValid()?QString("%1x%2").arg(windowSize.width()).arg(windowSize.height()):QString("full"));
+}
+/*
+ *@brief:  测试结果转换成json对象
+ *@date:   2026.10.18
+ *@return: QJsonObject:测试结果
+ */
+QJsonObject RenderBenchmark::Result::toJson() const
+{
+    QJsonObject object;
+    object["name"] = testCase.name();
+    object["host"] = hostName(testCase.host);
+    object["format"] = formatName(testCase.pixelFormat);
+    object["width"] = testCase.frameSize.width();
+    object["height"] = testCase.frameSize.height();
+    object["frames"] = frames;
+    object["seconds"] = seconds;
+    object["ms_per_frame"] = msPerFrame();
+    object["fps"] = fps();
+    object["paint_gpu_ms"] = (paintGpuMs < 0)?QJsonValue():QJsonValue(paintGpuMs);
+    object["gpu_samples"] = double(gpuSamples);
+    object["frame_gpu_ms"] = (frameGpuMs < 0)?QJsonValue():QJsonValue(frameGpuMs);
+    object["frame_gpu_samples"] = double(frameGpuSamples);
+    object["stale_frames"] = double(staleFrames);
+    object["renderer"] = renderer;
+    return object;
+}
+/*
+ *@brief:  运行一个测试用例
+ *@date:   2026.10.18
+ *@param:  testCase:测试用例
+ *@return: Result:测试结果，frames为0表示失败
+ */
+RenderBenchmark::Result RenderBenchmark::run(const Case &testCase)
+{
+    fillFrames(testCase);
+    if(testCase.host == WindowHost)
+    {
+        return runHost<OpenGLWindow>(testCase);
+    }
+    return runHost<OpenGLWidget>(testCase);
+}
+/*
+ *@brief:  在测试窗口中显示宿主并统计
+ *注:每显示完一帧(frameSwapped)立即放入下一帧，预热帧之后开始计时，统计testCase.frames帧或超时后结束。
+ *@date:   2026.10.18
+ *@param:  testCase:测试用例
+ *@return: Result:测试结果
+ */
+template<class HostType>
+RenderBenchmark::Result RenderBenchmark::runHost(const Case &testCase)
+{
+    Result result;
+    result.testCase = testCase;
+
+    QWidget window;
+    window.setWindowTitle(testCase.name());
+    QVBoxLayout *layout = new QVBoxLayout(&window);
+    layout->setContentsMargins(0,0,0,0);
+    TimedHost<HostType> *host = new TimedHost<HostType>(testCase.pixelFormat,testCase.frameSize.width(),
+                                                        testCase.frameSize.height(),true);
+    host->setPboUploadEnabled(pboUpload);
+    layout->addWidget(embedHost(host,&window));
+
+    QEventLoop loop;
+    QElapsedTimer elapsed;
+    int swapped = 0;
+    const int warmup = qMax(testCase.warmup,1);
+    auto postFrame = [this,host,&swapped](){
+        uchar *frame[1] = {(uchar *)frameData[swapped & 1].data()};
+        host->postV4l2Frame(frame);
+    };
+    connect(host,&HostType::frameSwapped,&loop,[&](){
+        swapped++;
+        if(swapped == warmup)
+        {
+            elapsed.start();
+            host->gpuTimer.reset();
+            host->resetFrameTimer();
+        }
+        else if(swapped == warmup + testCase.frames)
+        {
+            result.frames = testCase.frames;
+            result.seconds = elapsed.nsecsElapsed()/1e9;
+            loop.quit();
+            return;
+        }
+        postFrame();
+    });
+    QTimer::singleShot(timeout*1000,&loop,[&](){
+        fprintf(stderr,"%s: timeout after %d frames\n",qPrintable(testCase.name()),swapped);
+        if(elapsed.isValid())
+        {
+            result.frames = swapped - warmup;
+            result.seconds = elapsed.nsecsElapsed()/1e9;
+        }
+        loop.quit();
+    });
+
+    if(testCase.windowSize.isValid())
+    {
+        window.resize(testCase.windowSize);
+        window.show();
+    }
+    else
+    {
+        window.showFullScreen();
+    }
+    postFrame();
+    loop.exec();
+
+    //取回剩余的GPU计时结果
+    host->makeCurrent();
+    host->gpuTimer.collect(true);
+    host->doneCurrent();
+    result.renderer = host->gpuTimer.renderer();
+    result.gpuSamples = host->gpuTimer.sampleCount();
+    result.paintGpuMs = host->gpuTimer.isValid()?host->gpuTimer.averageMs():-1;
+    result.frameGpuMs = host->frameAverageMs();
+    result.frameGpuSamples = host->frameSampleCount();
+    result.staleFrames = host->staleFrameCount();
+    return result;
+}
+/*
+ *@brief:  生成两帧内容不同的合成帧(交替放入，每一帧都需要重新上传纹理)
+ *@date:   2026.10.18
+ *@param:  testCase:测试用例
+ */
+void RenderBenchmark::fillFrames(const Case &testCase)
+{
+    const uint bytes = ColorToRgb24::frameBytes(testCase.pixelFormat,testCase.frameSize.width(),
+                                                testCase.frameSize.height());
+    for(int f=0;f<2;f++)
+    {
+        frameData[f].resize(bytes);
+        uchar *data = (uchar *)frameData[f].data();
+        for(uint i=0;i<bytes;i++)
+        {
+            data[i] = uchar((i*7 + f*1024) >> 3);
+        }
+    }
+}
+
+QString RenderBenchmark::hostName(Host host)
+{
+    return (host == WindowHost)?QString("window"):QString("widget");
+}
+QString RenderBenchmark::formatName(uint pixelFormat)
+{
+    for(const FormatName &format : formatNames)
+    {
+        if(format.pixelFormat == pixelFormat)
+        {
+            return format.name;
+        }
+    }
+    return QString::number(pixelFormat,16);
+}
+uint RenderBenchmark::formatFromName(const QString &name)
+{
+    for(const FormatName &format : formatNames)
+    {
+        if(name.compare(format.name,Qt::CaseInsensitive) == 0)
+        {
+            return format.pixelFormat;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   显示宿主(OpenGLWidget/OpenGLWindow)的渲染性能测试
+ *
+ *两种宿主使用同一个V4l2Rendering，区别只在于OpenGLWidget先绘制到组件的FBO，再由Qt合成到顶层窗口(多一次全屏纹理blit)，
+ *OpenGLWindow(通过QWidget::createWindowContainer()嵌入)直接绘制到窗口表面。测试时使用合成的帧数据，每显示完一帧
+ *(frameSwapped)立即放入下一帧，统计:
+ *1.frame_ms:关闭垂直同步时每显示一帧的平均间隔(包括合成)，GPU是瓶颈时即每帧的GPU时间；
+ *2.frame_gpu_ms:从paintGL()开始到显示完成(frameSwapped)的GPU时间(GL_TIMESTAMP)，包括QOpenGLWidget在顶层窗口中的合成，
+ *两种宿主的差值即合成的开销(开启垂直同步时交换缓冲在GPU上的等待也会计入，此时只用于两种宿主之间的比较)；
+ *3.paint_gpu_ms:只是paintGL()中提交的命令在GPU上的执行时间(GpuTimer)，两种宿主基本相同，用于确认差异来自合成而不是绘制。
+ */
+#ifndef RENDERBENCHMARK_H
+#define RENDERBENCHMARK_H
+
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+
+class RenderBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    //显示宿主
+    enum Host
+    {
+        WidgetHost = 0,//OpenGLWidget(QOpenGLWidget，合成到顶层窗口)
+        WindowHost//OpenGLWindow(QOpenGLWindow+createWindowContainer，直接绘制到窗口表面)
+    };
+    struct Case
+    {
+        Host host = WidgetHost;
+        uint pixelFormat = 0;
+        QSize frameSize = QSize(1920,1080);
+        QSize windowSize;//无效尺寸表示全屏
+        int frames = 600;//统计的帧数
+        int warmup = 60;//预热帧数(着色器编译、FBO和PBO分配等)
+
+        QString name() const;//唯一标识，用于对比两次测试结果
+    };
+    struct Result
+    {
+        Case testCase;
+        int frames = 0;//实际统计的帧数(超时时小于testCase.frames)
+        double seconds = 0;
+        double paintGpuMs = -1;//不支持GPU计时时为-1
+        quint64 gpuSamples = 0;
+        double frameGpuMs = -1;//整帧(包括合成)的GPU时间，不支持时间戳查询时为-1
+        quint64 frameGpuSamples = 0;
+        quint64 staleFrames = 0;
+        QString renderer;
+
+        double msPerFrame() const {return frames?(seconds*1000/frames):0;}
+        double fps() const {return seconds>0?(frames/seconds):0;}
+        QJsonObject toJson() const;
+    };
+
+    explicit RenderBenchmark(QObject *parent = nullptr);
+
+    void setTimeout(int seconds){timeout = seconds;}
+    void setPboUploadEnabled(bool enabled){pboUpload = enabled;}
+    Result run(const Case &testCase);
+
+    static QString hostName(Host host);
+    static QString formatName(uint pixelFormat);
+    static uint formatFromName(const QString &name);
+
+private:
+    template<class HostType>
+    Result runHost(const Case &testCase);
+    void fillFrames(const Case &testCase);
+
+    int timeout = 30;//每个用例的超时时间(秒)
+    bool pboUpload = true;
+    QByteArray frameData[2];//两帧内容不同的合成帧，交替放入
+};
+
+#endif // RENDERBENCHMARK_H
@@ -0,0 +1,364 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   3D LUT颜色分级(加载.cube文件)，供软解码(ColorToRgb24)和OpenGL渲染(V4l2Rendering)共用
+ */
+#include "colorlut3d.h"
+#include "colortorgb24.h"//ENABLE_SIMD_CONVERT
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QDebug>
+#include <math.h>
+#include <string.h>
+
+/*根据编译器支持的指令集确定SIMD实现方式(与ColorToRgb24一致)*/
+#ifdef ENABLE_SIMD_CONVERT
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define COLOR_LUT3D_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define COLOR_LUT3D_SSE2
+#endif
+#endif
+
+ColorLut3D::ColorLut3D()
+{
+    memset(indexTable,0,sizeof(indexTable));
+    memset(fracTable,0,sizeof(fracTable));
+}
+/*
+ *@brief:  加载.cube文件
+ *注:支持TITLE、LUT_3D_SIZE、DOMAIN_MIN、DOMAIN_MAX、LUT_3D_INPUT_RANGE关键字，数据行为三个浮点数(r最快变化)，
+ *输出值超出[0,1]的部分会被截断。加载失败时保留原有数据不变。
+ *@date:   2026.10.18
+ *@param:  fileName:.cube文件路径
+ *@return: bool:true=加载成功
+ */
+bool ColorLut3D::loadCubeFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug()<<QString("open cube file %1 failed!").arg(fileName);
+        return false;
+    }
+
+    QTextStream stream(&file);
+    QString title;
+    int size = 0;
+    float domainMin[3] = {0.0f,0.0f,0.0f};
+    float domainMax[3] = {1.0f,1.0f,1.0f};
+    std::vector<float> data;
+    int lineNumber = 0;
+    while(!stream.atEnd())
+    {
+        QString line = stream.readLine().simplified();
+        lineNumber++;
+        if(line.isEmpty() || line.startsWith('#'))
+        {
+            continue;
+        }
+        QStringList fields = line.split(' ');
+        const QString &key = fields.at(0);
+        if(key == "TITLE")
+        {
+            title = line.mid(5).trimmed().remove('"');
+        }
+        else if(key == "LUT_3D_SIZE" && fields.size() == 2)
+        {
+            size = fields.at(1).toInt();
+            if(size < 2 || size > 256)
+            {
+                qDebug()<<QString("cube file %1: unsupported LUT_3D_SIZE %2").arg(fileName).arg(size);
+                return false;
+            }
+            data.reserve(size_t(size)*size*size*3);
+        }
+        else if((key == "DOMAIN_MIN" || key == "DOMAIN_MAX") && fields.size() == 4)
+        {
+            float *domain = (key == "DOMAIN_MIN")?domainMin:domainMax;
+            for(int i=0;i<3;i++)
+            {
+                domain[i] = fields.at(i+1).toFloat();
+            }
+        }
+        else if(key == "LUT_3D_INPUT_RANGE" && fields.size() == 3)
+        {
+            for(int i=0;i<3;i++)
+            {
+                domainMin[i] = fields.at(1).toFloat();
+                domainMax[i] = fields.at(2).toFloat();
+            }
+        }
+        else if(key == "LUT_1D_SIZE")
+        {
+            qDebug()<<QString("cube file %1: 1D LUT is not supported").arg(fileName);
+            return false;
+        }
+        else if(key.at(0).isLetter())
+        {
+            //其他关键字(如LUT_1D_INPUT_RANGE等)不影响3D LUT，直接忽略
+            continue;
+        }
+        else
+        {
+            bool ok = (fields.size() == 3);
+            for(int i=0;ok && i<3;i++)
+            {
+                data.push_back(fields.at(i).toFloat(&ok));
+            }
+            if(!ok)
+            {
+                qDebug()<<QString("cube file %1: invalid data at line %2").arg(fileName).arg(lineNumber);
+                return false;
+            }
+        }
+    }
+    if(size == 0 || data.size() != size_t(size)*size*size*3)
+    {
+        qDebug()<<QString("cube file %1: expect %2 entries, got %3")
+                  .arg(fileName).arg(size_t(size)*size*size).arg(data.size()/3);
+        return false;
+    }
+    for(int i=0;i<3;i++)
+    {
+        if(!(domainMax[i] > domainMin[i]))
+        {
+            qDebug()<<QString("cube file %1: invalid domain").arg(fileName);
+            return false;
+        }
+    }
+
+    //格点输出值放大255*64倍存储，16位定点插值后右移14位(64*256)即为8位结果
+    std::vector<Node> lutNodes(size_t(size)*size*size);
+    for(size_t i=0;i<lutNodes.size();i++)
+    {
+        quint16 *value = &lutNodes[i].r;
+        for(int c=0;c<3;c++)
+        {
+            float v = data[i*3+c];
+            v = (v > 1.0f)?1.0f:(v < 0.0f)?0.0f:v;
+            value[c] = quint16(v*255.0f*64.0f+0.5f);
+        }
+        lutNodes[i].pad = 0;
+    }
+
+    lutSize = size;
+    lutTitle = title;
+    nodes.swap(lutNodes);
+    buildInputTables(domainMin,domainMax);
+    return true;
+}
+/*
+ *@brief:  生成8位输入到格点索引和权重的映射表，热点循环内只需查表，不需要除法
+ *@date:   2026.10.18
+ *@param:  domainMin,domainMax:各通道的输入范围
+ */
+void ColorLut3D::buildInputTables(const float domainMin[], const float domainMax[])
+{
+    const quint32 stride[3] = {1,quint32(lutSize),quint32(lutSize*lutSize)};
+    for(int c=0;c<3;c++)
+    {
+        for(int v=0;v<256;v++)
+        {
+            float t = (v/255.0f - domainMin[c])/(domainMax[c] - domainMin[c]);
+            t = (t > 1.0f)?1.0f:(t < 0.0f)?0.0f:t;
+            float pos = t*(lutSize-1);
+            int index = int(floorf(pos));
+            int frac = int((pos-index)*256.0f+0.5f);
+            //最后一个格点没有下一个格点，改为前一个格点的权重256
+            if(index >= lutSize-1)
+            {
+                index = lutSize-2;
+                frac = 256;
+            }
+            indexTable[c][v] = index*stride[c];
+            fracTable[c][v] = frac;
+        }
+    }
+}
+/*
+ *@brief:  确定像素所在的四面体(格点立方体按权重大小顺序切分为6个四面体)
+ *四面体的4个顶点依次为立方体的起点(base)、base+offset1、base+offset2、对角点，权重之和为256
+ *@date:   2026.10.18
+ *@param:  r,g,b:输入颜色
+ *@param:  offset1,offset2:第二、三个顶点相对起点的索引偏移
+ *@param:  weight:4个顶点的权重
+ *@return: uint:起点格点的索引
+ */
+uint ColorLut3D::tetrahedron(int r, int g, int b, uint &offset1, uint &offset2, int weight[]) const
+{
+    const int fr = fracTable[0][r];
+    const int fg = fracTable[1][g];
+    const int fb = fracTable[2][b];
+    const uint sR = 1;
+    const uint sG = lutSize;
+    const uint sB = lutSize*lutSize;
+    if(fr >= fg)
+    {
+        if(fg >= fb)//r>=g>=b
+        {
+            offset1 = sR;offset2 = sR+sG;
+            weight[0] = 256-fr;weight[1] = fr-fg;weight[2] = fg-fb;weight[3] = fb;
+        }
+        else if(fr >= fb)//r>=b>g
+        {
+            offset1 = sR;offset2 = sR+sB;
+            weight[0] = 256-fr;weight[1] = fr-fb;weight[2] = fb-fg;weight[3] = fg;
+        }
+        else//b>r>=g
+        {
+            offset1 = sB;offset2 = sR+sB;
+            weight[0] = 256-fb;weight[1] = fb-fr;weight[2] = fr-fg;weight[3] = fg;
+        }
+    }
+    else
+    {
+        if(fb > fg)//b>g>r
+        {
+            offset1 = sB;offset2 = sG+sB;
+            weight[0] = 256-fb;weight[1] = fb-fg;weight[2] = fg-fr;weight[3] = fr;
+        }
+        else if(fb > fr)//g>=b>r
+        {
+            offset1 = sG;offset2 = sG+sB;
+            weight[0] = 256-fg;weight[1] = fg-fb;weight[2] = fb-fr;weight[3] = fr;
+        }
+        else//g>r>=b
+        {
+            offset1 = sG;offset2 = sR+sG;
+            weight[0] = 256-fg;weight[1] = fg-fr;weight[2] = fr-fb;weight[3] = fb;
+        }
+    }
+    return indexTable[0][r] + indexTable[1][g] + indexTable[2][b];
+}
+/*
+ *@brief:  对连续的像素原地进行颜色分级(四面体插值)
+ *注:每个像素的4个格点各通过一次8字节加载取出，SIMD实现将r、g、b三个通道放在同一个向量中并行乘加。
+ *@date:   2026.10.18
+ *@param:  pixels:像素数据地址
+ *@param:  count:像素个数
+ *@param:  bytesPerPixel:每个像素的字节数
+ *@param:  rOffset,gOffset,bOffset:r、g、b分量在像素内的字节偏移
+ */
+void ColorLut3D::applyRow(uchar *pixels, uint count, uint bytesPerPixel,
+                          uint rOffset, uint gOffset, uint bOffset) const
+{
+    if(!isValid())
+    {
+        return;
+    }
+    const Node *lut = nodes.data();
+    const uint diagonal = 1 + lutSize + lutSize*lutSize;
+    uint offset1,offset2;
+    int w[4];
+    for(uint i=0;i<count;i++,pixels+=bytesPerPixel)
+    {
+        const uint base = tetrahedron(pixels[rOffset],pixels[gOffset],pixels[bOffset],offset1,offset2,w);
+        const Node *n0 = lut + base;
+        const Node *n1 = n0 + offset1;
+        const Node *n2 = n0 + offset2;
+        const Node *n3 = n0 + diagonal;
+#if defined(COLOR_LUT3D_NEON)
+        uint32x4_t acc = vmull_n_u16(vld1_u16(&n0->r),w[0]);
+        acc = vmlal_n_u16(acc,vld1_u16(&n1->r),w[1]);
+        acc = vmlal_n_u16(acc,vld1_u16(&n2->r),w[2]);
+        acc = vmlal_n_u16(acc,vld1_u16(&n3->r),w[3]);
+        uint16x4_t result = vrshrn_n_u32(acc,14);
+        pixels[rOffset] = vget_lane_u16(result,0);
+        pixels[gOffset] = vget_lane_u16(result,1);
+        pixels[bOffset] = vget_lane_u16(result,2);
+#elif defined(COLOR_LUT3D_SSE2)
+        //两个格点按通道交错，与成对的权重做madd，即可一次得到两个格点的加权和
+        __m128i n01 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)n0),_mm_loadl_epi64((const __m128i *)n1));
+        __m128i n23 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)n2),_mm_loadl_epi64((const __m128i *)n3));
+        __m128i sum = _mm_add_epi32(_mm_madd_epi16(n01,_mm_set1_epi32((w[1]<<16)|w[0])),
+                                    _mm_madd_epi16(n23,_mm_set1_epi32((w[3]<<16)|w[2])));
+        sum = _mm_srli_epi32(_mm_add_epi32(sum,_mm_set1_epi32(1<<13)),14);
+        sum = _mm_packs_epi32(sum,sum);
+        pixels[rOffset] = _mm_extract_epi16(sum,0);
+        pixels[gOffset] = _mm_extract_epi16(sum,1);
+        pixels[bOffset] = _mm_extract_epi16(sum,2);
+#else
+        pixels[rOffset] = (w[0]*n0->r + w[1]*n1->r + w[2]*n2->r + w[3]*n3->r + (1<<13))>>14;
+        pixels[gOffset] = (w[0]*n0->g + w[1]*n1->g + w[2]*n2->g + w[3]*n3->g + (1<<13))>>14;
+        pixels[bOffset] = (w[0]*n0->b + w[1]*n1->b + w[2]*n2->b + w[3]*n3->b + (1<<13))>>14;
+#endif
+    }
+}
+/*
+ *@brief:  生成3D纹理数据(RGBA8，尺寸size*size*size，r最快变化)
+ *@date:   2026.10.18
+ *@return: QByteArray:纹理数据，LUT无效时为空
+ */
+QByteArray ColorLut3D::textureData3D() const
+{
+    QByteArray data(int(nodes.size()*4),char(0xff));
+    uchar *dst = (uchar *)data.data();
+    for(size_t i=0;i<nodes.size();i++,dst+=4)
+    {
+        dst[0] = (nodes[i].r + 32)>>6;
+        dst[1] = (nodes[i].g + 32)>>6;
+        dst[2] = (nodes[i].b + 32)>>6;
+    }
+    return data;
+}
+/*
+ *@brief:  2D纹理(atlas)平铺b切片的列数，尽量接近正方形，避免65^3时单行宽度(4225)超过OpenGL ES 2.0常见的最大纹理尺寸
+ *@date:   2026.10.18
+ */
+int ColorLut3D::atlasColumns() const
+{
+    return int(ceil(sqrt(double(lutSize))));
+}
+/*
+ *@brief:  2D纹理(atlas)的尺寸
+ *@date:   2026.10.18
+ */
+QSize ColorLut3D::atlasSize() const
+{
+    if(!isValid())
+    {
+        return QSize();
+    }
+    const int columns = atlasColumns();
+    const int rows = (lutSize + columns - 1)/columns;
+    return QSize(columns*lutSize,rows*lutSize);
+}
+/*
+ *@brief:  生成2D纹理(atlas)数据(RGBA8)，第b个切片位于(b%columns,b/columns)，切片内x=r、y=g
+ *@date:   2026.10.18
+ *@return: QByteArray:纹理数据，LUT无效时为空
+ */
+QByteArray ColorLut3D::textureDataAtlas() const
+{
+    const QSize atlas = atlasSize();
+    QByteArray data(atlas.width()*atlas.height()*4,char(0));
+    const int columns = atlasColumns();
+    for(int b=0;b<lutSize;b++)
+    {
+        const int sliceX = (b%columns)*lutSize;
+        const int sliceY = (b/columns)*lutSize;
+        for(int g=0;g<lutSize;g++)
+        {
+            uchar *dst = (uchar *)data.data() + ((sliceY+g)*atlas.width() + sliceX)*4;
+            const Node *src = nodes.data() + (size_t(b)*lutSize + g)*lutSize;
+            for(int r=0;r<lutSize;r++,dst+=4,src++)
+            {
+                dst[0] = (src->r + 32)>>6;
+                dst[1] = (src->g + 32)>>6;
+                dst[2] = (src->b + 32)>>6;
+                dst[3] = 0xff;
+            }
+        }
+    }
+    return data;
+}
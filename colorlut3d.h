@@ -0,0 +1,71 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   3D LUT颜色分级(加载.cube文件)，供软解码(ColorToRgb24)和OpenGL渲染(V4l2Rendering)共用
+ *
+ *.cube文件(Adobe/Resolve通用格式)描述了一个N*N*N的rgb格点，每个格点记录输入颜色映射后的输出颜色，常见尺寸为17/33/65。
+ *软解码使用四面体插值(每个像素读取4个格点，比三线性插值少一半访存，且在灰阶上没有色偏)，格点按r最快变化的顺序存储，每个格点
+ *为4个16位分量(r,g,b,0)共8字节，一次加载即可取出一个格点，且不会跨越缓存行；支持SIMD时每个像素的三个通道并行计算。
+ *OpenGL渲染时使用3D纹理(OpenGL/OpenGL ES 3.0)由硬件完成三线性插值，OpenGL ES 2.0不支持3D纹理，则将各个b切片平铺成
+ *一张2D纹理(atlas)，片内由硬件双线性插值，片间在着色器中插值。
+ */
+#ifndef COLORLUT3D_H
+#define COLORLUT3D_H
+
+#include "qglobal.h"
+#include <QString>
+#include <QByteArray>
+#include <QSize>
+#include <vector>
+
+class ColorLut3D
+{
+public:
+    ColorLut3D();
+
+    //加载.cube文件(仅支持LUT_3D_SIZE，尺寸范围[2,256])
+    bool loadCubeFile(const QString &fileName);
+
+    bool isValid() const {return lutSize > 0;}
+    int size() const {return lutSize;}
+    QString title() const {return lutTitle;}
+
+    //对一行(或一段连续的)像素原地进行颜色分级，通过各通道的字节偏移适配不同的rgb输出格式
+    void applyRow(uchar *pixels,uint count,uint bytesPerPixel,
+                  uint rOffset,uint gOffset,uint bOffset) const;
+
+    /*纹理数据(RGBA8)
+     *3D纹理:尺寸为size*size*size，按r、g、b顺序排列，可直接上传
+     *2D纹理(atlas):b切片按atlasColumns()列平铺，尺寸为atlasSize()*/
+    QByteArray textureData3D() const;
+    QByteArray textureDataAtlas() const;
+    int atlasColumns() const;
+    QSize atlasSize() const;
+
+private:
+    //格点(输出颜色放大255*64倍，范围[0,16320]，便于16位定点插值)
+    struct alignas(8) Node
+    {
+        quint16 r;
+        quint16 g;
+        quint16 b;
+        quint16 pad;
+    };
+    void buildInputTables(const float domainMin[3],const float domainMax[3]);
+    inline uint tetrahedron(int r,int g,int b,uint &offset1,uint &offset2,int weight[4]) const;
+
+    int lutSize = 0;
+    QString lutTitle;
+    std::vector<Node> nodes;
+    //8位输入到格点的映射表:index为乘上对应步长(r:1 g:size b:size*size)后的格点索引，frac为格点间的权重[0,256]
+    quint32 indexTable[3][256];
+    quint16 fracTable[3][256];
+};
+
+#endif // COLORLUT3D_H
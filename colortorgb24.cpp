@@ -7,189 +7,1629 @@
 /*
  *@author:  缪庆瑞
  *@date:    2024.03.21
- *@brief:   将指定颜色空间数据转换为rgb24格式(软解码)
+ *@update:  2026.10.18
+ *@brief:   将指定颜色空间数据转换为rgb24(及32位rgb)格式(软解码)
  */
 #include "colortorgb24.h"
+#include "colorlut3d.h"
+#include "framestatistics.h"
 #include <QDebug>
 #include <QTime>
-
-ColorToRgb24::ColorAdjustmentParam ColorToRgb24::colorAdjustParam;
-int ColorToRgb24::brightnessLUT[256] = {0};
-int ColorToRgb24::contrastLUT[256] = {0};
-int ColorToRgb24::saturationLUT[511] = {0};
+#include <vector>
+#include <new>
+#include <string.h>
 
 ColorToRgb24::ColorToRgb24()
+    : adjustLutState(quintptr(ColorAdjustLut::create(ColorAdjustmentParam(),QSharedPointer<const ColorLut3D>())))
+{
+
+}
+
+ColorToRgb24::~ColorToRgb24()
+{
+    //析构时已经没有读者，释放发布中的快照
+    reinterpret_cast<const ColorAdjustLut *>(adjustLutState.load() & ~LUT_ACQUIRE_MASK)->unref();
+}
+/*转换期间持有查表快照的一份引用(分离引用计数):
+ *1.先在adjustLutState的低位登记(CAS加一)，同时读到快照地址，登记期间写者即使替换了快照，也会把登记数转交给旧快照的
+ *引用计数，所以该快照不会被释放；
+ *2.快照引用计数加一后撤销登记:地址未变时CAS减一，已被替换时写者已经代为加过一次，改为对快照引用计数减一。
+ *读者之间、读者与写者之间只有CAS重试，不加锁也不等待，写者发布新快照后不等待读者，旧快照在最后一个引用释放时释放*/
+class ColorToRgb24::LutReader
+{
+public:
+    explicit LutReader(ColorToRgb24 *converter)
+    {
+        std::atomic<quintptr> &state = converter->adjustLutState;
+        quintptr current = state.load(std::memory_order_relaxed);
+        while(true)
+        {
+            if((current & LUT_ACQUIRE_MASK) == LUT_ACQUIRE_MASK)
+            {
+                //同时登记的读者超过63个(极少出现)，等待其他读者撤销登记
+                current = state.load(std::memory_order_relaxed);
+                continue;
+            }
+            if(state.compare_exchange_weak(current,current+1,std::memory_order_acquire,std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        snapshot = reinterpret_cast<const ColorAdjustLut *>(current & ~LUT_ACQUIRE_MASK);
+        snapshot->refCount.fetch_add(1,std::memory_order_relaxed);
+
+        quintptr registered = current + 1;
+        while(true)
+        {
+            if((registered & ~LUT_ACQUIRE_MASK) != quintptr(snapshot))
+            {
+                snapshot->unref();//写者已经把登记转交给快照的引用计数
+                break;
+            }
+            if(state.compare_exchange_weak(registered,registered-1,std::memory_order_relaxed,std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+    }
+    ~LutReader()
+    {
+        snapshot->unref();
+    }
+    const ColorAdjustLut *lut() const {return snapshot;}
+
+private:
+    const ColorAdjustLut *snapshot;
+
+    Q_DISABLE_COPY(LutReader)
+};
+/*根据编译器支持的指令集确定SIMD实现方式*/
+#ifdef ENABLE_SIMD_CONVERT
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define COLOR_CONVERT_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define COLOR_CONVERT_SSE2
+#endif
+#endif
+
+namespace {
+/*输出像素格式的写入方式
+ *bytesPerPixel:每个像素的字节数  rOffset/gOffset/bOffset:r、g、b分量在像素内的字节偏移(3D LUT原地处理时使用)
+ *write():写入一个像素(rgb已经限定在[0,255])
+ *hasSimd/storeSimd8():SIMD实现中一次写入8个像素，不支持的格式hasSimd为false*/
+struct Rgb888Writer
+{
+    enum {bytesPerPixel = 3};
+    enum {rOffset = 0,gOffset = 1,bOffset = 2};
+    static inline void write(uchar *dst,int r,int g,int b)
+    {
+        dst[0] = r;
+        dst[1] = g;
+        dst[2] = b;
+    }
+#if defined(COLOR_CONVERT_NEON)
+    enum {hasSimd = true};
+    static inline void storeSimd8(uchar *dst,uint8x8_t r,uint8x8_t g,uint8x8_t b)
+    {
+        uint8x8x3_t pixels = {{r,g,b}};
+        vst3_u8(dst,pixels);
+    }
+#elif defined(COLOR_CONVERT_SSE2)
+    //SSE2没有三字节交错存储指令，拼接的代价比标量还高，所以不提供SIMD实现
+    enum {hasSimd = false};
+    static inline void storeSimd8(uchar *,__m128i,__m128i,__m128i){}
+#endif
+};
+//32位整形0xffRRGGBB，与字节序无关(ARGB32_Premultiplied在alpha为0xff时与之完全一致)
+struct Rgb32Writer
+{
+    enum {bytesPerPixel = 4};
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    enum {rOffset = 2,gOffset = 1,bOffset = 0};
+#else
+    enum {rOffset = 1,gOffset = 2,bOffset = 3};
+#endif
+    static inline void write(uchar *dst,int r,int g,int b)
+    {
+        *(quint32 *)dst = 0xff000000u|(r<<16)|(g<<8)|b;
+    }
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+#if defined(COLOR_CONVERT_NEON)
+    enum {hasSimd = true};
+    static inline void storeSimd8(uchar *dst,uint8x8_t r,uint8x8_t g,uint8x8_t b)
+    {
+        uint8x8x4_t pixels = {{b,g,r,vdup_n_u8(0xff)}};
+        vst4_u8(dst,pixels);
+    }
+#elif defined(COLOR_CONVERT_SSE2)
+    enum {hasSimd = true};
+    static inline void storeSimd8(uchar *dst,__m128i r,__m128i g,__m128i b)
+    {
+        __m128i bg = _mm_unpacklo_epi8(b,g);
+        __m128i ra = _mm_unpacklo_epi8(r,_mm_set1_epi8((char)0xff));
+        _mm_storeu_si128((__m128i *)dst,_mm_unpacklo_epi16(bg,ra));
+        _mm_storeu_si128((__m128i *)(dst+16),_mm_unpackhi_epi16(bg,ra));
+    }
+#endif
+#else
+    enum {hasSimd = false};
+#endif
+};
+//R,G,B,0xff四字节
+struct Rgbx8888Writer
+{
+    enum {bytesPerPixel = 4};
+    enum {rOffset = 0,gOffset = 1,bOffset = 2};
+    static inline void write(uchar *dst,int r,int g,int b)
+    {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        *(quint32 *)dst = 0xff000000u|(b<<16)|(g<<8)|r;
+#else
+        *(quint32 *)dst = (r<<24)|(g<<16)|(b<<8)|0xffu;
+#endif
+    }
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+#if defined(COLOR_CONVERT_NEON)
+    enum {hasSimd = true};
+    static inline void storeSimd8(uchar *dst,uint8x8_t r,uint8x8_t g,uint8x8_t b)
+    {
+        uint8x8x4_t pixels = {{r,g,b,vdup_n_u8(0xff)}};
+        vst4_u8(dst,pixels);
+    }
+#elif defined(COLOR_CONVERT_SSE2)
+    enum {hasSimd = true};
+    static inline void storeSimd8(uchar *dst,__m128i r,__m128i g,__m128i b)
+    {
+        __m128i rg = _mm_unpacklo_epi8(r,g);
+        __m128i ba = _mm_unpacklo_epi8(b,_mm_set1_epi8((char)0xff));
+        _mm_storeu_si128((__m128i *)dst,_mm_unpacklo_epi16(rg,ba));
+        _mm_storeu_si128((__m128i *)(dst+16),_mm_unpackhi_epi16(rg,ba));
+    }
+#endif
+#else
+    enum {hasSimd = false};
+#endif
+};
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+//小端字节序下B,G,R,0xff四字节与RGB32存储一致
+typedef Rgb32Writer Bgra8888Writer;
+#else
+struct Bgra8888Writer
+{
+    enum {bytesPerPixel = 4};
+    enum {rOffset = 2,gOffset = 1,bOffset = 0};
+    enum {hasSimd = false};
+    static inline void write(uchar *dst,int r,int g,int b)
+    {
+        *(quint32 *)dst = (b<<24)|(g<<16)|(r<<8)|0xffu;
+    }
+};
+#endif
+
+#if defined(COLOR_CONVERT_NEON)
+/*
+ *@brief:   SIMD一次转换8个像素(NEON)
+ *通过vqdmulh(2*a*b>>16)实现16位定点乘法：分量先左移7位，与放大256倍的系数相乘后右移16位再乘2，结果即为(分量*系数)>>8
+ *@param:   y,u,v:8个像素对应的yuv分量(u、v已按像素展开)
+ *@param:   r,g,b:转换结果，已饱和到[0,255]
+ */
+template<class Coef>
+inline void yuvToRgbSimd8(uint8x8_t y,uint8x8_t u,uint8x8_t v,uint8x8_t &r,uint8x8_t &g,uint8x8_t &b)
+{
+    int16x8_t y16 = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)),vdupq_n_s16(Coef::yOff)),7);
+    int16x8_t u16 = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)),vdupq_n_s16(128)),7);
+    int16x8_t v16 = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)),vdupq_n_s16(128)),7);
+    int16x8_t yTerm = vqdmulhq_n_s16(y16,Coef::yMul);
+    r = vqmovun_s16(vaddq_s16(yTerm,vqdmulhq_n_s16(v16,Coef::rv)));
+    g = vqmovun_s16(vsubq_s16(vsubq_s16(yTerm,vqdmulhq_n_s16(u16,Coef::gu)),vqdmulhq_n_s16(v16,Coef::gv)));
+    b = vqmovun_s16(vaddq_s16(yTerm,vqdmulhq_n_s16(u16,Coef::bu)));
+}
+/*将交错存储的4组uv(u0,v0,u1,v1...)展开为每个像素对应的u、v(u0,u0,u1,u1...)*/
+inline void expandUvSimd8(uint8x8_t uv,uint8x8_t &u,uint8x8_t &v)
+{
+    uint8x8x2_t unzip = vuzp_u8(uv,uv);
+    u = vzip_u8(unzip.val[0],unzip.val[0]).val[0];
+    v = vzip_u8(unzip.val[1],unzip.val[1]).val[0];
+}
+#elif defined(COLOR_CONVERT_SSE2)
+/*
+ *@brief:   SIMD一次转换8个像素(SSE2)
+ *通过mulhi(a*b>>16)实现16位定点乘法：分量先左移7位，与放大512倍的系数相乘后右移16位，结果即为(分量*系数)>>8
+ *@param:   y,u,v:8个像素对应的yuv分量(16位，u、v已按像素展开)
+ *@param:   r,g,b:转换结果，低8字节有效，已饱和到[0,255]
+ */
+template<class Coef>
+inline void yuvToRgbSimd8(__m128i y,__m128i u,__m128i v,__m128i &r,__m128i &g,__m128i &b)
+{
+    __m128i y16 = _mm_slli_epi16(_mm_sub_epi16(y,_mm_set1_epi16(Coef::yOff)),7);
+    __m128i u16 = _mm_slli_epi16(_mm_sub_epi16(u,_mm_set1_epi16(128)),7);
+    __m128i v16 = _mm_slli_epi16(_mm_sub_epi16(v,_mm_set1_epi16(128)),7);
+    __m128i yTerm = _mm_mulhi_epi16(y16,_mm_set1_epi16(Coef::yMul*2));
+    __m128i r16 = _mm_add_epi16(yTerm,_mm_mulhi_epi16(v16,_mm_set1_epi16(Coef::rv*2)));
+    __m128i g16 = _mm_sub_epi16(_mm_sub_epi16(yTerm,_mm_mulhi_epi16(u16,_mm_set1_epi16(Coef::gu*2))),
+                                _mm_mulhi_epi16(v16,_mm_set1_epi16(Coef::gv*2)));
+    __m128i b16 = _mm_add_epi16(yTerm,_mm_mulhi_epi16(u16,_mm_set1_epi16(Coef::bu*2)));
+    r = _mm_packus_epi16(r16,r16);
+    g = _mm_packus_epi16(g16,g16);
+    b = _mm_packus_epi16(b16,b16);
+}
+/*将交错存储的4组uv(16位:u0,v0,u1,v1...)展开为每个像素对应的u、v(u0,u0,u1,u1...)*/
+inline void expandUvSimd8(__m128i uv,__m128i &u,__m128i &v)
+{
+    u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv,_MM_SHUFFLE(2,2,0,0)),_MM_SHUFFLE(2,2,0,0));
+    v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv,_MM_SHUFFLE(3,3,1,1)),_MM_SHUFFLE(3,3,1,1));
+}
+#endif
+
+#if defined(COLOR_CONVERT_NEON)
+typedef uint8x8_t SimdVec8;//8个像素的单个分量(NEON:8位)
+typedef uint8x16_t SimdLuma16;//16个像素的Y分量(8位)
+#elif defined(COLOR_CONVERT_SSE2)
+typedef __m128i SimdVec8;//8个像素的单个分量(SSE2:16位)
+typedef __m128i SimdLuma16;//16个像素的Y分量(8位)
+#endif
+
+/*源数据的访问方式(source traits)，所有转换实现(整帧、缩放、裁剪旋转)共用同一套核心循环，新增格式只需要提供对应的访问方式
+ *yuv格式:Y和UV分别按各自平面的坐标访问(chroma坐标=luma坐标>>chromaShift)
+ *  lumaRow()/luma():第y行的luma行地址及该行第x个像素的Y
+ *  chromaRow()/chromaU()/chromaV():第cy行的chroma行地址及该行第cx组的U、V
+ *  loadSimd8():SIMD实现，一次取出一行内8个像素的y、u、v(u、v已按像素展开)
+ *  loadBox2Simd8():2倍盒式滤波的SIMD实现，一次取出8个目标像素对应的y、u、v平均值
+ *  loadLuma16():SIMD实现，一次取出一行内16个像素的Y(默认Y平面连续存储，packed格式需要分离)
+ *rgb格式:row()/pixel()获取第y行的行地址及该行第x个像素的r、g、b*/
+struct SourceBase
+{
+    enum {hasSimd = false,hasBox2Simd = false};
+#if defined(COLOR_CONVERT_NEON) || defined(COLOR_CONVERT_SSE2)
+    void loadSimd8(const uchar *,const uchar *,uint,SimdVec8 &,SimdVec8 &,SimdVec8 &) const {}
+    void loadBox2Simd8(uint,uint,SimdVec8 &,SimdVec8 &,SimdVec8 &) const {}
+#endif
+#if defined(COLOR_CONVERT_NEON)
+    SimdLuma16 loadLuma16(const uchar *lumaRow,uint x) const {return vld1q_u8(lumaRow+x);}
+#elif defined(COLOR_CONVERT_SSE2)
+    SimdLuma16 loadLuma16(const uchar *lumaRow,uint x) const {return _mm_loadu_si128((const __m128i *)(lumaRow+x));}
+#endif
+};
+/*YUV422 packed格式(YUYV/UYVY/YVYU)，每四个字节表示两个像素，模板参数为Y(第一个)、U、V在四字节中的偏移*/
+template<uint YOff,uint UOff,uint VOff>
+struct Packed422Source : SourceBase
+{
+    enum {chromaShiftX = 1,chromaShiftY = 0};
+    enum {hasSimd = true,hasBox2Simd = true};
+    const uchar *data;
+    uint width;
+
+    Packed422Source(const uchar *packed,uint w):data(packed),width(w){}
+    const uchar *lumaRow(uint y) const {return data + y*width*2;}
+    int luma(const uchar *row,uint x) const {return row[x*2+YOff];}
+    const uchar *chromaRow(uint cy) const {return data + cy*width*2;}
+    int chromaU(const uchar *row,uint cx) const {return row[cx*4+UOff];}
+    int chromaV(const uchar *row,uint cx) const {return row[cx*4+VOff];}
+#if defined(COLOR_CONVERT_NEON)
+    void loadSimd8(const uchar *lumaRow,const uchar *,uint x,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        //vld2分离出8个y和交错的4组uv
+        uint8x8x2_t pixels = vld2_u8(lumaRow+x*2);
+        y = pixels.val[YOff];
+        if(UOff < VOff) expandUvSimd8(pixels.val[1-YOff],u,v);
+        else expandUvSimd8(pixels.val[1-YOff],v,u);
+    }
+    void loadBox2Simd8(uint dy,uint dx,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        //vld4按四字节分离出两列y、u、v，32字节正好对应8个目标像素
+        uint8x8x4_t row0 = vld4_u8(lumaRow(dy*2)+dx*4);
+        uint8x8x4_t row1 = vld4_u8(lumaRow(dy*2+1)+dx*4);
+        uint16x8_t sum = vaddq_u16(vaddl_u8(row0.val[YOff],row0.val[YOff+2]),
+                                   vaddl_u8(row1.val[YOff],row1.val[YOff+2]));
+        y = vrshrn_n_u16(sum,2);
+        u = vrhadd_u8(row0.val[UOff],row1.val[UOff]);
+        v = vrhadd_u8(row0.val[VOff],row1.val[VOff]);
+    }
+    SimdLuma16 loadLuma16(const uchar *lumaRow,uint x) const
+    {
+        return vld2q_u8(lumaRow+x*2).val[YOff];
+    }
+#elif defined(COLOR_CONVERT_SSE2)
+    void loadSimd8(const uchar *lumaRow,const uchar *,uint x,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        //每16位中一个字节为y，另一个字节为交错的uv
+        const __m128i lowMask = _mm_set1_epi16(0x00ff);
+        __m128i pixels = _mm_loadu_si128((const __m128i *)(lumaRow+x*2));
+        __m128i uv = YOff?_mm_and_si128(pixels,lowMask):_mm_srli_epi16(pixels,8);
+        y = YOff?_mm_srli_epi16(pixels,8):_mm_and_si128(pixels,lowMask);
+        if(UOff < VOff) expandUvSimd8(uv,u,v);
+        else expandUvSimd8(uv,v,u);
+    }
+    void loadBox2Simd8(uint dy,uint dx,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        const __m128i lowMask = _mm_set1_epi16(0x00ff);
+        const uchar *row0 = lumaRow(dy*2)+dx*4;
+        const uchar *row1 = lumaRow(dy*2+1)+dx*4;
+        __m128i a0 = _mm_loadu_si128((const __m128i *)row0);
+        __m128i a1 = _mm_loadu_si128((const __m128i *)(row0+16));
+        __m128i b0 = _mm_loadu_si128((const __m128i *)row1);
+        __m128i b1 = _mm_loadu_si128((const __m128i *)(row1+16));
+        //两行的y相加后再通过madd将相邻两列相加
+        __m128i ya0 = YOff?_mm_srli_epi16(a0,8):_mm_and_si128(a0,lowMask);
+        __m128i ya1 = YOff?_mm_srli_epi16(a1,8):_mm_and_si128(a1,lowMask);
+        __m128i yb0 = YOff?_mm_srli_epi16(b0,8):_mm_and_si128(b0,lowMask);
+        __m128i yb1 = YOff?_mm_srli_epi16(b1,8):_mm_and_si128(b1,lowMask);
+        __m128i s0 = _mm_madd_epi16(_mm_add_epi16(ya0,yb0),_mm_set1_epi16(1));
+        __m128i s1 = _mm_madd_epi16(_mm_add_epi16(ya1,yb1),_mm_set1_epi16(1));
+        y = _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(s0,s1),_mm_set1_epi16(2)),2);
+        //交错的uv两行相加后按32位拆分出第一个色度(低16位)和第二个色度(高16位)
+        __m128i c0 = YOff?_mm_add_epi16(_mm_and_si128(a0,lowMask),_mm_and_si128(b0,lowMask)):
+                          _mm_add_epi16(_mm_srli_epi16(a0,8),_mm_srli_epi16(b0,8));
+        __m128i c1 = YOff?_mm_add_epi16(_mm_and_si128(a1,lowMask),_mm_and_si128(b1,lowMask)):
+                          _mm_add_epi16(_mm_srli_epi16(a1,8),_mm_srli_epi16(b1,8));
+        __m128i first = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(c0,16),16),
+                                        _mm_srai_epi32(_mm_slli_epi32(c1,16),16));
+        __m128i second = _mm_packs_epi32(_mm_srai_epi32(c0,16),_mm_srai_epi32(c1,16));
+        first = _mm_srli_epi16(_mm_add_epi16(first,_mm_set1_epi16(1)),1);
+        second = _mm_srli_epi16(_mm_add_epi16(second,_mm_set1_epi16(1)),1);
+        u = (UOff < VOff)?first:second;
+        v = (UOff < VOff)?second:first;
+    }
+    SimdLuma16 loadLuma16(const uchar *lumaRow,uint x) const
+    {
+        //取出每16位中的y，再饱和打包为8位(y不超过255，打包不会改变数值)
+        const __m128i lowMask = _mm_set1_epi16(0x00ff);
+        __m128i a = _mm_loadu_si128((const __m128i *)(lumaRow+x*2));
+        __m128i b = _mm_loadu_si128((const __m128i *)(lumaRow+x*2+16));
+        a = YOff?_mm_srli_epi16(a,8):_mm_and_si128(a,lowMask);
+        b = YOff?_mm_srli_epi16(b,8):_mm_and_si128(b,lowMask);
+        return _mm_packus_epi16(a,b);
+    }
+#endif
+};
+typedef Packed422Source<0,1,3> YuyvSource;
+typedef Packed422Source<1,0,2> UyvySource;
+typedef Packed422Source<0,3,1> YvyuSource;
+/*YUV semi-planar格式，Y平面之后为交错存储的UV平面，ChromaShiftY=1对应NV12/NV21(YUV420SP)，0对应NV16/NV61(YUV422SP)*/
+template<uint ChromaShiftY>
+struct SemiPlanarSource : SourceBase
+{
+    enum {chromaShiftX = 1,chromaShiftY = ChromaShiftY};
+    enum {hasSimd = true,hasBox2Simd = (ChromaShiftY == 1)};//2倍缩小时只有420每个目标像素恰好对应一组uv
+    const uchar *data;
+    uint width;
+    uint height;
+    uint uOffset;//uv在交错存储中的偏移(NV12/NV16为UV顺序，NV21/NV61为VU顺序)
+    uint vOffset;
+
+    SemiPlanarSource(bool is_uv_order,const uchar *frame,uint w,uint h)
+        :data(frame),width(w),height(h),uOffset(is_uv_order?0:1),vOffset(is_uv_order?1:0){}
+    const uchar *lumaRow(uint y) const {return data + y*width;}
+    int luma(const uchar *row,uint x) const {return row[x];}
+    const uchar *chromaRow(uint cy) const {return data + width*height + cy*width;}
+    int chromaU(const uchar *row,uint cx) const {return row[cx*2+uOffset];}
+    int chromaV(const uchar *row,uint cx) const {return row[cx*2+vOffset];}
+#if defined(COLOR_CONVERT_NEON)
+    void loadSimd8(const uchar *lumaRow,const uchar *chromaRow,uint x,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        y = vld1_u8(lumaRow+x);
+        //uv顺序相反时展开后交换即可
+        if(uOffset == 0) expandUvSimd8(vld1_u8(chromaRow+x),u,v);
+        else expandUvSimd8(vld1_u8(chromaRow+x),v,u);
+    }
+    void loadBox2Simd8(uint dy,uint dx,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        uint16x8_t sum = vaddq_u16(vpaddlq_u8(vld1q_u8(lumaRow(dy*2)+dx*2)),
+                                   vpaddlq_u8(vld1q_u8(lumaRow(dy*2+1)+dx*2)));
+        y = vrshrn_n_u16(sum,2);
+        uint8x8x2_t uv = vld2_u8(chromaRow(dy)+dx*2);
+        u = uv.val[uOffset];
+        v = uv.val[vOffset];
+    }
+#elif defined(COLOR_CONVERT_SSE2)
+    void loadSimd8(const uchar *lumaRow,const uchar *chromaRow,uint x,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        const __m128i zero = _mm_setzero_si128();
+        y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(lumaRow+x)),zero);
+        //uv顺序相反时展开后交换即可
+        __m128i uv = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(chromaRow+x)),zero);
+        if(uOffset == 0) expandUvSimd8(uv,u,v);
+        else expandUvSimd8(uv,v,u);
+    }
+    void loadBox2Simd8(uint dy,uint dx,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        const __m128i lowMask = _mm_set1_epi16(0x00ff);
+        __m128i a = _mm_loadu_si128((const __m128i *)(lumaRow(dy*2)+dx*2));
+        __m128i b = _mm_loadu_si128((const __m128i *)(lumaRow(dy*2+1)+dx*2));
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a,lowMask),_mm_srli_epi16(a,8)),
+                                    _mm_add_epi16(_mm_and_si128(b,lowMask),_mm_srli_epi16(b,8)));
+        y = _mm_srli_epi16(_mm_add_epi16(sum,_mm_set1_epi16(2)),2);
+        __m128i uv = _mm_loadu_si128((const __m128i *)(chromaRow(dy)+dx*2));
+        u = uOffset?_mm_srli_epi16(uv,8):_mm_and_si128(uv,lowMask);
+        v = vOffset?_mm_srli_epi16(uv,8):_mm_and_si128(uv,lowMask);
+    }
+#endif
+};
+typedef SemiPlanarSource<1> Nv12_21Source;
+typedef SemiPlanarSource<0> Nv16_61Source;
+/*YUV420 planar格式(YUV420/YVU420)，Y、U、V三个平面连续存储，U、V平面宽高均为Y平面的一半
+ *chromaRow()返回U平面的行地址，V平面相对U平面的偏移固定(YVU420时为负)*/
+struct PlanarSource : SourceBase
+{
+    enum {chromaShiftX = 1,chromaShiftY = 1};
+    enum {hasSimd = true};
+    const uchar *data;
+    uint width;
+    const uchar *uPlane;
+    long vPlaneOffset;
+
+    PlanarSource(bool is_yuv420,const uchar *frame,uint w,uint h):data(frame),width(w)
+    {
+        const uchar *plane1 = frame + w*h;
+        const uchar *plane2 = plane1 + (w/2)*(h/2);
+        uPlane = is_yuv420?plane1:plane2;
+        vPlaneOffset = is_yuv420?(plane2-plane1):(plane1-plane2);
+    }
+    const uchar *lumaRow(uint y) const {return data + y*width;}
+    int luma(const uchar *row,uint x) const {return row[x];}
+    const uchar *chromaRow(uint cy) const {return uPlane + cy*(width/2);}
+    int chromaU(const uchar *row,uint cx) const {return row[cx];}
+    int chromaV(const uchar *row,uint cx) const {return row[vPlaneOffset+cx];}
+#if defined(COLOR_CONVERT_NEON)
+    void loadSimd8(const uchar *lumaRow,const uchar *chromaRow,uint x,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        //u、v各读取4个字节(避免最后一行越界)，再将每个元素重复一次
+        quint32 u4,v4;
+        memcpy(&u4,chromaRow+x/2,4);
+        memcpy(&v4,chromaRow+vPlaneOffset+x/2,4);
+        uint8x8_t u8 = vreinterpret_u8_u32(vdup_n_u32(u4));
+        uint8x8_t v8 = vreinterpret_u8_u32(vdup_n_u32(v4));
+        y = vld1_u8(lumaRow+x);
+        u = vzip_u8(u8,u8).val[0];
+        v = vzip_u8(v8,v8).val[0];
+    }
+#elif defined(COLOR_CONVERT_SSE2)
+    void loadSimd8(const uchar *lumaRow,const uchar *chromaRow,uint x,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        //u、v各读取4个字节(避免最后一行越界)，再将每个元素重复一次
+        const __m128i zero = _mm_setzero_si128();
+        quint32 u4,v4;
+        memcpy(&u4,chromaRow+x/2,4);
+        memcpy(&v4,chromaRow+vPlaneOffset+x/2,4);
+        __m128i u8 = _mm_cvtsi32_si128(int(u4));
+        __m128i v8 = _mm_cvtsi32_si128(int(v4));
+        y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(lumaRow+x)),zero);
+        u = _mm_unpacklo_epi8(_mm_unpacklo_epi8(u8,u8),zero);
+        v = _mm_unpacklo_epi8(_mm_unpacklo_epi8(v8,v8),zero);
+    }
+#endif
+};
+/*灰度格式(GREY)，只有Y平面，uv固定为128(编译期常量，色度相关的计算会被优化掉)*/
+struct GreySource : SourceBase
+{
+    enum {chromaShiftX = 1,chromaShiftY = 0};
+    enum {hasSimd = true};
+    const uchar *data;
+    uint width;
+
+    GreySource(const uchar *grey,uint w):data(grey),width(w){}
+    const uchar *lumaRow(uint y) const {return data + y*width;}
+    int luma(const uchar *row,uint x) const {return row[x];}
+    const uchar *chromaRow(uint) const {return data;}
+    int chromaU(const uchar *,uint) const {return 128;}
+    int chromaV(const uchar *,uint) const {return 128;}
+#if defined(COLOR_CONVERT_NEON)
+    void loadSimd8(const uchar *lumaRow,const uchar *,uint x,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        y = vld1_u8(lumaRow+x);
+        u = v = vdup_n_u8(128);
+    }
+#elif defined(COLOR_CONVERT_SSE2)
+    void loadSimd8(const uchar *lumaRow,const uchar *,uint x,SimdVec8 &y,SimdVec8 &u,SimdVec8 &v) const
+    {
+        y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(lumaRow+x)),_mm_setzero_si128());
+        u = v = _mm_set1_epi16(128);
+    }
+#endif
+};
+/*RGB32(V4L2_PIX_FMT_RGB32)，每个像素按字节顺序存储为(alpha/填充),R,G,B*/
+struct Rgb32Source
+{
+    const uchar *data;
+    uint width;
+
+    Rgb32Source(const uchar *rgb32,uint w):data(rgb32),width(w){}
+    const uchar *row(uint y) const {return data + y*width*4;}
+    void pixel(const uchar *row,uint x,int &r,int &g,int &b) const
+    {
+        r = row[x*4+1];
+        g = row[x*4+2];
+        b = row[x*4+3];
+    }
+};
+/*RGB565(V4L2_PIX_FMT_RGB565)，每个像素为小端存储的16位数据(rrrrrggggggbbbbb)，低位复制到高位扩展为8位*/
+struct Rgb565Source
+{
+    const uchar *data;
+    uint width;
+
+    Rgb565Source(const uchar *rgb565,uint w):data(rgb565),width(w){}
+    const uchar *row(uint y) const {return data + y*width*2;}
+    void pixel(const uchar *row,uint x,int &r,int &g,int &b) const
+    {
+        uint value = row[x*2] | (row[x*2+1]<<8);
+        r = (value>>11)&0x1f;
+        g = (value>>5)&0x3f;
+        b = value&0x1f;
+        r = (r<<3)|(r>>2);
+        g = (g<<2)|(g>>4);
+        b = (b<<3)|(b>>2);
+    }
+};
+
+/*2的整数次幂求对数(编译期)*/
+constexpr uint log2Pow2(uint n)
+{
+    return (n <= 1)?0:1+log2Pow2(n>>1);
+}
+/*源尺寸恰好是目标尺寸的2倍或4倍时返回对应倍数(使用盒式滤波)，否则返回0(使用双线性插值)*/
+inline uint boxScaleFactor(uint width,uint height,uint dst_width,uint dst_height)
+{
+    if(width == dst_width*2 && height == dst_height*2)
+    {
+        return 2;
+    }
+    if(width == dst_width*4 && height == dst_height*4)
+    {
+        return 4;
+    }
+    return 0;
+}
+/*双线性插值的采样位置:相邻两个源像素的索引及后者的权重(8位定点小数)*/
+struct ScaleTap
+{
+    uint index0;
+    uint index1;
+    int frac;
+};
+/*按像素中心对齐计算目标像素对应的源采样位置:src=(dst+0.5)*src_size/dst_size-0.5*/
+inline ScaleTap scaleTap(uint dst_pos,uint dst_size,uint src_size)
+{
+    ScaleTap tap;
+    qint64 pos = (qint64(2*dst_pos+1)*src_size*128)/dst_size - 128;
+    if(pos < 0)
+    {
+        pos = 0;
+    }
+    tap.index0 = uint(pos>>8);
+    tap.frac = int(pos&0xff);
+    if(tap.index0 >= src_size-1)
+    {
+        tap.index0 = src_size-1;
+        tap.frac = 0;
+    }
+    tap.index1 = (tap.index0+1 < src_size)?tap.index0+1:tap.index0;
+    return tap;
+}
+/*双线性插值:a、b为上一行相邻两像素，c、d为下一行相邻两像素，fx、fy为8位定点权重*/
+inline int bilinearSample(int a,int b,int c,int d,int fx,int fy)
+{
+    int top = (a<<8) + (b-a)*fx;
+    int bottom = (c<<8) + (d-c)*fx;
+    return ((top<<8) + (bottom-top)*fy + 32768)>>16;
+}
+
+/*裁剪、镜像、旋转时输出分块的边长(像素)
+ *旋转90/270度时源图像的一行对应目标图像的一列，逐行处理会使每个像素都写入不同的缓存行，分块后一个块内写入的
+ *缓存行(32行)在块处理完之前都能留在一级缓存中*/
+const uint transformTileSize = 32;
+/*裁剪、镜像、旋转参数换算后的目标布局:裁剪区域内(cx,cy)像素的目标地址为origin+cx*stepX+cy*stepY(字节偏移，可以为负)*/
+struct TransformLayout
+{
+    uint x;//对齐后的裁剪区域
+    uint y;
+    uint width;
+    uint height;
+    uint dstWidth;//目标宽高
+    uint dstHeight;
+    long origin;
+    long stepX;
+    long stepY;
+    uint tileWidth;//分块大小(不旋转时按整行处理)
+    uint tileHeight;
+};
+/*
+ *@brief:   计算裁剪、镜像、旋转后的目标布局
+ *@param:   transform:裁剪、镜像、旋转参数
+ *@param:   width,height:源图像宽高  bytes_per_pixel:目标像素字节数
+ *@param:   align:裁剪区域的对齐要求(yuv格式为2，rgb格式为1)
+ */
+inline TransformLayout transformLayout(const ColorToRgb24::FrameTransform &transform,uint width,uint height,
+                                       uint bytes_per_pixel,uint align)
+{
+    TransformLayout layout;
+    layout.x = qMin(transform.cropX,width)/align*align;
+    layout.y = qMin(transform.cropY,height)/align*align;
+    layout.width = transform.cropWidth?qMin(transform.cropWidth,width-layout.x):width-layout.x;
+    layout.height = transform.cropHeight?qMin(transform.cropHeight,height-layout.y):height-layout.y;
+    layout.width = layout.width/align*align;
+    layout.height = layout.height/align*align;
+    const bool swapSize = (transform.rotation == 90 || transform.rotation == 270);
+    layout.dstWidth = swapSize?layout.height:layout.width;
+    layout.dstHeight = swapSize?layout.width:layout.height;
+    //裁剪区域内的坐标先镜像再旋转，计算出目标地址，该映射为线性映射，只需计算原点和两个方向的步长
+    auto offset = [&](long cx,long cy)->long{
+        long mx = transform.hMirror?long(layout.width)-1-cx:cx;
+        long my = transform.vMirror?long(layout.height)-1-cy:cy;
+        long ox = mx,oy = my;
+        if(transform.rotation == 90)
+        {
+            ox = long(layout.height)-1-my;
+            oy = mx;
+        }
+        else if(transform.rotation == 180)
+        {
+            ox = long(layout.width)-1-mx;
+            oy = long(layout.height)-1-my;
+        }
+        else if(transform.rotation == 270)
+        {
+            ox = my;
+            oy = long(layout.width)-1-mx;
+        }
+        return (oy*long(layout.dstWidth) + ox)*long(bytes_per_pixel);
+    };
+    layout.origin = offset(0,0);
+    layout.stepX = offset(1,0) - layout.origin;
+    layout.stepY = offset(0,1) - layout.origin;
+    layout.tileWidth = swapSize?transformTileSize:qMax(layout.width,1u);
+    layout.tileHeight = swapSize?transformTileSize:1;
+    return layout;
+}
+/*按块遍历裁剪区域，func(x0,y0,x1,y1)处理[x0,x1)*[y0,y1)范围内的像素*/
+template<class Func>
+inline void forEachTile(const TransformLayout &layout,Func func)
+{
+    for(uint ty=0;ty<layout.height;ty+=layout.tileHeight)
+    {
+        for(uint tx=0;tx<layout.width;tx+=layout.tileWidth)
+        {
+            func(tx,ty,qMin(tx+layout.tileWidth,layout.width),qMin(ty+layout.tileHeight,layout.height));
+        }
+    }
+}
+}
+
+/*
+ *@brief:   根据转换标准和range选择对应特化的转换实现，保证热点循环内的系数均为编译期常量
+ *@date:    2026.10.18
+ *@param:   ycbcr_enc:转换标准(V4L2_YCBCR_ENC_*)  is_tv_range:true=TV Range  false=Full Range
+ *@param:   format:rgb输出格式
+ *@param:   args:转换实现的参数
+ */
+template<template<class,class> class Kernel,typename... Args>
+void ColorToRgb24::dispatch(uint ycbcr_enc, bool is_tv_range, RgbOutputFormat format, Args... args)
+{
+    if(ycbcr_enc == V4L2_YCBCR_ENC_709)
+    {
+        if(is_tv_range) dispatchWriter<Kernel,YuvShiftCoef<V4L2_YCBCR_ENC_709,true> >(format,args...);
+        else dispatchWriter<Kernel,YuvShiftCoef<V4L2_YCBCR_ENC_709,false> >(format,args...);
+    }
+    else if(ycbcr_enc == V4L2_YCBCR_ENC_BT2020)
+    {
+        if(is_tv_range) dispatchWriter<Kernel,YuvShiftCoef<V4L2_YCBCR_ENC_BT2020,true> >(format,args...);
+        else dispatchWriter<Kernel,YuvShiftCoef<V4L2_YCBCR_ENC_BT2020,false> >(format,args...);
+    }
+    else
+    {
+        if(is_tv_range) dispatchWriter<Kernel,YuvShiftCoef<V4L2_YCBCR_ENC_601,true> >(format,args...);
+        else dispatchWriter<Kernel,YuvShiftCoef<V4L2_YCBCR_ENC_601,false> >(format,args...);
+    }
+}
+/*
+ *@brief:   根据rgb输出格式选择对应特化的转换实现
+ *@date:    2026.10.18
+ */
+template<template<class,class> class Kernel,class Coef,typename... Args>
+void ColorToRgb24::dispatchWriter(RgbOutputFormat format, Args... args)
+{
+    switch(format)
+    {
+    case RGB32:
+    case ARGB32_Premultiplied:
+        Kernel<Coef,Rgb32Writer>::run(args...);
+        break;
+    case RGBX8888:
+        Kernel<Coef,Rgbx8888Writer>::run(args...);
+        break;
+    case BGRA8888:
+        Kernel<Coef,Bgra8888Writer>::run(args...);
+        break;
+    default:
+        Kernel<Coef,Rgb888Writer>::run(args...);
+        break;
+    }
+}
+/*
+ *@brief:   根据V4L2帧格式构造对应的源数据访问方式，yuv格式调用YuvKernel，rgb格式调用RgbKernel
+ *@date:    2026.10.18
+ *@param:   pixel_format:V4L2帧格式(V4L2_PIX_FMT_*)
+ *@param:   frame:帧数据地址(单平面连续存储)  width,height:帧宽高
+ *@param:   ycbcr_enc:转换标准(V4L2_YCBCR_ENC_*)  is_tv_range:true=TV Range  false=Full Range
+ *@param:   format:rgb输出格式
+ *@param:   args:转换实现的参数(源数据访问方式之后的参数)
+ *@return:  bool:false=不支持该帧格式
+ */
+template<template<class,class> class YuvKernel,template<class,class> class RgbKernel,typename... Args>
+bool ColorToRgb24::dispatchSource(uint pixel_format, uchar *frame, uint width, uint height,
+                                  uint ycbcr_enc, bool is_tv_range, RgbOutputFormat format, Args... args)
+{
+    switch(pixel_format)
+    {
+    case V4L2_PIX_FMT_YUYV:
+        dispatch<YuvKernel>(ycbcr_enc,is_tv_range,format,YuyvSource(frame,width),args...);
+        break;
+    case V4L2_PIX_FMT_UYVY:
+        dispatch<YuvKernel>(ycbcr_enc,is_tv_range,format,UyvySource(frame,width),args...);
+        break;
+    case V4L2_PIX_FMT_YVYU:
+        dispatch<YuvKernel>(ycbcr_enc,is_tv_range,format,YvyuSource(frame,width),args...);
+        break;
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV21:
+        dispatch<YuvKernel>(ycbcr_enc,is_tv_range,format,
+                            Nv12_21Source(pixel_format == V4L2_PIX_FMT_NV12,frame,width,height),args...);
+        break;
+    case V4L2_PIX_FMT_NV16:
+    case V4L2_PIX_FMT_NV61:
+        dispatch<YuvKernel>(ycbcr_enc,is_tv_range,format,
+                            Nv16_61Source(pixel_format == V4L2_PIX_FMT_NV16,frame,width,height),args...);
+        break;
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_YVU420:
+        dispatch<YuvKernel>(ycbcr_enc,is_tv_range,format,
+                            PlanarSource(pixel_format == V4L2_PIX_FMT_YUV420,frame,width,height),args...);
+        break;
+    case V4L2_PIX_FMT_GREY:
+        dispatch<YuvKernel>(ycbcr_enc,is_tv_range,format,GreySource(frame,width),args...);
+        break;
+    //rgb源格式不涉及yuv转换系数，固定使用一种特化即可
+    case V4L2_PIX_FMT_RGB32:
+        dispatchWriter<RgbKernel,YuvShiftCoef<V4L2_YCBCR_ENC_601,false> >(format,Rgb32Source(frame,width),args...);
+        break;
+    case V4L2_PIX_FMT_RGB565:
+        dispatchWriter<RgbKernel,YuvShiftCoef<V4L2_YCBCR_ENC_601,false> >(format,Rgb565Source(frame,width),args...);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+/*
+ *@brief:   提取Y分量的核心实现(源格式由Source决定)
+ *注:不缩小时每次用SIMD取出16个像素的Y直接存储；2倍缩小时取出两行各16个Y，相邻两列相加后两行再相加，得到8个目标像素；
+ *4倍缩小时取出四行各32个Y，相邻两列相加、四行相加后再将相邻的两个和相加，得到8个目标像素；其他倍数使用标量盒式滤波。
+ *@date:    2026.10.18
+ *@param:   src:yuv源数据的访问方式  luma:灰度数据地址
+ *@param:   width,height:源帧宽高  downsample:宽高的缩小倍数
+ */
+template<class Source>
+void ColorToRgb24::lumaKernel(const Source &src, uchar *luma, uint width, uint height, uint downsample)
+{
+    const uint dstWidth = width/downsample;
+    const uint dstHeight = height/downsample;
+#if defined(COLOR_CONVERT_NEON) || defined(COLOR_CONVERT_SSE2)
+    const bool useSimd = simdEnabled.load(std::memory_order_relaxed);
+#endif
+    if(downsample == 1)
+    {
+        for(uint i=0;i<height;i++)
+        {
+            const uchar *lumaRow = src.lumaRow(i);
+            uchar *dst = luma + i*width;
+            uint j = 0;
+#if defined(COLOR_CONVERT_NEON)
+            for(;useSimd && j+16<=width;j+=16)
+            {
+                vst1q_u8(dst+j,src.loadLuma16(lumaRow,j));
+            }
+#elif defined(COLOR_CONVERT_SSE2)
+            for(;useSimd && j+16<=width;j+=16)
+            {
+                _mm_storeu_si128((__m128i *)(dst+j),src.loadLuma16(lumaRow,j));
+            }
+#endif
+            for(;j<width;j++)
+            {
+                dst[j] = src.luma(lumaRow,j);
+            }
+        }
+    }
+    else if(downsample == 2)
+    {
+        for(uint dy=0;dy<dstHeight;dy++)
+        {
+            const uchar *row0 = src.lumaRow(dy*2);
+            const uchar *row1 = src.lumaRow(dy*2+1);
+            uchar *dst = luma + dy*dstWidth;
+            uint dx = 0;
+#if defined(COLOR_CONVERT_NEON)
+            for(;useSimd && dx+8<=dstWidth;dx+=8)
+            {
+                uint16x8_t sum = vaddq_u16(vpaddlq_u8(src.loadLuma16(row0,dx*2)),
+                                           vpaddlq_u8(src.loadLuma16(row1,dx*2)));
+                vst1_u8(dst+dx,vrshrn_n_u16(sum,2));
+            }
+#elif defined(COLOR_CONVERT_SSE2)
+            const __m128i lowMask = _mm_set1_epi16(0x00ff);
+            for(;useSimd && dx+8<=dstWidth;dx+=8)
+            {
+                __m128i a = src.loadLuma16(row0,dx*2);
+                __m128i b = src.loadLuma16(row1,dx*2);
+                __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a,lowMask),_mm_srli_epi16(a,8)),
+                                            _mm_add_epi16(_mm_and_si128(b,lowMask),_mm_srli_epi16(b,8)));
+                sum = _mm_srli_epi16(_mm_add_epi16(sum,_mm_set1_epi16(2)),2);
+                _mm_storel_epi64((__m128i *)(dst+dx),_mm_packus_epi16(sum,sum));
+            }
+#endif
+            for(;dx<dstWidth;dx++)
+            {
+                dst[dx] = (src.luma(row0,dx*2) + src.luma(row0,dx*2+1) +
+                           src.luma(row1,dx*2) + src.luma(row1,dx*2+1) + 2)>>2;
+            }
+        }
+    }
+    else if(downsample == 4)
+    {
+        for(uint dy=0;dy<dstHeight;dy++)
+        {
+            const uchar *rows[4];
+            for(uint i=0;i<4;i++)
+            {
+                rows[i] = src.lumaRow(dy*4+i);
+            }
+            uchar *dst = luma + dy*dstWidth;
+            uint dx = 0;
+#if defined(COLOR_CONVERT_NEON)
+            for(;useSimd && dx+8<=dstWidth;dx+=8)
+            {
+                uint16x8_t sum0 = vpaddlq_u8(src.loadLuma16(rows[0],dx*4));
+                uint16x8_t sum1 = vpaddlq_u8(src.loadLuma16(rows[0],dx*4+16));
+                for(uint i=1;i<4;i++)
+                {
+                    sum0 = vpadalq_u8(sum0,src.loadLuma16(rows[i],dx*4));
+                    sum1 = vpadalq_u8(sum1,src.loadLuma16(rows[i],dx*4+16));
+                }
+                uint16x8_t sum = vcombine_u16(vrshrn_n_u32(vpaddlq_u16(sum0),4),vrshrn_n_u32(vpaddlq_u16(sum1),4));
+                vst1_u8(dst+dx,vmovn_u16(sum));
+            }
+#elif defined(COLOR_CONVERT_SSE2)
+            const __m128i lowMask = _mm_set1_epi16(0x00ff);
+            const __m128i ones = _mm_set1_epi16(1);
+            for(;useSimd && dx+8<=dstWidth;dx+=8)
+            {
+                __m128i sum0 = _mm_setzero_si128();
+                __m128i sum1 = _mm_setzero_si128();
+                for(uint i=0;i<4;i++)
+                {
+                    __m128i a = src.loadLuma16(rows[i],dx*4);
+                    __m128i b = src.loadLuma16(rows[i],dx*4+16);
+                    sum0 = _mm_add_epi16(sum0,_mm_add_epi16(_mm_and_si128(a,lowMask),_mm_srli_epi16(a,8)));
+                    sum1 = _mm_add_epi16(sum1,_mm_add_epi16(_mm_and_si128(b,lowMask),_mm_srli_epi16(b,8)));
+                }
+                //相邻两个16位和相加得到32位的4x4块和，四舍五入后除以16
+                const __m128i round = _mm_set1_epi32(8);
+                sum0 = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(sum0,ones),round),4);
+                sum1 = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(sum1,ones),round),4);
+                __m128i sum = _mm_packs_epi32(sum0,sum1);
+                _mm_storel_epi64((__m128i *)(dst+dx),_mm_packus_epi16(sum,sum));
+            }
+#endif
+            for(;dx<dstWidth;dx++)
+            {
+                uint sum = 0;
+                for(uint i=0;i<4;i++)
+                {
+                    for(uint j=0;j<4;j++)
+                    {
+                        sum += src.luma(rows[i],dx*4+j);
+                    }
+                }
+                dst[dx] = (sum + 8)>>4;
+            }
+        }
+    }
+    else
+    {
+        const uint count = downsample*downsample;
+        for(uint dy=0;dy<dstHeight;dy++)
+        {
+            uchar *dst = luma + dy*dstWidth;
+            for(uint dx=0;dx<dstWidth;dx++)
+            {
+                uint sum = 0;
+                for(uint by=0;by<downsample;by++)
+                {
+                    const uchar *lumaRow = src.lumaRow(dy*downsample+by);
+                    for(uint bx=0;bx<downsample;bx++)
+                    {
+                        sum += src.luma(lumaRow,dx*downsample+bx);
+                    }
+                }
+                dst[dx] = (sum + count/2)/count;
+            }
+        }
+    }
+}
+/*
+ *@brief:   统计Y分量直方图的核心实现(源格式由Source决定)
+ *注:使用4张部分直方图轮流累加，平坦区域相邻像素取值相同时不会连续读写同一个计数，避免存储转发造成的流水线停顿，最后再合并；
+ *不抽样时每次用SIMD取出16个像素的Y(packed格式同时完成分离)。
+ *@date:    2026.10.18
+ *@param:   src:yuv源数据的访问方式  stats:帧统计(累加到Luma通道)
+ *@param:   width,height:源帧宽高  step:抽样步长(每隔step行、step列统计一个像素)
+ */
+template<class Source>
+void ColorToRgb24::lumaStatisticsKernel(const Source &src, FrameStatistics &stats, uint width, uint height, uint step)
+{
+    quint32 partial[4][256];
+    memset(partial,0,sizeof(partial));
+#if defined(COLOR_CONVERT_NEON) || defined(COLOR_CONVERT_SSE2)
+    const bool useSimd = (step == 1) && simdEnabled.load(std::memory_order_relaxed);
+    alignas(16) uchar block[16];
+#endif
+    for(uint i=0;i<height;i+=step)
+    {
+        const uchar *lumaRow = src.lumaRow(i);
+        uint j = 0;
+#if defined(COLOR_CONVERT_NEON) || defined(COLOR_CONVERT_SSE2)
+        for(;useSimd && j+16<=width;j+=16)
+        {
+#if defined(COLOR_CONVERT_NEON)
+            vst1q_u8(block,src.loadLuma16(lumaRow,j));
+#else
+            _mm_store_si128((__m128i *)block,src.loadLuma16(lumaRow,j));
+#endif
+            for(uint k=0;k<16;k+=4)
+            {
+                partial[0][block[k]]++;
+                partial[1][block[k+1]]++;
+                partial[2][block[k+2]]++;
+                partial[3][block[k+3]]++;
+            }
+        }
+#endif
+        for(;j+3*step<width;j+=4*step)
+        {
+            partial[0][src.luma(lumaRow,j)]++;
+            partial[1][src.luma(lumaRow,j+step)]++;
+            partial[2][src.luma(lumaRow,j+2*step)]++;
+            partial[3][src.luma(lumaRow,j+3*step)]++;
+        }
+        for(;j<width;j+=step)
+        {
+            partial[0][src.luma(lumaRow,j)]++;
+        }
+    }
+    for(uint i=0;i<256;i++)
+    {
+        partial[0][i] += partial[1][i] + partial[2][i] + partial[3][i];
+    }
+    stats.accumulateHistogram(FrameStatistics::Luma,partial[0]);
+}
+/*
+ *@brief:   yuv转rgb的核心实现(按转换系数和输出格式特化，源格式由Source决定)
+ *注:逐行处理，未启用颜色调整时每次用SIMD转换8个像素，剩余部分每次转换两个共用一组uv的像素
+ *@date:    2026.10.18
+ *@param:   src:yuv源数据的访问方式  lut:颜色调整查表快照(一帧内不变)  stats:帧统计(可以为空)
+ *@param:   rgb:rgb帧格式数据地址  width,height:宽高
+ */
+template<class Coef,class Writer>
+struct ColorToRgb24::YuvKernel
+{
+    template<class Source>
+    static void run(Source src,const ColorAdjustLut *lut,FrameStatistics *stats,uchar *rgb,uint width,uint height)
+    {
+        //qDebug()<<"yuv_to_rgb-start:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
+        int y0,y1,u,v;
+        int r_uv,g_uv,b_uv;
+#if defined(COLOR_CONVERT_NEON) || defined(COLOR_CONVERT_SSE2)
+        //颜色调整需要逐像素查表，只在未启用颜色调整时使用SIMD实现
+        const bool useSimd = Source::hasSimd && Writer::hasSimd && !isColorAdjustEnabled(lut) &&
+                simdEnabled.load(std::memory_order_relaxed);
+#endif
+        for(uint i=0;i<height;i++)
+        {
+            const uchar *lumaRow = src.lumaRow(i);
+            const uchar *chromaRow = src.chromaRow(i>>Source::chromaShiftY);
+            uchar *dst = rgb + i*width*Writer::bytesPerPixel;
+            uint j = 0;
+#if defined(COLOR_CONVERT_NEON) || defined(COLOR_CONVERT_SSE2)
+            if(useSimd)
+            {
+                SimdVec8 y8,u8,v8,r,g,b;
+                for(;j+8<=width;j+=8)
+                {
+                    src.loadSimd8(lumaRow,chromaRow,j,y8,u8,v8);
+                    yuvToRgbSimd8<Coef>(y8,u8,v8,r,g,b);
+                    Writer::storeSimd8(dst+j*Writer::bytesPerPixel,r,g,b);
+                }
+            }
+#endif
+            /*每次循环转换出两个rgb像素*/
+            for(;j<width;j+=2)
+            {
+                u = src.chromaU(chromaRow,j>>Source::chromaShiftX) - 128;
+                v = src.chromaV(chromaRow,j>>Source::chromaShiftX) - 128;
+                //移位法  计算RGB公式内不包含Y的部分(已加上四舍五入的偏移)，结果可以供两个rgb像素使用
+                r_uv = Coef::rv*v + 128;
+                g_uv = Coef::gu*u + Coef::gv*v - 128;
+                b_uv = Coef::bu*u + 128;
+                //Full Range时yMul=256,yOff=0,编译器会将其优化为单纯的移位
+                y0 = Coef::yMul*(src.luma(lumaRow,j) - Coef::yOff);
+                y1 = Coef::yMul*(src.luma(lumaRow,j+1) - Coef::yOff);
+                writePixel<Writer>(lut,dst+j*Writer::bytesPerPixel,(y0 + r_uv)>>8,(y0 - g_uv)>>8,(y0 + b_uv)>>8);
+                writePixel<Writer>(lut,dst+(j+1)*Writer::bytesPerPixel,(y1 + r_uv)>>8,(y1 - g_uv)>>8,(y1 + b_uv)>>8);
+            }
+            finishRows<Writer>(lut,stats,dst,width);
+        }
+        //qDebug()<<"yuv_to_rgb-end:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
+    }
+};
+/*
+ *@brief:   rgb源格式转rgb的核心实现(按输出格式特化，Coef不使用，源格式由Source决定)
+ *@date:    2026.10.18
+ *@param:   src:rgb源数据的访问方式  lut:颜色调整查表快照(一帧内不变)  stats:帧统计(可以为空)
+ *@param:   rgb:rgb帧格式数据地址  width,height:宽高
+ */
+template<class Coef,class Writer>
+struct ColorToRgb24::RgbKernel
+{
+    template<class Source>
+    static void run(Source src,const ColorAdjustLut *lut,FrameStatistics *stats,uchar *rgb,uint width,uint height)
+    {
+        int r,g,b;
+#ifdef ENABLE_COLOR_ADJUST
+        const bool colorAdjust = isColorAdjustEnabled(lut);
+#endif
+        for(uint i=0;i<height;i++)
+        {
+            const uchar *row = src.row(i);
+            uchar *dst = rgb + i*width*Writer::bytesPerPixel;
+            for(uint j=0;j<width;j++)
+            {
+                src.pixel(row,j,r,g,b);
+#ifdef ENABLE_COLOR_ADJUST
+                if(colorAdjust)
+                {
+                    rgbColorAdjust(lut,r,g,b);
+                }
+#endif
+                Writer::write(dst+j*Writer::bytesPerPixel,r,g,b);
+            }
+            finishRows<Writer>(lut,stats,dst,width);
+        }
+    }
+};
+/*
+ *@brief:   缩放转换(yuv源格式)，在yuv空间滤波后只转换缩放后的像素
+ *注:源尺寸恰好为目标尺寸的2倍或4倍时使用盒式滤波(求块平均)，其他比例使用双线性插值
+ *@date:    2026.10.18
+ *@param:   src:yuv源数据的访问方式  lut:颜色调整查表快照(一帧内不变)  stats:帧统计(可以为空)
+ *@param:   rgb:rgb帧格式数据地址  width,height:源宽高  dst_width,dst_height:目标宽高
+ */
+template<class Coef,class Writer>
+struct ColorToRgb24::ScaleKernel
+{
+    template<class Source>
+    static void run(Source src,const ColorAdjustLut *lut,FrameStatistics *stats,uchar *rgb,uint width,uint height,uint dst_width,uint dst_height)
+    {
+        uint factor = boxScaleFactor(width,height,dst_width,dst_height);
+        if(factor == 2)
+        {
+            box<Source,2>(src,lut,stats,rgb,dst_width,dst_height);
+        }
+        else if(factor == 4)
+        {
+            box<Source,4>(src,lut,stats,rgb,dst_width,dst_height);
+        }
+        else
+        {
+            bilinear(src,lut,stats,rgb,width,height,dst_width,dst_height);
+        }
+    }
+    //盒式滤波(2倍/4倍)
+    template<class Source,uint Factor>
+    static void box(const Source &src,const ColorAdjustLut *lut,FrameStatistics *stats,uchar *rgb,uint dst_width,uint dst_height)
+    {
+        //每个目标像素对应的luma块为Factor*Factor，chroma块按照采样比例缩小(块内元素数均为2的整数次幂)
+        const uint chromaW = Factor>>Source::chromaShiftX;
+        const uint chromaH = Factor>>Source::chromaShiftY;
+        const uint lumaShift = log2Pow2(Factor*Factor);
+        const uint chromaShift = log2Pow2(chromaW*chromaH);
+        int y,u,v;
+#if defined(COLOR_CONVERT_NEON) || defined(COLOR_CONVERT_SSE2)
+        //颜色调整需要逐像素查表，只在未启用颜色调整时使用SIMD实现(目前只有2倍缩小)
+        const bool useSimd = (Factor == 2) && Source::hasBox2Simd && Writer::hasSimd && !isColorAdjustEnabled(lut) &&
+                simdEnabled.load(std::memory_order_relaxed);
+#endif
+        for(uint dy=0;dy<dst_height;dy++)
+        {
+            uchar *dst = rgb + dy*dst_width*Writer::bytesPerPixel;
+            uint dx = 0;
+#if defined(COLOR_CONVERT_NEON) || defined(COLOR_CONVERT_SSE2)
+            if(useSimd)
+            {
+                SimdVec8 y8,u8,v8,r,g,b;
+                for(;dx+8<=dst_width;dx+=8)
+                {
+                    src.loadBox2Simd8(dy,dx,y8,u8,v8);
+                    yuvToRgbSimd8<Coef>(y8,u8,v8,r,g,b);
+                    Writer::storeSimd8(dst+dx*Writer::bytesPerPixel,r,g,b);
+                }
+            }
+#endif
+            for(;dx<dst_width;dx++)
+            {
+                y = 0;
+                for(uint i=0;i<Factor;i++)
+                {
+                    const uchar *row = src.lumaRow(dy*Factor+i);
+                    for(uint j=0;j<Factor;j++)
+                    {
+                        y += src.luma(row,dx*Factor+j);
+                    }
+                }
+                u = 0;
+                v = 0;
+                for(uint i=0;i<chromaH;i++)
+                {
+                    const uchar *row = src.chromaRow(dy*chromaH+i);
+                    for(uint j=0;j<chromaW;j++)
+                    {
+                        u += src.chromaU(row,dx*chromaW+j);
+                        v += src.chromaV(row,dx*chromaW+j);
+                    }
+                }
+                //四舍五入求平均
+                yuvToRgbPixel<Coef,Writer>(lut,dst+dx*Writer::bytesPerPixel,
+                                           (y + ((1<<lumaShift)>>1))>>lumaShift,
+                                           (u + ((1<<chromaShift)>>1))>>chromaShift,
+                                           (v + ((1<<chromaShift)>>1))>>chromaShift);
+            }
+            finishRows<Writer>(lut,stats,dst,dst_width);
+        }
+    }
+    /*双线性插值(任意比例)
+     *y和uv分别在各自平面上插值，每一列的采样位置和权重预先计算，行内循环只有查表和乘加。缩小超过2倍时会有一定的混叠，
+     *此时优先选择能被整除的目标尺寸(使用盒式滤波)*/
+    template<class Source>
+    static void bilinear(const Source &src,const ColorAdjustLut *lut,FrameStatistics *stats,uchar *rgb,uint width,uint height,
+                         uint dst_width,uint dst_height)
+    {
+        const uint chromaWidth = width>>Source::chromaShiftX;
+        const uint chromaHeight = height>>Source::chromaShiftY;
+        std::vector<ScaleTap> lumaTapX(dst_width);
+        std::vector<ScaleTap> chromaTapX(dst_width);
+        for(uint dx=0;dx<dst_width;dx++)
+        {
+            lumaTapX[dx] = scaleTap(dx,dst_width,width);
+            chromaTapX[dx] = scaleTap(dx,dst_width,chromaWidth);
+        }
+        for(uint dy=0;dy<dst_height;dy++)
+        {
+            uchar *dst = rgb + dy*dst_width*Writer::bytesPerPixel;
+            const ScaleTap lumaTapY = scaleTap(dy,dst_height,height);
+            const ScaleTap chromaTapY = scaleTap(dy,dst_height,chromaHeight);
+            const uchar *luma0 = src.lumaRow(lumaTapY.index0);
+            const uchar *luma1 = src.lumaRow(lumaTapY.index1);
+            const uchar *chroma0 = src.chromaRow(chromaTapY.index0);
+            const uchar *chroma1 = src.chromaRow(chromaTapY.index1);
+            for(uint dx=0;dx<dst_width;dx++)
+            {
+                const ScaleTap &lx = lumaTapX[dx];
+                const ScaleTap &cx = chromaTapX[dx];
+                int y = bilinearSample(src.luma(luma0,lx.index0),src.luma(luma0,lx.index1),
+                                       src.luma(luma1,lx.index0),src.luma(luma1,lx.index1),lx.frac,lumaTapY.frac);
+                int u = bilinearSample(src.chromaU(chroma0,cx.index0),src.chromaU(chroma0,cx.index1),
+                                       src.chromaU(chroma1,cx.index0),src.chromaU(chroma1,cx.index1),
+                                       cx.frac,chromaTapY.frac);
+                int v = bilinearSample(src.chromaV(chroma0,cx.index0),src.chromaV(chroma0,cx.index1),
+                                       src.chromaV(chroma1,cx.index0),src.chromaV(chroma1,cx.index1),
+                                       cx.frac,chromaTapY.frac);
+                yuvToRgbPixel<Coef,Writer>(lut,dst+dx*Writer::bytesPerPixel,y,u,v);
+            }
+            finishRows<Writer>(lut,stats,dst,dst_width);
+        }
+    }
+};
+/*
+ *@brief:   缩放转换(rgb源格式)，按像素中心最近邻采样(rgb源格式主要用于调试，不做滤波)
+ *@date:    2026.10.18
+ */
+template<class Coef,class Writer>
+struct ColorToRgb24::RgbScaleKernel
 {
-
+    template<class Source>
+    static void run(Source src,const ColorAdjustLut *lut,FrameStatistics *stats,uchar *rgb,uint width,uint height,uint dst_width,uint dst_height)
+    {
+        int r,g,b;
+        for(uint dy=0;dy<dst_height;dy++)
+        {
+            const uchar *row = src.row((2*dy+1)*height/(2*dst_height));
+            uchar *dst = rgb + dy*dst_width*Writer::bytesPerPixel;
+            for(uint dx=0;dx<dst_width;dx++)
+            {
+                src.pixel(row,(2*dx+1)*width/(2*dst_width),r,g,b);
+                writePixel<Writer>(lut,dst+dx*Writer::bytesPerPixel,r,g,b);
+            }
+            finishRows<Writer>(lut,stats,dst,dst_width);
+        }
+    }
+};
+/*
+ *@brief:   裁剪、镜像、旋转转换(yuv源格式):按块遍历裁剪区域，转换后的像素直接写入目标位置
+ *注:裁剪区域已对齐到偶数，每次处理一行内的两个像素(共用一组uv)
+ *@date:    2026.10.18
+ *@param:   src:yuv源数据的访问方式  lut:颜色调整查表快照(一帧内不变)  stats:帧统计(可以为空)
+ *@param:   rgb:rgb帧格式数据地址  layout:目标布局
+ */
+template<class Coef,class Writer>
+struct ColorToRgb24::TransformKernel
+{
+    template<class Source>
+    static void run(Source src,const ColorAdjustLut *lut,FrameStatistics *stats,uchar *rgb,TransformLayout layout)
+    {
+        forEachTile(layout,[&](uint x0,uint y0,uint x1,uint y1){
+            int y_0,y_1,u,v;
+            int r_uv,g_uv,b_uv;
+            for(uint cy=y0;cy<y1;cy++)
+            {
+                const uint sy = layout.y + cy;
+                const uchar *lumaRow = src.lumaRow(sy);
+                const uchar *chromaRow = src.chromaRow(sy>>Source::chromaShiftY);
+                uchar *dst = rgb + layout.origin + long(cy)*layout.stepY;
+                for(uint cx=x0;cx<x1;cx+=2)
+                {
+                    const uint sx = layout.x + cx;
+                    u = src.chromaU(chromaRow,sx>>Source::chromaShiftX) - 128;
+                    v = src.chromaV(chromaRow,sx>>Source::chromaShiftX) - 128;
+                    r_uv = Coef::rv*v + 128;
+                    g_uv = Coef::gu*u + Coef::gv*v - 128;
+                    b_uv = Coef::bu*u + 128;
+                    y_0 = Coef::yMul*(src.luma(lumaRow,sx) - Coef::yOff);
+                    y_1 = Coef::yMul*(src.luma(lumaRow,sx+1) - Coef::yOff);
+                    writePixel<Writer>(lut,dst + long(cx)*layout.stepX,(y_0 + r_uv)>>8,(y_0 - g_uv)>>8,(y_0 + b_uv)>>8);
+                    writePixel<Writer>(lut,dst + long(cx+1)*layout.stepX,(y_1 + r_uv)>>8,(y_1 - g_uv)>>8,(y_1 + b_uv)>>8);
+                }
+            }
+        });
+        //输出按块写入的位置不连续，3D LUT和帧统计在整帧写完之后对连续的目标内存统一处理
+        finishRows<Writer>(lut,stats,rgb,layout.dstWidth*layout.dstHeight);
+    }
+};
+/*
+ *@brief:   裁剪、镜像、旋转转换(rgb源格式)
+ *@date:    2026.10.18
+ */
+template<class Coef,class Writer>
+struct ColorToRgb24::RgbTransformKernel
+{
+    template<class Source>
+    static void run(Source src,const ColorAdjustLut *lut,FrameStatistics *stats,uchar *rgb,TransformLayout layout)
+    {
+        forEachTile(layout,[&](uint x0,uint y0,uint x1,uint y1){
+            int r,g,b;
+            for(uint cy=y0;cy<y1;cy++)
+            {
+                const uchar *row = src.row(layout.y + cy);
+                uchar *dst = rgb + layout.origin + long(cy)*layout.stepY;
+                for(uint cx=x0;cx<x1;cx++)
+                {
+                    src.pixel(row,layout.x + cx,r,g,b);
+                    writePixel<Writer>(lut,dst + long(cx)*layout.stepX,r,g,b);
+                }
+            }
+        });
+        finishRows<Writer>(lut,stats,rgb,layout.dstWidth*layout.dstHeight);
+    }
+};
+/*
+ *@brief:   判断软解码是否支持指定的V4L2帧格式
+ *@date:    2026.10.18
+ *@param:   pixel_format:V4L2帧格式(V4L2_PIX_FMT_*)
+ *@return:  bool:true=支持
+ */
+bool ColorToRgb24::isSupportedFormat(uint pixel_format)
+{
+    return frameBytes(pixel_format,2,2) != 0;
+}
+/*
+ *@brief:   计算指定V4L2帧格式一帧数据(单平面连续存储)的字节数
+ *@date:    2026.10.18
+ *@param:   pixel_format:V4L2帧格式(V4L2_PIX_FMT_*)
+ *@param:   width:宽度  height:高度
+ *@return:  uint:一帧数据的字节数，0表示不支持该帧格式
+ */
+uint ColorToRgb24::frameBytes(uint pixel_format, const uint &width, const uint &height)
+{
+    switch(pixel_format)
+    {
+    case V4L2_PIX_FMT_YUYV:
+    case V4L2_PIX_FMT_UYVY:
+    case V4L2_PIX_FMT_YVYU:
+    case V4L2_PIX_FMT_NV16:
+    case V4L2_PIX_FMT_NV61:
+    case V4L2_PIX_FMT_RGB565:
+        return width*height*2;
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV21:
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_YVU420:
+        return width*height*3/2;
+    case V4L2_PIX_FMT_GREY:
+        return width*height;
+    case V4L2_PIX_FMT_RGB32:
+        return width*height*4;
+    default:
+        return 0;
+    }
+}
+/*
+ *@brief:   将指定V4L2帧格式的数据转换成指定格式的rgb数据，这里采用的是基于整形移位的yuv--rgb转换公式
+ *注:支持YUYV/UYVY/YVYU(YUV422 packed)、NV12/NV21(YUV420SP)、NV16/NV61(YUV422SP)、YUV420/YVU420(YUV420P)、
+ *GREY以及RGB32/RGB565，帧数据要求单平面连续存储，宽度要求为偶数(420格式高度也要求为偶数)
+ *@date:    2026.10.18
+ *@param:   pixel_format:V4L2帧格式(V4L2_PIX_FMT_*)
+ *@param:   frame:帧数据地址，该地址通常是对设备的内存映射空间
+ *@param:   rgb:rgb帧格式数据地址，该地址内存空间(width*height*bytesPerPixel(format))必须在方法外申请
+ *@param:   width:宽度  height:高度
+ *@param:   format:rgb输出格式
+ *@param:   ycbcr_enc:转换标准(V4L2_YCBCR_ENC_*)  is_tv_range:true=TV Range  false=Full Range
+ *@return:  bool:false=不支持该帧格式
+ */
+bool ColorToRgb24::frame_to_rgb(uint pixel_format, uchar *frame, uchar *rgb, const uint &width, const uint &height,
+                                RgbOutputFormat format, uint ycbcr_enc, bool is_tv_range)
+{
+    return globalInstance()->convert(pixel_format,frame,rgb,width,height,format,ycbcr_enc,is_tv_range);
+}
+/*
+ *@brief:   将指定V4L2帧格式的数据缩放转换成指定格式的rgb数据(滤波在yuv空间进行，只转换缩放后的像素)
+ *注:源尺寸恰好是目标尺寸的2倍或4倍时使用盒式滤波(box)，其他比例使用双线性插值(rgb源格式使用最近邻采样)
+ *@date:    2026.10.18
+ *@param:   pixel_format:V4L2帧格式(V4L2_PIX_FMT_*)
+ *@param:   frame:帧数据地址，该地址通常是对设备的内存映射空间
+ *@param:   rgb:rgb帧格式数据地址，该地址内存空间(dst_width*dst_height*bytesPerPixel(format))必须在方法外申请
+ *@param:   width:宽度  height:高度
+ *@param:   dst_width:目标宽度  dst_height:目标高度
+ *@param:   format:rgb输出格式
+ *@param:   ycbcr_enc:转换标准(V4L2_YCBCR_ENC_*)  is_tv_range:true=TV Range  false=Full Range
+ *@return:  bool:false=不支持该帧格式
+ */
+bool ColorToRgb24::frame_to_rgb_scaled(uint pixel_format, uchar *frame, uchar *rgb, const uint &width, const uint &height,
+                                       const uint &dst_width, const uint &dst_height, RgbOutputFormat format,
+                                       uint ycbcr_enc, bool is_tv_range)
+{
+    return globalInstance()->convertScaled(pixel_format,frame,rgb,width,height,dst_width,dst_height,
+                                           format,ycbcr_enc,is_tv_range);
+}
+/*
+ *@brief:   计算裁剪、镜像、旋转后的目标图像尺寸
+ *@date:    2026.10.18
+ *@param:   transform:裁剪、镜像、旋转参数
+ *@param:   width:宽度  height:高度
+ *@param:   dst_width,dst_height:目标宽高(裁剪区域对齐到偶数后的结果)
+ */
+void ColorToRgb24::transformedSize(const FrameTransform &transform, const uint &width, const uint &height,
+                                   uint &dst_width, uint &dst_height)
+{
+    TransformLayout layout = transformLayout(transform,width,height,1,2);
+    dst_width = layout.dstWidth;
+    dst_height = layout.dstHeight;
+}
+/*
+ *@brief:   将指定V4L2帧格式的数据裁剪、镜像、旋转后转换成指定格式的rgb数据
+ *@date:    2026.10.18
+ *@param:   pixel_format:V4L2帧格式(V4L2_PIX_FMT_*)
+ *@param:   frame:帧数据地址，该地址通常是对设备的内存映射空间
+ *@param:   rgb:rgb帧格式数据地址，该地址内存空间(尺寸由transformedSize()计算)必须在方法外申请
+ *@param:   width:宽度  height:高度
+ *@param:   transform:裁剪、镜像、旋转参数
+ *@param:   format:rgb输出格式
+ *@param:   ycbcr_enc:转换标准(V4L2_YCBCR_ENC_*)  is_tv_range:true=TV Range  false=Full Range
+ *@return:  bool:false=不支持该帧格式
+ */
+bool ColorToRgb24::frame_to_rgb_transformed(uint pixel_format, uchar *frame, uchar *rgb, const uint &width, const uint &height,
+                                            const FrameTransform &transform, RgbOutputFormat format,
+                                            uint ycbcr_enc, bool is_tv_range)
+{
+    return globalInstance()->convertTransformed(pixel_format,frame,rgb,width,height,transform,
+                                                format,ycbcr_enc,is_tv_range);
+}
+/*
+ *@brief:   使用本对象的颜色调整参数转换(参数说明同frame_to_rgb())
+ *注:转换开始时获取一次查表快照，整帧使用同一份快照，期间设置的新参数从下一帧开始生效
+ *@date:    2026.10.18
+ *@param:   stats:帧统计，不为空时在转换的同时累加输出像素的统计(不会先清空，多次转换/多个线程可以累加或合并)
+ */
+bool ColorToRgb24::convert(uint pixel_format, uchar *frame, uchar *rgb, const uint &width, const uint &height,
+                           RgbOutputFormat format, uint ycbcr_enc, bool is_tv_range, FrameStatistics *stats)
+{
+    LutReader reader(this);
+    return dispatchSource<YuvKernel,RgbKernel>(pixel_format,frame,width,height,ycbcr_enc,is_tv_range,format,
+                                               reader.lut(),stats,rgb,width,height);
+}
+/*
+ *@brief:   使用本对象的颜色调整参数缩放转换(参数说明同frame_to_rgb_scaled())
+ *@date:    2026.10.18
+ */
+bool ColorToRgb24::convertScaled(uint pixel_format, uchar *frame, uchar *rgb, const uint &width, const uint &height,
+                                 const uint &dst_width, const uint &dst_height, RgbOutputFormat format,
+                                 uint ycbcr_enc, bool is_tv_range, FrameStatistics *stats)
+{
+    if(dst_width == width && dst_height == height)
+    {
+        return convert(pixel_format,frame,rgb,width,height,format,ycbcr_enc,is_tv_range,stats);
+    }
+    LutReader reader(this);
+    return dispatchSource<ScaleKernel,RgbScaleKernel>(pixel_format,frame,width,height,ycbcr_enc,is_tv_range,format,
+                                                      reader.lut(),stats,rgb,width,height,dst_width,dst_height);
+}
+/*
+ *@brief:   使用本对象的颜色调整参数裁剪、镜像、旋转转换(参数说明同frame_to_rgb_transformed())
+ *@date:    2026.10.18
+ */
+bool ColorToRgb24::convertTransformed(uint pixel_format, uchar *frame, uchar *rgb, const uint &width, const uint &height,
+                                      const FrameTransform &transform, RgbOutputFormat format,
+                                      uint ycbcr_enc, bool is_tv_range, FrameStatistics *stats)
+{
+    if(transform.isIdentity())
+    {
+        return convert(pixel_format,frame,rgb,width,height,format,ycbcr_enc,is_tv_range,stats);
+    }
+    //rgb源格式同样对齐到偶数，保证与yuv格式的输出尺寸一致
+    TransformLayout layout = transformLayout(transform,width,height,bytesPerPixel(format),2);
+    LutReader reader(this);
+    return dispatchSource<TransformKernel,RgbTransformKernel>(pixel_format,frame,width,height,ycbcr_enc,is_tv_range,
+                                                              format,reader.lut(),stats,rgb,layout);
+}
+/*
+ *@brief:   获取可零拷贝使用的Y平面地址
+ *注:返回的地址就是帧地址(Y平面位于帧起始处，每行width个字节连续存储)，生命周期与帧数据一致。
+ *@date:    2026.10.18
+ *@param:   pixel_format:帧格式(V4L2_PIX_FMT_*)  frame:帧数据地址
+ *@return:  const uchar*:Y平面地址，packed和rgb格式返回NULL
+ */
+const uchar *ColorToRgb24::lumaPlane(uint pixel_format, const uchar *frame)
+{
+    switch(pixel_format)
+    {
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV21:
+    case V4L2_PIX_FMT_NV16:
+    case V4L2_PIX_FMT_NV61:
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_YVU420:
+    case V4L2_PIX_FMT_GREY:
+        return frame;
+    default:
+        return NULL;
+    }
+}
+/*
+ *@brief:   提取帧数据的Y分量到连续存储的灰度缓冲区(可缩小)
+ *@date:    2026.10.18
+ *@param:   pixel_format:帧格式(V4L2_PIX_FMT_*)  frame:帧数据地址
+ *@param:   luma:灰度数据地址，内存空间((width/downsample)*(height/downsample))必须在方法外申请
+ *@param:   width,height:源帧宽高  downsample:宽高的缩小倍数(>=1，2倍、4倍使用SIMD实现)
+ *@return:  bool:true=成功  false=不支持该格式(rgb格式)或参数错误
+ */
+bool ColorToRgb24::frame_to_luma(uint pixel_format, const uchar *frame, uchar *luma,
+                                 const uint &width, const uint &height, uint downsample)
+{
+    if(downsample == 0 || width < downsample || height < downsample)
+    {
+        return false;
+    }
+    switch(pixel_format)
+    {
+    case V4L2_PIX_FMT_YUYV:
+        lumaKernel(YuyvSource(frame,width),luma,width,height,downsample);
+        break;
+    case V4L2_PIX_FMT_UYVY:
+        lumaKernel(UyvySource(frame,width),luma,width,height,downsample);
+        break;
+    case V4L2_PIX_FMT_YVYU:
+        lumaKernel(YvyuSource(frame,width),luma,width,height,downsample);
+        break;
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV21:
+    case V4L2_PIX_FMT_NV16:
+    case V4L2_PIX_FMT_NV61:
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_YVU420:
+    case V4L2_PIX_FMT_GREY:
+        //Y平面连续存储，各格式的luma访问方式一致
+        lumaKernel(GreySource(frame,width),luma,width,height,downsample);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+/*
+ *@brief:   统计原始帧数据Y分量的直方图(不做rgb转换)
+ *注:结果累加到stats的Luma通道(不会先清空)，r、g、b通道不变。TV Range数据的取值范围为[16,235]，判断欠曝/过曝时
+ *可以使用FrameStatistics::countBelow(Luma,16)/countAbove(Luma,235)。
+ *@date:    2026.10.18
+ *@param:   pixel_format:帧格式(V4L2_PIX_FMT_*)  frame:帧数据地址
+ *@param:   width,height:源帧宽高
+ *@param:   stats:帧统计
+ *@param:   step:抽样步长(>=1)，每隔step行、step列统计一个像素，1表示统计全部像素(使用SIMD实现)
+ *@return:  bool:true=成功  false=不支持该格式(rgb格式)或参数错误
+ */
+bool ColorToRgb24::frame_statistics(uint pixel_format, const uchar *frame, const uint &width, const uint &height,
+                                    FrameStatistics &stats, uint step)
+{
+    if(step == 0)
+    {
+        return false;
+    }
+    switch(pixel_format)
+    {
+    case V4L2_PIX_FMT_YUYV:
+        lumaStatisticsKernel(YuyvSource(frame,width),stats,width,height,step);
+        break;
+    case V4L2_PIX_FMT_UYVY:
+        lumaStatisticsKernel(UyvySource(frame,width),stats,width,height,step);
+        break;
+    case V4L2_PIX_FMT_YVYU:
+        lumaStatisticsKernel(YvyuSource(frame,width),stats,width,height,step);
+        break;
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV21:
+    case V4L2_PIX_FMT_NV16:
+    case V4L2_PIX_FMT_NV61:
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_YVU420:
+    case V4L2_PIX_FMT_GREY:
+        lumaStatisticsKernel(GreySource(frame,width),stats,width,height,step);
+        break;
+    default:
+        return false;
+    }
+    return true;
 }
 /*
  *@brief:   将yuyv帧格式数据转换成rgb24格式数据，这里采用的是基于整形移位的yuv--rgb转换公式
  *注:YUYV是YUV422采样方式(数据存储分为packed(打包)和planar(平面))中的一种，基于packed方式的转换。
  *@date:    2019.8.7
+ *@update:  2026.10.18
  *@param:   yuyv:yuyv帧格式数据地址，该地址通常是对设备的内存映射空间
  *@param:   rgb24:rgb888帧格式数据地址，该地址内存空间必须在方法外申请
  *@param:   width:宽度  height:高度
+ *@param:   ycbcr_enc:转换标准(V4L2_YCBCR_ENC_*)  is_tv_range:true=TV Range  false=Full Range
  */
 void ColorToRgb24::yuyv_to_rgb24_shift(uchar *yuyv, uchar *rgb24,
-                                       const uint &width, const uint &height)
-{
-    //qDebug()<<"yuyv_to_rgb24_shift-start:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
-    int yvyuLen = width*height*2;//yuyv用四字节表示两个像素
-    int y0,u,y1,v;
-    int r_uv,g_uv,b_uv;
-    int r,g,b;
-    int rgbIndex = 0;
-    /*每次循环转换出两个rgb像素*/
-    for(int i = 0;i<yvyuLen;i += 4)
-    {
-        //按顺序提取yuyv数据
-        y0 = yuyv[i+0];
-        u  = yuyv[i+1] - 128;
-        y1 = yuyv[i+2];
-        v  = yuyv[i+3] - 128;
-        //移位法  计算RGB公式内不包含Y的部分，结果可以供两个rgb像素使用
-        r_uv = v+((103*v)>>8);
-        g_uv = ((88*u)>>8)+((183*v)>>8);
-        b_uv = u+((197*u)>>8);
-        //像素1的rgb数据
-        r = y0 + r_uv;
-        g = y0 - g_uv;
-        b = y0 + b_uv;
-        r = (r > 255)?255:(r < 0)?0:r;
-        g = (g > 255)?255:(g < 0)?0:g;
-        b = (b > 255)?255:(b < 0)?0:b;
-#ifdef ENABLE_COLOR_ADJUST
-        rgbColorAdjust(r,g,b);
-#endif
-        rgb24[rgbIndex++] = r;
-        rgb24[rgbIndex++] = g;
-        rgb24[rgbIndex++] = b;
-        //像素2的rgb数据
-        r = y1 + r_uv;
-        g = y1 - g_uv;
-        b = y1 + b_uv;
-        r = (r > 255)?255:(r < 0)?0:r;
-        g = (g > 255)?255:(g < 0)?0:g;
-        b = (b > 255)?255:(b < 0)?0:b;
-#ifdef ENABLE_COLOR_ADJUST
-        rgbColorAdjust(r,g,b);
-#endif
-        rgb24[rgbIndex++] = r;
-        rgb24[rgbIndex++] = g;
-        rgb24[rgbIndex++] = b;
-    }
-    //qDebug()<<"yuyv_to_rgb24_shift-end:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
+                                       const uint &width, const uint &height,
+                                       uint ycbcr_enc, bool is_tv_range)
+{
+    frame_to_rgb(V4L2_PIX_FMT_YUYV,yuyv,rgb24,width,height,RGB888,ycbcr_enc,is_tv_range);
 }
 /*
  *@brief:   将NV12/NV21帧格式数据转换成rgb24格式数据，这里采用的是基于整形移位的yuv--rgb转换公式
  *注：NV12/NV21是YUV420SP格式的一种，two-plane模式(连续缓存)，即Y和UV分为两个plane，Y按照和planar存储，
  *UV(CbCr)则为packed交错存储,两种格式仅仅UV的先后顺序相反。
  *@date:    2024.3.22
+ *@update:  2026.10.18
  *@param:   is_nv12:true=NV12  false=NV21
  *@param:   nv12_21:NV12/NV21(YUV420SP的一种)帧格式数据地址，该地址通常是对设备的内存映射空间
  *@param:   rgb24:rgb888帧格式数据地址，该地址内存空间必须在方法外申请
  *@param:   width:宽度  height:高度
+ *@param:   ycbcr_enc:转换标准(V4L2_YCBCR_ENC_*)  is_tv_range:true=TV Range  false=Full Range
  */
 void ColorToRgb24::nv12_21_to_rgb24_shift(bool is_nv12, uchar *nv12_21, uchar *rgb24,
-                                          const uint &width, const uint &height)
-{
-    //qDebug()<<"nv12_21_to_rgb24_shift-start:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
-    uint y_len,rgb_width,cur_pixel_pos,cur_row_pixel_len;
-    uint cur_pixel_rgb_pos,next_pixel_rgb_pos;
-    int y_odd1,y_odd2,y_even1,y_even2,u,v;
-    int r_uv,g_uv,b_uv;
-    int r,g,b;
-    y_len = width*height;//Y分量的字节长度
-    rgb_width = width*3;//一行rgb像素的字节长度
-    cur_pixel_pos = 0;//当前处理的像素位置
-    for(uint i=0;i<height;i+=2)//一次处理两行
-    {
-        cur_row_pixel_len = cur_pixel_pos;//当前行首的像素距离首个像素的长度
-        for(uint j=0;j<width;j+=2)//一次处理两列
-        {
-            //当前的rgb像素位置 = 当前处理像素位置*3
-            cur_pixel_rgb_pos = cur_pixel_pos*3;
-            next_pixel_rgb_pos = cur_pixel_rgb_pos + rgb_width;
-            //uv分量
-            if(is_nv12)
-            {
-                u = nv12_21[y_len-(cur_row_pixel_len>>1)+cur_pixel_pos] - 128;
-                v = nv12_21[y_len-(cur_row_pixel_len>>1)+cur_pixel_pos+1] - 128;
-            }
-            else
-            {
-                v = nv12_21[y_len-(cur_row_pixel_len>>1)+cur_pixel_pos] - 128;
-                u = nv12_21[y_len-(cur_row_pixel_len>>1)+cur_pixel_pos+1] - 128;
-            }
-
-            //移位法  计算RGB公式内不包含Y的部分，结果可以供4个rgb像素使用
-            r_uv = v+((103*v)>>8);
-            g_uv = ((88*u)>>8)+((183*v)>>8);
-            b_uv = u+((197*u)>>8);
-            //四个Y分量，共用一组uv
-            y_odd1 = nv12_21[cur_pixel_pos];
-            y_odd2 = nv12_21[cur_pixel_pos+1];
-            y_even1 = nv12_21[cur_pixel_pos+width];
-            y_even2 = nv12_21[cur_pixel_pos+1+width];
-            /*关联Y分量，计算出rgb值*/
-            //奇数行
-            r = y_odd1 + r_uv;
-            g = y_odd1 - g_uv;
-            b = y_odd1 + b_uv;
-            r = (r > 255)?255:(r < 0)?0:r;
-            g = (g > 255)?255:(g < 0)?0:g;
-            b = (b > 255)?255:(b < 0)?0:b;
-#ifdef ENABLE_COLOR_ADJUST
-            rgbColorAdjust(r,g,b);
-#endif
-            rgb24[cur_pixel_rgb_pos] = r;
-            rgb24[cur_pixel_rgb_pos+1] = g;
-            rgb24[cur_pixel_rgb_pos+2] = b;
-            r = y_odd2 + r_uv;
-            g = y_odd2 - g_uv;
-            b = y_odd2 + b_uv;
-            r = (r > 255)?255:(r < 0)?0:r;
-            g = (g > 255)?255:(g < 0)?0:g;
-            b = (b > 255)?255:(b < 0)?0:b;
-#ifdef ENABLE_COLOR_ADJUST
-            rgbColorAdjust(r,g,b);
-#endif
-            rgb24[cur_pixel_rgb_pos+3] = r;
-            rgb24[cur_pixel_rgb_pos+4] = g;
-            rgb24[cur_pixel_rgb_pos+5] = b;
-            //偶数行
-            r = y_even1 + r_uv;
-            g = y_even1 - g_uv;
-            b = y_even1 + b_uv;
-            r = (r > 255)?255:(r < 0)?0:r;
-            g = (g > 255)?255:(g < 0)?0:g;
-            b = (b > 255)?255:(b < 0)?0:b;
-#ifdef ENABLE_COLOR_ADJUST
-            rgbColorAdjust(r,g,b);
-#endif
-            rgb24[next_pixel_rgb_pos] = r;
-            rgb24[next_pixel_rgb_pos+1] = g;
-            rgb24[next_pixel_rgb_pos+2] = b;
-            r = y_even2 + r_uv;
-            g = y_even2 - g_uv;
-            b = y_even2 + b_uv;
-            r = (r > 255)?255:(r < 0)?0:r;
-            g = (g > 255)?255:(g < 0)?0:g;
-            b = (b > 255)?255:(b < 0)?0:b;
-#ifdef ENABLE_COLOR_ADJUST
-            rgbColorAdjust(r,g,b);
-#endif
-            rgb24[next_pixel_rgb_pos+3] = r;
-            rgb24[next_pixel_rgb_pos+4] = g;
-            rgb24[next_pixel_rgb_pos+5] = b;
-
-            //像素位置向后移动两列
-            cur_pixel_pos += 2;
-        }
-        //像素位置向后跳过一行
-        cur_pixel_pos += width;
-    }
-    //qDebug()<<"nv12_21_to_rgb24_shift-end:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
+                                          const uint &width, const uint &height,
+                                          uint ycbcr_enc, bool is_tv_range)
+{
+    frame_to_rgb(is_nv12?V4L2_PIX_FMT_NV12:V4L2_PIX_FMT_NV21,nv12_21,rgb24,width,height,RGB888,ycbcr_enc,is_tv_range);
 }
 /*
  *@brief:   将rgb32(rgb8888,对应fourcc为rgb4)帧格式数据转换成rgb24格式数据
@@ -200,88 +1640,388 @@ void ColorToRgb24::nv12_21_to_rgb24_shift(bool is_nv12, uchar *nv12_21, uchar *r
  */
 void ColorToRgb24::rgb4_to_rgb24(uchar *rgb32, uchar *rgb24, const uint &width, const uint &height)
 {
-    int rgb32_len = width*height*4;
-    int rgb24_index = 0;
-#ifdef ENABLE_COLOR_ADJUST
-    int r,g,b;
-    for(int i=0;i<rgb32_len;i+=4)
-    {
-        r = rgb32[i+1];
-        g = rgb32[i+2];
-        b = rgb32[i+3];
-        rgbColorAdjust(r,g,b);
-        rgb24[rgb24_index] = r;
-        rgb24[++rgb24_index] = g;
-        rgb24[++rgb24_index] = b;
-    }
-#else
-    for(int i=0;i<rgb32_len;i+=4)
-    {
-        rgb24[rgb24_index] = rgb32[i+1];
-        rgb24[++rgb24_index] = rgb32[i+2];
-        rgb24[++rgb24_index] = rgb32[i+3];
-    }
-#endif
+    frame_to_rgb(V4L2_PIX_FMT_RGB32,rgb32,rgb24,width,height,RGB888);
+}
+/*
+ *@brief:   将yuyv帧格式数据转换成指定格式的rgb数据(参数说明同frame_to_rgb())
+ *@date:    2026.10.18
+ */
+void ColorToRgb24::yuyv_to_rgb(uchar *yuyv, uchar *rgb, const uint &width, const uint &height,
+                               RgbOutputFormat format, uint ycbcr_enc, bool is_tv_range)
+{
+    frame_to_rgb(V4L2_PIX_FMT_YUYV,yuyv,rgb,width,height,format,ycbcr_enc,is_tv_range);
+}
+/*
+ *@brief:   将NV12/NV21帧格式数据转换成指定格式的rgb数据(参数说明同frame_to_rgb())
+ *@date:    2026.10.18
+ *@param:   is_nv12:true=NV12  false=NV21
+ */
+void ColorToRgb24::nv12_21_to_rgb(bool is_nv12, uchar *nv12_21, uchar *rgb, const uint &width, const uint &height,
+                                  RgbOutputFormat format, uint ycbcr_enc, bool is_tv_range)
+{
+    frame_to_rgb(is_nv12?V4L2_PIX_FMT_NV12:V4L2_PIX_FMT_NV21,nv12_21,rgb,width,height,format,ycbcr_enc,is_tv_range);
+}
+/*
+ *@brief:   将rgb32(rgb8888,对应fourcc为rgb4)帧格式数据转换成指定格式的rgb数据(参数说明同frame_to_rgb())
+ *@date:    2026.10.18
+ */
+void ColorToRgb24::rgb4_to_rgb(uchar *rgb32, uchar *rgb, const uint &width, const uint &height,
+                               RgbOutputFormat format)
+{
+    frame_to_rgb(V4L2_PIX_FMT_RGB32,rgb32,rgb,width,height,format);
+}
+/*
+ *@brief:   将yuyv帧格式数据缩放转换成指定格式的rgb数据(参数说明同frame_to_rgb_scaled())
+ *@date:    2026.10.18
+ */
+void ColorToRgb24::yuyv_to_rgb_scaled(uchar *yuyv, uchar *rgb, const uint &width, const uint &height,
+                                      const uint &dst_width, const uint &dst_height, RgbOutputFormat format,
+                                      uint ycbcr_enc, bool is_tv_range)
+{
+    frame_to_rgb_scaled(V4L2_PIX_FMT_YUYV,yuyv,rgb,width,height,dst_width,dst_height,format,ycbcr_enc,is_tv_range);
+}
+/*
+ *@brief:   将NV12/NV21帧格式数据缩放转换成指定格式的rgb数据(参数说明同frame_to_rgb_scaled())
+ *@date:    2026.10.18
+ *@param:   is_nv12:true=NV12  false=NV21
+ */
+void ColorToRgb24::nv12_21_to_rgb_scaled(bool is_nv12, uchar *nv12_21, uchar *rgb, const uint &width, const uint &height,
+                                         const uint &dst_width, const uint &dst_height, RgbOutputFormat format,
+                                         uint ycbcr_enc, bool is_tv_range)
+{
+    frame_to_rgb_scaled(is_nv12?V4L2_PIX_FMT_NV12:V4L2_PIX_FMT_NV21,nv12_21,rgb,width,height,
+                        dst_width,dst_height,format,ycbcr_enc,is_tv_range);
+}
+/*
+ *@brief:   将rgb32(rgb8888,对应fourcc为rgb4)帧格式数据缩放转换成指定格式的rgb数据(参数说明同frame_to_rgb_scaled())
+ *@date:    2026.10.18
+ */
+void ColorToRgb24::rgb4_to_rgb_scaled(uchar *rgb32, uchar *rgb, const uint &width, const uint &height,
+                                      const uint &dst_width, const uint &dst_height, RgbOutputFormat format)
+{
+    frame_to_rgb_scaled(V4L2_PIX_FMT_RGB32,rgb32,rgb,width,height,dst_width,dst_height,format);
+}
+/*
+ *@brief:   将yuyv帧格式数据裁剪、镜像、旋转后转换成指定格式的rgb数据(参数说明同frame_to_rgb_transformed())
+ *@date:    2026.10.18
+ */
+void ColorToRgb24::yuyv_to_rgb_transformed(uchar *yuyv, uchar *rgb, const uint &width, const uint &height,
+                                           const FrameTransform &transform, RgbOutputFormat format,
+                                           uint ycbcr_enc, bool is_tv_range)
+{
+    frame_to_rgb_transformed(V4L2_PIX_FMT_YUYV,yuyv,rgb,width,height,transform,format,ycbcr_enc,is_tv_range);
 }
 /*
- *@brief:  颜色调整参数设置
+ *@brief:   将NV12/NV21帧格式数据裁剪、镜像、旋转后转换成指定格式的rgb数据(参数说明同frame_to_rgb_transformed())
+ *@date:    2026.10.18
+ *@param:   is_nv12:true=NV12  false=NV21
+ */
+void ColorToRgb24::nv12_21_to_rgb_transformed(bool is_nv12, uchar *nv12_21, uchar *rgb, const uint &width, const uint &height,
+                                              const FrameTransform &transform, RgbOutputFormat format,
+                                              uint ycbcr_enc, bool is_tv_range)
+{
+    frame_to_rgb_transformed(is_nv12?V4L2_PIX_FMT_NV12:V4L2_PIX_FMT_NV21,nv12_21,rgb,width,height,
+                             transform,format,ycbcr_enc,is_tv_range);
+}
+/*
+ *@brief:   将rgb32(rgb8888,对应fourcc为rgb4)帧格式数据裁剪、镜像、旋转后转换成指定格式的rgb数据(参数说明同frame_to_rgb_transformed())
+ *@date:    2026.10.18
+ */
+void ColorToRgb24::rgb4_to_rgb_transformed(uchar *rgb32, uchar *rgb, const uint &width, const uint &height,
+                                           const FrameTransform &transform, RgbOutputFormat format)
+{
+    frame_to_rgb_transformed(V4L2_PIX_FMT_RGB32,rgb32,rgb,width,height,transform,format);
+}
+/*
+ *@brief:  颜色调整参数设置(作用于全局转换对象，即静态转换接口)
  *@date:   2025.08.12
+ *@update: 2026.10.18
  *@param:  brightness:亮度调整  典型范围[0.5,1.5]
  *@param:  contrast:对比度调整  典型范围[0.5,1.5]
  *@param:  saturation:饱和度调整  典型范围[0.0,2.0]
  */
 void ColorToRgb24::setColorAdjustParam(const double &brightness, const double &contrast, const double &saturation)
 {
-    //qDebug()<<"setColorAdjustParam-start:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
-    colorAdjustParam.brightness = brightness;
-    colorAdjustParam.contrast = contrast;
-    colorAdjustParam.saturation = saturation;
+    globalInstance()->setColorAdjustment(brightness,contrast,saturation);
+}
+/*
+ *@brief:  静态转换接口使用的全局转换对象(首次调用时构造，线程安全)
+ *@date:   2026.10.18
+ *@return: ColorToRgb24*:全局转换对象
+ */
+ColorToRgb24 *ColorToRgb24::globalInstance()
+{
+    static ColorToRgb24 instance;
+    return &instance;
+}
+std::atomic<bool> ColorToRgb24::simdEnabled(true);
+/*
+ *@brief:  编译时是否启用了SIMD实现
+ *@date:   2026.10.18
+ *@return: bool:true=启用(SSE2/NEON)
+ */
+bool ColorToRgb24::isSimdAvailable()
+{
+#if defined(COLOR_CONVERT_NEON) || defined(COLOR_CONVERT_SSE2)
+    return true;
+#else
+    return false;
+#endif
+}
+/*
+ *@brief:  设置SIMD实现的运行时开关(作用于所有转换对象，从下一帧开始生效)
+ *注:关闭后所有格式均使用标量实现，主要用于性能对比，正常使用时不需要关闭。
+ *@date:   2026.10.18
+ *@param:  enabled:true=使用SIMD实现(编译时已启用的前提下)  false=强制使用标量实现
+ */
+void ColorToRgb24::setSimdEnabled(bool enabled)
+{
+    simdEnabled.store(enabled);
+}
+/*
+ *@brief:  获取SIMD实现的运行时开关
+ *@date:   2026.10.18
+ *@return: bool:true=已开启(编译时未启用SIMD时仍然使用标量实现)
+ */
+bool ColorToRgb24::isSimdEnabled()
+{
+    return simdEnabled.load();
+}
+/*
+ *@brief:  设置本对象的颜色调整参数(新参数通过查表快照发布，参见publishAdjustLut())
+ *@date:   2026.10.18
+ *@param:  brightness:亮度调整  典型范围[0.5,1.5]
+ *@param:  contrast:对比度调整  典型范围[0.5,1.5]
+ *@param:  saturation:饱和度调整  典型范围[0.0,2.0]
+ */
+void ColorToRgb24::setColorAdjustment(const double &brightness, const double &contrast, const double &saturation)
+{
+    ColorAdjustmentParam param;
+    param.brightness = brightness;
+    param.contrast = contrast;
+    param.saturation = saturation;
+
+    QMutexLocker locker(&adjustMutex);
+    //持有adjustMutex期间发布中的快照不会被替换，可以直接访问
+    const ColorAdjustLut *current = reinterpret_cast<const ColorAdjustLut *>(adjustLutState.load() & ~LUT_ACQUIRE_MASK);
+    publishAdjustLut(param,current->lut3D);
+}
+/*
+ *@brief:  设置本对象的3D LUT(颜色分级)，与颜色调整参数一样通过快照发布
+ *@date:   2026.10.18
+ *@param:  lut3D:3D LUT，空指针或无效的LUT表示不使用
+ */
+void ColorToRgb24::setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D)
+{
+    QMutexLocker locker(&adjustMutex);
+    const ColorAdjustLut *current = reinterpret_cast<const ColorAdjustLut *>(adjustLutState.load() & ~LUT_ACQUIRE_MASK);
+    publishAdjustLut(current->param,(lut3D && lut3D->isValid())?lut3D:QSharedPointer<const ColorLut3D>());
+}
+/*
+ *@brief:  获取本对象当前的3D LUT
+ *@date:   2026.10.18
+ *@return: QSharedPointer<const ColorLut3D>:3D LUT，未设置时为空
+ */
+QSharedPointer<const ColorLut3D> ColorToRgb24::colorLut3D()
+{
+    LutReader reader(this);
+    return reader.lut()->lut3D;
+}
+/*
+ *@brief:  生成并发布新的查表快照(调用者需持有adjustMutex)
+ *注:先在私有内存中生成完整的新快照，再通过一次原子交换发布(RCU方式)，正在转换的帧继续使用旧快照，不会出现撕裂。
+ *交换出的低位登记数(正在获取引用的读者)转交给旧快照的引用计数，同时释放发布本身占用的引用，旧快照在最后一个持有它的
+ *转换结束时释放。设置参数不等待读者，同一对象上重叠的转换(分块并行转换、全局对象被多个线程共用)也不会让设置阻塞。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  param:颜色调整参数
+ *@param:  lut3D:3D LUT(可以为空)
+ */
+void ColorToRgb24::publishAdjustLut(const ColorAdjustmentParam &param, const QSharedPointer<const ColorLut3D> &lut3D)
+{
+    //qDebug()<<"publishAdjustLut-start:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
+    const ColorAdjustLut *newLut = ColorAdjustLut::create(param,lut3D);
+    const quintptr previous = adjustLutState.exchange(quintptr(newLut),std::memory_order_acq_rel);
+    const ColorAdjustLut *oldLut = reinterpret_cast<const ColorAdjustLut *>(previous & ~LUT_ACQUIRE_MASK);
+    oldLut->unref(1 - int(previous & LUT_ACQUIRE_MASK));
+    //qDebug()<<"publishAdjustLut-end:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
+}
+/*
+ *@brief:  获取本对象当前的颜色调整参数
+ *@date:   2026.10.18
+ *@return: ColorAdjustmentParam:颜色调整参数
+ */
+ColorToRgb24::ColorAdjustmentParam ColorToRgb24::colorAdjustment()
+{
+    LutReader reader(this);
+    return reader.lut()->param;
+}
+/*
+ *@brief:  根据颜色调整参数生成查表快照(按缓存行对齐申请内存)
+ *@date:   2025.08.12
+ *@update: 2026.10.18
+ *@param:  param:颜色调整参数
+ *@param:  lut3D:3D LUT(可以为空)
+ *@return: ColorAdjustLut*:查表快照，通过destroy()释放
+ */
+ColorToRgb24::ColorAdjustLut *ColorToRgb24::ColorAdjustLut::create(const ColorAdjustmentParam &param,
+                                                                   const QSharedPointer<const ColorLut3D> &lut3D)
+{
+    //C++11的new不保证超过alignof(max_align_t)的对齐，这里手动申请对齐内存
+    ColorAdjustLut *lut = new(qMallocAligned(sizeof(ColorAdjustLut),alignof(ColorAdjustLut))) ColorAdjustLut;
+    lut->param = param;
+    lut->lut3D = lut3D;
+    lut->refCount.store(1,std::memory_order_relaxed);//发布本身占用的引用
+    lut->adjustContrast = (param.contrast != 1.0);
+    lut->adjustSaturation = (param.saturation != 1.0);
+    lut->adjustBrightness = (param.brightness != 1.0);
+    lut->enabled = lut->adjustContrast || lut->adjustSaturation || lut->adjustBrightness;
 
     //更新亮度、对比度查表数据
     for(int i=0;i<256;i++)
     {
-        brightnessLUT[i] = i*colorAdjustParam.brightness;
-        brightnessLUT[i] = (brightnessLUT[i] > 255)?255:(brightnessLUT[i] < 0)?0:brightnessLUT[i];
-        contrastLUT[i] = qRound(128+(i-128)*colorAdjustParam.contrast);
-        contrastLUT[i] = (contrastLUT[i] > 255)?255:(contrastLUT[i] < 0)?0:contrastLUT[i];
+        int brightness = i*param.brightness;
+        lut->brightnessLUT[i] = (brightness > 255)?255:(brightness < 0)?0:brightness;
+        int contrast = qRound(128+(i-128)*param.contrast);
+        lut->contrastLUT[i] = (contrast > 255)?255:(contrast < 0)?0:contrast;
     }
-    //更新饱和度查表数据
+    //更新饱和度查表数据，L+差值最终会限定在[0,255]，所以差值超出±511的部分可以直接截断，不影响结果
     for(int i=0;i<511;i++)
     {
-        saturationLUT[i] = qRound((i-255)*colorAdjustParam.saturation);
+        int saturation = qRound((i-255)*param.saturation);
+        lut->saturationLUT[i] = (saturation > 511)?511:(saturation < -511)?-511:saturation;
+    }
+    return lut;
+}
+/*
+ *@brief:  释放查表快照
+ *@date:   2026.10.18
+ *@param:  lut:create()生成的查表快照
+ */
+void ColorToRgb24::ColorAdjustLut::destroy(const ColorAdjustLut *lut)
+{
+    if(lut)
+    {
+        lut->~ColorAdjustLut();
+        qFreeAligned(const_cast<ColorAdjustLut *>(lut));
+    }
+}
+/*
+ *@brief:  释放快照的引用，引用计数减为0时释放快照
+ *@date:   2026.10.18
+ *@param:  count:释放的引用数(写者替换快照时为1减去转交的登记数，可以为负)
+ */
+void ColorToRgb24::ColorAdjustLut::unref(int count) const
+{
+    if(refCount.fetch_sub(count,std::memory_order_acq_rel) == count)
+    {
+        destroy(this);
+    }
+}
+/*
+ *@brief:  判断当前是否需要进行颜色调整(未定义ENABLE_COLOR_ADJUST或参数均为1.0时不需要)
+ *@date:   2026.10.18
+ *@param:  lut:颜色调整查表快照
+ *@return: bool:true=需要进行颜色调整
+ */
+bool ColorToRgb24::isColorAdjustEnabled(const ColorAdjustLut *lut)
+{
+#ifdef ENABLE_COLOR_ADJUST
+    return lut->enabled;
+#else
+    Q_UNUSED(lut);
+    return false;
+#endif
+}
+/*
+ *@brief:  将计算出的rgb值限定在[0,255]，进行颜色调整(如果启用)后按照输出格式写入
+ *@date:   2026.10.18
+ *@param:  lut:颜色调整查表快照  dst:像素写入地址
+ *@param:  r,g,b:转换后的rgb值(未限定范围)
+ */
+template<class Writer>
+void ColorToRgb24::writePixel(const ColorAdjustLut *lut, uchar *dst, int r, int g, int b)
+{
+    r = (r > 255)?255:(r < 0)?0:r;
+    g = (g > 255)?255:(g < 0)?0:g;
+    b = (b > 255)?255:(b < 0)?0:b;
+#ifdef ENABLE_COLOR_ADJUST
+    if(lut->enabled)
+    {
+        rgbColorAdjust(lut,r,g,b);
     }
-    //qDebug()<<"setColorAdjustParam-start:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
+#else
+    Q_UNUSED(lut);
+#endif
+    Writer::write(dst,r,g,b);
+}
+/*
+ *@brief:  单个像素的yuv转rgb(整形移位)，用于缩放转换等无法共用uv中间结果的场景
+ *@date:   2026.10.18
+ *@param:  lut:颜色调整查表快照  dst:像素写入地址
+ *@param:  y,u,v:yuv分量(未减去偏移)
+ */
+template<class Coef,class Writer>
+void ColorToRgb24::yuvToRgbPixel(const ColorAdjustLut *lut, uchar *dst, int y, int u, int v)
+{
+    y = Coef::yMul*(y - Coef::yOff);
+    u -= 128;
+    v -= 128;
+    writePixel<Writer>(lut,dst,(y + Coef::rv*v + 128)>>8,(y - (Coef::gu*u + Coef::gv*v - 128))>>8,
+                       (y + Coef::bu*u + 128)>>8);
 }
 /*
- *@brief:  针对颜色调整参数(colorAdjustParam),对rgb颜色进行调整
+ *@brief:  针对颜色调整查表快照,对rgb颜色进行调整
  *@date:   2025.08.12
+ *@update: 2026.10.18
+ *@param:  lut:颜色调整查表快照
  *@param:  r,g,b:以引用形式传递原始数据，调整后的数据直接应用到参数上  范围[0,255]
  */
-void ColorToRgb24::rgbColorAdjust(int &r, int &g, int &b)
+void ColorToRgb24::rgbColorAdjust(const ColorAdjustLut *lut, int &r, int &g, int &b)
 {
     //对比度调整
-    if(colorAdjustParam.contrast != 1.0)
+    if(lut->adjustContrast)
     {
-        r = contrastLUT[r];
-        g = contrastLUT[g];
-        b = contrastLUT[b];
+        r = lut->contrastLUT[r];
+        g = lut->contrastLUT[g];
+        b = lut->contrastLUT[b];
     }
     //饱和度调整(相对更耗时，如果硬件性能不够的话，尽量不要调整该参数)
-    if(colorAdjustParam.saturation != 1.0)
+    if(lut->adjustSaturation)
     {
         int luma = (306*r+601*g+117*b)>>10;
-        r = luma + saturationLUT[r-luma+255];
-        g = luma + saturationLUT[g-luma+255];
-        b = luma + saturationLUT[b-luma+255];
+        r = luma + lut->saturationLUT[r-luma+255];
+        g = luma + lut->saturationLUT[g-luma+255];
+        b = luma + lut->saturationLUT[b-luma+255];
         r = (r > 255)?255:(r < 0)?0:r;
         g = (g > 255)?255:(g < 0)?0:g;
         b = (b > 255)?255:(b < 0)?0:b;
     }
     //亮度调整(顺序上放在最后)
-    if(colorAdjustParam.brightness != 1.0)
+    if(lut->adjustBrightness)
+    {
+        r = lut->brightnessLUT[r];
+        g = lut->brightnessLUT[g];
+        b = lut->brightnessLUT[b];
+    }
+}
+/*
+ *@brief:  对已写入的连续像素应用3D LUT并累加帧统计(均未设置时直接返回)
+ *注:每转换完一行调用一次，此时该行数据仍在一级缓存中，统计的是3D LUT之后的最终输出。
+ *@date:   2026.10.18
+ *@param:  lut:颜色调整查表快照
+ *@param:  stats:帧统计(可以为空)
+ *@param:  dst:像素地址  count:像素个数
+ */
+template<class Writer>
+void ColorToRgb24::finishRows(const ColorAdjustLut *lut, FrameStatistics *stats, uchar *dst, uint count)
+{
+    if(lut->lut3D)
+    {
+        lut->lut3D->applyRow(dst,count,Writer::bytesPerPixel,Writer::rOffset,Writer::gOffset,Writer::bOffset);
+    }
+    if(stats)
     {
-        r = brightnessLUT[r];
-        g = brightnessLUT[g];
-        b = brightnessLUT[b];
+        stats->accumulateRgb(dst,count,Writer::bytesPerPixel,Writer::rOffset,Writer::gOffset,Writer::bOffset);
     }
 }
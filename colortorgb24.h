@@ -7,24 +7,40 @@
 /*
  *@author:  缪庆瑞
  *@date:    2024.03.21
+ *@update:  2026.10.18
  *@brief:   将指定颜色空间数据转换为rgb24格式(软解码)
  *
  *该模块目前集成了软解码(包含基础的颜色调整)相关的接口：
- *软解码包括V4L2_PIX_FMT_YUYV、V4L2_PIX_FMT_NV12、V4L2_PIX_FMT_NV21三种yuv格式到rgb的转换处理，均是使用CCIR 601的转换公
- *式(整形移位)，为了提高处理性能，转换函数已经尽最大可能的进行了优化。
+ *软解码包括V4L2_PIX_FMT_YUYV、V4L2_PIX_FMT_NV12、V4L2_PIX_FMT_NV21三种yuv格式到rgb的转换处理，均是使用整形移位的转换公
+ *式，为了提高处理性能，转换函数已经尽最大可能的进行了优化。
+ *转换标准(BT601/BT709/BT2020)和量化范围(Full/TV Range)由调用者传递(通常来自驱动VIDIOC_G_FMT返回的colorspace、ycbcr_enc、
+ *quantization)，每种组合的转换系数均为编译期常量，并各自实例化一份转换函数，所以热点循环内不存在额外的判断。
  *根据具体需求，通过宏定义(减少因软件标志判断的性能损失)控制是否启用颜色调整处理，目前只针对亮度、对比度、饱和度三项基础参数进行调整。
+ *颜色调整参数及查表数据属于转换对象(实例)，多路摄像头可以各自持有一个转换对象，互不影响地并行转换。查表数据以不可变快照的形式
+ *发布，设置参数时先生成新快照再通过一次原子指针交换替换旧快照(RCU方式)，转换过程不加锁，且一帧内始终使用同一份快照，不会出现
+ *半帧新参数、半帧旧参数的撕裂现象。原有的静态接口内部使用一个全局转换对象(globalInstance())，保持兼容。
+ *另外可以为转换对象设置3D LUT(ColorLut3D，.cube文件)进行颜色分级，在基础颜色调整之后逐行应用(行数据仍在一级缓存中)，
+ *不影响yuv转rgb本身的SIMD实现。同样在逐行处理的位置可以顺带累加帧统计(FrameStatistics:直方图、均值、过曝/欠曝像素数)，
+ *省去对rgb帧的第二次遍历；只需要亮度统计时可以使用frame_statistics()直接统计原始帧的Y分量。
  *
  *注:关于软解码初期尝试过使用完全查表法(提前基于转换公式将r、g、b的所有可能性计算出来存到表里，通过yuv值索引获取)实现yuv到rgb的转换，
  *但该方式会涉及多维数据（r_yv_table[256][256]、g_yuv_table[256][256][256]、b_yu_table[256][256])访问,初始化运算量较大(进行
  *一千六百多万次的计算，需要考虑cpu主频性能，否则初始化时间可能难以接受)，占用内存较多(约16M)，更严重的是完全查表法有一个无法解决的性能
  *瓶颈，便是多维数组数据量太大造成cpu缓存命中率降低，导致频繁读内存查表效率反而更低。为了避开该瓶颈，采用部分查表法(提前基于整形移位将uv
  *分量跟rgb分量的关系计算存到表里)省却了一部分cpu计算，但后续还是要关联Y分量，进行rgb阈值判断，相较与对每个像素都进行整形移位计算的方式，
- *部分查表法在性能上并没有提高多少。
+ *部分查表法在性能上并没有提高多少。上述结论可以使用benchmark目录下的性能测试程序(包含两种查表法的参考实现)在新硬件上重新验证。
  */
 #ifndef COLORTORGB24_H
 #define COLORTORGB24_H
 
 #include "qglobal.h"
+#include <QMutex>
+#include <QSharedPointer>
+#include <atomic>
+#include <linux/videodev2.h>//v4l2的头文件
+
+class ColorLut3D;
+class FrameStatistics;
 
 /*表示是否启用颜色调整(亮度、对比度、饱和度)处理算法
  *这里通过宏定义控制是否启用颜色调整处理算法，之所以不使用内部的软标志，是为了减少因代码标志判断造成的性能损失，实现软解码性能的最优化。
@@ -32,38 +48,85 @@
  */
 #define ENABLE_COLOR_ADJUST
 
+/*表示是否启用SIMD(x86 SSE2/ARM NEON)加速转换
+ *仅在编译器支持对应指令集，且当前未进行颜色调整(参数均为1.0)时生效，其余情况自动使用标量实现。
+ *SIMD实现使用16位定点运算，与标量实现相比每个分量可能存在±2以内的舍入误差。
+ */
+#define ENABLE_SIMD_CONVERT
+
+/*YUV转RGB的转换系数(Full Range，浮点)，软解码和着色器(V4l2Rendering)共用同一份系数
+ *R=Y+rv*(V-128)  G=Y-gu*(U-128)-gv*(V-128)  B=Y+bu*(U-128)
+ *各系数由标准定义的Kr、Kb推导：rv=2(1-Kr) bu=2(1-Kb) gu=bu*Kb/Kg gv=rv*Kr/Kg*/
+struct YuvToRgbCoef
+{
+    float rv;
+    float gu;
+    float gv;
+    float bu;
+};
+/*根据ycbcr_enc(V4L2_YCBCR_ENC_*)获取对应标准的转换系数，未知的编码按照BT601处理*/
+constexpr YuvToRgbCoef yuvToRgbCoef(uint ycbcr_enc)
+{
+    return (ycbcr_enc == V4L2_YCBCR_ENC_709)?YuvToRgbCoef{1.5748f,0.187324f,0.468124f,1.8556f}:
+           (ycbcr_enc == V4L2_YCBCR_ENC_BT2020)?YuvToRgbCoef{1.4746f,0.164553f,0.571353f,1.8814f}:
+           YuvToRgbCoef{1.402f,0.344136f,0.714136f,1.772f};
+}
+/*浮点系数转换为整形移位系数(放大256倍并四舍五入)*/
+constexpr int yuvCoefShift(float coef)
+{
+    return int(coef*256.0f+0.5f);
+}
+/*整形移位使用的转换系数(放大256倍)，编译期由浮点系数自动推导，每种标准和range组合对应一个特化类型
+ *TV Range需要先将Y[16,235]拉伸到[0,255](乘以255/219)，UV[16,240]拉伸到[0,255](乘以255/224)*/
+template<uint YcbcrEnc,bool IsTvRange>
+struct YuvShiftCoef
+{
+    static constexpr float uvScale = IsTvRange?(255.0f/224.0f):1.0f;
+
+    static constexpr int yMul = IsTvRange?yuvCoefShift(255.0f/219.0f):256;
+    static constexpr int yOff = IsTvRange?16:0;
+    static constexpr int rv = yuvCoefShift(yuvToRgbCoef(YcbcrEnc).rv*uvScale);
+    static constexpr int gu = yuvCoefShift(yuvToRgbCoef(YcbcrEnc).gu*uvScale);
+    static constexpr int gv = yuvCoefShift(yuvToRgbCoef(YcbcrEnc).gv*uvScale);
+    static constexpr int bu = yuvCoefShift(yuvToRgbCoef(YcbcrEnc).bu*uvScale);
+};
+
 class ColorToRgb24
 {
 public:
     ColorToRgb24();
+    ~ColorToRgb24();
 
-    /* 软解码
-     * YUV<---->RGB格式转换常用公式(CCIR BT601，主要针对标清图像，高清图像不建议软解码)如下：
-     *
-     * 注:下述公式yuv和rgb值区间均为全范围[0,255],但很多摄像头采集的YUV数据是TV范围：Y[16,235],UV[16,240]
-     * 这也导致了基于该算法处理的图像失真，纯黑色(16,16,16)会误被认为带亮度的灰色
-     * 浮点计算(效率低)                                  整形移位:(效率较高)
-     *                                                 v=V-128; u=U-128;
-     * R=Y+1.403*(V−128)                               R=Y+v+((103*v)>>8)
-     * G=Y–0.343*(U–128)–0.714*(V–128)                 G=Y-((88*u)>>8)-((183*v)>>8)
-     * B=Y+1.770*(U–128)                               B=Y+u+((197*u)>>8)
-     *
-     * Y=0.299R+0.587G+0.114B
-     * U(Cb)=−0.169R−0.331G+0.500B+128
-     * V(Cr)=0.500R−0.419G−0.081B+128
-     */
-    static void yuyv_to_rgb24_shift(uchar *yuyv,uchar *rgb24,
-                                    const uint &width,const uint &height);
-    static void nv12_21_to_rgb24_shift(bool is_nv12,uchar *nv12_21,uchar *rgb24,
-                                    const uint &width,const uint &height);
-    static void rgb4_to_rgb24(uchar *rgb32,uchar *rgb24,const uint &width,const uint &height);
-
-    /*颜色调整参数设置*/
-    static void setColorAdjustParam(const double &brightness,const double &contrast,const double &saturation);
+    /*rgb输出格式
+     *32位格式每个像素4字节对齐存储，可以直接封装成对应的QImage格式交给Qt绘制，省去QPixmap::fromImage()内部再次转换成
+     *本地32位格式的开销，同时4字节对齐的存储也更适合SIMD向量化处理。*/
+    enum RgbOutputFormat
+    {
+        RGB888 = 0,//R,G,B三字节  对应QImage::Format_RGB888
+        RGB32,//按32位整形0xffRRGGBB存储(小端字节序为B,G,R,0xff)  对应QImage::Format_RGB32
+        ARGB32_Premultiplied,//alpha固定为0xff，存储与RGB32一致  对应QImage::Format_ARGB32_Premultiplied
+        RGBX8888,//R,G,B,0xff四字节  对应QImage::Format_RGBX8888，OpenGL的GL_RGBA
+        BGRA8888//B,G,R,0xff四字节  对应OpenGL的GL_BGRA(小端字节序下与RGB32一致)
+    };
+    static uint bytesPerPixel(RgbOutputFormat format){return (format == RGB888)?3:4;}
 
+    /*裁剪、镜像、旋转参数，处理顺序为先裁剪，再镜像，最后顺时针旋转(与V4l2Rendering的着色器处理一致)*/
+    struct FrameTransform
+    {
+        uint cropX = 0;//裁剪区域的左顶点(源图像坐标)，yuv格式会向下对齐到色度采样的边界(偶数)
+        uint cropY = 0;
+        uint cropWidth = 0;//裁剪区域的宽高，0表示一直到图像的右(下)边界，yuv格式会向下对齐到偶数
+        uint cropHeight = 0;
+        bool hMirror = false;//水平镜像
+        bool vMirror = false;//垂直镜像
+        uint rotation = 0;//顺时针旋转角度(0/90/180/270)
 
-private:
-    static inline void rgbColorAdjust(int &r,int &g,int &b);
+        bool isIdentity() const
+        {
+            return cropX == 0 && cropY == 0 && cropWidth == 0 && cropHeight == 0 &&
+                    !hMirror && !vMirror && rotation == 0;
+        }
+    };
 
     //颜色调整参数结构声明(目前主要针对亮度、对比度、饱和度进行调整)
     struct ColorAdjustmentParam
@@ -86,15 +149,190 @@ private:
          */
         double saturation = 1.0;
     };
-    static ColorAdjustmentParam colorAdjustParam;
-    //亮度调节查表法，只有加法和范围校验，运算并不复杂，这里纯粹是以空间换时间，追求极限性能
-    static int brightnessLUT[256];
-    //对比度调节查表法,减少浮点计算的性能损失(实测对于一些浮点运算能力低的硬件会导致图像闪烁)
-    static int contrastLUT[256];
-    /*饱和度调节查表法，同样是为了减少浮点计算的性能损失
-     *数组元素对应上述(R(GB)-L)的变量区间，这里不使用两个变量的二维数组是因为[256][256]有64Kb，可能会超出cpu
-     *一级缓存大小，造成缓存命中率降低。*/
-    static int saturationLUT[511];
+
+    /* 软解码
+     * YUV<---->RGB格式转换常用公式(以CCIR BT601为例，BT709/BT2020仅系数不同，参见yuvToRgbCoef())如下：
+     *
+     * 注:下述公式yuv和rgb值区间均为全范围[0,255],但很多摄像头采集的YUV数据是TV范围：Y[16,235],UV[16,240]
+     * 所以需要根据驱动返回的quantization传递is_tv_range，否则纯黑色(16,16,16)会误被认为带亮度的灰色
+     * 浮点计算(效率低)                                  整形移位:(效率较高,系数见YuvShiftCoef)
+     *                                                 v=V-128; u=U-128; y=Y(TV Range:y=(298*(Y-16))>>8)
+     * R=Y+1.403*(V−128)                               R=y+((359*v+128)>>8)
+     * G=Y–0.343*(U–128)–0.714*(V–128)                 G=y-((88*u+183*v-128)>>8)
+     * B=Y+1.770*(U–128)                               B=y+((454*u+128)>>8)
+     *
+     * Y=0.299R+0.587G+0.114B
+     * U(Cb)=−0.169R−0.331G+0.500B+128
+     * V(Cr)=0.500R−0.419G−0.081B+128
+     *
+     * ycbcr_enc:转换标准(V4L2_YCBCR_ENC_601/V4L2_YCBCR_ENC_709/V4L2_YCBCR_ENC_BT2020)
+     * is_tv_range:true=TV Range(V4L2_QUANTIZATION_LIM_RANGE)  false=Full Range(V4L2_QUANTIZATION_FULL_RANGE)
+     */
+    /*通用转换接口，根据V4L2帧格式(V4L2_PIX_FMT_*)选择对应的转换实现，返回false表示不支持该格式
+     *支持YUYV/UYVY/YVYU、NV12/NV21、NV16/NV61、YUV420/YVU420、GREY、RGB32、RGB565(单平面连续存储)*/
+    static bool isSupportedFormat(uint pixel_format);
+    static uint frameBytes(uint pixel_format,const uint &width,const uint &height);//一帧数据的字节数
+    static bool frame_to_rgb(uint pixel_format,uchar *frame,uchar *rgb,const uint &width,const uint &height,
+                             RgbOutputFormat format,uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+    static bool frame_to_rgb_scaled(uint pixel_format,uchar *frame,uchar *rgb,const uint &width,const uint &height,
+                                    const uint &dst_width,const uint &dst_height,RgbOutputFormat format,
+                                    uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+    static bool frame_to_rgb_transformed(uint pixel_format,uchar *frame,uchar *rgb,const uint &width,const uint &height,
+                                         const FrameTransform &transform,RgbOutputFormat format,
+                                         uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+
+    /*亮度(灰度)输出接口，用于只需要灰度图的分析处理(运动检测、条码识别等)，不做任何rgb转换
+     *lumaPlane():Y平面连续存储在帧起始处的格式(NV12/NV21/NV16/NV61/YUV420/YVU420/GREY)直接返回帧地址，可零拷贝使用，
+     *其他格式返回NULL
+     *frame_to_luma():将Y分量提取到连续存储的灰度缓冲区，宽高各缩小downsample倍(盒式滤波)，luma内存空间大小为
+     *(width/downsample)*(height/downsample)，packed格式(YUYV/UYVY/YVYU)的分离以及2倍、4倍缩小使用SIMD实现，rgb格式返回false*/
+    static const uchar *lumaPlane(uint pixel_format,const uchar *frame);
+    static bool frame_to_luma(uint pixel_format,const uchar *frame,uchar *luma,const uint &width,const uint &height,
+                              uint downsample=1);
+    /*原始帧Y分量的统计接口(直方图、均值、过曝/欠曝，参见FrameStatistics)，不做rgb转换，结果累加到stats的Luma通道，
+     *step为抽样步长(每隔step行、step列统计一个像素)，rgb格式返回false*/
+    static bool frame_statistics(uint pixel_format,const uchar *frame,const uint &width,const uint &height,
+                                 FrameStatistics &stats,uint step=1);
+
+    /*转换对象接口，参数同上述通用接口，使用本对象的颜色调整参数，可在多个线程中并行调用
+     *stats不为空时在转换的同时累加输出帧的统计(每转换完一行趁数据仍在缓存中累加，不需要对rgb帧再遍历一遍)，
+     *统计不会先清空，分块并行转换(如按cropY/cropHeight分块调用convertTransformed())时每个线程使用各自的统计对象，
+     *完成后通过FrameStatistics::merge()合并*/
+    bool convert(uint pixel_format,uchar *frame,uchar *rgb,const uint &width,const uint &height,
+                 RgbOutputFormat format,uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false,
+                 FrameStatistics *stats=NULL);
+    bool convertScaled(uint pixel_format,uchar *frame,uchar *rgb,const uint &width,const uint &height,
+                       const uint &dst_width,const uint &dst_height,RgbOutputFormat format,
+                       uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false,FrameStatistics *stats=NULL);
+    bool convertTransformed(uint pixel_format,uchar *frame,uchar *rgb,const uint &width,const uint &height,
+                            const FrameTransform &transform,RgbOutputFormat format,
+                            uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false,FrameStatistics *stats=NULL);
+    //设置/获取本对象的颜色调整参数，新参数从下一帧开始生效
+    void setColorAdjustment(const double &brightness,const double &contrast,const double &saturation);
+    ColorAdjustmentParam colorAdjustment();
+    //设置/获取本对象的3D LUT(颜色分级，在基础颜色调整之后应用)，传入空指针表示不使用，新LUT从下一帧开始生效
+    void setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D);
+    QSharedPointer<const ColorLut3D> colorLut3D();
+    //静态接口使用的全局转换对象
+    static ColorToRgb24 *globalInstance();
+    /*SIMD实现的运行时开关(作用于所有转换对象，默认开启)，用于性能对比(参见benchmark)和排查舍入误差问题
+     *isSimdAvailable():编译时是否启用了SIMD实现(ENABLE_SIMD_CONVERT且编译器支持SSE2/NEON)*/
+    static bool isSimdAvailable();
+    static void setSimdEnabled(bool enabled);
+    static bool isSimdEnabled();
+
+    /*按帧格式命名的转换接口(保留原有接口，内部调用上述通用接口)*/
+    static void yuyv_to_rgb24_shift(uchar *yuyv,uchar *rgb24,
+                                    const uint &width,const uint &height,
+                                    uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+    static void nv12_21_to_rgb24_shift(bool is_nv12,uchar *nv12_21,uchar *rgb24,
+                                    const uint &width,const uint &height,
+                                    uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+    static void rgb4_to_rgb24(uchar *rgb32,uchar *rgb24,const uint &width,const uint &height);
+
+    /*指定rgb输出格式的转换接口，rgb内存空间大小为width*height*bytesPerPixel(format)，32位格式要求4字节对齐*/
+    static void yuyv_to_rgb(uchar *yuyv,uchar *rgb,const uint &width,const uint &height,RgbOutputFormat format,
+                            uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+    static void nv12_21_to_rgb(bool is_nv12,uchar *nv12_21,uchar *rgb,const uint &width,const uint &height,
+                               RgbOutputFormat format,uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+    static void rgb4_to_rgb(uchar *rgb32,uchar *rgb,const uint &width,const uint &height,RgbOutputFormat format);
+
+    /*缩放输出的转换接口(用于小窗口预览)，在yuv空间滤波后只转换缩放后的像素，rgb内存空间大小为dst_width*dst_height*bytesPerPixel(format)
+     *源尺寸恰好是目标尺寸的2倍或4倍时使用盒式滤波(box)，其他比例使用双线性插值，尺寸相同时等同于不缩放的接口*/
+    static void yuyv_to_rgb_scaled(uchar *yuyv,uchar *rgb,const uint &width,const uint &height,
+                                   const uint &dst_width,const uint &dst_height,RgbOutputFormat format,
+                                   uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+    static void nv12_21_to_rgb_scaled(bool is_nv12,uchar *nv12_21,uchar *rgb,const uint &width,const uint &height,
+                                      const uint &dst_width,const uint &dst_height,RgbOutputFormat format,
+                                      uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+    static void rgb4_to_rgb_scaled(uchar *rgb32,uchar *rgb,const uint &width,const uint &height,
+                                   const uint &dst_width,const uint &dst_height,RgbOutputFormat format);
+
+    /*裁剪、镜像、旋转输出的转换接口，一次转换完成，不需要再通过QImage::mirrored()/transformed()额外拷贝
+     *rgb内存空间大小由transformedSize()计算(旋转90/270度时宽高互换)，输出按块写入，避免旋转时逐列写入造成缓存颠簸*/
+    static void transformedSize(const FrameTransform &transform,const uint &width,const uint &height,
+                                uint &dst_width,uint &dst_height);
+    static void yuyv_to_rgb_transformed(uchar *yuyv,uchar *rgb,const uint &width,const uint &height,
+                                        const FrameTransform &transform,RgbOutputFormat format,
+                                        uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+    static void nv12_21_to_rgb_transformed(bool is_nv12,uchar *nv12_21,uchar *rgb,const uint &width,const uint &height,
+                                           const FrameTransform &transform,RgbOutputFormat format,
+                                           uint ycbcr_enc=V4L2_YCBCR_ENC_601,bool is_tv_range=false);
+    static void rgb4_to_rgb_transformed(uchar *rgb32,uchar *rgb,const uint &width,const uint &height,
+                                        const FrameTransform &transform,RgbOutputFormat format);
+
+    /*颜色调整参数设置(作用于全局转换对象)*/
+    static void setColorAdjustParam(const double &brightness,const double &contrast,const double &saturation);
+
+
+private:
+    /*颜色调整查表快照，创建后只读不再修改，按cpu缓存行(64字节)对齐，三张表总共约1.5Kb，可常驻一级缓存*/
+    struct alignas(64) ColorAdjustLut
+    {
+        ColorAdjustmentParam param;
+        bool enabled;//任意一项参数不为1.0
+        bool adjustContrast;
+        bool adjustSaturation;
+        bool adjustBrightness;
+        //亮度调节查表法，只有加法和范围校验，运算并不复杂，这里纯粹是以空间换时间，追求极限性能
+        uchar brightnessLUT[256];
+        //对比度调节查表法,减少浮点计算的性能损失(实测对于一些浮点运算能力低的硬件会导致图像闪烁)
+        uchar contrastLUT[256];
+        /*饱和度调节查表法，同样是为了减少浮点计算的性能损失
+         *数组元素对应上述(R(GB)-L)的变量区间，这里不使用两个变量的二维数组是因为[256][256]有64Kb，可能会超出cpu
+         *一级缓存大小，造成缓存命中率降低。*/
+        short saturationLUT[511];
+        //3D LUT颜色分级(可以为空)，快照持有一份引用，保证转换期间不会被释放
+        QSharedPointer<const ColorLut3D> lut3D;
+        //快照的引用计数(发布中的快照自身占一个，每个读者各占一个)，减为0时释放
+        mutable std::atomic<int> refCount;
+
+        static ColorAdjustLut *create(const ColorAdjustmentParam &param,const QSharedPointer<const ColorLut3D> &lut3D);
+        static void destroy(const ColorAdjustLut *lut);
+        void unref(int count = 1) const;
+    };
+    //转换期间持有当前快照的一个引用(RAII)，析构时释放
+    class LutReader;
+
+    /*按照转换系数和输出格式特化的转换实现(静态run()函数)，定义在cpp中
+     *Coef:YuvShiftCoef的特化类型(rgb源格式不使用)  Writer:输出像素格式的写入方式(对应RgbOutputFormat)*/
+    template<class Coef,class Writer> struct YuvKernel;
+    template<class Coef,class Writer> struct RgbKernel;
+    template<class Coef,class Writer> struct ScaleKernel;
+    template<class Coef,class Writer> struct RgbScaleKernel;
+    template<class Coef,class Writer> struct TransformKernel;
+    template<class Coef,class Writer> struct RgbTransformKernel;
+    //根据运行时参数选择对应特化的转换实现
+    template<template<class,class> class Kernel,typename... Args>
+    static void dispatch(uint ycbcr_enc,bool is_tv_range,RgbOutputFormat format,Args... args);
+    template<template<class,class> class Kernel,class Coef,typename... Args>
+    static void dispatchWriter(RgbOutputFormat format,Args... args);
+    //根据帧格式构造源数据的访问方式(source traits)，再选择对应特化的转换实现
+    template<class Source>
+    static void lumaKernel(const Source &src,uchar *luma,uint width,uint height,uint downsample);
+    template<class Source>
+    static void lumaStatisticsKernel(const Source &src,FrameStatistics &stats,uint width,uint height,uint step);
+    template<template<class,class> class YuvKernel,template<class,class> class RgbKernel,typename... Args>
+    static bool dispatchSource(uint pixel_format,uchar *frame,uint width,uint height,
+                               uint ycbcr_enc,bool is_tv_range,RgbOutputFormat format,Args... args);
+
+    static inline bool isColorAdjustEnabled(const ColorAdjustLut *lut);
+    template<class Writer>
+    static inline void writePixel(const ColorAdjustLut *lut,uchar *dst,int r,int g,int b);
+    template<class Coef,class Writer>
+    static inline void yuvToRgbPixel(const ColorAdjustLut *lut,uchar *dst,int y,int u,int v);
+    static inline void rgbColorAdjust(const ColorAdjustLut *lut,int &r,int &g,int &b);
+    template<class Writer>
+    static inline void finishRows(const ColorAdjustLut *lut,FrameStatistics *stats,uchar *dst,uint count);
+    void publishAdjustLut(const ColorAdjustmentParam &param,const QSharedPointer<const ColorLut3D> &lut3D);
+
+    Q_DISABLE_COPY(ColorToRgb24)
+    /*当前发布的查表快照(不为空)的地址|正在获取引用的读者数。快照按64字节对齐，低6位用来记录已经读到该地址、尚未
+     *增加快照引用计数的读者，写者替换快照时把这部分计数转交给旧快照的引用计数，读者和写者都只使用原子操作*/
+    std::atomic<quintptr> adjustLutState;
+    static const quintptr LUT_ACQUIRE_MASK = 63;
+    static std::atomic<bool> simdEnabled;//SIMD实现的运行时开关
+    QMutex adjustMutex;//只用于串行化参数设置(写者)，转换过程(读者)不加锁
 
 };
 
@@ -0,0 +1,544 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   隔行视频的反交错处理(软件实现)
+ */
+#include "deinterlacer.h"
+#include "colortorgb24.h"//ENABLE_SIMD_CONVERT
+#include <string.h>
+
+/*根据编译器支持的指令集确定SIMD实现方式(与ColorToRgb24一致)*/
+#ifdef ENABLE_SIMD_CONVERT
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DEINTERLACE_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define DEINTERLACE_SSE2
+#endif
+#endif
+
+/*
+ *@brief:  两行逐字节求平均(四舍五入)，用于Bob插值
+ *@date:   2026.10.18
+ *@param:  a,b:上下两行  dst:输出行  n:字节数
+ */
+static void averageLines(const uchar *a, const uchar *b, uchar *dst, uint n)
+{
+    uint x = 0;
+#if defined(DEINTERLACE_SSE2)
+    for(;ColorToRgb24::isSimdEnabled() && x+16<=n;x+=16)
+    {
+        _mm_storeu_si128((__m128i *)(dst+x),_mm_avg_epu8(_mm_loadu_si128((const __m128i *)(a+x)),
+                                                         _mm_loadu_si128((const __m128i *)(b+x))));
+    }
+#elif defined(DEINTERLACE_NEON)
+    for(;ColorToRgb24::isSimdEnabled() && x+16<=n;x+=16)
+    {
+        vst1q_u8(dst+x,vrhaddq_u8(vld1q_u8(a+x),vld1q_u8(b+x)));
+    }
+#endif
+    for(;x<n;x++)
+    {
+        dst[x] = (a[x] + b[x] + 1)>>1;
+    }
+}
+/*
+ *@brief:  三行逐字节按1:2:1混合(两次四舍五入平均)，用于线性混合
+ *@date:   2026.10.18
+ *@param:  above,cur,below:上、当前、下三行  dst:输出行  n:字节数
+ */
+static void blendLines(const uchar *above, const uchar *cur, const uchar *below, uchar *dst, uint n)
+{
+    uint x = 0;
+#if defined(DEINTERLACE_SSE2)
+    for(;ColorToRgb24::isSimdEnabled() && x+16<=n;x+=16)
+    {
+        __m128i ac = _mm_avg_epu8(_mm_loadu_si128((const __m128i *)(above+x)),
+                                  _mm_loadu_si128((const __m128i *)(below+x)));
+        _mm_storeu_si128((__m128i *)(dst+x),_mm_avg_epu8(ac,_mm_loadu_si128((const __m128i *)(cur+x))));
+    }
+#elif defined(DEINTERLACE_NEON)
+    for(;ColorToRgb24::isSimdEnabled() && x+16<=n;x+=16)
+    {
+        uint8x16_t ac = vrhaddq_u8(vld1q_u8(above+x),vld1q_u8(below+x));
+        vst1q_u8(dst+x,vrhaddq_u8(ac,vld1q_u8(cur+x)));
+    }
+#endif
+    for(;x<n;x++)
+    {
+        const uint ac = (above[x] + below[x] + 1)>>1;
+        dst[x] = (ac + cur[x] + 1)>>1;
+    }
+}
+/*
+ *@brief:  运动自适应生成缺失的一行
+ *注:运动量取上下两行(保留的场)以及缺失行(另一场)与上一次采样的绝对差的最大值，超过阈值时使用上下两行的平均，
+ *否则保留另一场的数据(交织)。SSE2使用饱和减法求绝对差，再用掩码选择，NEON使用vabd/vbsl。
+ *@date:   2026.10.18
+ *@param:  woven,wovenPrev:缺失行位置另一场的当前/上一次数据
+ *@param:  above,abovePrev,below,belowPrev:保留的场中上下两行的当前/上一次数据
+ *@param:  dst:输出行  n:字节数  threshold:运动阈值
+ */
+static void adaptiveLine(const uchar *woven, const uchar *wovenPrev, const uchar *above, const uchar *abovePrev,
+                         const uchar *below, const uchar *belowPrev, uchar *dst, uint n, uint threshold)
+{
+    uint x = 0;
+#if defined(DEINTERLACE_SSE2)
+    const __m128i thr = _mm_set1_epi8(char(threshold));
+    for(;ColorToRgb24::isSimdEnabled() && x+16<=n;x+=16)
+    {
+        const __m128i w = _mm_loadu_si128((const __m128i *)(woven+x));
+        const __m128i wp = _mm_loadu_si128((const __m128i *)(wovenPrev+x));
+        const __m128i a = _mm_loadu_si128((const __m128i *)(above+x));
+        const __m128i ap = _mm_loadu_si128((const __m128i *)(abovePrev+x));
+        const __m128i b = _mm_loadu_si128((const __m128i *)(below+x));
+        const __m128i bp = _mm_loadu_si128((const __m128i *)(belowPrev+x));
+        __m128i diff = _mm_or_si128(_mm_subs_epu8(w,wp),_mm_subs_epu8(wp,w));
+        diff = _mm_max_epu8(diff,_mm_or_si128(_mm_subs_epu8(a,ap),_mm_subs_epu8(ap,a)));
+        diff = _mm_max_epu8(diff,_mm_or_si128(_mm_subs_epu8(b,bp),_mm_subs_epu8(bp,b)));
+        //diff<=threshold时饱和减法结果为0，即静止
+        const __m128i still = _mm_cmpeq_epi8(_mm_subs_epu8(diff,thr),_mm_setzero_si128());
+        const __m128i interp = _mm_avg_epu8(a,b);
+        _mm_storeu_si128((__m128i *)(dst+x),_mm_or_si128(_mm_and_si128(still,w),_mm_andnot_si128(still,interp)));
+    }
+#elif defined(DEINTERLACE_NEON)
+    const uint8x16_t thr = vdupq_n_u8(uchar(threshold));
+    for(;ColorToRgb24::isSimdEnabled() && x+16<=n;x+=16)
+    {
+        const uint8x16_t w = vld1q_u8(woven+x);
+        const uint8x16_t a = vld1q_u8(above+x);
+        const uint8x16_t b = vld1q_u8(below+x);
+        uint8x16_t diff = vabdq_u8(w,vld1q_u8(wovenPrev+x));
+        diff = vmaxq_u8(diff,vabdq_u8(a,vld1q_u8(abovePrev+x)));
+        diff = vmaxq_u8(diff,vabdq_u8(b,vld1q_u8(belowPrev+x)));
+        vst1q_u8(dst+x,vbslq_u8(vcgtq_u8(diff,thr),vrhaddq_u8(a,b),w));
+    }
+#endif
+    for(;x<n;x++)
+    {
+        uint diff = qAbs(int(woven[x]) - int(wovenPrev[x]));
+        diff = qMax<uint>(diff,qAbs(int(above[x]) - int(abovePrev[x])));
+        diff = qMax<uint>(diff,qAbs(int(below[x]) - int(belowPrev[x])));
+        dst[x] = (diff > threshold)?uchar((above[x] + below[x] + 1)>>1):woven[x];
+    }
+}
+
+Deinterlacer::Deinterlacer()
+{
+}
+/*
+ *@brief:  是否支持该帧格式(各平面的分量按字节存储)
+ *@date:   2026.10.18
+ *@param:  pixel_format:帧格式(V4L2_PIX_FMT_*)
+ *@return: bool:true=支持
+ */
+bool Deinterlacer::isSupportedFormat(uint pixel_format)
+{
+    Plane planes[3];
+    return planeLayout(pixel_format,16,16,planes) != 0;
+}
+/*
+ *@brief:  是否为需要处理的隔行场格式
+ *@date:   2026.10.18
+ *@param:  field:场格式(V4L2_FIELD_*)
+ *@return: bool:true=两场交织、先后存储或交替传输
+ */
+bool Deinterlacer::isInterlaced(uint field)
+{
+    switch(field)
+    {
+    case V4L2_FIELD_INTERLACED:
+    case V4L2_FIELD_INTERLACED_TB:
+    case V4L2_FIELD_INTERLACED_BT:
+    case V4L2_FIELD_SEQ_TB:
+    case V4L2_FIELD_SEQ_BT:
+    case V4L2_FIELD_ALTERNATE:
+        return true;
+    default:
+        return false;
+    }
+}
+/*
+ *@brief:  确定场序
+ *注:INTERLACED(及ALTERNATE)的场序由视频标准决定，525行(NTSC，有效480/486行)底场优先，其余标准(PAL等)顶场优先。
+ *@date:   2026.10.18
+ *@param:  field:场格式(V4L2_FIELD_*)  height:帧高
+ *@return: bool:true=顶场优先
+ */
+bool Deinterlacer::isTopFieldFirst(uint field, uint height) const
+{
+    if(fieldOrder != AutoFieldOrder)
+    {
+        return fieldOrder == TopFieldFirst;
+    }
+    switch(field)
+    {
+    case V4L2_FIELD_INTERLACED_TB:
+    case V4L2_FIELD_SEQ_TB:
+        return true;
+    case V4L2_FIELD_INTERLACED_BT:
+    case V4L2_FIELD_SEQ_BT:
+        return false;
+    default:
+        return height != 480 && height != 486;
+    }
+}
+/*
+ *@brief:  清除历史帧，下一帧(场)重新开始累积
+ *@date:   2026.10.18
+ */
+void Deinterlacer::reset()
+{
+    historyFormat = 0;
+    historyWidth = 0;
+    historyHeight = 0;
+    fieldsWoven = 0;
+    previousValid = false;
+}
+/*
+ *@brief:  处理一个隔行帧(两场在同一个缓冲帧中)
+ *注:SEQ格式先交织到内部缓冲区，关闭反交错时直接返回交织帧(INTERLACED为输入帧本身)。运动自适应需要上一帧，
+ *第一帧或格式尺寸变化时使用Bob。
+ *@date:   2026.10.18
+ *@param:  pixel_format:帧格式(V4L2_PIX_FMT_*)  frame:帧数据地址
+ *@param:  width,height:帧宽高  field:场格式(V4L2_FIELD_INTERLACED*、V4L2_FIELD_SEQ_*)
+ *@return: uchar*:逐行帧(内部缓冲区，在下一次处理之前有效)，NULL表示不支持的格式或场格式
+ */
+uchar *Deinterlacer::process(uint pixel_format, uchar *frame, uint width, uint height, uint field)
+{
+    secondFieldFrame = NULL;
+    lastInterlacedFrame = NULL;
+    Plane planes[3];
+    const int planeCount = planeLayout(pixel_format,width,height,planes);
+    if(planeCount == 0 || !isInterlaced(field) || field == V4L2_FIELD_ALTERNATE)
+    {
+        return NULL;
+    }
+    if(pixel_format != historyFormat || width != historyWidth || height != historyHeight)
+    {
+        reset();
+        historyFormat = pixel_format;
+        historyWidth = width;
+        historyHeight = height;
+    }
+    const uint frameSize = planes[planeCount-1].offset + planes[planeCount-1].bytesPerLine*planes[planeCount-1].lines;
+    uchar *src = frame;
+    //SEQ格式:每个平面先存(SEQ_TB)顶场再存底场，交织到内部缓冲区
+    if(field == V4L2_FIELD_SEQ_TB || field == V4L2_FIELD_SEQ_BT)
+    {
+        woven.resize(frameSize);
+        for(int i=0;i<planeCount;i++)
+        {
+            const Plane &plane = planes[i];
+            const uint firstLines = (field == V4L2_FIELD_SEQ_TB)?(plane.lines + 1)/2:plane.lines/2;
+            const uint firstParity = (field == V4L2_FIELD_SEQ_TB)?0:1;
+            for(uint y=0;y<plane.lines;y++)
+            {
+                const uint line = ((y&1) == firstParity)?(y>>1):(firstLines + (y>>1));
+                memcpy(woven.data() + plane.offset + y*plane.bytesPerLine,
+                       frame + plane.offset + line*plane.bytesPerLine,plane.bytesPerLine);
+            }
+        }
+        src = woven.data();
+    }
+    lastInterlacedFrame = src;
+
+    const uint firstParity = isTopFieldFirst(field,height)?0:1;
+    const bool fieldRate = fieldRateOutput && (deinterlaceMode == Bob || deinterlaceMode == MotionAdaptive);
+    uchar *result = src;
+    if(deinterlaceMode == Bob || deinterlaceMode == MotionAdaptive)
+    {
+        const uchar *prev = (deinterlaceMode == MotionAdaptive && previousValid)?previous.data():NULL;
+        result = deinterlaceFrame(src,prev,planeCount,planes,firstParity,output[0]);
+        if(fieldRate)
+        {
+            secondFieldFrame = deinterlaceFrame(src,prev,planeCount,planes,firstParity^1,output[1]);
+        }
+        if(deinterlaceMode == MotionAdaptive)
+        {
+            previous.assign(src,src + frameSize);
+            previousValid = true;
+        }
+    }
+    else if(deinterlaceMode == LinearBlend)
+    {
+        output[0].resize(frameSize);
+        for(int i=0;i<planeCount;i++)
+        {
+            blendPlane(src + planes[i].offset,planes[i],output[0].data() + planes[i].offset);
+        }
+        result = output[0].data();
+    }
+    return result;
+}
+/*
+ *@brief:  处理一个场(ALTERNATE，每个缓冲帧只有一场)
+ *注:内部缓冲区保存最近两场的交织结果，Bob直接由当前场插值；运动自适应将当前场与前两场(同一场)比较，
+ *缺失的行静止处使用前一场；关闭反交错和线性混合使用交织结果。开启场频输出(Bob和MotionAdaptive)时每一场都输出，
+ *否则只在每对场的第二场(按场序)输出。
+ *@date:   2026.10.18
+ *@param:  pixel_format:帧格式(V4L2_PIX_FMT_*)  fieldData:场数据地址(各平面的行数为帧的一半)
+ *@param:  width,height:帧宽高(场高的两倍)  isBottom:true=底场(v4l2_buffer.field为V4L2_FIELD_BOTTOM)
+ *@return: uchar*:逐行帧(内部缓冲区，在下一次处理之前有效)，NULL表示这一场不输出或不支持的格式
+ */
+uchar *Deinterlacer::processField(uint pixel_format, const uchar *fieldData, uint width, uint height, bool isBottom)
+{
+    secondFieldFrame = NULL;
+    lastInterlacedFrame = NULL;
+    Plane planes[3],fieldPlanes[3];
+    const int planeCount = planeLayout(pixel_format,width,height,planes);
+    if(planeCount == 0 || planeLayout(pixel_format,width,height/2,fieldPlanes) != planeCount)
+    {
+        return NULL;
+    }
+    const uint frameSize = planes[planeCount-1].offset + planes[planeCount-1].bytesPerLine*planes[planeCount-1].lines;
+    if(pixel_format != historyFormat || width != historyWidth || height != historyHeight || woven.size() != frameSize)
+    {
+        reset();
+        historyFormat = pixel_format;
+        historyWidth = width;
+        historyHeight = height;
+        woven.assign(frameSize,0);
+    }
+    const uint parity = isBottom?1:0;
+    const uint firstParity = isTopFieldFirst(V4L2_FIELD_ALTERNATE,height)?0:1;
+    const bool interpolate = (deinterlaceMode == Bob || deinterlaceMode == MotionAdaptive);
+    const bool needOutput = (interpolate && fieldRateOutput) || parity != firstParity;
+
+    uchar *result = NULL;
+    //Bob及历史场不足时由当前场插值，运动自适应需要在交织前比较(交织后同一场的历史数据会被覆盖)
+    if(needOutput && interpolate && (deinterlaceMode == Bob || fieldsWoven < 2))
+    {
+        result = bobField(fieldData,planeCount,planes,fieldPlanes,parity);
+    }
+    else if(needOutput && interpolate)
+    {
+        output[0].resize(frameSize);
+        for(int i=0;i<planeCount;i++)
+        {
+            const uchar *history = woven.data() + planes[i].offset;
+            adaptivePlane(fieldData + fieldPlanes[i].offset,1,history,NULL,history,
+                          planes[i],parity,output[0].data() + planes[i].offset);
+        }
+        result = output[0].data();
+    }
+    //将当前场交织到对应的行
+    for(int i=0;i<planeCount;i++)
+    {
+        const Plane &plane = planes[i];
+        for(uint k=0;k<fieldPlanes[i].lines;k++)
+        {
+            memcpy(woven.data() + plane.offset + (2*k + parity)*plane.bytesPerLine,
+                   fieldData + fieldPlanes[i].offset + k*plane.bytesPerLine,plane.bytesPerLine);
+        }
+    }
+    fieldsWoven = qMin(fieldsWoven + 1,2u);
+    lastInterlacedFrame = woven.data();
+    //关闭反交错和线性混合使用交织结果，只有一场有效(第一次输出)时插值
+    if(needOutput && !interpolate)
+    {
+        result = woven.data();
+        if(fieldsWoven < 2)
+        {
+            result = bobField(fieldData,planeCount,planes,fieldPlanes,parity);
+        }
+        else if(deinterlaceMode == LinearBlend)
+        {
+            output[0].resize(frameSize);
+            for(int i=0;i<planeCount;i++)
+            {
+                blendPlane(woven.data() + planes[i].offset,planes[i],output[0].data() + planes[i].offset);
+            }
+            result = output[0].data();
+        }
+    }
+    return result;
+}
+/*
+ *@brief:  计算帧格式各平面的布局(单平面连续存储)
+ *@date:   2026.10.18
+ *@param:  pixel_format:帧格式(V4L2_PIX_FMT_*)
+ *@param:  width,height:帧宽高
+ *@param:  planes:输出各平面的起始偏移、每行字节数、行数
+ *@return: int:平面数，0表示不支持该格式
+ */
+int Deinterlacer::planeLayout(uint pixel_format, uint width, uint height, Deinterlacer::Plane planes[])
+{
+    const uint lumaSize = width*height;
+    switch(pixel_format)
+    {
+    case V4L2_PIX_FMT_YUYV:
+    case V4L2_PIX_FMT_YVYU:
+    case V4L2_PIX_FMT_UYVY:
+        planes[0].offset = 0;
+        planes[0].bytesPerLine = width*2;
+        planes[0].lines = height;
+        return 1;
+    case V4L2_PIX_FMT_RGB32:
+        planes[0].offset = 0;
+        planes[0].bytesPerLine = width*4;
+        planes[0].lines = height;
+        return 1;
+    case V4L2_PIX_FMT_GREY:
+        planes[0].offset = 0;
+        planes[0].bytesPerLine = width;
+        planes[0].lines = height;
+        return 1;
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV21:
+    case V4L2_PIX_FMT_NV16:
+    case V4L2_PIX_FMT_NV61:
+        planes[0].offset = 0;
+        planes[0].bytesPerLine = width;
+        planes[0].lines = height;
+        planes[1].offset = lumaSize;
+        planes[1].bytesPerLine = width;
+        planes[1].lines = (pixel_format == V4L2_PIX_FMT_NV16 || pixel_format == V4L2_PIX_FMT_NV61)?height:height/2;
+        return 2;
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_YVU420:
+        planes[0].offset = 0;
+        planes[0].bytesPerLine = width;
+        planes[0].lines = height;
+        planes[1].offset = lumaSize;
+        planes[1].bytesPerLine = width/2;
+        planes[1].lines = height/2;
+        planes[2].offset = lumaSize + lumaSize/4;
+        planes[2].bytesPerLine = width/2;
+        planes[2].lines = height/2;
+        return 3;
+    default:
+        return 0;
+    }
+}
+/*
+ *@brief:  Bob插值一个平面:保留场的行直接拷贝，另一场的行由上下两行平均得到(边界行拷贝相邻行)
+ *@date:   2026.10.18
+ *@param:  kept:保留场的数据，第y行(保留场)的地址为kept+(y>>keptShift)*bytesPerLine(交织帧为0，单独的场为1)
+ *@param:  plane:平面布局(帧)  parity:保留场(0=顶场 1=底场)  dst:输出平面
+ */
+void Deinterlacer::bobPlane(const uchar *kept, uint keptShift, const Plane &plane, uint parity, uchar *dst)
+{
+    const uint bpl = plane.bytesPerLine;
+    for(uint y=0;y<plane.lines;y++)
+    {
+        uchar *line = dst + y*bpl;
+        if((y&1) == parity)
+        {
+            memcpy(line,kept + (y>>keptShift)*bpl,bpl);
+            continue;
+        }
+        const uchar *above = (y > 0)?kept + ((y-1)>>keptShift)*bpl:NULL;
+        const uchar *below = (y+1 < plane.lines)?kept + ((y+1)>>keptShift)*bpl:NULL;
+        if(above == NULL || below == NULL)
+        {
+            above = below = (above?above:below);
+        }
+        if(above)
+        {
+            averageLines(above,below,line,bpl);
+        }
+    }
+}
+/*
+ *@brief:  线性混合一个平面
+ *@date:   2026.10.18
+ *@param:  src:交织帧的平面  plane:平面布局  dst:输出平面
+ */
+void Deinterlacer::blendPlane(const uchar *src, const Plane &plane, uchar *dst)
+{
+    const uint bpl = plane.bytesPerLine;
+    if(plane.lines < 2)
+    {
+        memcpy(dst,src,bpl*plane.lines);
+        return;
+    }
+    for(uint y=0;y<plane.lines;y++)
+    {
+        const uint above = (y > 0)?y-1:y+1;
+        const uint below = (y+1 < plane.lines)?y+1:y-1;
+        blendLines(src + above*bpl,src + y*bpl,src + below*bpl,dst + y*bpl,bpl);
+    }
+}
+/*
+ *@brief:  运动自适应处理一个平面
+ *@date:   2026.10.18
+ *@param:  kept,keptShift:保留场的数据(同bobPlane())
+ *@param:  woven,wovenPrev:另一场在交织帧中的当前/上一次数据(wovenPrev为NULL表示没有，只比较保留场)
+ *@param:  keptPrev:保留场上一次的数据(交织帧)
+ *@param:  plane:平面布局(帧)  parity:保留场(0=顶场 1=底场)  dst:输出平面
+ */
+void Deinterlacer::adaptivePlane(const uchar *kept, uint keptShift, const uchar *woven, const uchar *wovenPrev,
+                                 const uchar *keptPrev, const Plane &plane, uint parity, uchar *dst)
+{
+    const uint bpl = plane.bytesPerLine;
+    if(plane.lines < 2)
+    {
+        bobPlane(kept,keptShift,plane,parity,dst);
+        return;
+    }
+    for(uint y=0;y<plane.lines;y++)
+    {
+        uchar *line = dst + y*bpl;
+        if((y&1) == parity)
+        {
+            memcpy(line,kept + (y>>keptShift)*bpl,bpl);
+            continue;
+        }
+        const uint above = (y > 0)?y-1:y+1;
+        const uint below = (y+1 < plane.lines)?y+1:y-1;
+        const uchar *wovenLine = woven + y*bpl;
+        adaptiveLine(wovenLine,wovenPrev?wovenPrev + y*bpl:wovenLine,
+                     kept + (above>>keptShift)*bpl,keptPrev + above*bpl,
+                     kept + (below>>keptShift)*bpl,keptPrev + below*bpl,line,bpl,motionThreshold);
+    }
+}
+/*
+ *@brief:  由单独的一场(ALTERNATE)Bob插值生成逐行帧
+ *@date:   2026.10.18
+ *@param:  fieldData:场数据  planeCount,planes,fieldPlanes:帧和场的平面布局  parity:场(0=顶场 1=底场)
+ *@return: uchar*:输出帧地址
+ */
+uchar *Deinterlacer::bobField(const uchar *fieldData, int planeCount, const Plane planes[], const Plane fieldPlanes[],
+                              uint parity)
+{
+    output[0].resize(planes[planeCount-1].offset + planes[planeCount-1].bytesPerLine*planes[planeCount-1].lines);
+    for(int i=0;i<planeCount;i++)
+    {
+        bobPlane(fieldData + fieldPlanes[i].offset,1,planes[i],parity,output[0].data() + planes[i].offset);
+    }
+    return output[0].data();
+}
+/*
+ *@brief:  由交织帧生成保留指定场的逐行帧(有上一帧时运动自适应，否则Bob)
+ *@date:   2026.10.18
+ *@param:  src:交织帧  prev:上一帧(交织帧)，NULL表示Bob
+ *@param:  planeCount,planes:平面布局  parity:保留场(0=顶场 1=底场)
+ *@param:  out:输出缓冲区
+ *@return: uchar*:输出帧地址
+ */
+uchar *Deinterlacer::deinterlaceFrame(const uchar *src, const uchar *prev, int planeCount, const Plane planes[],
+                                      uint parity, std::vector<uchar> &out)
+{
+    out.resize(planes[planeCount-1].offset + planes[planeCount-1].bytesPerLine*planes[planeCount-1].lines);
+    for(int i=0;i<planeCount;i++)
+    {
+        const uint offset = planes[i].offset;
+        if(prev)
+        {
+            adaptivePlane(src + offset,0,src + offset,prev + offset,prev + offset,planes[i],parity,out.data() + offset);
+        }
+        else
+        {
+            bobPlane(src + offset,0,planes[i],parity,out.data() + offset);
+        }
+    }
+    return out.data();
+}
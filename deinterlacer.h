@@ -0,0 +1,115 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   隔行视频(PAL/NTSC模拟采集)的反交错处理(软件实现)，在原始帧(yuv)上进行，输出逐行帧后再交由软解码、运动检测等处理
+ *
+ *1.场格式:根据驱动协商的v4l2_field处理不同的场存储方式:
+ *  INTERLACED/INTERLACED_TB/INTERLACED_BT:两场逐行交织在一帧中，直接反交错；
+ *  SEQ_TB/SEQ_BT:两场先后存储在一帧中(每个平面先存一场再存另一场)，先交织(weave)到内部缓冲区再反交错；
+ *  ALTERNATE:每个缓冲帧只有一场(高度为帧高的一半，顶/底场由v4l2_buffer.field给出)，内部保存最近的一帧交织结果，
+ *  每来一场更新对应的行，即使关闭反交错也需要交织成完整帧，后续处理才能使用帧高。
+ *  NONE/TOP/BOTTOM(逐行或只采集一场)不需要处理。
+ *2.反交错模式:
+ *  Bob:只保留一场，缺失的行由上下两行(同一场)平均得到，没有梳状纹，垂直分辨率减半；
+ *  LinearBlend:每一行与上下两行按1:2:1混合，梳状纹变为轻微的重影，画面稳定、无闪烁；
+ *  MotionAdaptive:缺失的行逐字节判断与上一帧(ALTERNATE为前两场)相比是否运动，静止处保留另一场(完整垂直分辨率)，
+ *  运动处使用Bob插值。
+ *3.场频输出:Bob和MotionAdaptive模式下可以开启场频输出，每个隔行帧依次输出保留第一场、第二场的两帧(PAL 25帧->50帧)，
+ *运动更流畅；ALTERNATE每一场都输出一帧。关闭时每个隔行帧(ALTERNATE每两场)输出一帧。
+ *行内运算都是逐字节的(平均、混合、差值比较)，packed格式(YUYV等)的Y、U、V交织存储也不需要拆分，各平面按行处理即可，
+ *使用SIMD(SSE2 pavgb/NEON vrhadd)实现。支持YUYV/YVYU/UYVY/NV12/NV21/NV16/NV61/YUV420/YVU420/GREY/RGB32，
+ *RGB565的分量不是按字节存储的，不支持。硬件渲染的反交错在V4l2Rendering的片段着色器中实现，参数含义与这里一致。
+ */
+#ifndef DEINTERLACER_H
+#define DEINTERLACER_H
+
+#include "qglobal.h"
+#include <vector>
+
+class Deinterlacer
+{
+public:
+    //反交错模式
+    enum Mode
+    {
+        Off = 0,//不处理(SEQ/ALTERNATE仍然交织成完整帧)
+        Bob,//单场插值
+        LinearBlend,//线性混合(1:2:1)
+        MotionAdaptive//运动自适应(静止处交织，运动处插值)
+    };
+    //场序(哪一场在时间上先到达)
+    enum FieldOrder
+    {
+        AutoFieldOrder = 0,//根据场格式和帧高确定(INTERLACED:NTSC 480行底场优先，其余顶场优先)
+        TopFieldFirst,
+        BottomFieldFirst
+    };
+
+    Deinterlacer();
+
+    void setMode(Mode mode){deinterlaceMode = mode;}
+    Mode mode() const {return deinterlaceMode;}
+    //场频输出(仅Bob和MotionAdaptive模式有效)
+    void setFieldRate(bool on){fieldRateOutput = on;}
+    bool isFieldRate() const {return fieldRateOutput;}
+    void setFieldOrder(FieldOrder order){fieldOrder = order;}
+    //运动自适应的阈值(字节的绝对差，默认10，需要高于噪声)
+    void setMotionThreshold(uint threshold){motionThreshold = qMin(threshold,255u);}
+
+    static bool isSupportedFormat(uint pixel_format);
+    //是否为需要处理的隔行场格式(V4L2_FIELD_*)
+    static bool isInterlaced(uint field);
+    bool isTopFieldFirst(uint field,uint height) const;
+
+    //处理一个隔行帧(INTERLACED*/SEQ*)，返回逐行帧，NULL表示不支持的格式
+    uchar *process(uint pixel_format,uchar *frame,uint width,uint height,uint field);
+    //处理一个场(ALTERNATE)，height为帧高，返回逐行帧，NULL表示这一场只交织不输出(未开启场频输出时的第一场)或不支持的格式
+    uchar *processField(uint pixel_format,const uchar *fieldData,uint width,uint height,bool isBottom);
+    //场频输出时上一次process()保留第二场的逐行帧，没有时返回NULL
+    uchar *secondField() const {return secondFieldFrame;}
+    //上一次处理的交织帧(SEQ/ALTERNATE为内部缓冲区，INTERLACED为输入帧)，可交给着色器反交错
+    uchar *interlacedFrame() const {return lastInterlacedFrame;}
+    //清除历史帧(运动自适应和ALTERNATE的交织结果)
+    void reset();
+
+private:
+    struct Plane
+    {
+        uint offset = 0;//平面在帧中的起始偏移
+        uint bytesPerLine = 0;
+        uint lines = 0;
+    };
+    static int planeLayout(uint pixel_format,uint width,uint height,Plane planes[3]);
+
+    void bobPlane(const uchar *kept,uint keptShift,const Plane &plane,uint parity,uchar *dst);
+    void blendPlane(const uchar *src,const Plane &plane,uchar *dst);
+    void adaptivePlane(const uchar *kept,uint keptShift,const uchar *woven,const uchar *wovenPrev,
+                       const uchar *keptPrev,const Plane &plane,uint parity,uchar *dst);
+    uchar *bobField(const uchar *fieldData,int planeCount,const Plane planes[],const Plane fieldPlanes[],uint parity);
+    uchar *deinterlaceFrame(const uchar *src,const uchar *prev,int planeCount,const Plane planes[],
+                            uint parity,std::vector<uchar> &out);
+
+    Mode deinterlaceMode = Off;
+    bool fieldRateOutput = false;
+    FieldOrder fieldOrder = AutoFieldOrder;
+    uint motionThreshold = 10;
+
+    std::vector<uchar> woven;//SEQ/ALTERNATE交织后的帧
+    std::vector<uchar> previous;//运动自适应的上一帧(交织帧)
+    std::vector<uchar> output[2];//输出帧(第一场、第二场)
+    uint historyFormat = 0;//历史帧(woven/previous)对应的格式和尺寸，变化时丢弃
+    uint historyWidth = 0;
+    uint historyHeight = 0;
+    uint fieldsWoven = 0;//ALTERNATE已交织的场数(woven中两场都有效后才能运动自适应)
+    bool previousValid = false;
+    uchar *secondFieldFrame = NULL;
+    uchar *lastInterlacedFrame = NULL;
+};
+
+#endif // DEINTERLACER_H
@@ -0,0 +1,195 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   固定数量的对齐帧缓冲区池
+ */
+#include "framebufferpool.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+//缓冲区对齐字节数(缓存行)
+#define FRAME_BUFFER_ALIGNMENT 64
+
+FrameBufferPool::PoolData::~PoolData()
+{
+    for(uint i=0;i<count;i++)
+    {
+        free(slotArray[i].data);
+    }
+    delete [] slotArray;
+}
+
+FrameBufferPool::FrameBufferPool(uint bufferCount)
+    :count(bufferCount?bufferCount:1)
+{
+}
+/*
+ *@brief:  析构
+ *注:只释放池对缓冲区组的引用，仍被QImage持有的缓冲区在全部归还后释放。
+ *@date:   2026.10.18
+ */
+FrameBufferPool::~FrameBufferPool()
+{
+    poolData.reset();
+}
+/*
+ *@brief:  设置每个缓冲区的字节数
+ *注:尺寸变化时建立新的缓冲区组，旧组中已经取出的缓冲区归还时随旧组一起释放，不影响外部正在使用的帧。
+ *@date:   2026.10.18
+ *@param:  size:缓冲区字节数
+ *@return: bool:false=申请内存失败
+ */
+bool FrameBufferPool::setBufferSize(uint size)
+{
+    if(poolData && poolData->bufferSize == size)
+    {
+        return true;
+    }
+    poolData.reset();
+    nextIndex = 0;
+    if(size == 0)
+    {
+        return true;
+    }
+    std::shared_ptr<PoolData> data(new PoolData);
+    data->bufferSize = size;
+    data->slotArray = new Slot[count];
+    data->count = count;
+    for(uint i=0;i<count;i++)
+    {
+        void *buffer = NULL;
+        if(posix_memalign(&buffer,FRAME_BUFFER_ALIGNMENT,size) != 0)
+        {
+            printf("FrameBufferPool: allocate %u bytes failed.\n",size);
+            return false;
+        }
+        data->slotArray[i].data = (uchar *)buffer;
+    }
+    poolData = data;
+    return true;
+}
+/*
+ *@brief:  当前空闲的缓冲区数量
+ *@date:   2026.10.18
+ *@return: uint:空闲数量
+ */
+uint FrameBufferPool::freeCount() const
+{
+    uint freeBuffers = 0;
+    for(uint i=0;poolData && i<poolData->count;i++)
+    {
+        if(!poolData->slotArray[i].inUse.load(std::memory_order_acquire))
+        {
+            freeBuffers++;
+        }
+    }
+    return freeBuffers;
+}
+/*
+ *@brief:  取一个空闲缓冲区
+ *注:从上次取出的下一个位置开始轮询，保证同一缓冲区尽可能晚地被重用。只能在一个线程(采集线程)中调用。
+ *@date:   2026.10.18
+ *@return: uchar*:缓冲区地址，所有缓冲区都在使用中时返回NULL
+ */
+uchar *FrameBufferPool::acquire()
+{
+    if(!poolData)
+    {
+        return NULL;
+    }
+    for(uint i=0;i<poolData->count;i++)
+    {
+        const uint index = (nextIndex + i)%poolData->count;
+        Slot &slot = poolData->slotArray[index];
+        bool expected = false;
+        if(slot.inUse.compare_exchange_strong(expected,true,std::memory_order_acquire))
+        {
+            slot.keepAlive = poolData;
+            nextIndex = index + 1;
+            return slot.data;
+        }
+    }
+    return NULL;
+}
+/*
+ *@brief:  归还未封装成QImage的缓冲区
+ *@date:   2026.10.18
+ *@param:  buffer:acquire()取出的缓冲区
+ */
+void FrameBufferPool::release(uchar *buffer)
+{
+    Slot *slot = findSlot(buffer);
+    if(slot)
+    {
+        releaseSlot(slot);
+    }
+}
+/*
+ *@brief:  将acquire()取出的缓冲区封装成QImage
+ *注:QImage不拷贝数据，该帧的最后一个隐式共享引用释放时(可以在任意线程)通过清理函数归还缓冲区。
+ *@date:   2026.10.18
+ *@param:  buffer:acquire()取出的缓冲区
+ *@param:  width,height,bytesPerLine:图像宽高及每行字节数(height*bytesPerLine不能超过缓冲区尺寸)
+ *@param:  format:图像格式
+ *@return: QImage:封装的图像，参数无效时返回空图像并归还缓冲区
+ */
+QImage FrameBufferPool::wrapImage(uchar *buffer, int width, int height, int bytesPerLine, QImage::Format format)
+{
+    Slot *slot = findSlot(buffer);
+    if(!slot)
+    {
+        return QImage();
+    }
+    if(width <= 0 || height <= 0 || (quint64)bytesPerLine*height > poolData->bufferSize)
+    {
+        releaseSlot(slot);
+        return QImage();
+    }
+    return QImage(buffer,width,height,bytesPerLine,format,imageCleanup,slot);
+}
+/*
+ *@brief:  查找缓冲区对应的槽(只在当前缓冲区组中查找)
+ *@date:   2026.10.18
+ *@param:  buffer:缓冲区地址
+ *@return: Slot*:正在使用中的槽，没有找到时返回NULL
+ */
+FrameBufferPool::Slot *FrameBufferPool::findSlot(uchar *buffer) const
+{
+    for(uint i=0;buffer && poolData && i<poolData->count;i++)
+    {
+        Slot *slot = &poolData->slotArray[i];
+        if(slot->data == buffer && slot->inUse.load(std::memory_order_acquire))
+        {
+            return slot;
+        }
+    }
+    return NULL;
+}
+/*
+ *@brief:  归还一个槽
+ *注:先取走槽对缓冲区组的引用再清除使用标志，避免与采集线程的acquire()竞争；如果这是旧组的最后一个引用，
+ *函数返回时旧组连同该槽一起释放。
+ *@date:   2026.10.18
+ *@param:  slot:要归还的槽
+ */
+void FrameBufferPool::releaseSlot(Slot *slot)
+{
+    std::shared_ptr<PoolData> hold;
+    hold.swap(slot->keepAlive);
+    slot->inUse.store(false,std::memory_order_release);
+}
+/*
+ *@brief:  QImage的清理函数
+ *@date:   2026.10.18
+ *@param:  info:wrapImage()传入的槽
+ */
+void FrameBufferPool::imageCleanup(void *info)
+{
+    releaseSlot(static_cast<Slot *>(info));
+}
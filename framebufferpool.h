@@ -0,0 +1,73 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   固定数量的对齐帧缓冲区池，缓冲区以QImage的形式交给外部，最后一个引用释放时自动归还
+ *
+ *1.池中缓冲区数量固定，按64字节对齐申请(适合SIMD转换和纹理上传)，采集线程通过acquire()取空闲缓冲区写入一帧，再由
+ *wrapImage()封装成QImage(不拷贝)，QImage的清理函数(QImageCleanupFunction)在该帧的最后一个隐式共享引用释放时将缓冲区
+ *归还到池中。外部持有QImage期间该缓冲区不会被再次取出，所以正在绘制的帧不会被后续帧覆盖；外部处理不过来占满所有缓冲区时
+ *acquire()返回NULL，由采集方丢弃新帧。
+ *2.acquire()和归还(可能发生在任意线程)通过每个缓冲区的原子标志完成，不加锁；取空闲缓冲区时从上次取出的位置轮询，
+ *即使外部没有持有QImage(只使用裸指针)，同一缓冲区也要间隔bufferCount帧才会被重用。
+ *3.缓冲区尺寸变化时重新建立一组缓冲区，尚未归还的旧缓冲区由QImage持有的引用维持，归还时随旧组一起释放，池对象先于
+ *QImage析构也是安全的。
+ */
+#ifndef FRAMEBUFFERPOOL_H
+#define FRAMEBUFFERPOOL_H
+
+#include "qglobal.h"
+#include <QImage>
+#include <atomic>
+#include <memory>
+
+class FrameBufferPool
+{
+public:
+    explicit FrameBufferPool(uint bufferCount=4);
+    ~FrameBufferPool();
+
+    //设置每个缓冲区的字节数，与当前尺寸不同时重新建立缓冲区组
+    bool setBufferSize(uint size);
+    uint bufferSize() const {return poolData?poolData->bufferSize:0;}
+    uint bufferCount() const {return count;}
+    uint freeCount() const;//当前空闲的缓冲区数量
+
+    //取一个空闲缓冲区，没有空闲缓冲区时返回NULL
+    uchar *acquire();
+    //归还未封装成QImage的缓冲区
+    void release(uchar *buffer);
+    //将acquire()取出的缓冲区封装成QImage(不拷贝)，缓冲区的归还交由QImage负责
+    QImage wrapImage(uchar *buffer,int width,int height,int bytesPerLine,QImage::Format format);
+
+private:
+    struct PoolData;
+    struct Slot
+    {
+        uchar *data = NULL;
+        std::atomic<bool> inUse;
+        std::shared_ptr<PoolData> keepAlive;//取出期间持有所在的缓冲区组，保证归还前不被释放
+        Slot():inUse(false){}
+    };
+    struct PoolData
+    {
+        uint bufferSize = 0;
+        uint count = 0;
+        Slot *slotArray = NULL;
+        ~PoolData();
+    };
+    Slot *findSlot(uchar *buffer) const;
+    static void releaseSlot(Slot *slot);
+    static void imageCleanup(void *info);
+
+    uint count = 4;
+    uint nextIndex = 0;//轮询起点
+    std::shared_ptr<PoolData> poolData;
+};
+
+#endif // FRAMEBUFFERPOOL_H
@@ -0,0 +1,103 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   采集线程与渲染(GUI)线程之间只保留最新一帧的单槽邮箱
+ */
+#include "framemailbox.h"
+#include <string.h>
+
+FrameMailbox::FrameMailbox()
+    :middleState(2),postedFrames(0),staleFrames(0)
+{
+    memset(frameSlots,0,sizeof(frameSlots));
+}
+
+FrameMailbox::~FrameMailbox()
+{
+    setFrameBytes(0);
+}
+/*
+ *@brief:  设置一帧数据的字节数
+ *注:为三个槽各申请一块64字节对齐的缓冲区(之后不再分配)，设置为0时释放并退回只保存地址的方式。不是线程安全的，
+ *需要在写端、读端开始使用之前(例如渲染组件的构造函数中)设置。
+ *@date:   2026.10.18
+ *@param:  bytes:一帧数据的字节数(连续存储)
+ */
+void FrameMailbox::setFrameBytes(uint bytes)
+{
+    for(int i=0;i<3;i++)
+    {
+        qFreeAligned(frameSlots[i].buffer);
+        frameSlots[i].buffer = (bytes > 0)?(uchar *)qMallocAligned(bytes,64):nullptr;
+        memset(frameSlots[i].planes,0,sizeof(frameSlots[i].planes));
+    }
+    frameSize = bytes;
+}
+/*
+ *@brief:  放入一帧(写线程)
+ *注:先写入写端持有的槽，再与中间槽交换，交换出的槽如果还有新帧说明读端没来得及取走，该帧计为过时帧。
+ *设置了帧大小时拷贝frame[0]开始的一帧数据(调用返回后即可归还采集缓冲区)，否则只保存各平面的地址。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  frame:帧各平面的地址(指针数组)
+ *@param:  planeCount:平面数(不超过VIDEO_MAX_PLANES，拷贝模式下只使用连续存储的frame[0])
+ *@return: bool:true=邮箱之前为空，读端需要被通知(请求刷新)  false=覆盖了尚未取走的帧，读端已经被通知过
+ */
+bool FrameMailbox::post(uchar **frame, uint planeCount)
+{
+    planeCount = qMin(planeCount,uint(VIDEO_MAX_PLANES));
+    Slot &slot = frameSlots[writeIndex];
+    if(slot.buffer)
+    {
+        memcpy(slot.buffer,frame[0],frameSize);
+        slot.planes[0] = slot.buffer;
+    }
+    else
+    {
+        for(uint i=0;i<planeCount;i++)
+        {
+            slot.planes[i] = frame[i];
+        }
+    }
+    const uint previous = middleState.exchange(writeIndex|FRESH_FLAG,std::memory_order_acq_rel);
+    writeIndex = previous & INDEX_MASK;
+    postedFrames.fetch_add(1,std::memory_order_relaxed);
+    if(previous & FRESH_FLAG)
+    {
+        staleFrames.fetch_add(1,std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+/*
+ *@brief:  取走最新的一帧(读线程)
+ *注:只有读端会清除新帧标志，所以检查到有新帧后的交换一定取到新帧(期间写端再次放入时取到的是更新的一帧)。
+ *拷贝模式下取到的是读端槽的地址，下一次take()之前有效。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  frame:用于接收帧各平面地址的指针数组
+ *@param:  planeCount:平面数(不超过VIDEO_MAX_PLANES)
+ *@return: bool:true=取到新帧
+ */
+bool FrameMailbox::take(uchar **frame, uint planeCount)
+{
+    if(!hasFrame())
+    {
+        return false;
+    }
+    const uint previous = middleState.exchange(readIndex,std::memory_order_acq_rel);
+    readIndex = previous & INDEX_MASK;
+    planeCount = qMin(planeCount,uint(VIDEO_MAX_PLANES));
+    const Slot &slot = frameSlots[readIndex];
+    for(uint i=0;i<planeCount;i++)
+    {
+        frame[i] = slot.planes[i];
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   采集线程与渲染(GUI)线程之间只保留最新一帧的单槽邮箱
+ *
+ *1.原始帧通过排队信号传给渲染组件时，GUI线程繁忙会导致事件堆积，每一个过时的帧仍然会被上传纹理并再次请求刷新。邮箱只保留
+ *最新的一帧:采集端post()覆盖尚未取走的帧(计为过时帧)，渲染端在绘制时take()取走最新的一帧，每次显示最多上传一次。
+ *2.内部为三缓冲:写端、读端各持有一个槽，中间槽的索引和"有新帧"标志放在一个原子变量中，post()/take()各是一次原子交换，
+ *不加锁、不分配内存，适用于一个写线程和一个读线程。
+ *3.采集模块在发射原始帧之后立即把缓冲帧归还给驱动(VIDIOC_QBUF)，而渲染端要到下一次绘制才取走上传，期间驱动可能已经在
+ *重新填充该缓冲帧。所以通过setFrameBytes()设置帧大小后，post()把帧数据拷贝到写端持有的槽中(每个槽一块常驻的对齐缓冲区，
+ *不会每帧分配内存)，take()返回读端槽的地址，读端再次take()之前该数据不会被写端修改；未设置帧大小时只保存各平面的地址，
+ *地址的有效期由调用者保证。
+ */
+#ifndef FRAMEMAILBOX_H
+#define FRAMEMAILBOX_H
+
+#include "qglobal.h"
+#include <linux/videodev2.h>
+#include <atomic>
+
+class FrameMailbox
+{
+public:
+    FrameMailbox();
+    ~FrameMailbox();
+
+    //设置一帧数据的字节数(连续存储)，>0时post()拷贝帧数据，需要在开始post()/take()之前设置
+    void setFrameBytes(uint bytes);
+    uint frameBytes() const {return frameSize;}
+    //放入一帧(覆盖尚未取走的帧)，返回true表示邮箱之前为空(读端需要被通知)
+    bool post(uchar **frame,uint planeCount=1);
+    //取走最新的一帧，没有新帧时返回false
+    bool take(uchar **frame,uint planeCount=1);
+    bool hasFrame() const {return (middleState.load(std::memory_order_acquire) & FRESH_FLAG) != 0;}
+
+    quint64 postedCount() const {return postedFrames.load(std::memory_order_relaxed);}
+    quint64 staleCount() const {return staleFrames.load(std::memory_order_relaxed);}//被覆盖而没有上传的帧数
+
+private:
+    static const uint FRESH_FLAG = 0x4;//中间槽有尚未取走的新帧
+    static const uint INDEX_MASK = 0x3;
+
+    struct Slot
+    {
+        uchar *planes[VIDEO_MAX_PLANES];
+        uchar *buffer;//拷贝模式下槽自己的帧缓冲区
+    }frameSlots[3];
+    uint frameSize = 0;//一帧数据的字节数，0=只保存地址
+    uint writeIndex = 0;//写端持有的槽(只在写线程中访问)
+    uint readIndex = 1;//读端持有的槽(只在读线程中访问)
+    std::atomic<uint> middleState;//中间槽索引|FRESH_FLAG
+    std::atomic<quint64> postedFrames;
+    std::atomic<quint64> staleFrames;
+
+    Q_DISABLE_COPY(FrameMailbox)
+};
+
+#endif // FRAMEMAILBOX_H
@@ -0,0 +1,209 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   帧统计信息(直方图、均值、过曝/欠曝像素数)
+ */
+#include "framestatistics.h"
+#include <string.h>
+
+/*
+ *@brief:  构造函数
+ *@date:   2026.10.18
+ */
+FrameStatistics::FrameStatistics()
+{
+    reset();
+}
+/*
+ *@brief:  清空统计数据
+ *@date:   2026.10.18
+ */
+void FrameStatistics::reset()
+{
+    memset(histograms,0,sizeof(histograms));
+    clippedLow = 0;
+    clippedHigh = 0;
+}
+/*
+ *@brief:  合并另一份统计数据
+ *@date:   2026.10.18
+ *@param:  other:另一份统计数据(如其他线程转换另一部分区域得到的部分统计)
+ */
+void FrameStatistics::merge(const FrameStatistics &other)
+{
+    for(int c=0;c<ChannelCount;c++)
+    {
+        accumulateHistogram(Channel(c),other.histograms[c]);
+    }
+    clippedLow += other.clippedLow;
+    clippedHigh += other.clippedHigh;
+}
+/*
+ *@brief:  累加一段连续的rgb像素
+ *注:亮度按BT601权重计算L=(306*R+601*G+117*B)>>10(与ColorToRgb24的饱和度调整一致)。同一张直方图上相邻像素取值相同
+ *(平坦区域很常见)时，后一次累加要等前一次写回同一个计数器，所以较长的一段分成两路:偶数像素直接累加到本对象的直方图，
+ *奇数像素累加到局部的部分直方图，两路之间没有依赖，可以并行执行，最后再合并。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  pixels:像素数据地址
+ *@param:  count:像素个数
+ *@param:  bytesPerPixel:每个像素的字节数
+ *@param:  rOffset,gOffset,bOffset:r、g、b分量在像素内的字节偏移
+ */
+void FrameStatistics::accumulateRgb(const uchar *pixels, uint count, uint bytesPerPixel,
+                                    uint rOffset, uint gOffset, uint bOffset)
+{
+    quint32 *lumaHist = histograms[Luma];
+    quint32 *redHist = histograms[Red];
+    quint32 *greenHist = histograms[Green];
+    quint32 *blueHist = histograms[Blue];
+    uint low = 0,high = 0;
+    //部分直方图的清零与合并有固定开销，像素较少时只用一路
+    if(count >= 256)
+    {
+        quint32 partial[ChannelCount][256];
+        memset(partial,0,sizeof(partial));
+        for(;count>=2;count-=2,pixels+=2*bytesPerPixel)
+        {
+            const uint r0 = pixels[rOffset];
+            const uint g0 = pixels[gOffset];
+            const uint b0 = pixels[bOffset];
+            const uint r1 = pixels[bytesPerPixel + rOffset];
+            const uint g1 = pixels[bytesPerPixel + gOffset];
+            const uint b1 = pixels[bytesPerPixel + bOffset];
+            lumaHist[(306*r0 + 601*g0 + 117*b0)>>10]++;
+            partial[Luma][(306*r1 + 601*g1 + 117*b1)>>10]++;
+            redHist[r0]++;
+            partial[Red][r1]++;
+            greenHist[g0]++;
+            partial[Green][g1]++;
+            blueHist[b0]++;
+            partial[Blue][b1]++;
+            low += (r0 == 0) | (g0 == 0) | (b0 == 0);
+            low += (r1 == 0) | (g1 == 0) | (b1 == 0);
+            high += (r0 == 255) | (g0 == 255) | (b0 == 255);
+            high += (r1 == 255) | (g1 == 255) | (b1 == 255);
+        }
+        for(int c=0;c<ChannelCount;c++)
+        {
+            accumulateHistogram(Channel(c),partial[c]);
+        }
+    }
+    for(uint i=0;i<count;i++,pixels+=bytesPerPixel)
+    {
+        const uint r = pixels[rOffset];
+        const uint g = pixels[gOffset];
+        const uint b = pixels[bOffset];
+        lumaHist[(306*r + 601*g + 117*b)>>10]++;
+        redHist[r]++;
+        greenHist[g]++;
+        blueHist[b]++;
+        //使用按位或代替逻辑或，避免分支
+        low += (r == 0) | (g == 0) | (b == 0);
+        high += (r == 255) | (g == 255) | (b == 255);
+    }
+    clippedLow += low;
+    clippedHigh += high;
+}
+/*
+ *@brief:  累加一份256级的直方图到指定通道
+ *@date:   2026.10.18
+ *@param:  channel:通道
+ *@param:  histogram:直方图(256个元素)
+ */
+void FrameStatistics::accumulateHistogram(Channel channel, const quint32 *histogram)
+{
+    quint32 *dst = histograms[channel];
+    for(int i=0;i<256;i++)
+    {
+        dst[i] += histogram[i];
+    }
+}
+/*
+ *@brief:  统计的像素数
+ *@date:   2026.10.18
+ *@param:  channel:通道
+ *@return: quint64:像素数
+ */
+quint64 FrameStatistics::pixels(Channel channel) const
+{
+    quint64 sum = 0;
+    for(int i=0;i<256;i++)
+    {
+        sum += histograms[channel][i];
+    }
+    return sum;
+}
+/*
+ *@brief:  均值
+ *@date:   2026.10.18
+ *@param:  channel:通道
+ *@return: double:均值[0,255]，没有统计数据时返回0
+ */
+double FrameStatistics::mean(Channel channel) const
+{
+    quint64 count = 0,sum = 0;
+    for(int i=0;i<256;i++)
+    {
+        count += histograms[channel][i];
+        sum += quint64(histograms[channel][i])*i;
+    }
+    return count?double(sum)/count:0.0;
+}
+/*
+ *@brief:  百分位
+ *@date:   2026.10.18
+ *@param:  channel:通道
+ *@param:  ratio:比例[0,1]，如0.5为中值，0.99可用于高光判断
+ *@return: uint:满足"取值<=结果的像素占比>=ratio"的最小取值，没有统计数据时返回0
+ */
+uint FrameStatistics::percentile(Channel channel, double ratio) const
+{
+    const quint64 count = pixels(channel);
+    if(count == 0)
+    {
+        return 0;
+    }
+    ratio = qBound(0.0,ratio,1.0);
+    const quint64 target = qMax<quint64>(1,quint64(ratio*count + 0.5));
+    quint64 sum = 0;
+    for(uint i=0;i<256;i++)
+    {
+        sum += histograms[channel][i];
+        if(sum >= target)
+        {
+            return i;
+        }
+    }
+    return 255;
+}
+/*
+ *@brief:  取值<=level/>=level的像素数(TV Range的原始数据可以使用16/235作为欠曝/过曝的阈值)
+ *@date:   2026.10.18
+ *@param:  channel:通道  level:阈值[0,255]
+ *@return: quint64:像素数
+ */
+quint64 FrameStatistics::countBelow(Channel channel, uint level) const
+{
+    quint64 sum = 0;
+    for(uint i=0;i<=qMin(level,255u);i++)
+    {
+        sum += histograms[channel][i];
+    }
+    return sum;
+}
+quint64 FrameStatistics::countAbove(Channel channel, uint level) const
+{
+    quint64 sum = 0;
+    for(uint i=level;i<256;i++)
+    {
+        sum += histograms[channel][i];
+    }
+    return sum;
+}
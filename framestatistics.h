@@ -0,0 +1,67 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   帧统计信息(亮度及r、g、b各通道的直方图、均值、过曝/欠曝像素数)，用于自动曝光决策和图像状态监测
+ *
+ *统计数据有两种来源，均由ColorToRgb24在已有的数据遍历中顺带累加，不需要对rgb帧再做一遍处理：
+ *1.转换时统计(ColorToRgb24::convert()等接口传入stats)：每转换完一行，趁该行rgb数据仍在一级缓存中累加r、g、b直方图，
+ *  亮度由rgb按BT601权重计算(与饱和度调整的L一致)，反映的是颜色调整和3D LUT之后的最终输出。
+ *2.原始数据统计(ColorToRgb24::frame_statistics())：只统计原始帧的Y分量，不做rgb转换，packed格式使用SIMD分离Y分量，
+ *  可按步长抽样，适合不需要rgb输出或只需要亮度的场景。
+ *均值、百分位、过曝/欠曝计数都由直方图推导，累加时只有直方图和两个计数器。多个统计对象可以通过merge()合并，
+ *分块并行转换时每个线程持有各自的统计对象(部分直方图)，全部完成后再合并，线程之间没有共享写入。
+ */
+#ifndef FRAMESTATISTICS_H
+#define FRAMESTATISTICS_H
+
+#include "qglobal.h"
+#include <QMetaType>
+
+class FrameStatistics
+{
+public:
+    //统计通道
+    enum Channel
+    {
+        Luma = 0,//亮度(Y分量或由rgb计算)
+        Red,
+        Green,
+        Blue,
+        ChannelCount
+    };
+
+    FrameStatistics();
+
+    void reset();//清空统计数据
+    void merge(const FrameStatistics &other);//合并另一份统计数据(如其他线程的部分统计)
+
+    //累加一段连续的rgb像素(亮度由rgb计算)，通过各通道的字节偏移适配不同的rgb输出格式
+    void accumulateRgb(const uchar *pixels,uint count,uint bytesPerPixel,uint rOffset,uint gOffset,uint bOffset);
+    //累加一份256级的直方图到指定通道
+    void accumulateHistogram(Channel channel,const quint32 *histogram);
+
+    const quint32 *histogram(Channel channel) const {return histograms[channel];}
+    bool hasChannel(Channel channel) const {return pixels(channel) != 0;}
+    quint64 pixels(Channel channel) const;//统计的像素数
+    double mean(Channel channel) const;//均值，没有统计数据时返回0
+    uint percentile(Channel channel,double ratio) const;//百分位(ratio范围[0,1])，如0.5为中值
+    quint64 countBelow(Channel channel,uint level) const;//取值<=level的像素数
+    quint64 countAbove(Channel channel,uint level) const;//取值>=level的像素数
+    //r、g、b任意一个通道为0(欠曝)/255(过曝)的像素数，只有转换时统计才有效
+    quint64 clippedLowPixels() const {return clippedLow;}
+    quint64 clippedHighPixels() const {return clippedHigh;}
+
+private:
+    quint32 histograms[ChannelCount][256];
+    quint64 clippedLow;
+    quint64 clippedHigh;
+};
+Q_DECLARE_METATYPE(FrameStatistics)
+
+#endif // FRAMESTATISTICS_H
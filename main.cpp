@@ -5,6 +5,8 @@ int main(int argc, char *argv[])
 {
 
     //QApplication::setAttribute(Qt::AA_ShareOpenGLContexts, true);
+    //着色器程序二进制的磁盘缓存默认开启，驱动的程序二进制有问题时可以关闭
+    //QApplication::setAttribute(Qt::AA_DisableShaderDiskCache, true);
     QApplication a(argc, argv);
 
     VideoDisplayWidget w;
@@ -0,0 +1,592 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   多路V4L2帧数据的拼接(画面分割)渲染(基于opengl的api)
+ */
+#include "mosaicrendering.h"
+#include "colortorgb24.h"
+#include <QRegularExpression>
+#include <QRegularExpressionMatch>
+#include <QDebug>
+#include <math.h>
+
+/*
+ *@brief:  构造函数
+ *@date:   2026.10.18
+ *@param:  pixel_format:帧格式(使用v4l2的宏，所有路相同)
+ *@param:  pixel_width:像素宽度(需要确保为偶数)  pixel_height:像素高度
+ *@param:  stream_count:路数
+ *@param:  is_tv_range:true=TV Range   false=FULL Range
+ */
+MosaicRendering::MosaicRendering(uint pixel_format, uint pixel_width, uint pixel_height, uint stream_count,
+                                 bool is_tv_range, QObject *parent)
+    : QObject(parent),pixelFormat(pixel_format),pixelWidth(pixel_width),pixelHeight(pixel_height),
+      streams(stream_count?stream_count:1),isTVRange(is_tv_range)
+{
+    streamValid.fill(false,streams);
+    setGridLayout();
+}
+/*
+ *@brief:  析构函数，释放资源
+ *注:外部需要保证析构时OpenGL上下文为当前上下文(与OpenGLWidget一致，在组件析构时makeCurrent())。
+ *@date:   2026.10.18
+ */
+MosaicRendering::~MosaicRendering()
+{
+    for(uint i=0;i<MOSAIC_PLANE_COUNT;i++)
+    {
+        delete planeTextures[i];
+    }
+}
+/*
+ *@brief:  建立OpenGL的资源和状态
+ *注:支持多次调用(参见V4l2Rendering::initializeGL())，纹理在新的上下文中重新创建，各路需要等到下一帧才重新显示。
+ *@date:   2026.10.18
+ */
+void MosaicRendering::initializeGL()
+{
+    isInitGl = true;
+
+    initializeOpenGLFunctions();//绑定QOpenGLFunctions的上下文
+    glClearColor(0.0f,0.0f,0.0f,1.0f);//设置清屏颜色
+    glClear(GL_COLOR_BUFFER_BIT);//清空颜色缓冲区
+
+    /*0.关联上下文的销毁信号，用来销毁OpenGL纹理对象*/
+    connect(QOpenGLContext::currentContext(),&QOpenGLContext::aboutToBeDestroyed,
+            this,&MosaicRendering::destroyTexture,Qt::DirectConnection);
+
+    /*1.纹理数组需要OpenGL 3.0/OpenGL ES 3.0，否则使用atlas*/
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    useTextureArray = (context->format().majorVersion() >= 3);
+
+    /*2.初始化VAO、VBO(顶点数据在绘制时根据布局和有效的路生成)*/
+    VAO.create();
+    VAO.bind();
+    VBO.create();
+    VBO.bind();
+    VBO.setUsagePattern(QOpenGLBuffer::DynamicDraw);//布局或有效的路改变时重新写入
+
+    /*3.初始化纹理和着色器程序*/
+    initTextures();
+    initShaderProgram();
+
+    VBO.release();
+    VAO.release();
+
+    streamValid.fill(false,streams);
+    vertexDataChanged = true;
+}
+/*
+ *@brief:  设置OpenGL的视口
+ *@date:   2026.10.18
+ *@param:  w:宽  h:高
+ */
+void MosaicRendering::resizeGL(int w, int h)
+{
+    this->widgetWidth = w;
+    this->widgetHeight = h;
+    glViewport(0,0,w,h);
+}
+/*
+ *@brief:  渲染OpenGL场景
+ *注:所有已收到帧的路在一次glDrawArrays中绘制完成，没有收到帧的区域保持清屏颜色。
+ *@date:   2026.10.18
+ */
+void MosaicRendering::paintGL()
+{
+    glClear(GL_COLOR_BUFFER_BIT);//防止叠图
+
+    if(planeCount == 0)
+    {
+        return;
+    }
+    if(vertexDataChanged)
+    {
+        updateVertexData();
+        vertexDataChanged = false;
+    }
+    if(vertexCount == 0)
+    {
+        return;
+    }
+
+    shaderProgram.bind();
+    VAO.bind();
+    //为片段着色器传递新的颜色编码参数
+    if(colorEncodingParamChanged)
+    {
+        shaderProgram.setUniformValue("yuv2rgb",yuvToRgbMatrix());
+        shaderProgram.setUniformValue("rgbOffset",yuvToRgbOffset());
+
+        colorEncodingParamChanged = false;
+    }
+    //各平面的纹理绑定到对应的纹理单元，一次绘制所有的路
+    for(uint i=0;i<planeCount;i++)
+    {
+        planeTextures[i]->bind(i);
+    }
+    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    for(uint i=0;i<planeCount;i++)
+    {
+        planeTextures[i]->release(i);
+    }
+    VAO.release();
+    shaderProgram.release();
+}
+/*
+ *@brief:  设置网格布局
+ *@date:   2026.10.18
+ *@param:  columns:列数，0=按路数自动计算(ceil(sqrt(路数)))
+ *@param:  rows:行数，0=按路数和列数自动计算
+ */
+void MosaicRendering::setGridLayout(uint columns, uint rows)
+{
+    if(columns == 0)
+    {
+        columns = (uint)ceil(sqrt((double)streams));
+    }
+    if(rows == 0)
+    {
+        rows = (streams + columns - 1)/columns;
+    }
+    QVector<QRectF> tiles;
+    for(uint i=0;i<streams && i<columns*rows;i++)
+    {
+        tiles.append(QRectF((i%columns)*1.0/columns,(i/columns)*1.0/rows,1.0/columns,1.0/rows));
+    }
+    setTileLayout(tiles);
+}
+/*
+ *@brief:  设置任意布局
+ *注:区域可以重叠，绘制顺序为路的顺序(后面的路覆盖前面的路)，支持动态调整。
+ *@date:   2026.10.18
+ *@param:  tiles:tiles[i]为第i路的归一化显示区域(左上角为原点，[0,1])，超出tiles数量的路不显示
+ */
+void MosaicRendering::setTileLayout(const QVector<QRectF> &tiles)
+{
+    tileRects = tiles;
+    vertexDataChanged = true;
+}
+/*
+ *@brief:  设置yuv颜色编码参数(转换标准和量化范围)，所有路相同
+ *@date:   2026.10.18
+ *@param:  ycbcr_enc:转换标准(V4L2_YCBCR_ENC_601/V4L2_YCBCR_ENC_709/V4L2_YCBCR_ENC_BT2020)
+ *@param:  is_tv_range:true=TV Range   false=FULL Range
+ */
+void MosaicRendering::setColorEncodingParam(const uint &ycbcr_enc, const bool &is_tv_range)
+{
+    if(ycbcrEncoding != ycbcr_enc || isTVRange != is_tv_range)
+    {
+        ycbcrEncoding = ycbcr_enc;
+        isTVRange = is_tv_range;
+        colorEncodingParamChanged = true;
+    }
+}
+/*
+ *@brief:  获取当前转换标准和量化范围对应的yuv转rgb矩阵(与V4l2Rendering::yuvToRgbMatrix()一致)
+ *@date:   2026.10.18
+ *@return: QMatrix3x3:按行优先排列的转换矩阵，rgb = matrix * (y,u,v) + offset
+ */
+QMatrix3x3 MosaicRendering::yuvToRgbMatrix()
+{
+    const YuvToRgbCoef coef = yuvToRgbCoef(ycbcrEncoding);
+    const float ys = isTVRange?255.0f/219.0f:1.0f;
+    const float uvs = isTVRange?255.0f/224.0f:1.0f;
+    const float values[] = {ys, 0.0f,          coef.rv*uvs,
+                            ys, -coef.gu*uvs,  -coef.gv*uvs,
+                            ys, coef.bu*uvs,   0.0f};
+    return QMatrix3x3(values);
+}
+/*
+ *@brief:  获取当前转换标准和量化范围对应的rgb偏移(与V4l2Rendering::yuvToRgbOffset()一致)
+ *@date:   2026.10.18
+ *@return: QVector3D:与yuvToRgbMatrix()配合使用的rgb偏移
+ */
+QVector3D MosaicRendering::yuvToRgbOffset()
+{
+    const YuvToRgbCoef coef = yuvToRgbCoef(ycbcrEncoding);
+    const float y0 = isTVRange?16.0f/219.0f:0.0f;
+    const float uv0 = isTVRange?16.0f/224.0f + 0.5f:0.5f;
+    return QVector3D(-(y0 + coef.rv*uv0),
+                     -(y0 - coef.gu*uv0 - coef.gv*uv0),
+                     -(y0 + coef.bu*uv0));
+}
+/*
+ *@brief:  更新第stream路的帧数据
+ *注:只更新该路对应的纹理层(atlas中的一格)，其他路保持不变，需要在OpenGL上下文中调用。
+ *@date:   2026.10.18
+ *@param:  stream:路号[0,路数)
+ *@param:  v4l2FrameData:v4l2帧二维指针(指针数组)，v4l2FrameData[0]即完整的yuv数据(各平面连续存储)
+ */
+void MosaicRendering::updateV4l2Frame(uint stream, uchar **v4l2FrameData)
+{
+    //确保已经初始化opengl相关资源(initializeGL)，否则直接操作纹理会出错
+    if(!this->isInitGl || planeCount == 0 || stream >= streams || v4l2FrameData == nullptr)
+    {
+        return;
+    }
+
+    const uchar *frameData = v4l2FrameData[0];
+    const uint ySize = pixelWidth*pixelHeight;
+    //one planes格式，两个纹理读取同一份数据
+    if(pixelFormat == V4L2_PIX_FMT_YUYV ||
+            pixelFormat == V4L2_PIX_FMT_YVYU)
+    {
+        uploadPlane(0,stream,QOpenGLTexture::LuminanceAlpha,frameData);
+        uploadPlane(1,stream,QOpenGLTexture::RGBA,frameData);
+    }
+    //two planes格式
+    else if(pixelFormat == V4L2_PIX_FMT_NV12 ||
+            pixelFormat == V4L2_PIX_FMT_NV21)
+    {
+        uploadPlane(0,stream,QOpenGLTexture::Luminance,frameData);
+        uploadPlane(1,stream,QOpenGLTexture::LuminanceAlpha,frameData+ySize);
+    }
+    //three planes格式
+    else if(pixelFormat == V4L2_PIX_FMT_YUV420 ||
+            pixelFormat == V4L2_PIX_FMT_YVU420)
+    {
+        uploadPlane(0,stream,QOpenGLTexture::Luminance,frameData);
+        uploadPlane(1,stream,QOpenGLTexture::Luminance,frameData+ySize);
+        uploadPlane(2,stream,QOpenGLTexture::Luminance,frameData+ySize*5/4);
+    }
+    //第一次收到该路的帧，需要加入绘制
+    if(!streamValid[stream])
+    {
+        streamValid[stream] = true;
+        vertexDataChanged = true;
+    }
+}
+/*
+ *@brief:  初始化各平面的纹理对象
+ *注:纹理格式与V4l2Rendering::initTexture()一致(Luminance等格式兼容OpenGL ES 2.0)。纹理数组每一路一层；atlas每行
+ *ceil(sqrt(路数))路，尺寸不能超过GL_MAX_TEXTURE_SIZE(例如Mali-400为4096，16路720p的Y平面为2880x2880)。
+ *@date:   2026.10.18
+ */
+void MosaicRendering::initTextures()
+{
+    for(uint i=0;i<MOSAIC_PLANE_COUNT;i++)
+    {
+        delete planeTextures[i];
+        planeTextures[i] = nullptr;
+    }
+    planeCount = 0;
+
+    QOpenGLTexture::TextureFormat formats[MOSAIC_PLANE_COUNT];
+    QOpenGLTexture::PixelFormat pixelFormats[MOSAIC_PLANE_COUNT];
+    uint bytesPerTexel[MOSAIC_PLANE_COUNT];
+    if(pixelFormat == V4L2_PIX_FMT_YUYV || pixelFormat == V4L2_PIX_FMT_YVYU)
+    {
+        planeCount = 2;
+        //每两个字节提取一个Y
+        planeSizes[0] = QSize(pixelWidth,pixelHeight);
+        formats[0] = QOpenGLTexture::LuminanceAlphaFormat;
+        pixelFormats[0] = QOpenGLTexture::LuminanceAlpha;
+        bytesPerTexel[0] = 2;
+        //每四个字节提取一组UV
+        planeSizes[1] = QSize(pixelWidth/2,pixelHeight);
+        formats[1] = QOpenGLTexture::RGBAFormat;
+        pixelFormats[1] = QOpenGLTexture::RGBA;
+        bytesPerTexel[1] = 4;
+    }
+    else if(pixelFormat == V4L2_PIX_FMT_NV12 || pixelFormat == V4L2_PIX_FMT_NV21)
+    {
+        planeCount = 2;
+        planeSizes[0] = QSize(pixelWidth,pixelHeight);
+        formats[0] = QOpenGLTexture::LuminanceFormat;
+        pixelFormats[0] = QOpenGLTexture::Luminance;
+        bytesPerTexel[0] = 1;
+        planeSizes[1] = QSize(pixelWidth/2,pixelHeight/2);
+        formats[1] = QOpenGLTexture::LuminanceAlphaFormat;
+        pixelFormats[1] = QOpenGLTexture::LuminanceAlpha;
+        bytesPerTexel[1] = 2;
+    }
+    else if(pixelFormat == V4L2_PIX_FMT_YUV420 || pixelFormat == V4L2_PIX_FMT_YVU420)
+    {
+        planeCount = 3;
+        planeSizes[0] = QSize(pixelWidth,pixelHeight);
+        planeSizes[1] = planeSizes[2] = QSize(pixelWidth/2,pixelHeight/2);
+        for(uint i=0;i<planeCount;i++)
+        {
+            formats[i] = QOpenGLTexture::LuminanceFormat;
+            pixelFormats[i] = QOpenGLTexture::Luminance;
+            bytesPerTexel[i] = 1;
+        }
+    }
+    else
+    {
+        qDebug()<<QString("MosaicRendering:not support current pixelFormat:%1%2%3%4!")
+                  .arg((char)(pixelFormat&0xff))
+                  .arg((char)((pixelFormat>>8)&0xff))
+                  .arg((char)((pixelFormat>>16)&0xff))
+                  .arg((char)((pixelFormat>>24)&0xff));
+        return;
+    }
+
+    atlasColumns = (uint)ceil(sqrt((double)streams));
+    const uint atlasRows = (streams + atlasColumns - 1)/atlasColumns;
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE,&maxTextureSize);
+    for(uint i=0;i<planeCount;i++)
+    {
+        //行字节数不是4的整数倍时改变解包的字节对齐
+        const uint lineBytes = planeSizes[i].width()*bytesPerTexel[i];
+        planeTransferOptions[i].setAlignment((lineBytes%4 == 0)?4:((lineBytes%2 == 0)?2:1));
+
+        QOpenGLTexture *texture;
+        if(useTextureArray)
+        {
+            texture = new QOpenGLTexture(QOpenGLTexture::Target2DArray);
+            texture->setSize(planeSizes[i].width(),planeSizes[i].height());
+            texture->setLayers(streams);
+        }
+        else
+        {
+            texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
+            texture->setSize(planeSizes[i].width()*atlasColumns,planeSizes[i].height()*atlasRows);
+            if(texture->width() > maxTextureSize || texture->height() > maxTextureSize)
+            {
+                qDebug()<<"MosaicRendering: atlas"<<texture->width()<<"x"<<texture->height()
+                       <<"exceeds GL_MAX_TEXTURE_SIZE"<<maxTextureSize;
+            }
+        }
+        texture->setFormat(formats[i]);
+        texture->setMinMagFilters(QOpenGLTexture::Linear, QOpenGLTexture::Linear);
+        texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+        texture->allocateStorage(pixelFormats[i],QOpenGLTexture::UInt8);
+        planeTextures[i] = texture;
+    }
+}
+/*
+ *@brief:  初始化着色器程序
+ *注:纹理数组版本使用sampler2DArray(GLSL 1.30/GLSL ES 3.00)，纹理坐标的第三个分量为层号；atlas版本只使用前两个分量。
+ *着色器的采样统一通过SAMPLE()宏完成，两种版本的主函数相同。需要在VAO和VBO绑定的状态下调用。
+ *@date:   2026.10.18
+ */
+void MosaicRendering::initShaderProgram()
+{
+    QString vertexShader = QString("attribute vec2 aPos;\n"
+                                   "attribute vec3 aTexCoord;\n"
+                                   "varying vec3 TexCoord;\n\n"
+                                   "void main(){\n"
+                                   "gl_Position = vec4(aPos, 0.0, 1.0);\n"
+                                   "TexCoord = aTexCoord;\n"
+                                   "}\n");
+    //各格式的yuv采样(tex0~tex2依次为各平面)
+    QString sampleShader;
+    if(pixelFormat == V4L2_PIX_FMT_YUYV || pixelFormat == V4L2_PIX_FMT_YVYU)
+    {
+        sampleShader = QString("vec2 uv = SAMPLE(tex1).ga;\n"
+                               "vec3 yuv = vec3(SAMPLE(tex0).r, %1, %2);\n");
+    }
+    else if(pixelFormat == V4L2_PIX_FMT_NV12 || pixelFormat == V4L2_PIX_FMT_NV21)
+    {
+        sampleShader = QString("vec2 uv = SAMPLE(tex1).ra;\n"
+                               "vec3 yuv = vec3(SAMPLE(tex0).r, %1, %2);\n");
+    }
+    else
+    {
+        sampleShader = QString("vec3 yuv = vec3(SAMPLE(tex0).r, %1, %2);\n");
+    }
+    //格式UV顺序不同
+    if(pixelFormat == V4L2_PIX_FMT_YUV420)
+    {
+        sampleShader = sampleShader.arg("SAMPLE(tex1).r","SAMPLE(tex2).r");
+    }
+    else if(pixelFormat == V4L2_PIX_FMT_YVU420)
+    {
+        sampleShader = sampleShader.arg("SAMPLE(tex2).r","SAMPLE(tex1).r");
+    }
+    else if(pixelFormat == V4L2_PIX_FMT_YUYV || pixelFormat == V4L2_PIX_FMT_NV12)
+    {
+        sampleShader = sampleShader.arg("uv.x","uv.y");
+    }
+    else
+    {
+        sampleShader = sampleShader.arg("uv.y","uv.x");
+    }
+    QString fragmentShader = QString("varying vec3 TexCoord;\n\n"
+                                     "uniform mat3 yuv2rgb;\n"
+                                     "uniform vec3 rgbOffset;\n"
+                                     "uniform SAMPLER tex0;\n"
+                                     "uniform SAMPLER tex1;\n"
+                                     "uniform SAMPLER tex2;\n\n"
+                                     "void main(){\n"
+                                     "%1"
+                                     "vec3 rgb = yuv2rgb * yuv + rgbOffset;\n"
+                                     "rgb = clamp(rgb,0.0,1.0);\n"
+                                     "rgb = pow(rgb, vec3(1.0/2.2));\n"//伽马校正(与V4l2Rendering一致)
+                                     "gl_FragColor = vec4(rgb, 1.0);\n"
+                                     "}\n").arg(sampleShader);
+
+    //获取当前的glsl版本，声明到着色器中(参见V4l2Rendering::initVertexShader()/initFragmentShader())
+    const QString glslVersionStr = QString((const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
+    const bool isES = glslVersionStr.contains("ES",Qt::CaseInsensitive);
+    int glslVersion = 100;
+    QRegularExpressionMatch expMatch;
+    if(glslVersionStr.lastIndexOf(QRegularExpression("\\d+[.]\\d+"),-1,&expMatch) != -1)
+    {
+        glslVersion = expMatch.captured().toDouble()*1000/10;
+    }
+    if(useTextureArray)
+    {
+        fragmentShader.prepend("#define SAMPLER sampler2DArray\n"
+                               "#define SAMPLE(tex) texture(tex, TexCoord)\n"
+                               "out vec4 FragColor;\n");
+        fragmentShader.replace("varying","in");
+        fragmentShader.replace("gl_FragColor","FragColor");
+        vertexShader.replace("attribute","in");
+        vertexShader.replace("varying","out");
+        if(isES)
+        {
+            fragmentShader.prepend("#version 300 es\nprecision mediump float;\nprecision mediump sampler2DArray;\n");
+            vertexShader.prepend("#version 300 es\n");
+        }
+        else
+        {
+            fragmentShader.prepend(QString("#version %1\n").arg(qMax(glslVersion,130)));
+            vertexShader.prepend(QString("#version %1\n").arg(qMax(glslVersion,130)));
+        }
+    }
+    else
+    {
+        fragmentShader.prepend("#define SAMPLER sampler2D\n"
+                               "#define SAMPLE(tex) texture2D(tex, TexCoord.xy)\n");
+        if(isES)
+        {
+            //OpenGL ES 2.0不用加版本头，仅指定精度
+            fragmentShader.prepend("precision mediump float;\n");
+        }
+    }
+
+    shaderProgram.removeAllShaders();
+#if QT_VERSION >= QT_VERSION_CHECK(5,9,0)
+    shaderProgram.addCacheableShaderFromSourceCode(QOpenGLShader::Vertex,vertexShader);
+    shaderProgram.addCacheableShaderFromSourceCode(QOpenGLShader::Fragment,fragmentShader);
+#else
+    shaderProgram.addShaderFromSourceCode(QOpenGLShader::Vertex,vertexShader);
+    shaderProgram.addShaderFromSourceCode(QOpenGLShader::Fragment,fragmentShader);
+#endif
+    shaderProgram.bindAttributeLocation("aPos",0);
+    shaderProgram.bindAttributeLocation("aTexCoord",1);
+    if(!shaderProgram.link())
+    {
+        qDebug()<<"MosaicRendering: link failed:"<<shaderProgram.log();
+    }
+    shaderProgram.bind();
+    //顶点数据:顶点坐标(2float)+纹理坐标(3float，第三个分量为层号)
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5*sizeof(float), nullptr);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5*sizeof(float), reinterpret_cast<void *>(2*sizeof(float)));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    //采样器绑定到对应的纹理单元，传递转换矩阵
+    shaderProgram.setUniformValue("tex0",0);
+    shaderProgram.setUniformValue("tex1",1);
+    shaderProgram.setUniformValue("tex2",2);
+    shaderProgram.setUniformValue("yuv2rgb",yuvToRgbMatrix());
+    shaderProgram.setUniformValue("rgbOffset",yuvToRgbOffset());
+    colorEncodingParamChanged = false;
+    shaderProgram.release();
+}
+/*
+ *@brief:  根据布局和已收到帧的路生成顶点数据(每一路两个三角形)，写入VBO
+ *注:atlas中相邻格的像素会被线性过滤混合到边缘，纹理坐标向内收缩半个色度像素。
+ *@date:   2026.10.18
+ */
+void MosaicRendering::updateVertexData()
+{
+    const uint atlasRows = (streams + atlasColumns - 1)/atlasColumns;
+    const QSize chromaSize = planeSizes[planeCount-1];
+    const float insetX = useTextureArray?0.0f:0.5f/chromaSize.width();
+    const float insetY = useTextureArray?0.0f:0.5f/chromaSize.height();
+    QVector<float> vertices;
+    vertices.reserve(streams*6*5);
+    for(uint i=0;i<streams && i<(uint)tileRects.size();i++)
+    {
+        if(!streamValid[i])
+        {
+            continue;
+        }
+        //显示区域转换为标准化设备坐标(y轴向上)
+        const QRectF &rect = tileRects.at(i);
+        const float x0 = rect.left()*2.0 - 1.0;
+        const float x1 = rect.right()*2.0 - 1.0;
+        const float y0 = 1.0 - rect.top()*2.0;
+        const float y1 = 1.0 - rect.bottom()*2.0;
+        //纹理坐标(左上角为原点，与帧数据的行顺序一致)
+        float s0 = 0.0f, s1 = 1.0f, t0 = 0.0f, t1 = 1.0f, layer = i;
+        if(!useTextureArray)
+        {
+            const uint column = i%atlasColumns;
+            const uint row = i/atlasColumns;
+            s0 = (column + insetX)/atlasColumns;
+            s1 = (column + 1 - insetX)/atlasColumns;
+            t0 = (row + insetY)/atlasRows;
+            t1 = (row + 1 - insetY)/atlasRows;
+            layer = 0.0f;
+        }
+        const float tile[] = {
+            x0, y0, s0, t0, layer,
+            x1, y0, s1, t0, layer,
+            x0, y1, s0, t1, layer,
+            x0, y1, s0, t1, layer,
+            x1, y0, s1, t0, layer,
+            x1, y1, s1, t1, layer
+        };
+        for(uint j=0;j<sizeof(tile)/sizeof(float);j++)
+        {
+            vertices.append(tile[j]);
+        }
+    }
+    vertexCount = vertices.size()/5;
+    VBO.bind();
+    VBO.allocate(vertices.constData(),vertices.size()*sizeof(float));
+    VBO.release();
+}
+/*
+ *@brief:  更新某一路某一平面的纹理数据
+ *注:平铺纹理(atlas)只更新该路所在的子区域，直接调用glTexSubImage2D()(QOpenGLTexture带偏移的setData()需要Qt5.14)。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  plane:平面索引
+ *@param:  stream:路号
+ *@param:  sourceFormat:源数据的像素格式(与initTextures()中的格式对应)
+ *@param:  data:平面数据
+ */
+void MosaicRendering::uploadPlane(uint plane, uint stream, QOpenGLTexture::PixelFormat sourceFormat, const uchar *data)
+{
+    QOpenGLTexture *texture = planeTextures[plane];
+    if(useTextureArray)
+    {
+        texture->setData(0,stream,sourceFormat,QOpenGLTexture::UInt8,data,&planeTransferOptions[plane]);
+    }
+    else
+    {
+        const QSize &size = planeSizes[plane];
+        texture->bind();
+        glPixelStorei(GL_UNPACK_ALIGNMENT,planeTransferOptions[plane].alignment());
+        glTexSubImage2D(GL_TEXTURE_2D,0,(stream%atlasColumns)*size.width(),(stream/atlasColumns)*size.height(),
+                        size.width(),size.height(),GLenum(sourceFormat),GL_UNSIGNED_BYTE,data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT,4);
+        texture->release();
+    }
+}
+/*
+ *@brief:  销毁OpenGL纹理对象(关联QOpenGLContext::aboutToBeDestroyed信号，原因参见V4l2Rendering::destroyTexture())
+ *@date:   2026.10.18
+ */
+void MosaicRendering::destroyTexture()
+{
+    for(uint i=0;i<MOSAIC_PLANE_COUNT;i++)
+    {
+        delete planeTextures[i];
+        planeTextures[i] = nullptr;
+    }
+    planeCount = 0;
+}
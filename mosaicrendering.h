@@ -0,0 +1,102 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   多路V4L2帧数据的拼接(画面分割)渲染(基于opengl的api)
+ *
+ *1.所有路共用一个OpenGL上下文、一个着色器程序、一个VAO/VBO，每一路不再需要单独的OpenGLWidget(上下文切换以及每个
+ *组件单独合成在16路时占了大部分GPU时间)。各路帧格式和尺寸相同，每个平面(Y/UV/U/V)的所有路放在一个纹理中:
+ *OpenGL 3.0/OpenGL ES 3.0及以上使用2D纹理数组(每一路一层)，OpenGL ES 2.0使用平铺的2D纹理(atlas，每一路一格)。
+ *2.所有分块(tile)的顶点(两个三角形，纹理坐标带有层号)放在同一个VBO中，一次glDrawArrays绘制完所有路。
+ *3.某一路有新帧时只更新该路对应的纹理层(或atlas中的一格)，没有新帧的路保留上一帧，尚未收到帧的路不绘制。
+ *4.布局由每一路的归一化显示区域(左上角为原点)确定，可通过setGridLayout()设置为网格，也可以通过setTileLayout()
+ *设置任意布局(如一大多小)。
+ *注:颜色转换与V4l2Rendering一致(转换矩阵合并了range转换、伽马校正)，不支持镜像、裁剪、颜色调整和反交错等单路处理。
+ */
+#ifndef MOSAICRENDERING_H
+#define MOSAICRENDERING_H
+
+#include <linux/videodev2.h>//v4l2的头文件
+#include <QObject>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLBuffer>
+#include <QOpenGLTexture>
+#include <QOpenGLPixelTransferOptions>
+#include <QGenericMatrix>
+#include <QVector3D>
+#include <QVector>
+#include <QRectF>
+
+//每个平面最多的纹理数(YUV420为Y、U、V三个)
+#define MOSAIC_PLANE_COUNT 3
+
+class MosaicRendering : public QObject,protected QOpenGLExtraFunctions
+{
+    Q_OBJECT
+public:
+    explicit MosaicRendering(uint pixel_format,uint pixel_width,uint pixel_height,
+                             uint stream_count,bool is_tv_range = true,QObject *parent=nullptr);
+    ~MosaicRendering();
+
+    void initializeGL();
+    void resizeGL(int w,int h);
+    void paintGL();
+
+    //网格布局(columns/rows为0时自动按路数计算接近正方形的网格)
+    void setGridLayout(uint columns=0,uint rows=0);
+    //任意布局:tiles[i]为第i路的归一化显示区域(左上角为原点，[0,1])，超出tiles数量的路不显示
+    void setTileLayout(const QVector<QRectF> &tiles);
+    QVector<QRectF> tileLayout(){return tileRects;}
+    void setColorEncodingParam(const uint &ycbcr_enc,const bool &is_tv_range);
+    uint streamCount(){return streams;}
+    bool isTextureArray(){return useTextureArray;}
+    //更新第stream路的帧数据(需要在OpenGL上下文中调用)
+    void updateV4l2Frame(uint stream,uchar **v4l2FrameData);
+
+private:
+    void initTextures();
+    void initShaderProgram();
+    void updateVertexData();
+    void uploadPlane(uint plane,uint stream,QOpenGLTexture::PixelFormat sourceFormat,const uchar *data);
+    void destroyTexture();
+    QMatrix3x3 yuvToRgbMatrix();
+    QVector3D yuvToRgbOffset();
+
+    uint pixelFormat = 0;//采集帧格式(所有路相同)
+    uint pixelWidth = 0;//像素宽度
+    uint pixelHeight = 0;//像素高度
+    uint streams = 1;//路数
+    uint widgetWidth = 0;//渲染组件宽度
+    uint widgetHeight = 0;//渲染组件高度
+    bool isTVRange = true;//TV range标识
+    uint ycbcrEncoding = V4L2_YCBCR_ENC_709;//yuv转rgb的转换标准(V4L2_YCBCR_ENC_*)
+    bool colorEncodingParamChanged = false;//表示颜色编码参数是否改变
+
+    bool isInitGl = false;//初始化标识
+    bool useTextureArray = true;//true=2D纹理数组  false=2D纹理(atlas)
+    uint atlasColumns = 1;//atlas中每行的路数
+    //各平面的纹理对象及像素解包参数(字节对齐)
+    uint planeCount = 0;
+    QOpenGLTexture *planeTextures[MOSAIC_PLANE_COUNT] = {nullptr};
+    QSize planeSizes[MOSAIC_PLANE_COUNT];//单路的平面尺寸(纹理像素)
+    QOpenGLPixelTransferOptions planeTransferOptions[MOSAIC_PLANE_COUNT];
+    //顶点数据
+    QOpenGLVertexArrayObject VAO;
+    QOpenGLBuffer VBO;
+    uint vertexCount = 0;//本次绘制的顶点数(已收到帧的路数*6)
+    bool vertexDataChanged = true;//布局或有效的路改变时重新生成顶点数据
+    //着色器
+    QOpenGLShaderProgram shaderProgram;
+    //布局及各路状态
+    QVector<QRectF> tileRects;//每一路的归一化显示区域
+    QVector<bool> streamValid;//该路是否已经收到帧
+};
+
+#endif // MOSAICRENDERING_H
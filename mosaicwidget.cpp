@@ -0,0 +1,111 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   继承自QOpenGLWidget，在一个组件(一个OpenGL上下文)中拼接显示多路摄像头画面
+ */
+#include "mosaicwidget.h"
+
+/*
+ *@brief:  构造函数
+ *@date:   2026.10.18
+ *@param:  pixel_format:帧格式(使用v4l2的宏，所有路相同)
+ *@param:  pixel_width:像素宽度(需要确保为偶数)  pixel_height:像素高度
+ *@param:  stream_count:路数
+ *@param:  is_tv_range:true=TV Range   false=FULL Range
+ */
+MosaicWidget::MosaicWidget(uint pixel_format, uint pixel_width, uint pixel_height, uint stream_count,
+                           bool is_tv_range, QWidget *parent)
+    : QOpenGLWidget(parent),
+      mosaicRendering(new MosaicRendering(pixel_format,pixel_width,pixel_height,stream_count,is_tv_range))
+{
+}
+
+MosaicWidget::~MosaicWidget()
+{
+    makeCurrent();
+    if(mosaicRendering)
+    {
+        delete mosaicRendering;
+    }
+}
+/*
+ *@brief:  设置网格布局
+ *@date:   2026.10.18
+ *@param:  columns:列数  rows:行数，0=自动计算
+ */
+void MosaicWidget::setGridLayout(uint columns, uint rows)
+{
+    mosaicRendering->setGridLayout(columns,rows);
+    update();
+}
+/*
+ *@brief:  设置任意布局
+ *@date:   2026.10.18
+ *@param:  tiles:tiles[i]为第i路的归一化显示区域(左上角为原点，[0,1])
+ */
+void MosaicWidget::setTileLayout(const QVector<QRectF> &tiles)
+{
+    mosaicRendering->setTileLayout(tiles);
+    update();
+}
+/*
+ *@brief:  设置颜色编码参数
+ *@date:   2026.10.18
+ *@param:  ycbcr_enc:转换标准(V4L2_YCBCR_ENC_*)
+ *@param:  is_tv_range:true=TV Range   false=FULL Range
+ */
+void MosaicWidget::setColorEncodingParam(const uint &ycbcr_enc, const bool &is_tv_range)
+{
+    mosaicRendering->setColorEncodingParam(ycbcr_enc,is_tv_range);
+    update();
+}
+/*
+ *@brief:  建立OpenGL的资源和状态
+ *@date:   2026.10.18
+ */
+void MosaicWidget::initializeGL()
+{
+    mosaicRendering->initializeGL();
+}
+/*
+ *@brief:  设置OpenGL的视口
+ *@date:   2026.10.18
+ *@param:  w:宽  h:高
+ */
+void MosaicWidget::resizeGL(int w, int h)
+{
+    mosaicRendering->resizeGL(w,h);
+}
+/*
+ *@brief:  渲染OpenGL场景
+ *@date:   2026.10.18
+ */
+void MosaicWidget::paintGL()
+{
+    mosaicRendering->paintGL();
+}
+/*
+ *@brief:  更新某一路的V4l2帧数据
+ *注:只上传该路的纹理，重绘由update()合并，多路在同一事件循环周期内到达时只绘制一次。
+ *@date:   2026.10.18
+ *@param:  stream:路号
+ *@param:  v4l2Frame:v4l2帧二维指针(指针数组[planes])，v4l2Frame[0]即完整的v4l2数据
+ */
+void MosaicWidget::updateV4l2FrameSlot(uint stream, uchar **v4l2Frame)
+{
+    if(!this->isVisible())
+    {
+        return;
+    }
+
+    makeCurrent();
+    mosaicRendering->updateV4l2Frame(stream,v4l2Frame);
+    doneCurrent();
+    update();
+}
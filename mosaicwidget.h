@@ -0,0 +1,47 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   继承自QOpenGLWidget，在一个组件(一个OpenGL上下文)中拼接显示多路摄像头画面
+ */
+#ifndef MOSAICWIDGET_H
+#define MOSAICWIDGET_H
+
+#include "mosaicrendering.h"
+#include <QOpenGLWidget>
+
+class MosaicWidget : public QOpenGLWidget
+{
+    Q_OBJECT
+public:
+    explicit MosaicWidget(uint pixel_format,uint pixel_width,uint pixel_height,
+                          uint stream_count,bool is_tv_range=true,QWidget *parent = nullptr);
+    ~MosaicWidget();
+
+    //设置网格布局(columns/rows为0时自动计算)
+    void setGridLayout(uint columns=0,uint rows=0);
+    //设置任意布局(每一路的归一化显示区域，左上角为原点)
+    void setTileLayout(const QVector<QRectF> &tiles);
+    //设置颜色编码参数(转换标准和量化范围，所有路相同)
+    void setColorEncodingParam(const uint &ycbcr_enc,const bool &is_tv_range);
+
+protected:
+    virtual void initializeGL();
+    virtual void resizeGL(int w,int h);
+    virtual void paintGL();
+
+private:
+    //负责拼接渲染多路v4l2帧数据
+    MosaicRendering *mosaicRendering = nullptr;
+
+public slots:
+    void updateV4l2FrameSlot(uint stream,uchar **v4l2Frame);
+
+};
+
+#endif // MOSAICWIDGET_H
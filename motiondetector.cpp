@@ -0,0 +1,243 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   基于缩小亮度图的运动(画面变化)检测
+ */
+#include "motiondetector.h"
+#include "colortorgb24.h"//ENABLE_SIMD_CONVERT
+#include <string.h>
+
+/*根据编译器支持的指令集确定SIMD实现方式(与ColorToRgb24一致)*/
+#ifdef ENABLE_SIMD_CONVERT
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MOTION_DETECT_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MOTION_DETECT_SSE2
+#endif
+#endif
+
+MotionDetector::MotionDetector()
+{
+}
+/*
+ *@brief:  设置块尺寸
+ *@date:   2026.10.18
+ *@param:  size:块的边长(亮度图像素)，向下对齐到8的倍数，范围[8,64]，修改后参考图重新建立
+ */
+void MotionDetector::setBlockSize(uint size)
+{
+    size = qBound(8u,size&~7u,64u);
+    if(size != blockSide)
+    {
+        blockSide = size;
+        reset();
+    }
+}
+/*
+ *@brief:  清除参考图，下一帧总是判定为变化
+ *@date:   2026.10.18
+ */
+void MotionDetector::reset()
+{
+    reference.clear();
+    refWidth = 0;
+    refHeight = 0;
+}
+/*
+ *@brief:  检测原始帧
+ *注:先由frame_to_luma()按照downsample()提取缩小的亮度图，再进行检测。
+ *@date:   2026.10.18
+ *@param:  pixel_format:帧格式(V4L2_PIX_FMT_*)  frame:帧数据地址
+ *@param:  width,height:原始帧宽高
+ *@return: const Result&:检测结果(在下一次检测之前有效)，不支持的格式总是判定为变化
+ */
+const MotionDetector::Result &MotionDetector::detect(uint pixel_format, const uchar *frame, uint width, uint height)
+{
+    const uint lumaWidth = width/lumaDownsample;
+    const uint lumaHeight = height/lumaDownsample;
+    lumaBuf.resize(lumaWidth*lumaHeight);
+    if(lumaBuf.empty() ||
+            !ColorToRgb24::frame_to_luma(pixel_format,frame,lumaBuf.data(),width,height,lumaDownsample))
+    {
+        resetResult(width,height,1);
+        return result;
+    }
+    return detectLuma(lumaBuf.data(),lumaWidth,lumaHeight,lumaDownsample);
+}
+/*
+ *@brief:  检测亮度图
+ *注:首先计算所有块的SAD并生成掩码，只有整帧判定为变化时才将变化块拷贝到参考图，被判定为未变化(后续处理会跳过)的帧
+ *不影响参考图，否则小于minChangedBlocks的局部变化会被逐帧吸收而永远无法触发。
+ *@date:   2026.10.18
+ *@param:  luma:亮度图(每行width个字节连续存储)
+ *@param:  width,height:亮度图宽高
+ *@param:  scale:亮度图相对于原始帧的缩小倍数(用于将changedRect换算为原始帧坐标)
+ *@return: const Result&:检测结果(在下一次检测之前有效)
+ */
+const MotionDetector::Result &MotionDetector::detectLuma(const uchar *luma, uint width, uint height, uint scale)
+{
+    if(width == 0 || height == 0)
+    {
+        resetResult(0,0,scale);
+        return result;
+    }
+    const uint blocksX = (width + blockSide - 1)/blockSide;
+    const uint blocksY = (height + blockSide - 1)/blockSide;
+    //第一帧或尺寸变化:建立参考图，整帧判定为变化
+    if(width != refWidth || height != refHeight || reference.size() != width*height)
+    {
+        reference.assign(luma,luma + width*height);
+        refWidth = width;
+        refHeight = height;
+        resetResult(width,height,scale);
+        result.blocksX = blocksX;
+        result.blocksY = blocksY;
+        result.changedBlocks = blocksX*blocksY;
+        result.mask.fill(1,blocksX*blocksY);
+        return result;
+    }
+
+    result.blocksX = blocksX;
+    result.blocksY = blocksY;
+    result.mask.fill(0,blocksX*blocksY);
+    char *mask = result.mask.data();
+    quint64 totalSad = 0;
+    uint changedBlocks = 0;
+    uint minBx = blocksX,minBy = blocksY,maxBx = 0,maxBy = 0;
+    for(uint by=0;by<blocksY;by++)
+    {
+        const uint y0 = by*blockSide;
+        const uint blockHeight = qMin(blockSide,height - y0);
+        for(uint bx=0;bx<blocksX;bx++)
+        {
+            const uint x0 = bx*blockSide;
+            const uint blockWidth = qMin(blockSide,width - x0);
+            const uint offset = y0*width + x0;
+            const uint sad = blockSad(luma + offset,reference.data() + offset,width,blockWidth,blockHeight);
+            totalSad += sad;
+            if(sad > threshold*blockWidth*blockHeight)
+            {
+                mask[by*blocksX + bx] = 1;
+                changedBlocks++;
+                minBx = qMin(minBx,bx);
+                minBy = qMin(minBy,by);
+                maxBx = qMax(maxBx,bx);
+                maxBy = qMax(maxBy,by);
+            }
+        }
+    }
+    result.changedBlocks = changedBlocks;
+    result.score = double(changedBlocks)/(blocksX*blocksY);
+    result.meanDifference = double(totalSad)/(width*height);
+    result.changed = (changedBlocks >= minChangedBlocks);
+    result.changedRect = QRect();
+    if(!result.changed)
+    {
+        return result;
+    }
+    const uint right = qMin((maxBx + 1)*blockSide,width);
+    const uint bottom = qMin((maxBy + 1)*blockSide,height);
+    result.changedRect = QRect(minBx*blockSide*scale,minBy*blockSide*scale,
+                               (right - minBx*blockSide)*scale,(bottom - minBy*blockSide)*scale);
+    //更新参考图中的变化块
+    for(uint by=minBy;by<=maxBy;by++)
+    {
+        const uint y0 = by*blockSide;
+        const uint blockHeight = qMin(blockSide,height - y0);
+        for(uint bx=minBx;bx<=maxBx;bx++)
+        {
+            if(!mask[by*blocksX + bx])
+            {
+                continue;
+            }
+            const uint x0 = bx*blockSide;
+            const uint blockWidth = qMin(blockSide,width - x0);
+            for(uint y=y0;y<y0+blockHeight;y++)
+            {
+                memcpy(reference.data() + y*width + x0,luma + y*width + x0,blockWidth);
+            }
+        }
+    }
+    return result;
+}
+/*
+ *@brief:  将结果重置为整帧变化(第一帧、尺寸变化或不支持的格式)
+ *@date:   2026.10.18
+ *@param:  width,height:亮度图宽高  scale:亮度图相对于原始帧的缩小倍数
+ */
+void MotionDetector::resetResult(uint width, uint height, uint scale)
+{
+    result = Result();
+    result.changedRect = QRect(0,0,width*scale,height*scale);
+}
+/*
+ *@brief:  计算一个块的绝对差之和(SAD)
+ *注:SSE2使用psadbw一次得到16个像素的差值和，NEON使用vabal累加到16位再逐行扩展到32位(避免大块时溢出)，
+ *块宽不是8的倍数的部分(图像右边界)使用标量实现。
+ *@date:   2026.10.18
+ *@param:  cur,ref:当前帧和参考图中块的起始地址
+ *@param:  stride:每行的字节数
+ *@param:  width,height:块的宽高
+ *@return: uint:SAD
+ */
+uint MotionDetector::blockSad(const uchar *cur, const uchar *ref, uint stride, uint width, uint height)
+{
+    uint sum = 0;
+#if defined(MOTION_DETECT_NEON) || defined(MOTION_DETECT_SSE2)
+    const bool useSimd = ColorToRgb24::isSimdEnabled();
+#endif
+#if defined(MOTION_DETECT_SSE2)
+    __m128i acc = _mm_setzero_si128();
+#elif defined(MOTION_DETECT_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+#endif
+    for(uint y=0;y<height;y++,cur+=stride,ref+=stride)
+    {
+        uint x = 0;
+#if defined(MOTION_DETECT_SSE2)
+        for(;useSimd && x+16<=width;x+=16)
+        {
+            acc = _mm_add_epi64(acc,_mm_sad_epu8(_mm_loadu_si128((const __m128i *)(cur+x)),
+                                                 _mm_loadu_si128((const __m128i *)(ref+x))));
+        }
+        for(;useSimd && x+8<=width;x+=8)
+        {
+            acc = _mm_add_epi64(acc,_mm_sad_epu8(_mm_loadl_epi64((const __m128i *)(cur+x)),
+                                                 _mm_loadl_epi64((const __m128i *)(ref+x))));
+        }
+#elif defined(MOTION_DETECT_NEON)
+        uint16x8_t rowAcc = vdupq_n_u16(0);
+        for(;useSimd && x+16<=width;x+=16)
+        {
+            uint8x16_t a = vld1q_u8(cur+x);
+            uint8x16_t b = vld1q_u8(ref+x);
+            rowAcc = vabal_u8(rowAcc,vget_low_u8(a),vget_low_u8(b));
+            rowAcc = vabal_u8(rowAcc,vget_high_u8(a),vget_high_u8(b));
+        }
+        for(;useSimd && x+8<=width;x+=8)
+        {
+            rowAcc = vabal_u8(rowAcc,vld1_u8(cur+x),vld1_u8(ref+x));
+        }
+        acc = vpadalq_u16(acc,rowAcc);
+#endif
+        for(;x<width;x++)
+        {
+            sum += (cur[x] > ref[x])?(cur[x] - ref[x]):(ref[x] - cur[x]);
+        }
+    }
+#if defined(MOTION_DETECT_SSE2)
+    sum += _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc,8));
+#elif defined(MOTION_DETECT_NEON)
+    uint64x2_t acc64 = vpaddlq_u32(acc);
+    sum += vgetq_lane_u64(acc64,0) + vgetq_lane_u64(acc64,1);
+#endif
+    return sum;
+}
@@ -0,0 +1,84 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   基于缩小亮度图的运动(画面变化)检测，用于在静止场景下跳过软解码、上传、绘制、录像及分析等后续处理
+ *
+ *检测对象内部保存一张低分辨率的亮度参考图，每帧将当前亮度图划分为blockSize*blockSize的块，使用SIMD(SSE2 psadbw/NEON vabal)
+ *计算每个块与参考图的绝对差之和(SAD)，块内平均每像素的差值超过阈值即认为该块发生变化，输出变化块的掩码、变化比例以及
+ *变化区域的外接矩形，后续处理可以据此跳过整帧或只处理变化的区域。
+ *参考图只在变化块处更新为当前帧，未变化的块保持不变，所以缓慢的光照变化会不断累积，直到超过阈值时触发一次变化，不会被
+ *逐帧的微小差值掩盖；参考图与"后续处理最后一次处理过的画面"保持一致。
+ *亮度图默认由原始帧缩小4倍得到(frame_to_luma()，packed格式分离和4倍缩小均为SIMD实现)，主要开销是读取一遍原始帧的Y分量，
+ *块比较只针对十六分之一的像素，1080p YUYV下检测的开销约为一次完整软解码(RGB32)的五分之一，Y平面连续存储的格式更低。
+ */
+#ifndef MOTIONDETECTOR_H
+#define MOTIONDETECTOR_H
+
+#include "qglobal.h"
+#include <QByteArray>
+#include <QRect>
+#include <QMetaType>
+#include <vector>
+
+class MotionDetector
+{
+public:
+    //一帧的检测结果
+    struct Result
+    {
+        bool changed = true;//是否发生变化(变化块数>=minChangedBlocks，第一帧或尺寸变化时总为true)
+        uint changedBlocks = 0;//变化块数
+        double score = 1.0;//变化块的比例[0,1]
+        double meanDifference = 0;//整帧平均每像素的绝对差(亮度图)
+        uint blocksX = 0;//块的列数、行数
+        uint blocksY = 0;
+        QByteArray mask;//变化掩码(blocksX*blocksY，按行存储，1=变化)
+        QRect changedRect;//变化区域的外接矩形(原始帧坐标)，没有变化时为空
+    };
+
+    MotionDetector();
+
+    //块尺寸(亮度图像素，8的倍数，默认8，即原始帧中32*32的区域)
+    void setBlockSize(uint size);
+    uint blockSize() const {return blockSide;}
+    //变化阈值:块内平均每像素的亮度绝对差(默认6，需要高于传感器噪声)
+    void setThreshold(uint meanAbsDiff){threshold = meanAbsDiff;}
+    uint getThreshold() const {return threshold;}
+    //整帧判定为变化所需的最少变化块数(默认1)
+    void setMinChangedBlocks(uint count){minChangedBlocks = count?count:1;}
+    //由原始帧生成亮度图的缩小倍数(默认4，2倍和4倍为SIMD实现)
+    void setDownsample(uint downsample){lumaDownsample = downsample?downsample:1;}
+    uint downsample() const {return lumaDownsample;}
+
+    //检测原始帧(V4L2_PIX_FMT_*，rgb格式不支持，返回的结果总为变化)
+    const Result &detect(uint pixel_format,const uchar *frame,uint width,uint height);
+    //检测已经提取好的亮度图(每行连续存储)，scale为亮度图相对于原始帧的缩小倍数，用于换算changedRect
+    const Result &detectLuma(const uchar *luma,uint width,uint height,uint scale=1);
+    const Result &lastResult() const {return result;}
+    //清除参考图，下一帧总是判定为变化
+    void reset();
+
+private:
+    void resetResult(uint width,uint height,uint scale);
+    static uint blockSad(const uchar *cur,const uchar *ref,uint stride,uint width,uint height);
+
+    uint blockSide = 8;
+    uint threshold = 6;
+    uint minChangedBlocks = 1;
+    uint lumaDownsample = 4;
+
+    std::vector<uchar> lumaBuf;//由原始帧提取的亮度图
+    std::vector<uchar> reference;//参考图(尺寸与亮度图一致)
+    uint refWidth = 0;
+    uint refHeight = 0;
+    Result result;
+};
+Q_DECLARE_METATYPE(MotionDetector::Result)
+
+#endif // MOTIONDETECTOR_H
@@ -0,0 +1,375 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   无窗口的GPU帧格式转换服务(离屏渲染)
+ */
+#include "offscreenrendering.h"
+#include "colortorgb24.h"
+#include <QThread>
+#include <QTimer>
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QDebug>
+
+/*
+ *@brief:  构造
+ *注:构造时即创建转换对象，start()之前设置的参数直接作用于该对象。
+ *@date:   2026.10.18
+ *@param:  pixel_format:帧格式(V4L2_PIX_FMT_*)
+ *@param:  pixel_width:像素宽度  pixel_height:像素高度
+ *@param:  is_tv_range:TV range标识
+ *@param:  parent:父对象
+ */
+OffscreenRendering::OffscreenRendering(uint pixel_format, uint pixel_width, uint pixel_height,
+                                       bool is_tv_range, QObject *parent)
+    :QObject(parent),running(false),pendingFrameCount(0),droppedFrameCount(0)
+{
+    frameSize = ColorToRgb24::frameBytes(pixel_format,pixel_width,pixel_height);
+    if(frameSize == 0)
+    {
+        qDebug()<<"OffscreenRendering:unsupported pixel format"<<pixel_format;
+    }
+    rendering = new V4l2Rendering(pixel_format,pixel_width,pixel_height,is_tv_range);
+    //截图信号在V4l2Rendering的后台读取线程中发射，直接转发
+    connect(rendering,&V4l2Rendering::captureImageSig,this,&OffscreenRendering::convertedImageSig,
+            Qt::DirectConnection);
+    connect(rendering,&V4l2Rendering::pyramidImageSig,this,&OffscreenRendering::pyramidImageSig,
+            Qt::DirectConnection);
+}
+/*
+ *@brief:  析构
+ *@date:   2026.10.18
+ */
+OffscreenRendering::~OffscreenRendering()
+{
+    stop();
+    delete rendering;//stop()之后OpenGL资源已经随上下文释放
+}
+/*
+ *@brief:  创建离屏上下文并启动渲染线程
+ *注:QOffscreenSurface必须在GUI线程中创建和销毁，上下文创建后移动到渲染线程，之后所有OpenGL操作都在渲染线程中完成。
+ *stop()(包括启动失败)之后可以再次启动，转换对象在新的上下文中重新初始化。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@return: bool:true=启动成功
+ */
+bool OffscreenRendering::start()
+{
+    if(renderThread)
+    {
+        return true;
+    }
+    if(frameSize == 0)
+    {
+        return false;
+    }
+    surface = new QOffscreenSurface();
+    surface->create();
+    if(!surface->isValid())
+    {
+        qDebug()<<"OffscreenRendering:create offscreen surface failed";
+        delete surface;
+        surface = nullptr;
+        return false;
+    }
+    context = new QOpenGLContext();
+    context->setFormat(surface->format());
+    if(!context->create())
+    {
+        qDebug()<<"OffscreenRendering:create opengl context failed";
+        delete context;
+        context = nullptr;
+        delete surface;
+        surface = nullptr;
+        return false;
+    }
+
+    renderThread = new QThread();
+    renderWorker = new QObject();
+    renderWorker->moveToThread(renderThread);
+    context->moveToThread(renderThread);
+    rendering->moveToThread(renderThread);
+    renderThread->start();
+
+    //在渲染线程中初始化OpenGL资源，等待初始化完成
+    bool ok = false;
+    QMetaObject::invokeMethod(renderWorker,[this,&ok](){
+        if(!context->makeCurrent(surface))
+        {
+            return;
+        }
+        rendering->setDirectRenderEnabled(false);
+        rendering->initializeGL();
+        rendering->resizeGL(1,1);//不直接渲染，默认帧缓冲的视口不使用
+        pollTimer = new QTimer();
+        pollTimer->setSingleShot(true);
+        pollTimer->setInterval(2);
+        connect(pollTimer,&QTimer::timeout,renderWorker,[this](){pollReadback();});
+        context->doneCurrent();
+        ok = true;
+    },Qt::BlockingQueuedConnection);
+    if(!ok)
+    {
+        qDebug()<<"OffscreenRendering:make context current failed";
+        stop();
+        return false;
+    }
+    running = true;
+    qDebug()<<"OffscreenRendering:started,"<<context->format();
+    return true;
+}
+/*
+ *@brief:  停止渲染线程，释放OpenGL资源
+ *注:尚未渲染的帧以及尚未取回的读取结果直接丢弃。先在workerMutex内清除running，之后submitFrame()不会再向渲染线程
+ *排队，已经排队的帧在资源释放后执行时直接返回。转换对象保留(参数和信号连接不变)并移回GUI线程，其OpenGL资源随上下文
+ *的销毁释放(aboutToBeDestroyed)，之后可以再次start()。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ */
+void OffscreenRendering::stop()
+{
+    if(!renderThread)
+    {
+        return;
+    }
+    workerMutex.lock();
+    running = false;
+    workerMutex.unlock();
+    //OpenGL资源需要在上下文所在的线程中释放
+    QThread *guiThread = thread();
+    QMetaObject::invokeMethod(renderWorker,[this,guiThread](){
+        if(pollTimer)
+        {
+            delete pollTimer;
+            pollTimer = nullptr;
+        }
+        bool current = context->makeCurrent(surface);
+        rendering->moveToThread(guiThread);
+        if(current)
+        {
+            context->doneCurrent();
+        }
+        delete context;
+        context = nullptr;
+    },Qt::BlockingQueuedConnection);
+    renderThread->quit();
+    renderThread->wait();
+    workerMutex.lock();
+    delete renderWorker;
+    renderWorker = nullptr;
+    workerMutex.unlock();
+    delete renderThread;
+    renderThread = nullptr;
+    delete surface;
+    surface = nullptr;
+    pendingFrameCount = 0;
+}
+/*
+ *@brief:  设置裁剪参数
+ *注:该接口直接返回设置结果，只能在start()之前调用，启动之后使用setCropRect()。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  left_top_x,left_top_y:裁剪区域左上角坐标  width,height:裁剪区域尺寸
+ *@return: bool:true=设置成功
+ */
+bool OffscreenRendering::initCropRectParam(const uint &left_top_x, const uint &left_top_y,
+                                           const uint &width, const uint &height)
+{
+    if(renderThread)
+    {
+        return false;
+    }
+    return rendering->initCropRectParam(left_top_x,left_top_y,width,height);
+}
+/*
+ *@brief:  运行时设置裁剪区域(数字平移/变焦)，下一帧生效
+ *@date:   2026.10.18
+ *@param:  rect:裁剪区域(归一化[0,1]，左上角为原点)
+ */
+void OffscreenRendering::setCropRect(const QRectF &rect)
+{
+    invokeRender([=](){rendering->setCropRect(rect);});
+}
+/*
+ *@brief:  设置镜像参数
+ *@date:   2026.10.18
+ *@param:  hMirror:水平镜像  vMirror:垂直镜像
+ */
+void OffscreenRendering::setMirrorParam(const bool &hMirror, const bool &vMirror)
+{
+    invokeRender([=](){rendering->setMirrorParam(hMirror,vMirror);});
+}
+/*
+ *@brief:  设置旋转参数
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  rotation:旋转角度(0/90/180/270)
+ *@return: bool:true=设置成功  false=不支持的角度
+ */
+bool OffscreenRendering::setRotationParam(const uint &rotation)
+{
+    if(!V4l2Rendering::isRotationSupported(rotation))
+    {
+        return false;
+    }
+    invokeRender([=](){rendering->setRotationParam(rotation);});
+    return true;
+}
+/*
+ *@brief:  设置颜色编码参数
+ *@date:   2026.10.18
+ *@param:  ycbcr_enc:yuv转rgb的转换标准(V4L2_YCBCR_ENC_*)  is_tv_range:TV range标识
+ */
+void OffscreenRendering::setColorEncodingParam(const uint &ycbcr_enc, const bool &is_tv_range)
+{
+    invokeRender([=](){rendering->setColorEncodingParam(ycbcr_enc,is_tv_range);});
+}
+/*
+ *@brief:  设置颜色调整参数
+ *@date:   2026.10.18
+ *@param:  enableColorAdjust:是否启用颜色调整
+ *@param:  brightness:亮度  contrast:对比度  saturation:饱和度
+ */
+void OffscreenRendering::setColorAdjustParam(const bool &enableColorAdjust, const float &brightness,
+                                             const float &contrast, const float &saturation)
+{
+    invokeRender([=](){rendering->setColorAdjustParam(enableColorAdjust,brightness,contrast,saturation);});
+}
+/*
+ *@brief:  设置3D LUT(空指针表示关闭)
+ *@date:   2026.10.18
+ *@param:  lut3D:3D LUT
+ */
+void OffscreenRendering::setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D)
+{
+    invokeRender([=](){rendering->setColorLut3D(lut3D);});
+}
+/*
+ *@brief:  设置反交错参数
+ *注:离屏转换每个输入帧只输出一帧，场频输出时只输出第一场。
+ *@date:   2026.10.18
+ *@param:  mode:反交错模式  topFieldFirst:场序  fieldRate:场频输出
+ */
+void OffscreenRendering::setDeinterlaceParam(const Deinterlacer::Mode &mode, const bool &topFieldFirst,
+                                             const bool &fieldRate)
+{
+    invokeRender([=](){rendering->setDeinterlaceParam(mode,topFieldFirst,fieldRate);});
+}
+/*
+ *@brief:  设置输出尺寸
+ *注:输出尺寸小于转换后的尺寸时在GPU上缩小(FBO按输出尺寸创建)，可以减少读取的数据量。
+ *@date:   2026.10.18
+ *@param:  size:输出尺寸(无效尺寸表示原始像素帧size乘以裁剪比例)
+ */
+void OffscreenRendering::setOutputSize(const QSize &size)
+{
+    invokeRender([=](){rendering->setCaptureImageSize(size);});
+}
+/*
+ *@brief:  设置多分辨率输出的各层尺寸
+ *注:各层在一次渲染中完成(一次纹理上传)，分别异步读取后按层发射pyramidImageSig()。
+ *@date:   2026.10.18
+ *@param:  sizes:各层尺寸(从大到小，无效尺寸表示输出尺寸)，空表示关闭(恢复输出convertedImageSig)
+ */
+void OffscreenRendering::setOutputPyramid(const QVector<QSize> &sizes)
+{
+    invokeRender([=](){rendering->setOutputPyramid(sizes);});
+}
+/*
+ *@brief:  提交一帧原始数据
+ *注:数据拷贝后立即返回，调用者可以马上归还采集缓冲区。渲染线程中等待处理的帧达到MAX_PENDING_FRAMES时丢弃该帧，
+ *避免转换速度跟不上采集速度时延迟和内存不断增加。
+ *@date:   2026.10.18
+ *@param:  frame:一帧原始数据(单平面连续存储)
+ *@update: 2026.10.18
+ *@return: bool:true=已提交  false=未启动或渲染线程繁忙(丢弃)
+ */
+bool OffscreenRendering::submitFrame(const uchar *frame)
+{
+    if(!running || !frame)
+    {
+        return false;
+    }
+    if(pendingFrameCount.load(std::memory_order_relaxed) >= MAX_PENDING_FRAMES)
+    {
+        droppedFrameCount.fetch_add(1,std::memory_order_relaxed);
+        return false;
+    }
+    pendingFrameCount.fetch_add(1,std::memory_order_relaxed);
+    QByteArray data(reinterpret_cast<const char *>(frame),frameSize);
+    QMutexLocker locker(&workerMutex);
+    if(!running || !renderWorker)
+    {
+        pendingFrameCount.fetch_sub(1,std::memory_order_relaxed);
+        return false;
+    }
+    QMetaObject::invokeMethod(renderWorker,[this,data](){
+        renderFrame(data);
+        pendingFrameCount.fetch_sub(1,std::memory_order_relaxed);
+    },Qt::QueuedConnection);
+    return true;
+}
+/*
+ *@brief:  在渲染线程中执行转换对象的操作，未启动时直接执行
+ *@date:   2026.10.18
+ *@param:  func:操作
+ */
+void OffscreenRendering::invokeRender(const std::function<void()> &func)
+{
+    if(renderThread)
+    {
+        QMetaObject::invokeMethod(renderWorker,func,Qt::QueuedConnection);
+    }
+    else
+    {
+        func();
+    }
+}
+/*
+ *@brief:  渲染一帧(渲染线程)
+ *注:上传纹理、渲染到FBO并发起异步读取，读取未完成时启动定时器取回，不阻塞等待GPU。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  frame:一帧原始数据
+ */
+void OffscreenRendering::renderFrame(const QByteArray &frame)
+{
+    if(!context || !context->makeCurrent(surface))
+    {
+        return;
+    }
+    uchar *planes[1] = {reinterpret_cast<uchar *>(const_cast<char *>(frame.constData()))};
+    rendering->updateV4l2Frame(planes);
+    //设置了多分辨率输出时只输出各层，不再单独截图
+    rendering->setSingleCaptureImage(rendering->outputPyramid().isEmpty());
+    rendering->paintGL();
+    if(rendering->hasPendingReadback() && !pollTimer->isActive())
+    {
+        pollTimer->start();
+    }
+    context->doneCurrent();
+}
+/*
+ *@brief:  取回已完成的异步读取(渲染线程)
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ */
+void OffscreenRendering::pollReadback()
+{
+    if(!context || !context->makeCurrent(surface))
+    {
+        return;
+    }
+    rendering->pollReadback();
+    if(rendering->hasPendingReadback())
+    {
+        pollTimer->start();
+    }
+    context->doneCurrent();
+}
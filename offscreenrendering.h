@@ -0,0 +1,98 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   无窗口的GPU帧格式转换服务(离屏渲染)
+ *
+ *1.V4l2Rendering只能在OpenGLWidget的绘制流程中使用，录像、分析等没有窗口的模块无法使用GPU转换。该类在独立的渲染线程中
+ *创建OpenGL上下文，使用QOffscreenSurface作为绘制表面(eglfs/offscreen等平台支持时为EGL无表面上下文(EGL_KHR_surfaceless_context)，
+ *否则为pbuffer或隐藏窗口)，内部仍由V4l2Rendering完成转换，关闭直接渲染，只渲染到FBO。
+ *2.submitFrame()拷贝一帧原始数据后交给渲染线程(最多缓存MAX_PENDING_FRAMES帧，渲染线程处理不过来时拒绝新帧)，渲染线程上传纹理、
+ *渲染到FBO并发起异步读取(PBO+栅栏)，读取完成后在后台线程中翻转和转换格式，通过convertedImageSig()发射RGB32图像。
+ *3.支持V4l2Rendering的裁剪、镜像、旋转、颜色调整、3D LUT以及反交错，输出尺寸可以通过setOutputSize()缩小，也可以通过
+ *setOutputPyramid()一次输出多个尺寸。
+ *4.不依赖具体的GPU，可以在Mesa的软件光栅化(llvmpipe，LIBGL_ALWAYS_SOFTWARE=1)和QT_QPA_PLATFORM=offscreen下运行，便于测试。
+ */
+#ifndef OFFSCREENRENDERING_H
+#define OFFSCREENRENDERING_H
+
+#include "v4l2rendering.h"
+#include <QObject>
+#include <QImage>
+#include <QSize>
+#include <QByteArray>
+#include <QMutex>
+#include <functional>
+#include <atomic>
+
+//最多缓存(等待渲染)的帧数
+#define MAX_PENDING_FRAMES 2
+
+class QThread;
+class QTimer;
+class QOpenGLContext;
+class QOffscreenSurface;
+
+class OffscreenRendering : public QObject
+{
+    Q_OBJECT
+public:
+    explicit OffscreenRendering(uint pixel_format,uint pixel_width,uint pixel_height,
+                                bool is_tv_range = true,QObject *parent = nullptr);
+    ~OffscreenRendering();
+
+    //创建离屏上下文并启动渲染线程(需要在GUI线程中调用)
+    bool start();
+    void stop();
+    bool isRunning(){return renderThread != nullptr;}
+
+    //转换参数(含义与V4l2Rendering一致)，initCropRectParam()需要在start()之前设置，运行时使用setCropRect()
+    bool initCropRectParam(const uint &left_top_x,const uint &left_top_y,
+                           const uint &width,const uint &height);
+    void setCropRect(const QRectF &rect);
+    void setMirrorParam(const bool &hMirror,const bool &vMirror);
+    bool setRotationParam(const uint &rotation);
+    void setColorEncodingParam(const uint &ycbcr_enc,const bool &is_tv_range);
+    void setColorAdjustParam(const bool &enableColorAdjust,const float &brightness,
+                             const float &contrast,const float &saturation);
+    void setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D);
+    void setDeinterlaceParam(const Deinterlacer::Mode &mode,const bool &topFieldFirst,const bool &fieldRate=false);
+    //输出尺寸(无效尺寸表示原始像素帧size乘以裁剪比例)
+    void setOutputSize(const QSize &size);
+    //多分辨率输出的各层尺寸(从大到小)，设置后每帧只输出各层(pyramidImageSig)，不再发射convertedImageSig
+    void setOutputPyramid(const QVector<QSize> &sizes);
+
+    //提交一帧原始数据(拷贝)，渲染线程处理不过来时返回false(该帧被丢弃)
+    bool submitFrame(const uchar *frame);
+    uint droppedFrames(){return droppedFrameCount.load(std::memory_order_relaxed);}
+
+signals:
+    //转换完成的图像(RGB32)，在后台线程中发射，连接到GUI对象时自动排队到GUI线程
+    void convertedImageSig(const QImage &image);
+    //多分辨率输出的第level层(RGB32)，同样在后台线程中发射
+    void pyramidImageSig(uint level,const QImage &image);
+
+private:
+    void invokeRender(const std::function<void()> &func);
+    void renderFrame(const QByteArray &frame);
+    void pollReadback();
+
+    uint frameSize = 0;//一帧原始数据的字节数
+    V4l2Rendering *rendering = nullptr;//转换处理(运行期间只在渲染线程中访问，stop()后移回GUI线程)
+    QOffscreenSurface *surface = nullptr;
+    QOpenGLContext *context = nullptr;
+    QThread *renderThread = nullptr;
+    QObject *renderWorker = nullptr;//渲染线程中的任务接收对象
+    QMutex workerMutex;//保护采集线程对renderWorker的访问(与stop()互斥)
+    std::atomic<bool> running;//可以提交帧(stop()释放资源之前先清除)
+    QTimer *pollTimer = nullptr;//异步读取未完成时定时取回
+    std::atomic<uint> pendingFrameCount;
+    std::atomic<uint> droppedFrameCount;
+};
+
+#endif // OFFSCREENRENDERING_H
@@ -10,6 +10,7 @@
  *@brief:   继承自QOpenGLWidget，使用openglapi渲染显示
  */
 #include "openglwidget.h"
+#include "colortorgb24.h"
 #include <QTimer>
 #include <QFile>
 
@@ -23,6 +24,8 @@ OpenGLWidget::OpenGLWidget(uint pixel_format, uint pixel_width, uint pixel_heigh
     : QOpenGLWidget(parent),v4l2Rendering(new V4l2Rendering(pixel_format,pixel_width,pixel_height,is_tv_range))
 {
     connect(v4l2Rendering,&V4l2Rendering::captureImageSig,this,&OpenGLWidget::captureImageSig);
+    connect(v4l2Rendering,&V4l2Rendering::pyramidImageSig,this,&OpenGLWidget::pyramidImageSig);
+    frameMailbox.setFrameBytes(ColorToRgb24::frameBytes(pixel_format,pixel_width,pixel_height));
 }
 
 OpenGLWidget::~OpenGLWidget()
@@ -42,6 +45,24 @@ void OpenGLWidget::setSingleCaptureImage(bool on)
 {
     v4l2Rendering->setSingleCaptureImage(on);
 }
+/*
+ *@brief:  设置连拍采集image的帧数
+ *@date:   2026.10.18
+ *@param:  count:接下来需要采集的帧数，0=关闭
+ */
+void OpenGLWidget::setCaptureImageCount(uint count)
+{
+    v4l2Rendering->setCaptureImageCount(count);
+}
+/*
+ *@brief:  设置多分辨率输出的各层尺寸
+ *@date:   2026.10.18
+ *@param:  sizes:各层尺寸(从大到小，无效尺寸表示原始像素帧size乘以裁剪比例)，空表示关闭
+ */
+void OpenGLWidget::setOutputPyramid(const QVector<QSize> &sizes)
+{
+    v4l2Rendering->setOutputPyramid(sizes);
+}
 /*
  *@brief:  设置镜像参数
  *@date:   2025.08.14
@@ -52,11 +73,22 @@ void OpenGLWidget::setMirrorParam(const bool &hMirror, const bool &vMirror)
 {
     v4l2Rendering->setMirrorParam(hMirror,vMirror);
 }
+/*
+ *@brief:  设置旋转参数
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  rotation:顺时针旋转角度(0/90/180/270)
+ *@return: bool:true=设置成功  false=不支持的角度
+ */
+bool OpenGLWidget::setRotationParam(const uint &rotation)
+{
+    return v4l2Rendering->setRotationParam(rotation);
+}
 /*
  *@brief:  初始化裁剪参数
- *注:该接口如果需要使用，必须在initializeGL()之前调用，即QOpenGLWidget组件显示之前调用，不支持动态调节裁剪参数。
- *之所以不支持动态调节，一是这种需求很少，二是静态设置方便离屏渲染Image的处理，FBO的size可以设置成固定的，不用来回改。
+ *注:支持在显示之后调用(离屏渲染使用按尺寸等级复用的FBO池)，运行时平滑调节见setCropRect()/setDigitalZoom()。
  *@date:   2025.08.22
+ *@update: 2026.10.18
  *@param:  left_top_x,left_top_y:裁剪区域的左顶点,不可以超过真实图像宽高
  *@param:  width,height:裁剪区域的宽高,不可以超过真实图像宽高
  *@return: bool:true=初始化成功
@@ -64,7 +96,46 @@ void OpenGLWidget::setMirrorParam(const bool &hMirror, const bool &vMirror)
 bool OpenGLWidget::initCropRectParam(const uint &left_top_x, const uint &left_top_y,
                                     const uint &width, const uint &height)
 {
-    return v4l2Rendering->initCropRectParam(left_top_x,left_top_y,width,height);
+    bool ok = v4l2Rendering->initCropRectParam(left_top_x,left_top_y,width,height);
+    update();
+    return ok;
+}
+/*
+ *@brief:  设置裁剪区域(数字平移)
+ *@date:   2026.10.18
+ *@param:  rect:裁剪区域(归一化[0,1]，左上角为原点)
+ *@param:  duration:过渡时长(ms)，0表示立即生效
+ *@return: bool:true=设置成功
+ */
+bool OpenGLWidget::setCropRect(const QRectF &rect, int duration)
+{
+    bool ok = v4l2Rendering->setCropRect(rect,duration);
+    update();//视频暂停时也能看到变化，过渡动画期间由paintGL()保持刷新
+    return ok;
+}
+/*
+ *@brief:  数字变焦
+ *@date:   2026.10.18
+ *@param:  zoom:放大倍数(>=1)
+ *@param:  center:画面中心(归一化[0,1]，左上角为原点)
+ *@param:  duration:过渡时长(ms)，0表示立即生效
+ *@return: bool:true=设置成功
+ */
+bool OpenGLWidget::setDigitalZoom(const float &zoom, const QPointF &center, int duration)
+{
+    bool ok = v4l2Rendering->setDigitalZoom(zoom,center,duration);
+    update();
+    return ok;
+}
+/*
+ *@brief:  设置颜色编码参数(转换标准和量化范围)，通常使用采集模块从驱动获取的参数
+ *@date:   2026.10.18
+ *@param:  ycbcr_enc:转换标准(V4L2_YCBCR_ENC_601/V4L2_YCBCR_ENC_709/V4L2_YCBCR_ENC_BT2020)
+ *@param:  is_tv_range:true=TV Range   false=FULL Range
+ */
+void OpenGLWidget::setColorEncodingParam(const uint &ycbcr_enc, const bool &is_tv_range)
+{
+    v4l2Rendering->setColorEncodingParam(ycbcr_enc,is_tv_range);
 }
 /*
  *@brief:  设置颜色调整参数
@@ -79,11 +150,42 @@ void OpenGLWidget::setColorAdjustParam(const bool &enableColorAdjust, const floa
 {
     v4l2Rendering->setColorAdjustParam(enableColorAdjust,brightness,contrast,saturation);
 }
+/*
+ *@brief:  设置3D LUT颜色分级
+ *@date:   2026.10.18
+ *@param:  lut3D:已加载的3D LUT，空指针或无效的LUT表示关闭颜色分级
+ */
+void OpenGLWidget::setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D)
+{
+    v4l2Rendering->setColorLut3D(lut3D);
+}
+/*
+ *@brief:  设置反交错参数
+ *@date:   2026.10.18
+ *@param:  mode:反交错模式(Deinterlacer::Mode)
+ *@param:  topFieldFirst:true=顶场优先(PAL)  false=底场优先(NTSC)
+ *@param:  fieldRate:true=场频输出(Bob/MotionAdaptive)
+ */
+void OpenGLWidget::setDeinterlaceParam(const Deinterlacer::Mode &mode, const bool &topFieldFirst, const bool &fieldRate)
+{
+    v4l2Rendering->setDeinterlaceParam(mode,topFieldFirst,fieldRate);
+}
+/*
+ *@brief:  设置是否通过PBO异步上传帧数据
+ *注:在OpenGL初始化(initializeGL)时创建PBO，所以需要在部件显示之前设置，不支持PBO的环境(OpenGL ES 2.0)自动直接上传。
+ *@date:   2026.10.18
+ *@param:  enabled:true=PBO上传  false=直接从内存上传
+ */
+void OpenGLWidget::setPboUploadEnabled(bool enabled)
+{
+    v4l2Rendering->setPboUploadEnabled(enabled);
+}
 /*
  *@brief:  该接口仅用于功能测试，通过读取yuv文件测试该类的渲染功能
  *注:可使用FFmpeg工具将mp4格式文件转换成yuv文件进行测试，例如“ffmpeg -i test.mp4 -an -pix_fmt nv12 -s 1024x576 nv12.yuv”
  *FFmpeg支持的格式可通过“ffmpeg -pix_fmts”列出。
  *@date:   2024.05.17
+ *@update: 2026.10.18
  *@param:  file:需要读取的yuv文件
  *@param:  pixelFormat:yuv的帧格式
  *@param:  pixelWidth,pixelHeight:帧宽度和高度
@@ -95,7 +197,9 @@ void OpenGLWidget::readYuvFileTest(QString file, uint pixelFormat, uint pixelWid
     {
         QTimer *readYuvFileTimer = new QTimer(this);
         readYuvFileTimer->setInterval(40);
-        connect(readYuvFileTimer,&QTimer::timeout,this,[this,yuvFile,pixelFormat,pixelWidth,pixelHeight](){
+        //帧数据放入邮箱时拷贝，读取到同一块常驻的缓冲区中即可
+        QSharedPointer<QByteArray> array(new QByteArray());
+        connect(readYuvFileTimer,&QTimer::timeout,this,[this,yuvFile,array,pixelFormat,pixelWidth,pixelHeight](){
             if(yuvFile->atEnd())
             {
                 yuvFile->seek(0);
@@ -103,25 +207,28 @@ void OpenGLWidget::readYuvFileTest(QString file, uint pixelFormat, uint pixelWid
             if(pixelFormat == V4L2_PIX_FMT_YUYV ||
                     pixelFormat == V4L2_PIX_FMT_YVYU)
             {
-                QByteArray array = yuvFile->read(pixelWidth*pixelHeight*2);
+                array->resize(pixelWidth*pixelHeight*2);
+                yuvFile->read(array->data(),array->size());
                 uchar *yuvFrame[1];
-                yuvFrame[0] = (uchar *)array.data();
+                yuvFrame[0] = (uchar *)array->data();
                 updateV4l2FrameSlot(yuvFrame);
             }
             else if(pixelFormat == V4L2_PIX_FMT_NV12 ||
                     pixelFormat == V4L2_PIX_FMT_NV21)
             {
-                QByteArray array = yuvFile->read(pixelWidth*pixelHeight*3/2);
+                array->resize(pixelWidth*pixelHeight*3/2);
+                yuvFile->read(array->data(),array->size());
                 uchar *yuvFrame[1];
-                yuvFrame[0] = (uchar *)array.data();
+                yuvFrame[0] = (uchar *)array->data();
                 updateV4l2FrameSlot(yuvFrame);
             }
             else if(pixelFormat == V4L2_PIX_FMT_YUV420 ||
                     pixelFormat == V4L2_PIX_FMT_YVU420)
             {
-                QByteArray array = yuvFile->read(pixelWidth*pixelHeight*3/2);
+                array->resize(pixelWidth*pixelHeight*3/2);
+                yuvFile->read(array->data(),array->size());
                 uchar *yuvFrame[1];
-                yuvFrame[0] = (uchar *)array.data();
+                yuvFrame[0] = (uchar *)array->data();
                 updateV4l2FrameSlot(yuvFrame);
             }
         });
@@ -152,26 +259,95 @@ void OpenGLWidget::resizeGL(int w, int h)
 }
 /*
  *@brief:  渲染OpenGL场景
- *widget更新时会被调用
+ *widget更新时会被调用，先上传邮箱中最新的一帧(每次显示最多上传一次)
  *@date:   2024.05.17
+ *@update: 2026.10.18
  */
 void OpenGLWidget::paintGL()
 {
+    uploadMailboxFrame();
     v4l2Rendering->paintGL();
+    scheduleReadbackPoll();
+    //裁剪区域过渡动画期间持续刷新
+    if(v4l2Rendering->isCropAnimating())
+    {
+        update();
+    }
+}
+/*
+ *@brief:  截图的异步读取尚未完成时，定时(2ms)检查并取回
+ *注:视频暂停或最后一帧截图时不会再有paintGL()，由定时器保证截图最终被发射，检查本身不会阻塞。
+ *@date:   2026.10.18
+ */
+void OpenGLWidget::scheduleReadbackPoll()
+{
+    if(readbackPollScheduled || !v4l2Rendering->hasPendingReadback())
+    {
+        return;
+    }
+    readbackPollScheduled = true;
+    QTimer::singleShot(2,this,[this](){
+        readbackPollScheduled = false;
+        makeCurrent();
+        v4l2Rendering->pollReadback();
+        doneCurrent();
+        scheduleReadbackPoll();
+    });
 }
 /*
  *@brief:  更新(渲染)V4l2帧数据
+ *注:帧放入邮箱后请求刷新，纹理在绘制时上传(见postV4l2Frame())。
  *@date:   2024.05.17
+ *@update: 2026.10.18
  *@param:  v4l2Frame:v4l2帧二维指针(指针数组[planes])，planes根据pixelFormat格式在内部自动确定
  *对于多平面planes每一个元素对应着一个平面(不连续)，对于单平面v4l2Frame[0]即完整的v4l2数据
  */
 void OpenGLWidget::updateV4l2FrameSlot(uchar **v4l2Frame)
 {
-    if(!this->isVisible())
+    postV4l2Frame(v4l2Frame);
+}
+/*
+ *@brief:  放入最新的一帧
+ *注:线程安全(一个写线程)，可以通过Qt::DirectConnection在采集线程中直接调用，不再经过排队信号，GUI线程繁忙时不会堆积事件。
+ *邮箱之前为空时才请求一次刷新，刷新(paintGL())时取走最新的一帧上传纹理，之间被覆盖的帧只计数不上传。帧数据拷贝到邮箱
+ *的槽中(采集模块发射后立即归还缓冲帧，驱动可能在绘制之前重新填充)，调用返回后原始帧即可被覆盖。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  v4l2Frame:v4l2帧二维指针(指针数组[planes])，渲染只使用连续存储的v4l2Frame[0]
+ */
+void OpenGLWidget::postV4l2Frame(uchar **v4l2Frame)
+{
+    if(frameMailbox.post(v4l2Frame,1))
+    {
+        QMetaObject::invokeMethod(this,[this](){update();},Qt::QueuedConnection);
+    }
+}
+/*
+ *@brief:  取走邮箱中最新的一帧上传纹理(在paintGL()中调用，上下文已经是当前的)
+ *@date:   2026.10.18
+ */
+void OpenGLWidget::uploadMailboxFrame()
+{
+    uchar *v4l2Frame[1] = {nullptr};
+    if(!frameMailbox.take(v4l2Frame,1))
     {
         return;
     }
-
     v4l2Rendering->updateV4l2Frame(v4l2Frame);
-    update();
+    //场频输出:按照实测的帧间隔，在半帧之后切换到第二场并重绘
+    const qint64 frameInterval = frameTimer.isValid()?frameTimer.restart():0;
+    if(!frameTimer.isValid())
+    {
+        frameTimer.start();
+    }
+    const quint64 serial = ++frameSerial;
+    if(frameInterval > 0 && v4l2Rendering->isFieldRateOutput())
+    {
+        QTimer::singleShot(int(frameInterval/2),this,[this,serial](){
+            if(serial == frameSerial && v4l2Rendering->showSecondField())
+            {
+                update();
+            }
+        });
+    }
 }
@@ -22,7 +22,9 @@
 #define OPENGLWIDGET_H
 
 #include "v4l2rendering.h"
+#include "framemailbox.h"
 #include <QOpenGLWidget>
+#include <QElapsedTimer>
 
 class OpenGLWidget : public QOpenGLWidget
 {
@@ -35,13 +37,33 @@ public:
     //初始化裁剪参数
     bool initCropRectParam(const uint &left_top_x,const uint &left_top_y,
                           const uint &width,const uint &height);
+    //运行时设置裁剪区域/数字变焦(数字PTZ)，duration>0时平滑过渡
+    bool setCropRect(const QRectF &rect,int duration=0);
+    bool setDigitalZoom(const float &zoom,const QPointF &center,int duration=0);
     //设置开启/关闭单次采集Image
     void setSingleCaptureImage(bool on);
+    //设置连拍:接下来的count帧都采集Image(异步读取，按帧的顺序发射captureImageSig)
+    void setCaptureImageCount(uint count);
     //设置镜像参数
     void setMirrorParam(const bool &hMirror,const bool &vMirror);
+    //设置旋转参数(顺时针0/90/180/270)
+    bool setRotationParam(const uint &rotation);
+    //设置颜色编码参数(转换标准和量化范围)
+    void setColorEncodingParam(const uint &ycbcr_enc,const bool &is_tv_range);
     //设置颜色调整参数
     void setColorAdjustParam(const bool &enableColorAdjust,const float &brightness,
                              const float &contrast,const float &saturation);
+    //设置3D LUT颜色分级(空指针表示关闭)
+    void setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D);
+    //设置反交错参数(场频输出时每一帧在半帧之后显示第二场)
+    void setDeinterlaceParam(const Deinterlacer::Mode &mode,const bool &topFieldFirst,const bool &fieldRate);
+    //设置多分辨率输出的各层尺寸(每个新帧按层发射pyramidImageSig，空表示关闭)
+    void setOutputPyramid(const QVector<QSize> &sizes);
+    //设置是否通过PBO异步上传帧数据(默认开启，需要在显示之前设置)
+    void setPboUploadEnabled(bool enabled);
+    //放入最新的一帧(可在采集线程中直接调用)，绘制时取走上传，未来得及绘制的帧被覆盖(计为过时帧)
+    void postV4l2Frame(uchar **v4l2Frame);
+    quint64 staleFrameCount(){return frameMailbox.staleCount();}
     //该接口仅用于功能测试，通过读取yuv文件测试该类的渲染功能
     void readYuvFileTest(QString file,uint pixelFormat,
                          uint pixelWidth,uint pixelHeight);
@@ -54,9 +76,20 @@ protected:
 private:
     //负责渲染处理v4l2帧数据
     V4l2Rendering *v4l2Rendering = nullptr;
+    //采集线程与GUI线程之间的单槽邮箱(只保留最新一帧)
+    FrameMailbox frameMailbox;
+    //场频输出:帧间隔计时及帧序号(避免第二场的定时器作用到新的一帧)
+    QElapsedTimer frameTimer;
+    quint64 frameSerial = 0;
+    //截图异步读取尚未完成时定时取回(没有新帧触发paintGL的情况)
+    bool readbackPollScheduled = false;
+
+    void scheduleReadbackPoll();
+    void uploadMailboxFrame();
 
 signals:
     void captureImageSig(const QImage &image);
+    void pyramidImageSig(uint level,const QImage &image);
 
 public slots:
     void updateV4l2FrameSlot(uchar **v4l2Frame);
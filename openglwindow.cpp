@@ -0,0 +1,285 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   继承自QOpenGLWindow，直接渲染到窗口表面的V4l2Rendering宿主
+ */
+#include "openglwindow.h"
+#include "colortorgb24.h"
+#include <QTimer>
+
+/*
+ *@brief:  构造函数
+ *注:NoPartialUpdate模式下paintGL()直接绘制到窗口表面(每次完整重绘)，不经过中间FBO。
+ *@date:   2026.10.18
+ *@param:  pixel_format:帧格式(使用v4l2的宏)
+ *@param:  pixel_width:像素宽度(需要确保为偶数)  pixel_height:像素高度
+ *@param:  is_tv_range:TV range标识
+ *@param:  parent:父窗口，嵌入控件界面时使用QWidget::createWindowContainer()
+ */
+OpenGLWindow::OpenGLWindow(uint pixel_format, uint pixel_width, uint pixel_height, bool is_tv_range, QWindow *parent)
+    : QOpenGLWindow(QOpenGLWindow::NoPartialUpdate,parent),
+      v4l2Rendering(new V4l2Rendering(pixel_format,pixel_width,pixel_height,is_tv_range))
+{
+    connect(v4l2Rendering,&V4l2Rendering::captureImageSig,this,&OpenGLWindow::captureImageSig);
+    connect(v4l2Rendering,&V4l2Rendering::pyramidImageSig,this,&OpenGLWindow::pyramidImageSig);
+    frameMailbox.setFrameBytes(ColorToRgb24::frameBytes(pixel_format,pixel_width,pixel_height));
+}
+
+OpenGLWindow::~OpenGLWindow()
+{
+    makeCurrent();
+    if(v4l2Rendering)
+    {
+        delete v4l2Rendering;
+    }
+    doneCurrent();
+}
+/*
+ *@brief:  初始化裁剪参数
+ *@date:   2026.10.18
+ *@param:  left_top_x,left_top_y:裁剪区域的左顶点,不可以超过真实图像宽高
+ *@param:  width,height:裁剪区域的宽高,不可以超过真实图像宽高
+ *@return: bool:true=初始化成功
+ */
+bool OpenGLWindow::initCropRectParam(const uint &left_top_x, const uint &left_top_y,
+                                     const uint &width, const uint &height)
+{
+    bool ok = v4l2Rendering->initCropRectParam(left_top_x,left_top_y,width,height);
+    update();
+    return ok;
+}
+/*
+ *@brief:  设置裁剪区域(数字平移)
+ *@date:   2026.10.18
+ *@param:  rect:裁剪区域(归一化[0,1]，左上角为原点)
+ *@param:  duration:过渡时长(ms)，0表示立即生效
+ *@return: bool:true=设置成功
+ */
+bool OpenGLWindow::setCropRect(const QRectF &rect, int duration)
+{
+    bool ok = v4l2Rendering->setCropRect(rect,duration);
+    update();
+    return ok;
+}
+/*
+ *@brief:  数字变焦
+ *@date:   2026.10.18
+ *@param:  zoom:放大倍数(>=1)
+ *@param:  center:画面中心(归一化[0,1]，左上角为原点)
+ *@param:  duration:过渡时长(ms)，0表示立即生效
+ *@return: bool:true=设置成功
+ */
+bool OpenGLWindow::setDigitalZoom(const float &zoom, const QPointF &center, int duration)
+{
+    bool ok = v4l2Rendering->setDigitalZoom(zoom,center,duration);
+    update();
+    return ok;
+}
+/*
+ *@brief:  设置开启/关闭单次采集image
+ *@date:   2026.10.18
+ *@param:  on:true=开启  false=关闭
+ */
+void OpenGLWindow::setSingleCaptureImage(bool on)
+{
+    v4l2Rendering->setSingleCaptureImage(on);
+}
+/*
+ *@brief:  设置连拍采集image的帧数
+ *@date:   2026.10.18
+ *@param:  count:接下来需要采集的帧数，0=关闭
+ */
+void OpenGLWindow::setCaptureImageCount(uint count)
+{
+    v4l2Rendering->setCaptureImageCount(count);
+}
+/*
+ *@brief:  设置镜像参数
+ *@date:   2026.10.18
+ *@param:  hMirror:true=水平镜像
+ *@param:  vMirror:true=垂直镜像
+ */
+void OpenGLWindow::setMirrorParam(const bool &hMirror, const bool &vMirror)
+{
+    v4l2Rendering->setMirrorParam(hMirror,vMirror);
+}
+/*
+ *@brief:  设置旋转参数
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  rotation:顺时针旋转角度(0/90/180/270)
+ *@return: bool:true=设置成功  false=不支持的角度
+ */
+bool OpenGLWindow::setRotationParam(const uint &rotation)
+{
+    return v4l2Rendering->setRotationParam(rotation);
+}
+/*
+ *@brief:  设置颜色编码参数(转换标准和量化范围)
+ *@date:   2026.10.18
+ *@param:  ycbcr_enc:转换标准(V4L2_YCBCR_ENC_601/V4L2_YCBCR_ENC_709/V4L2_YCBCR_ENC_BT2020)
+ *@param:  is_tv_range:true=TV Range   false=FULL Range
+ */
+void OpenGLWindow::setColorEncodingParam(const uint &ycbcr_enc, const bool &is_tv_range)
+{
+    v4l2Rendering->setColorEncodingParam(ycbcr_enc,is_tv_range);
+}
+/*
+ *@brief:  设置颜色调整参数
+ *@date:   2026.10.18
+ *@param:  enableColorAdjust:是否使能基础颜色调整
+ *@param:  brightness:亮度调整  contrast:对比度调整  saturation:饱和度调整
+ */
+void OpenGLWindow::setColorAdjustParam(const bool &enableColorAdjust, const float &brightness,
+                                       const float &contrast, const float &saturation)
+{
+    v4l2Rendering->setColorAdjustParam(enableColorAdjust,brightness,contrast,saturation);
+}
+/*
+ *@brief:  设置3D LUT颜色分级
+ *@date:   2026.10.18
+ *@param:  lut3D:已加载的3D LUT，空指针或无效的LUT表示关闭颜色分级
+ */
+void OpenGLWindow::setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D)
+{
+    v4l2Rendering->setColorLut3D(lut3D);
+}
+/*
+ *@brief:  设置反交错参数
+ *@date:   2026.10.18
+ *@param:  mode:反交错模式(Deinterlacer::Mode)
+ *@param:  topFieldFirst:true=顶场优先(PAL)  false=底场优先(NTSC)
+ *@param:  fieldRate:true=场频输出(Bob/MotionAdaptive)
+ */
+void OpenGLWindow::setDeinterlaceParam(const Deinterlacer::Mode &mode, const bool &topFieldFirst, const bool &fieldRate)
+{
+    v4l2Rendering->setDeinterlaceParam(mode,topFieldFirst,fieldRate);
+}
+/*
+ *@brief:  设置多分辨率输出的各层尺寸
+ *@date:   2026.10.18
+ *@param:  sizes:各层尺寸(从大到小)，空表示关闭
+ */
+void OpenGLWindow::setOutputPyramid(const QVector<QSize> &sizes)
+{
+    v4l2Rendering->setOutputPyramid(sizes);
+}
+/*
+ *@brief:  设置是否通过PBO异步上传帧数据(在initializeGL()时创建PBO，需要在窗口显示之前设置)
+ *@date:   2026.10.18
+ *@param:  enabled:true=PBO上传  false=直接从内存上传
+ */
+void OpenGLWindow::setPboUploadEnabled(bool enabled)
+{
+    v4l2Rendering->setPboUploadEnabled(enabled);
+}
+/*
+ *@brief:  建立OpenGL的资源和状态
+ *@date:   2026.10.18
+ */
+void OpenGLWindow::initializeGL()
+{
+    v4l2Rendering->initializeGL();
+}
+/*
+ *@brief:  设置OpenGL的视口
+ *@date:   2026.10.18
+ *@param:  w:宽  h:高
+ */
+void OpenGLWindow::resizeGL(int w, int h)
+{
+    v4l2Rendering->resizeGL(w,h);
+}
+/*
+ *@brief:  渲染OpenGL场景
+ *注:绘制目标为窗口表面，paintGL()返回后由QOpenGLWindow直接交换缓冲，没有合成的纹理blit。
+ *@date:   2026.10.18
+ */
+void OpenGLWindow::paintGL()
+{
+    uploadMailboxFrame();
+    v4l2Rendering->paintGL();
+    scheduleReadbackPoll();
+    //裁剪区域过渡动画期间持续刷新
+    if(v4l2Rendering->isCropAnimating())
+    {
+        update();
+    }
+}
+/*
+ *@brief:  截图的异步读取尚未完成时，定时(2ms)检查并取回
+ *@date:   2026.10.18
+ */
+void OpenGLWindow::scheduleReadbackPoll()
+{
+    if(readbackPollScheduled || !v4l2Rendering->hasPendingReadback())
+    {
+        return;
+    }
+    readbackPollScheduled = true;
+    QTimer::singleShot(2,this,[this](){
+        readbackPollScheduled = false;
+        makeCurrent();
+        v4l2Rendering->pollReadback();
+        doneCurrent();
+        scheduleReadbackPoll();
+    });
+}
+/*
+ *@brief:  更新(渲染)V4l2帧数据
+ *@date:   2026.10.18
+ *@param:  v4l2Frame:v4l2帧二维指针(指针数组[planes])
+ */
+void OpenGLWindow::updateV4l2FrameSlot(uchar **v4l2Frame)
+{
+    postV4l2Frame(v4l2Frame);
+}
+/*
+ *@brief:  放入最新的一帧
+ *注:线程安全(一个写线程)，可以在采集线程中直接调用，邮箱之前为空时才请求一次刷新。帧数据拷贝到邮箱的槽中。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  v4l2Frame:v4l2帧二维指针(指针数组[planes])，渲染只使用连续存储的v4l2Frame[0]
+ */
+void OpenGLWindow::postV4l2Frame(uchar **v4l2Frame)
+{
+    if(frameMailbox.post(v4l2Frame,1))
+    {
+        QMetaObject::invokeMethod(this,[this](){update();},Qt::QueuedConnection);
+    }
+}
+/*
+ *@brief:  取走邮箱中最新的一帧上传纹理(在paintGL()中调用，上下文已经是当前的)
+ *@date:   2026.10.18
+ */
+void OpenGLWindow::uploadMailboxFrame()
+{
+    uchar *v4l2Frame[1] = {nullptr};
+    if(!frameMailbox.take(v4l2Frame,1))
+    {
+        return;
+    }
+    v4l2Rendering->updateV4l2Frame(v4l2Frame);
+    //场频输出:按照实测的帧间隔，在半帧之后切换到第二场并重绘
+    const qint64 frameInterval = frameTimer.isValid()?frameTimer.restart():0;
+    if(!frameTimer.isValid())
+    {
+        frameTimer.start();
+    }
+    const quint64 serial = ++frameSerial;
+    if(frameInterval > 0 && v4l2Rendering->isFieldRateOutput())
+    {
+        QTimer::singleShot(int(frameInterval/2),this,[this,serial](){
+            if(serial == frameSerial && v4l2Rendering->showSecondField())
+            {
+                update();
+            }
+        });
+    }
+}
@@ -0,0 +1,93 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   继承自QOpenGLWindow，直接渲染到窗口表面的V4l2Rendering宿主
+ *
+ *1.QOpenGLWidget先渲染到自己的FBO，再由Qt把该纹理合成到顶层窗口的后备存储(backing store)，1080p下每一帧多一次全屏的纹理
+ *blit。该窗口使用QOpenGLWindow::NoPartialUpdate，V4l2Rendering直接绘制到窗口表面(默认帧缓冲)，没有中间FBO和合成这一步。
+ *2.嵌入到控件界面时通过QWidget::createWindowContainer(window,parent)得到容器控件，容器对应一个原生子窗口，
+ *与其他控件的层叠、半透明覆盖等受限于原生窗口(视频画面上不要叠加普通控件)。
+ *3.接口与OpenGLWidget一致(邮箱传帧、截图、多分辨率输出、数字变焦等)。
+ */
+#ifndef OPENGLWINDOW_H
+#define OPENGLWINDOW_H
+
+#include "v4l2rendering.h"
+#include "framemailbox.h"
+#include <QOpenGLWindow>
+#include <QElapsedTimer>
+
+class OpenGLWindow : public QOpenGLWindow
+{
+    Q_OBJECT
+public:
+    explicit OpenGLWindow(uint pixel_format,uint pixel_width,
+                          uint pixel_height,bool is_tv_range=true,QWindow *parent = nullptr);
+    ~OpenGLWindow();
+
+    //初始化裁剪参数
+    bool initCropRectParam(const uint &left_top_x,const uint &left_top_y,
+                           const uint &width,const uint &height);
+    //运行时设置裁剪区域/数字变焦(数字PTZ)，duration>0时平滑过渡
+    bool setCropRect(const QRectF &rect,int duration=0);
+    bool setDigitalZoom(const float &zoom,const QPointF &center,int duration=0);
+    //设置开启/关闭单次采集Image
+    void setSingleCaptureImage(bool on);
+    //设置连拍:接下来的count帧都采集Image
+    void setCaptureImageCount(uint count);
+    //设置镜像参数
+    void setMirrorParam(const bool &hMirror,const bool &vMirror);
+    //设置旋转参数(顺时针0/90/180/270)
+    bool setRotationParam(const uint &rotation);
+    //设置颜色编码参数(转换标准和量化范围)
+    void setColorEncodingParam(const uint &ycbcr_enc,const bool &is_tv_range);
+    //设置颜色调整参数
+    void setColorAdjustParam(const bool &enableColorAdjust,const float &brightness,
+                             const float &contrast,const float &saturation);
+    //设置3D LUT颜色分级(空指针表示关闭)
+    void setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D);
+    //设置反交错参数(场频输出时每一帧在半帧之后显示第二场)
+    void setDeinterlaceParam(const Deinterlacer::Mode &mode,const bool &topFieldFirst,const bool &fieldRate);
+    //设置多分辨率输出的各层尺寸(空表示关闭)
+    void setOutputPyramid(const QVector<QSize> &sizes);
+    //设置是否通过PBO异步上传帧数据(需要在显示之前设置)
+    void setPboUploadEnabled(bool enabled);
+    //放入最新的一帧(可在采集线程中直接调用)
+    void postV4l2Frame(uchar **v4l2Frame);
+    quint64 staleFrameCount(){return frameMailbox.staleCount();}
+
+protected:
+    virtual void initializeGL();
+    virtual void resizeGL(int w,int h);
+    virtual void paintGL();
+
+private:
+    //负责渲染处理v4l2帧数据
+    V4l2Rendering *v4l2Rendering = nullptr;
+    //采集线程与GUI线程之间的单槽邮箱(只保留最新一帧)
+    FrameMailbox frameMailbox;
+    //场频输出:帧间隔计时及帧序号
+    QElapsedTimer frameTimer;
+    quint64 frameSerial = 0;
+    //截图异步读取尚未完成时定时取回
+    bool readbackPollScheduled = false;
+
+    void scheduleReadbackPoll();
+    void uploadMailboxFrame();
+
+signals:
+    void captureImageSig(const QImage &image);
+    void pyramidImageSig(uint level,const QImage &image);
+
+public slots:
+    void updateV4l2FrameSlot(uchar **v4l2Frame);
+
+};
+
+#endif // OPENGLWINDOW_H
@@ -26,13 +26,14 @@ PixmapWidget::PixmapWidget(QWidget *parent) : PARENT_WIDGET(parent)
  *注:可使用FFmpeg工具将mp4格式文件转换成yuv文件进行测试，例如“ffmpeg -i test.mp4 -an -pix_fmt nv12 -s 1024x576 nv12.yuv”
  *FFmpeg支持的格式可通过“ffmpeg -pix_fmts”列出。
  *@date:   2024.04.26
+ *@update: 2026.10.18
  *@param:  file:需要读取的yuv文件
  *@param:  pixelFormat:yuv的帧格式
  *@param:  pixelWidth,pixelHeight:帧宽度和高度
  */
 void PixmapWidget::readYuvFileTest(QString file, uint pixelFormat, uint pixelWidth, uint pixelHeight)
 {
-    uchar * selectRgbFrameBuf = (uchar *)malloc(pixelWidth*pixelHeight*3);
+    uchar * selectRgbFrameBuf = (uchar *)malloc(pixelWidth*pixelHeight*4);
     QFile *yuvFile = new QFile(file,this);
     if(yuvFile->open(QIODevice::ReadOnly))
     {
@@ -44,27 +45,16 @@ void PixmapWidget::readYuvFileTest(QString file, uint pixelFormat, uint pixelWid
             {
                 yuvFile->seek(0);
             }
-            if(pixelFormat == V4L2_PIX_FMT_YUYV)
+            //所有ColorToRgb24支持的格式统一处理，帧大小由格式决定
+            uint frameSize = ColorToRgb24::frameBytes(pixelFormat,pixelWidth,pixelHeight);
+            QByteArray array = yuvFile->read(frameSize);
+            if(frameSize && (uint)array.size() == frameSize &&
+                    ColorToRgb24::frame_to_rgb(pixelFormat,(uchar *)array.data(),selectRgbFrameBuf,
+                                          pixelWidth,pixelHeight,ColorToRgb24::RGB32))
             {
-                QByteArray array = yuvFile->read(pixelWidth*pixelHeight*2);
-                uchar *yuvFrame[1];
-                yuvFrame[0] = (uchar *)array.data();
-                ColorToRgb24::yuyv_to_rgb24_shift(yuvFrame[0],selectRgbFrameBuf,pixelWidth,pixelHeight);
-                //此处注意QImage的字节对齐，默认是32bit，如果帧宽度不是4的倍数，则需要特别指定bytesPerLine，否则显示会异常
-                QImage selectImage(selectRgbFrameBuf,pixelWidth,pixelHeight,pixelWidth*3,QImage::Format_RGB888);
-                this->setPixmap(QPixmap::fromImage(selectImage));//屏幕显示
-                this->update();//刷新显示
-            }
-            else if(pixelFormat == V4L2_PIX_FMT_NV12 ||
-                    pixelFormat == V4L2_PIX_FMT_NV21)
-            {
-                QByteArray array = yuvFile->read(pixelWidth*pixelHeight*3/2);
-                uchar *yuvFrame[1];
-                yuvFrame[0] = (uchar *)array.data();
-                ColorToRgb24::nv12_21_to_rgb24_shift((pixelFormat==V4L2_PIX_FMT_NV12),yuvFrame[0],selectRgbFrameBuf,pixelWidth,pixelHeight);
-                //此处注意QImage的字节对齐，默认是32bit，如果帧宽度不是4的倍数，则需要特别指定bytesPerLine，否则显示会异常
-                QImage selectImage(selectRgbFrameBuf,pixelWidth,pixelHeight,pixelWidth*3,QImage::Format_RGB888);
-                this->setPixmap(QPixmap::fromImage(selectImage));//屏幕显示
+                //直接输出RGB32(Qt原生格式)，绘制时无需再次转换，且每行字节数总是4的倍数
+                QImage selectImage(selectRgbFrameBuf,pixelWidth,pixelHeight,pixelWidth*4,QImage::Format_RGB32);
+                this->setImage(selectImage);//屏幕显示(不拷贝)
                 this->update();//刷新显示
             }
         });
@@ -85,6 +75,20 @@ void PixmapWidget::readYuvFileTest(QString file, uint pixelFormat, uint pixelWid
 void PixmapWidget::setPixmap(const QPixmap &pixmap)
 {
     this->pixmap = pixmap;
+    this->image = QImage();
+}
+/*
+ *@brief:  设置要绘制的image
+ *注:QImage是隐式共享类，这里只增加引用计数，不拷贝数据，绘制时也直接使用image的数据(32位格式不需要转换)，
+ *避免QPixmap::fromImage()每帧一次的深拷贝。如果image封装的是外部缓冲区，需要保证下一次调用之前缓冲区内容不被修改
+ *(V4L2Capture::captureRgbImageSig()发射的帧由缓冲区池保证)。
+ *@date:   2026.10.18
+ *@param:  image
+ */
+void PixmapWidget::setImage(const QImage &image)
+{
+    this->image = image;
+    this->pixmap = QPixmap();
 }
 /*
  *@brief:  重写绘图事件
@@ -105,6 +109,13 @@ void PixmapWidget::paintEvent(QPaintEvent *event)
      * 非常耗时间。对于缩小图，如果该方式画面有波纹，可以在外面先用scaled的快速转换将原图等比例缩小一定倍数后
      * 再传递进来进行放缩渲染*/
     painter.setRenderHint(QPainter::SmoothPixmapTransform);
-    painter.drawPixmap(this->rect(),pixmap,pixmap.rect());
+    if(!image.isNull())
+    {
+        painter.drawImage(this->rect(),image,image.rect());
+    }
+    else
+    {
+        painter.drawPixmap(this->rect(),pixmap,pixmap.rect());
+    }
 }
 
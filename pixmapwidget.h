@@ -17,6 +17,8 @@
  *注3:采用继承自QOpenGLWidget,在paintEvent()函数内使用QPainter调用drawPixmap或者drawImage绘图，在
  *Arm Linux设备(有GPU，支持opengl)上测试，cpu占用率相较与前面两种方式下降了10%左右，刷新绘图时间也有显著的
  *降低。
+ *注4:QPixmap::fromImage()每帧都会深拷贝一次，动态刷新时应使用setImage()直接绘制QImage(例如V4L2Capture::captureRgbImageSig()
+ *发射的缓冲区池帧)，QImage是隐式共享的，绘制前后都不拷贝、不申请内存，持有期间采集端也不会覆盖该帧。
  */
 #ifndef PIXMAPWIDGET_H
 #define PIXMAPWIDGET_H
@@ -32,6 +34,7 @@
 #define PARENT_WIDGET QWidget
 #endif
 #include <QPixmap>
+#include <QImage>
 
 class PixmapWidget : public PARENT_WIDGET
 {
@@ -44,6 +47,7 @@ public:
                          uint pixelWidth,uint pixelHeight);
 
     void setPixmap(const QPixmap &pixmap);
+    void setImage(const QImage &image);
 
 protected:
     virtual void paintEvent(QPaintEvent  *event) override;
@@ -52,6 +56,7 @@ signals:
 
 private:
     QPixmap pixmap;
+    QImage image;//优先于pixmap绘制
 
 };
 
@@ -0,0 +1,356 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   异步快照(截图)服务
+ */
+#include "snapshotservice.h"
+#include "colortorgb24.h"
+#include <QThread>
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QDebug>
+
+/*工作线程:循环从队列取任务编码保存，队列为空时等待，服务析构时处理完剩余任务后退出*/
+class SnapshotService::Worker : public QThread
+{
+public:
+    explicit Worker(SnapshotService *service):service(service){}
+
+protected:
+    void run() override
+    {
+        Job job;
+        while(service->takeJob(job))
+        {
+            service->processJob(job);
+            job = Job();//尽快释放帧数据
+        }
+    }
+
+private:
+    SnapshotService *service;
+};
+
+/*
+ *@brief:  构造
+ *@date:   2026.10.18
+ *@param:  workerCount:工作线程数(连拍PNG时可适当增加)
+ *@param:  queueCapacity:队列容量(最多缓存的帧数，限制内存占用)
+ *@param:  parent:父对象
+ */
+SnapshotService::SnapshotService(uint workerCount, uint queueCapacity, QObject *parent)
+    :QObject(parent),capacity(queueCapacity?queueCapacity:1),pendingShotCount(0),droppedShotCount(0)
+{
+    workerCount = workerCount?workerCount:1;
+    for(uint i=0;i<workerCount;i++)
+    {
+        QThread *worker = new Worker(this);
+        worker->start(QThread::LowPriority);//编码不应与采集、渲染线程争抢
+        workers.append(worker);
+    }
+}
+/*
+ *@brief:  析构
+ *注:等待工作线程处理完队列中剩余的快照后退出，已提交的帧不会丢失。
+ *@date:   2026.10.18
+ */
+SnapshotService::~SnapshotService()
+{
+    queueMutex.lock();
+    stopping = true;
+    pendingShotCount = 0;
+    queueCond.wakeAll();
+    queueMutex.unlock();
+    for(int i=0;i<workers.size();i++)
+    {
+        workers.at(i)->wait();
+        delete workers.at(i);
+    }
+    workers.clear();
+}
+/*
+ *@brief:  设置保存格式和质量
+ *@date:   2026.10.18
+ *@param:  format:保存格式
+ *@param:  quality:质量[0,100]，-1为Qt默认值(Raw格式忽略)
+ */
+void SnapshotService::setFormat(SnapshotService::Format format, int quality)
+{
+    QMutexLocker locker(&queueMutex);
+    saveFormat = format;
+    saveQuality = quality;
+}
+/*
+ *@brief:  设置保存目录(不存在时自动创建)
+ *@date:   2026.10.18
+ *@param:  dir:保存目录
+ */
+void SnapshotService::setOutputDirectory(const QString &dir)
+{
+    QDir().mkpath(dir);
+    QMutexLocker locker(&queueMutex);
+    outputDir = dir;
+}
+/*
+ *@brief:  设置文件名前缀
+ *@date:   2026.10.18
+ *@param:  prefix:前缀
+ */
+void SnapshotService::setFilePrefix(const QString &prefix)
+{
+    QMutexLocker locker(&queueMutex);
+    filePrefix = prefix;
+}
+/*
+ *@brief:  设置原始帧转换为rgb时使用的颜色编码参数
+ *@date:   2026.10.18
+ *@param:  ycbcrEnc:转换标准(V4L2_YCBCR_ENC_*)  isTvRange:true=TV Range
+ */
+void SnapshotService::setColorEncodingParam(uint ycbcrEnc, bool isTvRange)
+{
+    QMutexLocker locker(&queueMutex);
+    ycbcrEncoding = ycbcrEnc;
+    this->isTvRange = isTvRange;
+}
+/*
+ *@brief:  预约接下来的count帧(连拍)
+ *注:采集/渲染端每帧检查pendingShots()，不为0时提交当前帧，预约的帧全部处理完成后发射burstFinishedSig()。
+ *@date:   2026.10.18
+ *@param:  count:帧数，在尚未完成的预约上累加
+ */
+void SnapshotService::requestSnapshot(uint count)
+{
+    QMutexLocker locker(&queueMutex);
+    if(!stopping)
+    {
+        pendingShotCount += count;
+    }
+}
+/*
+ *@brief:  提交预约的rgb图像
+ *注:入队时深拷贝一次，不持有外部的缓冲区(如V4L2Capture的缓冲区池帧)，没有预约时直接返回，几乎没有开销。
+ *@date:   2026.10.18
+ *@param:  image:rgb图像
+ *@return: bool:true=已入队
+ */
+bool SnapshotService::submitImage(const QImage &image)
+{
+    if(pendingShots() == 0 || image.isNull())
+    {
+        return false;
+    }
+    Job job;
+    job.image = image.copy();
+    return enqueue(job,true);
+}
+/*
+ *@brief:  提交预约的原始帧
+ *@date:   2026.10.18
+ *@param:  pixelFormat:帧格式(V4L2_PIX_FMT_*，ColorToRgb24支持的格式)
+ *@param:  frame:帧数据地址(可以是映射内存，函数返回后不再访问)
+ *@param:  width,height:帧宽高
+ *@return: bool:true=已入队
+ */
+bool SnapshotService::submitFrame(uint pixelFormat, const uchar *frame, uint width, uint height)
+{
+    if(pendingShots() == 0)
+    {
+        return false;
+    }
+    const uint frameSize = ColorToRgb24::frameBytes(pixelFormat,width,height);
+    if(frame == NULL || frameSize == 0)
+    {
+        return false;
+    }
+    Job job;
+    job.frame = QByteArray((const char *)frame,frameSize);
+    job.pixelFormat = pixelFormat;
+    job.width = width;
+    job.height = height;
+    return enqueue(job,true);
+}
+/*
+ *@brief:  直接保存一张rgb图像(不需要预约)
+ *@date:   2026.10.18
+ *@param:  image:rgb图像
+ *@return: bool:true=已入队
+ */
+bool SnapshotService::saveImage(const QImage &image)
+{
+    if(image.isNull())
+    {
+        return false;
+    }
+    Job job;
+    job.image = image.copy();
+    return enqueue(job,false);
+}
+/*
+ *@brief:  直接保存一帧原始帧(不需要预约)
+ *@date:   2026.10.18
+ *@param:  参数同submitFrame()
+ *@return: bool:true=已入队
+ */
+bool SnapshotService::saveFrame(uint pixelFormat, const uchar *frame, uint width, uint height)
+{
+    const uint frameSize = ColorToRgb24::frameBytes(pixelFormat,width,height);
+    if(frame == NULL || frameSize == 0)
+    {
+        return false;
+    }
+    Job job;
+    job.frame = QByteArray((const char *)frame,frameSize);
+    job.pixelFormat = pixelFormat;
+    job.width = width;
+    job.height = height;
+    return enqueue(job,false);
+}
+/*
+ *@brief:  任务入队
+ *注:预约的消耗与入队在同一把锁内完成，工作线程看到的"预约数为0且连拍帧全部处理完"才是一次预约的真正结束。
+ *@date:   2026.10.18
+ *@param:  job:任务(帧数据已拷贝)，这里补充文件名和保存参数
+ *@param:  inBurst:true=消耗一次预约
+ *@return: bool:true=已入队  false=没有预约、队列已满或服务正在退出
+ */
+bool SnapshotService::enqueue(Job &job, bool inBurst)
+{
+    QMutexLocker locker(&queueMutex);
+    if(stopping || (inBurst && pendingShotCount == 0))
+    {
+        return false;
+    }
+    if((uint)jobQueue.size() >= capacity)
+    {
+        droppedShotCount++;
+        return false;
+    }
+    job.fileName = QDir(outputDir).filePath(filePrefix + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmsszzz")
+                                            + QString("_%1").arg(sequence++));
+    job.format = saveFormat;
+    job.quality = saveQuality;
+    job.ycbcrEncoding = ycbcrEncoding;
+    job.isTvRange = isTvRange;
+    job.inBurst = inBurst;
+    if(inBurst)
+    {
+        pendingShotCount--;
+        burstQueued++;
+    }
+    jobQueue.enqueue(job);
+    queueCond.wakeOne();
+    return true;
+}
+/*
+ *@brief:  工作线程取任务(队列为空时等待)
+ *@date:   2026.10.18
+ *@param:  job:取出的任务
+ *@return: bool:false=服务正在退出且队列已空，工作线程应结束
+ */
+bool SnapshotService::takeJob(SnapshotService::Job &job)
+{
+    QMutexLocker locker(&queueMutex);
+    while(jobQueue.isEmpty() && !stopping)
+    {
+        queueCond.wait(&queueMutex);
+    }
+    if(jobQueue.isEmpty())
+    {
+        return false;
+    }
+    job = jobQueue.dequeue();
+    return true;
+}
+/*
+ *@brief:  编码保存一个快照(工作线程)
+ *注:原始帧保存为PNG/JPEG时先转换为RGB32(Qt原生格式，编码器不需要再次转换)，Raw格式直接写入帧数据，
+ *rgb图像的Raw格式逐行写入有效像素(不含行尾对齐字节)。
+ *@date:   2026.10.18
+ *@param:  job:任务
+ */
+void SnapshotService::processJob(const SnapshotService::Job &job)
+{
+    QString fileName;
+    bool success = false;
+    if(job.format == Raw)
+    {
+        fileName = job.fileName + (job.image.isNull()?".yuv":".rgb");
+        QFile file(fileName);
+        if(file.open(QIODevice::WriteOnly))
+        {
+            if(job.image.isNull())
+            {
+                success = (file.write(job.frame) == job.frame.size());
+            }
+            else
+            {
+                const qint64 lineBytes = (qint64)job.image.width()*job.image.depth()/8;
+                success = true;
+                for(int y=0;y<job.image.height() && success;y++)
+                {
+                    success = (file.write((const char *)job.image.constScanLine(y),lineBytes) == lineBytes);
+                }
+            }
+            file.close();
+        }
+    }
+    else
+    {
+        QImage image = job.image;
+        if(image.isNull())
+        {
+            image = QImage(job.width,job.height,QImage::Format_RGB32);
+            if(!ColorToRgb24::frame_to_rgb(job.pixelFormat,(uchar *)job.frame.constData(),image.bits(),
+                                           job.width,job.height,ColorToRgb24::RGB32,
+                                           job.ycbcrEncoding,job.isTvRange))
+            {
+                image = QImage();
+            }
+        }
+        const bool isPng = (job.format == Png);
+        fileName = job.fileName + (isPng?".png":".jpg");
+        success = !image.isNull() && image.save(fileName,isPng?"PNG":"JPG",job.quality);
+    }
+    if(!success)
+    {
+        qDebug()<<QString("save snapshot %1 failed!").arg(fileName);
+    }
+    finishJob(job,fileName,success);
+}
+/*
+ *@brief:  一个快照处理完成，发射完成信号(工作线程)
+ *@date:   2026.10.18
+ *@param:  job:任务  fileName:保存的文件名  success:是否保存成功
+ */
+void SnapshotService::finishJob(const SnapshotService::Job &job, const QString &fileName, bool success)
+{
+    emit snapshotSavedSig(fileName,success);
+    if(!job.inBurst)
+    {
+        return;
+    }
+    queueMutex.lock();
+    burstDone++;
+    burstFailed += success?0:1;
+    const bool finished = (burstDone == burstQueued && pendingShotCount == 0);
+    const uint savedCount = burstDone - burstFailed;
+    const uint failedCount = burstFailed;
+    if(finished)
+    {
+        burstQueued = 0;
+        burstDone = 0;
+        burstFailed = 0;
+    }
+    queueMutex.unlock();
+    if(finished)
+    {
+        emit burstFinishedSig(savedCount,failedCount);
+    }
+}
@@ -0,0 +1,120 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   异步快照(截图)服务，在后台线程中编码保存，避免在GUI线程中压缩图片阻塞界面和视频刷新
+ *
+ *1.快照帧可以是rgb图像(软解码的QImage、OpenGL渲染的FBO图像)，也可以是原始帧(V4L2_PIX_FMT_*)，提交时深拷贝一次放入
+ *有界队列(不持有采集缓冲区池或映射内存)，队列满时拒绝提交，由后台工作线程依次取出编码保存。
+ *2.保存格式:PNG、JPEG(QImage编码，原始帧先由ColorToRgb24转换为RGB32)以及Raw(不编码，原始帧按原格式保存为.yuv，
+ *rgb图像按行保存像素数据为.rgb)，Raw格式的开销只有一次写文件。
+ *3.连拍:requestSnapshot(count)预约接下来的count帧，采集/渲染端每帧通过pendingShots()判断是否需要提交(只是一次原子读取)，
+ *提交成功才消耗一次预约，队列满时该帧跳过、由下一帧补上。
+ *4.每个文件保存完成后通过snapshotSavedSig()通知，一次预约的所有帧处理完成后发射burstFinishedSig()，信号在工作线程中
+ *发射，连接到GUI对象时自动排队到GUI线程。
+ */
+#ifndef SNAPSHOTSERVICE_H
+#define SNAPSHOTSERVICE_H
+
+#include <QObject>
+#include <QImage>
+#include <QByteArray>
+#include <QString>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QList>
+#include <linux/videodev2.h>
+#include <atomic>
+
+class QThread;
+
+class SnapshotService : public QObject
+{
+    Q_OBJECT
+public:
+    //保存格式
+    enum Format
+    {
+        Png = 0,
+        Jpeg,
+        Raw//不编码，原始帧保存为.yuv，rgb图像保存为.rgb
+    };
+
+    explicit SnapshotService(uint workerCount=1,uint queueCapacity=8,QObject *parent = 0);
+    ~SnapshotService();
+
+    //保存格式和质量(-1为Qt默认值，PNG的质量越高压缩级别越低、编码越快但文件越大)
+    void setFormat(Format format,int quality=-1);
+    //保存目录和文件名前缀，文件名为"前缀+提交时间+序号+扩展名"
+    void setOutputDirectory(const QString &dir);
+    void setFilePrefix(const QString &prefix);
+    //原始帧转换为rgb时使用的颜色编码参数(与V4L2Capture::getYcbcrEncoding()/getIsTvRange()一致)
+    void setColorEncodingParam(uint ycbcrEnc,bool isTvRange);
+
+    //预约接下来的count帧(连拍)，在已有预约上累加
+    void requestSnapshot(uint count=1);
+    uint pendingShots() const {return pendingShotCount.load(std::memory_order_relaxed);}
+    //提交快照帧(深拷贝入队)，没有预约或队列已满时返回false
+    bool submitImage(const QImage &image);
+    bool submitFrame(uint pixelFormat,const uchar *frame,uint width,uint height);
+    //直接保存一帧(不需要预约，不计入连拍)，队列已满时返回false
+    bool saveImage(const QImage &image);
+    bool saveFrame(uint pixelFormat,const uchar *frame,uint width,uint height);
+    uint droppedCount() const {return droppedShotCount.load(std::memory_order_relaxed);}//因队列已满被拒绝的帧数
+
+signals:
+    void snapshotSavedSig(const QString &fileName,bool success);//一个文件保存完成
+    void burstFinishedSig(uint savedCount,uint failedCount);//一次预约的所有帧处理完成
+
+private:
+    //队列中的一个快照任务
+    struct Job
+    {
+        QImage image;//rgb图像(image为空时使用原始帧)
+        QByteArray frame;//原始帧数据
+        uint pixelFormat = 0;
+        uint width = 0;
+        uint height = 0;
+        QString fileName;//不含扩展名
+        Format format = Png;//提交时的保存参数
+        int quality = -1;
+        uint ycbcrEncoding = V4L2_YCBCR_ENC_601;
+        bool isTvRange = false;
+        bool inBurst = false;//是否属于预约的连拍
+    };
+    class Worker;
+
+    bool enqueue(Job &job,bool inBurst);
+    bool takeJob(Job &job);
+    void processJob(const Job &job);
+    void finishJob(const Job &job,const QString &fileName,bool success);
+
+    Format saveFormat = Png;
+    int saveQuality = -1;
+    QString outputDir = ".";
+    QString filePrefix;
+    uint ycbcrEncoding = V4L2_YCBCR_ENC_601;
+    bool isTvRange = false;
+
+    QMutex queueMutex;
+    QWaitCondition queueCond;
+    QQueue<Job> jobQueue;
+    uint capacity = 8;
+    bool stopping = false;
+    uint sequence = 0;//文件名序号
+    uint burstQueued = 0;//本次连拍已入队的帧数
+    uint burstDone = 0;//本次连拍已处理的帧数
+    uint burstFailed = 0;//本次连拍保存失败的帧数
+
+    std::atomic<uint> pendingShotCount;//剩余的预约帧数(只在queueMutex内修改)
+    std::atomic<uint> droppedShotCount;
+    QList<QThread *> workers;
+};
+
+#endif // SNAPSHOTSERVICE_H
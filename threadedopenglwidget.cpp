@@ -0,0 +1,548 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   渲染线程模式的OpenGL显示组件
+ */
+#include "threadedopenglwidget.h"
+#include "colortorgb24.h"
+#include <QThread>
+#include <QTimer>
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QOpenGLTextureBlitter>
+#include <QDebug>
+
+/*
+ *@brief:  构造函数
+ *@date:   2026.10.18
+ *@param:  pixel_format:帧格式(使用v4l2的宏)
+ *@param:  pixel_width:像素宽度(需要确保为偶数)  pixel_height:像素高度
+ *@param:  is_tv_range:TV range标识
+ */
+ThreadedOpenGLWidget::ThreadedOpenGLWidget(uint pixel_format, uint pixel_width, uint pixel_height,
+                                           bool is_tv_range, QWidget *parent)
+    : QOpenGLWidget(parent),v4l2Rendering(new V4l2Rendering(pixel_format,pixel_width,pixel_height,is_tv_range)),
+      renderRunning(false),renderRequested(false),updatePending(false),animationPending(false)
+{
+    //截图在V4l2Rendering的后台读取线程中发射，直接转发
+    connect(v4l2Rendering,&V4l2Rendering::captureImageSig,this,&ThreadedOpenGLWidget::captureImageSig,
+            Qt::DirectConnection);
+    //采集模块发射后立即归还缓冲帧，邮箱拷贝帧数据
+    frameMailbox.setFrameBytes(ColorToRgb24::frameBytes(pixel_format,pixel_width,pixel_height));
+    //裁剪动画按显示的节奏渲染:离屏表面没有交换缓冲(垂直同步)，每显示一帧才请求渲染下一帧
+    connect(this,&QOpenGLWidget::frameSwapped,this,[this](){
+        if(animationPending.exchange(false))
+        {
+            requestRender();
+        }
+    });
+}
+
+ThreadedOpenGLWidget::~ThreadedOpenGLWidget()
+{
+    stopRenderThread(true);
+    makeCurrent();
+    if(blitter)
+    {
+        delete blitter;
+    }
+    doneCurrent();
+    if(v4l2Rendering)
+    {
+        delete v4l2Rendering;//渲染线程没有启动过时没有OpenGL资源
+    }
+}
+/*
+ *@brief:  初始化裁剪参数
+ *@date:   2026.10.18
+ *@param:  left_top_x,left_top_y:裁剪区域的左顶点  width,height:裁剪区域的宽高
+ *@return: bool:true=初始化成功  false=参数超出范围或渲染线程已经启动
+ */
+bool ThreadedOpenGLWidget::initCropRectParam(const uint &left_top_x, const uint &left_top_y,
+                                             const uint &width, const uint &height)
+{
+    if(renderThread)
+    {
+        return false;
+    }
+    return v4l2Rendering->initCropRectParam(left_top_x,left_top_y,width,height);
+}
+/*
+ *@brief:  设置裁剪区域(数字平移)
+ *@date:   2026.10.18
+ *@param:  rect:裁剪区域(归一化[0,1]，左上角为原点)
+ *@param:  duration:过渡时长(ms)，0表示立即生效
+ */
+void ThreadedOpenGLWidget::setCropRect(const QRectF &rect, int duration)
+{
+    invokeRender([=](){v4l2Rendering->setCropRect(rect,duration);});
+}
+/*
+ *@brief:  数字变焦
+ *@date:   2026.10.18
+ *@param:  zoom:放大倍数(>=1)
+ *@param:  center:画面中心(归一化[0,1]，左上角为原点)
+ *@param:  duration:过渡时长(ms)，0表示立即生效
+ */
+void ThreadedOpenGLWidget::setDigitalZoom(const float &zoom, const QPointF &center, int duration)
+{
+    invokeRender([=](){v4l2Rendering->setDigitalZoom(zoom,center,duration);});
+}
+/*
+ *@brief:  设置开启/关闭单次采集image
+ *@date:   2026.10.18
+ *@param:  on:true=开启  false=关闭
+ */
+void ThreadedOpenGLWidget::setSingleCaptureImage(bool on)
+{
+    invokeRender([=](){v4l2Rendering->setSingleCaptureImage(on);});
+}
+/*
+ *@brief:  设置连拍采集image的帧数
+ *@date:   2026.10.18
+ *@param:  count:接下来需要采集的帧数，0=关闭
+ */
+void ThreadedOpenGLWidget::setCaptureImageCount(uint count)
+{
+    invokeRender([=](){v4l2Rendering->setCaptureImageCount(count);});
+}
+/*
+ *@brief:  设置镜像参数
+ *@date:   2026.10.18
+ *@param:  hMirror:true=水平镜像  vMirror:true=垂直镜像
+ */
+void ThreadedOpenGLWidget::setMirrorParam(const bool &hMirror, const bool &vMirror)
+{
+    invokeRender([=](){v4l2Rendering->setMirrorParam(hMirror,vMirror);});
+}
+/*
+ *@brief:  设置旋转参数
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  rotation:顺时针旋转角度(0/90/180/270)
+ *@return: bool:true=设置成功  false=不支持的角度
+ */
+bool ThreadedOpenGLWidget::setRotationParam(const uint &rotation)
+{
+    if(!V4l2Rendering::isRotationSupported(rotation))
+    {
+        return false;
+    }
+    invokeRender([=](){v4l2Rendering->setRotationParam(rotation);});
+    return true;
+}
+/*
+ *@brief:  设置颜色编码参数(转换标准和量化范围)
+ *@date:   2026.10.18
+ *@param:  ycbcr_enc:转换标准(V4L2_YCBCR_ENC_*)  is_tv_range:true=TV Range   false=FULL Range
+ */
+void ThreadedOpenGLWidget::setColorEncodingParam(const uint &ycbcr_enc, const bool &is_tv_range)
+{
+    invokeRender([=](){v4l2Rendering->setColorEncodingParam(ycbcr_enc,is_tv_range);});
+}
+/*
+ *@brief:  设置颜色调整参数
+ *@date:   2026.10.18
+ *@param:  enableColorAdjust:是否使能基础颜色调整
+ *@param:  brightness:亮度  contrast:对比度  saturation:饱和度
+ */
+void ThreadedOpenGLWidget::setColorAdjustParam(const bool &enableColorAdjust, const float &brightness,
+                                               const float &contrast, const float &saturation)
+{
+    invokeRender([=](){v4l2Rendering->setColorAdjustParam(enableColorAdjust,brightness,contrast,saturation);});
+}
+/*
+ *@brief:  设置3D LUT颜色分级
+ *@date:   2026.10.18
+ *@param:  lut3D:已加载的3D LUT，空指针表示关闭
+ */
+void ThreadedOpenGLWidget::setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D)
+{
+    invokeRender([=](){v4l2Rendering->setColorLut3D(lut3D);});
+}
+/*
+ *@brief:  更新(渲染)V4l2帧数据
+ *@date:   2026.10.18
+ *@param:  v4l2Frame:v4l2帧二维指针(指针数组[planes])
+ */
+void ThreadedOpenGLWidget::updateV4l2FrameSlot(uchar **v4l2Frame)
+{
+    postV4l2Frame(v4l2Frame);
+}
+/*
+ *@brief:  放入最新的一帧并唤醒渲染线程
+ *注:线程安全(一个写线程)，可以通过Qt::DirectConnection在采集线程中直接调用，帧数据拷贝到邮箱的槽中。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  v4l2Frame:v4l2帧二维指针(指针数组[planes])，渲染只使用连续存储的v4l2Frame[0]
+ */
+void ThreadedOpenGLWidget::postV4l2Frame(uchar **v4l2Frame)
+{
+    frameMailbox.post(v4l2Frame,1);
+    requestRender();
+}
+/*
+ *@brief:  初始化OpenGL资源，启动渲染线程
+ *注:组件的上下文改变时(见V4l2Rendering::initializeGL()的说明)会再次调用，渲染线程以新的上下文作为共享上下文重新启动。
+ *@date:   2026.10.18
+ */
+void ThreadedOpenGLWidget::initializeGL()
+{
+    stopRenderThread(false);
+    if(blitter)
+    {
+        delete blitter;
+    }
+    blitter = new QOpenGLTextureBlitter();
+    blitter->create();
+    startRenderThread();
+}
+/*
+ *@brief:  组件尺寸改变，渲染线程按设备像素尺寸重新创建FBO
+ *@date:   2026.10.18
+ *@param:  w:宽  h:高
+ */
+void ThreadedOpenGLWidget::resizeGL(int w, int h)
+{
+    const QSize size = QSize(w,h)*devicePixelRatioF();
+    invokeRender([=](){
+        renderSize = size;
+        renderSizeChanged = true;
+    });
+}
+/*
+ *@brief:  显示渲染线程最新完成的一帧
+ *注:只是把FBO的纹理绘制到组件上，等待渲染完成的栅栏在GPU端进行(glWaitSync)，GUI线程不等待。
+ *@date:   2026.10.18
+ */
+void ThreadedOpenGLWidget::paintGL()
+{
+    QOpenGLExtraFunctions *f = context()->extraFunctions();
+    f->glClearColor(0.0f,0.0f,0.0f,1.0f);
+    f->glClear(GL_COLOR_BUFFER_BIT);
+
+    bufferMutex.lock();
+    if(readyFresh)
+    {
+        qSwap(frontIndex,readyIndex);
+        readyFresh = false;
+        frontValid = true;
+    }
+    RenderBuffer &buffer = renderBuffers[frontIndex];
+    bufferMutex.unlock();
+    if(!frontValid || !buffer.fbo)
+    {
+        return;
+    }
+    if(buffer.renderFence)
+    {
+        f->glWaitSync(buffer.renderFence,0,GL_TIMEOUT_IGNORED);
+        f->glDeleteSync(buffer.renderFence);
+        buffer.renderFence = nullptr;
+    }
+    blitter->bind();
+    blitter->blit(buffer.fbo->texture(),QMatrix4x4(),QOpenGLTextureBlitter::OriginBottomLeft);
+    blitter->release();
+    //显示完成后渲染线程才能再次绘制该FBO
+    if(isSyncSupported)
+    {
+        if(buffer.displayFence)
+        {
+            f->glDeleteSync(buffer.displayFence);
+        }
+        buffer.displayFence = f->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+        f->glFlush();
+    }
+    else
+    {
+        f->glFinish();
+    }
+}
+/*
+ *@brief:  创建共享上下文并启动渲染线程
+ *@date:   2026.10.18
+ *@return: bool:true=启动成功
+ */
+bool ThreadedOpenGLWidget::startRenderThread()
+{
+    renderSurface = new QOffscreenSurface();
+    renderSurface->setFormat(context()->format());
+    renderSurface->create();
+    renderContext = new QOpenGLContext();
+    renderContext->setFormat(context()->format());
+    renderContext->setShareContext(context());
+    if(!renderSurface->isValid() || !renderContext->create())
+    {
+        qDebug()<<"ThreadedOpenGLWidget:create shared context failed";
+        delete renderContext;
+        renderContext = nullptr;
+        delete renderSurface;
+        renderSurface = nullptr;
+        return false;
+    }
+
+    renderThread = new QThread();
+    renderWorker = new QObject();
+    renderWorker->moveToThread(renderThread);
+    renderContext->moveToThread(renderThread);
+    v4l2Rendering->moveToThread(renderThread);
+    renderThread->start(QThread::HighPriority);
+
+    bool ok = false;
+    const QSize initSize = size()*devicePixelRatioF();
+    QMetaObject::invokeMethod(renderWorker,[this,&ok,initSize](){
+        if(!renderContext->makeCurrent(renderSurface))
+        {
+            return;
+        }
+        const QSurfaceFormat format = renderContext->format();
+        if(renderContext->isOpenGLES())
+        {
+            isSyncSupported = (format.majorVersion() >= 3);
+        }
+        else
+        {
+            isSyncSupported = (format.version() >= qMakePair(3,2) || renderContext->hasExtension("GL_ARB_sync"));
+        }
+        v4l2Rendering->initializeGL();
+        renderSize = initSize;
+        renderSizeChanged = true;
+        pollTimer = new QTimer();
+        pollTimer->setSingleShot(true);
+        pollTimer->setInterval(2);
+        connect(pollTimer,&QTimer::timeout,renderWorker,[this](){pollReadback();});
+        renderContext->doneCurrent();
+        ok = true;
+    },Qt::BlockingQueuedConnection);
+    if(!ok)
+    {
+        qDebug()<<"ThreadedOpenGLWidget:make shared context current failed";
+        stopRenderThread(false);
+        return false;
+    }
+    renderRunning = true;
+    requestRender();
+    return true;
+}
+/*
+ *@brief:  停止渲染线程，释放渲染线程的OpenGL资源
+ *注:先在workerMutex内清除renderRunning，之后采集线程不会再向渲染线程排队；已经排队的渲染在资源释放后执行时直接返回。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  deleteRendering:true=同时销毁V4l2Rendering(析构时)  false=保留参数，移回GUI线程等待重新启动
+ */
+void ThreadedOpenGLWidget::stopRenderThread(bool deleteRendering)
+{
+    if(!renderThread)
+    {
+        return;
+    }
+    workerMutex.lock();
+    renderRunning = false;
+    workerMutex.unlock();
+    QThread *guiThread = thread();
+    QMetaObject::invokeMethod(renderWorker,[this,deleteRendering,guiThread](){
+        if(pollTimer)
+        {
+            delete pollTimer;
+            pollTimer = nullptr;
+        }
+        const bool current = renderContext->makeCurrent(renderSurface);
+        destroyRenderBuffers();
+        v4l2Rendering->setRenderTarget(nullptr);
+        if(deleteRendering)
+        {
+            delete v4l2Rendering;
+            v4l2Rendering = nullptr;
+        }
+        else
+        {
+            v4l2Rendering->moveToThread(guiThread);
+        }
+        if(current)
+        {
+            renderContext->doneCurrent();
+        }
+        delete renderContext;
+        renderContext = nullptr;
+    },Qt::BlockingQueuedConnection);
+    renderThread->quit();
+    renderThread->wait();
+    workerMutex.lock();
+    delete renderWorker;
+    renderWorker = nullptr;
+    workerMutex.unlock();
+    delete renderThread;
+    renderThread = nullptr;
+    delete renderSurface;
+    renderSurface = nullptr;
+    renderRequested = false;
+}
+/*
+ *@brief:  在渲染线程中执行V4l2Rendering的操作并重新渲染，渲染线程未启动时直接执行
+ *@date:   2026.10.18
+ *@param:  func:操作
+ */
+void ThreadedOpenGLWidget::invokeRender(const std::function<void()> &func)
+{
+    if(renderThread)
+    {
+        QMetaObject::invokeMethod(renderWorker,func,Qt::QueuedConnection);
+        requestRender();
+    }
+    else if(v4l2Rendering)
+    {
+        func();
+    }
+}
+/*
+ *@brief:  请求渲染线程渲染一次(已经排队的请求尚未执行时不再重复排队)
+ *注:可能在采集线程中调用，排队在workerMutex内完成，不会与停止渲染线程交错。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ */
+void ThreadedOpenGLWidget::requestRender()
+{
+    if(!renderRunning)
+    {
+        return;
+    }
+    QMutexLocker locker(&workerMutex);
+    if(renderRunning && renderWorker && !renderRequested.exchange(true))
+    {
+        QMetaObject::invokeMethod(renderWorker,[this](){renderFrame();},Qt::QueuedConnection);
+    }
+}
+/*
+ *@brief:  渲染一帧(渲染线程)
+ *注:取走邮箱中最新的一帧上传纹理(没有新帧时重绘上一帧，用于参数改变和尺寸改变)，绘制到当前的FBO后交给GUI线程显示。
+ *渲染线程停止后才执行的请求(资源已经释放)直接返回。裁剪动画期间不立即请求下一帧(离屏表面不受垂直同步限制，会以GPU
+ *的最大速度循环渲染)，而是等组件显示完这一帧(frameSwapped)后再请求，渲染频率与显示刷新率一致。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ */
+void ThreadedOpenGLWidget::renderFrame()
+{
+    renderRequested = false;
+    if(!renderContext || !v4l2Rendering || !renderContext->makeCurrent(renderSurface))
+    {
+        return;
+    }
+    QOpenGLExtraFunctions *f = renderContext->extraFunctions();
+    if(renderSizeChanged)
+    {
+        v4l2Rendering->resizeGL(renderSize.width(),renderSize.height());
+        renderSizeChanged = false;
+    }
+    uchar *v4l2Frame[1] = {nullptr};
+    if(frameMailbox.take(v4l2Frame,1))
+    {
+        v4l2Rendering->updateV4l2Frame(v4l2Frame);
+    }
+    //当前FBO:等待GUI线程显示完成，丢弃GUI线程没有取走的旧帧的栅栏
+    RenderBuffer &buffer = renderBuffers[writeIndex];
+    if(buffer.displayFence)
+    {
+        f->glWaitSync(buffer.displayFence,0,GL_TIMEOUT_IGNORED);
+        f->glDeleteSync(buffer.displayFence);
+        buffer.displayFence = nullptr;
+    }
+    if(buffer.renderFence)
+    {
+        f->glDeleteSync(buffer.renderFence);
+        buffer.renderFence = nullptr;
+    }
+    const QSize targetSize = renderSize.expandedTo(QSize(1,1));
+    if(!buffer.fbo || buffer.fbo->size() != targetSize)
+    {
+        delete buffer.fbo;
+        QOpenGLFramebufferObjectFormat fboFormat;
+        fboFormat.setAttachment(QOpenGLFramebufferObject::NoAttachment);
+        buffer.fbo = new QOpenGLFramebufferObject(targetSize,fboFormat);
+    }
+    v4l2Rendering->setRenderTarget(buffer.fbo);
+    v4l2Rendering->paintGL();
+    buffer.fbo->release();
+    if(isSyncSupported)
+    {
+        buffer.renderFence = f->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+        f->glFlush();//栅栏需要提交之后其他上下文才能等待
+    }
+    else
+    {
+        f->glFinish();
+    }
+    //裁剪动画:在交给GUI线程之前登记，保证显示这一帧的frameSwapped能够请求下一帧
+    if(v4l2Rendering->isCropAnimating())
+    {
+        animationPending = true;
+    }
+    //交给GUI线程
+    bufferMutex.lock();
+    qSwap(writeIndex,readyIndex);
+    readyFresh = true;
+    bufferMutex.unlock();
+    //GUI线程繁忙时最多只排队一次刷新，刷新时总是显示最新完成的一帧
+    if(!updatePending.exchange(true))
+    {
+        QMetaObject::invokeMethod(this,[this](){
+            updatePending = false;
+            update();
+        },Qt::QueuedConnection);
+    }
+    //截图读取
+    if(v4l2Rendering->hasPendingReadback() && !pollTimer->isActive())
+    {
+        pollTimer->start();
+    }
+    renderContext->doneCurrent();
+}
+/*
+ *@brief:  取回已完成的截图读取(渲染线程)
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ */
+void ThreadedOpenGLWidget::pollReadback()
+{
+    if(!renderContext || !v4l2Rendering || !renderContext->makeCurrent(renderSurface))
+    {
+        return;
+    }
+    v4l2Rendering->pollReadback();
+    if(v4l2Rendering->hasPendingReadback())
+    {
+        pollTimer->start();
+    }
+    renderContext->doneCurrent();
+}
+/*
+ *@brief:  销毁轮换的FBO和栅栏(渲染线程，上下文为当前)
+ *@date:   2026.10.18
+ */
+void ThreadedOpenGLWidget::destroyRenderBuffers()
+{
+    QOpenGLExtraFunctions *f = renderContext->extraFunctions();
+    QMutexLocker locker(&bufferMutex);
+    for(int i=0;i<3;i++)
+    {
+        RenderBuffer &buffer = renderBuffers[i];
+        if(buffer.renderFence)
+        {
+            f->glDeleteSync(buffer.renderFence);
+        }
+        if(buffer.displayFence)
+        {
+            f->glDeleteSync(buffer.displayFence);
+        }
+        delete buffer.fbo;
+        buffer = RenderBuffer();
+    }
+    readyFresh = false;
+    frontValid = false;
+}
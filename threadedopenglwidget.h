@@ -0,0 +1,120 @@
+/****************************************************************************
+*
+* Copyright (C) 2019-2025 MiaoQingrui. All rights reserved.
+* Author: 缪庆瑞 <justdoit_mqr@163.com>
+*
+****************************************************************************/
+/*
+ *@author:  缪庆瑞
+ *@date:    2026.10.18
+ *@brief:   渲染线程模式的OpenGL显示组件
+ *
+ *1.OpenGLWidget的纹理上传和绘制都在GUI线程的paintGL()中完成，界面布局、按键处理、截图编码等都会直接推迟视频。该组件中
+ *V4l2Rendering运行在独立的渲染线程中，使用与组件上下文共享的OpenGL上下文(绘制表面为QOffscreenSurface)，每一帧由渲染线程
+ *上传纹理并绘制到FBO(渲染到纹理)，完成后交给GUI线程，GUI线程的paintGL()只需把最新的纹理绘制到组件上(一次纹理blit)。
+ *2.采集线程通过postV4l2Frame()把最新一帧放入邮箱(FrameMailbox)并唤醒渲染线程，渲染线程的事件循环不受GUI线程影响，
+ *GUI线程繁忙时渲染照常进行，组件刷新时显示最新完成的一帧，中间的帧被跳过。
+ *3.渲染线程与GUI线程之间使用三个FBO轮换(渲染中、已完成、显示中)，支持栅栏(OpenGL 3.2/OpenGL ES 3.0)时通过glWaitSync在GPU
+ *端同步(渲染完成才显示、显示完成才再次渲染)，CPU不等待；不支持时退回glFinish。
+ *注:参数设置接口在渲染线程启动后排队到渲染线程执行；暂不支持场频输出的第二场。
+ */
+#ifndef THREADEDOPENGLWIDGET_H
+#define THREADEDOPENGLWIDGET_H
+
+#include "v4l2rendering.h"
+#include "framemailbox.h"
+#include <QOpenGLWidget>
+#include <QMutex>
+#include <functional>
+#include <atomic>
+
+class QOffscreenSurface;
+class QOpenGLContext;
+class QOpenGLTextureBlitter;
+class QTimer;
+
+class ThreadedOpenGLWidget : public QOpenGLWidget
+{
+    Q_OBJECT
+public:
+    explicit ThreadedOpenGLWidget(uint pixel_format,uint pixel_width,
+                                  uint pixel_height,bool is_tv_range=true,QWidget *parent = nullptr);
+    ~ThreadedOpenGLWidget();
+
+    //初始化裁剪参数(需要在显示之前调用，运行时使用setCropRect()/setDigitalZoom())
+    bool initCropRectParam(const uint &left_top_x,const uint &left_top_y,
+                           const uint &width,const uint &height);
+    void setCropRect(const QRectF &rect,int duration=0);
+    void setDigitalZoom(const float &zoom,const QPointF &center,int duration=0);
+    //截图(captureImageSig在后台线程中发射，连接到GUI对象时自动排队)
+    void setSingleCaptureImage(bool on);
+    void setCaptureImageCount(uint count);
+    //其余参数与OpenGLWidget一致
+    void setMirrorParam(const bool &hMirror,const bool &vMirror);
+    bool setRotationParam(const uint &rotation);
+    void setColorEncodingParam(const uint &ycbcr_enc,const bool &is_tv_range);
+    void setColorAdjustParam(const bool &enableColorAdjust,const float &brightness,
+                             const float &contrast,const float &saturation);
+    void setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D);
+    //放入最新的一帧(可在采集线程中直接调用)，由渲染线程取走上传
+    void postV4l2Frame(uchar **v4l2Frame);
+    quint64 staleFrameCount(){return frameMailbox.staleCount();}
+
+protected:
+    virtual void initializeGL();
+    virtual void resizeGL(int w,int h);
+    virtual void paintGL();
+
+private:
+    //渲染线程与GUI线程之间轮换的FBO
+    struct RenderBuffer
+    {
+        QOpenGLFramebufferObject *fbo = nullptr;
+        GLsync renderFence = nullptr;//渲染线程绘制完成的栅栏(GUI线程等待)
+        GLsync displayFence = nullptr;//GUI线程显示完成的栅栏(渲染线程再次绘制前等待)
+    };
+
+    bool startRenderThread();
+    void stopRenderThread(bool deleteRendering);
+    void invokeRender(const std::function<void()> &func);
+    void requestRender();
+    void renderFrame();
+    void pollReadback();
+    void destroyRenderBuffers();
+
+    //负责渲染处理v4l2帧数据(渲染线程启动后只在渲染线程中访问)
+    V4l2Rendering *v4l2Rendering = nullptr;
+    FrameMailbox frameMailbox;
+    //渲染线程
+    QOffscreenSurface *renderSurface = nullptr;
+    QOpenGLContext *renderContext = nullptr;
+    QThread *renderThread = nullptr;
+    QObject *renderWorker = nullptr;
+    QTimer *pollTimer = nullptr;//截图异步读取未完成时定时取回
+    QMutex workerMutex;//保护采集线程对renderWorker的访问(与停止渲染线程互斥)
+    std::atomic<bool> renderRunning;//渲染线程可以接收渲染请求(停止前先清除)
+    std::atomic<bool> renderRequested;//已经排队了一次渲染(合并多次请求)
+    std::atomic<bool> updatePending;//已经排队了一次GUI刷新(合并多次请求)
+    std::atomic<bool> animationPending;//裁剪动画的下一帧等待组件显示完成(frameSwapped)后再渲染
+    QSize renderSize;//渲染尺寸(设备像素，只在渲染线程中访问)
+    bool renderSizeChanged = false;
+    bool isSyncSupported = false;
+    //FBO轮换(索引的交换在bufferMutex内完成)
+    QMutex bufferMutex;
+    RenderBuffer renderBuffers[3];
+    int writeIndex = 0;//渲染线程正在绘制的FBO
+    int readyIndex = 1;//最新完成的FBO
+    int frontIndex = 2;//GUI线程正在显示的FBO
+    bool readyFresh = false;//readyIndex是否有尚未显示的新帧
+    bool frontValid = false;
+    //GUI线程绘制纹理
+    QOpenGLTextureBlitter *blitter = nullptr;
+
+signals:
+    void captureImageSig(const QImage &image);
+
+public slots:
+    void updateV4l2FrameSlot(uchar **v4l2Frame);
+};
+
+#endif // THREADEDOPENGLWIDGET_H
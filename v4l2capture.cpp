@@ -13,6 +13,8 @@
 #include "v4l2capture.h"
 #include "colortorgb24.h"
 #include <QTime>
+#include <QElapsedTimer>
+#include <QTimer>
 #include <QDebug>
 
 /*
@@ -29,8 +31,11 @@ V4L2Capture::V4L2Capture(bool useSelect, QObject *parent):
         selectThread = new QThread(this);
         this->moveToThread(selectThread);
         selectThread->start();
-        connect(this,SIGNAL(selectCaptureSig(bool,bool)),this,SLOT(selectCaptureSlot(bool,bool)));
+        connect(this,SIGNAL(selectCaptureSig(bool,bool,bool)),this,SLOT(selectCaptureSlot(bool,bool,bool)));
     }
+    //帧统计通过信号跨线程发送，需要注册元类型
+    qRegisterMetaType<FrameStatistics>("FrameStatistics");
+    qRegisterMetaType<MotionDetector::Result>("MotionDetector::Result");
 }
 /*
  *@brief:   析构函数(负责清理和回收资源)
@@ -40,6 +45,8 @@ V4L2Capture::~V4L2Capture()
 {
     closeDevice();
     clearSelectResource();
+    free(lumaFrameBuf[0]);
+    free(lumaFrameBuf[1]);
 }
 /*
  *@brief:   打开视频采集设备
@@ -176,12 +183,13 @@ void V4L2Capture::ioctlSetStreamParm(uint captureMode, uint timeperframe)
 /*
  *@brief:   设置视频流格式(v4l2_streamparm)，这里主要是视频输入(采集)流的格式
  *@date:    2022.8.13
- *@update:  2024.03.06
+ *@update:  2026.10.18
  *@param:   pixelformat:帧格式(V4L2_PIX_FMT*)
  *@param:   width:帧宽度  必须是16的倍数
- *@param:   height:帧高度  必须是16的倍数
+ *@param:   height:帧高度  必须是16的倍数(V4L2_FIELD_ALTERNATE时为场高)
+ *@param:   field:期望的场格式(V4L2_FIELD_*)，默认由驱动决定，实际值通过getField()获取
  */
-void V4L2Capture::ioctlSetStreamFmt(uint pixelformat, uint width, uint height)
+void V4L2Capture::ioctlSetStreamFmt(uint pixelformat, uint width, uint height, uint field)
 {
     v4l2_format format;
     memset(&format,0,sizeof(format));
@@ -197,7 +205,7 @@ void V4L2Capture::ioctlSetStreamFmt(uint pixelformat, uint width, uint height)
         format.fmt.pix_mp.width = width;
         format.fmt.pix_mp.height = height;
         format.fmt.pix_mp.pixelformat = pixelformat;
-        format.fmt.pix_mp.field = V4L2_FIELD_ANY;//帧域
+        format.fmt.pix_mp.field = field;//帧域
         /*planes相关参数应用层无需填写，由驱动层根据pixelformat自动设置，通过VIDIOC_G_FMT获取驱动设置得信息
         format.fmt.pix_mp.num_planes = 1;
         format.fmt.pix_mp.plane_fmt[0].bytesperline = width;
@@ -214,7 +222,7 @@ void V4L2Capture::ioctlSetStreamFmt(uint pixelformat, uint width, uint height)
         format.fmt.pix.width = width;
         format.fmt.pix.height = height;
         format.fmt.pix.pixelformat = pixelformat;
-        format.fmt.pix.field = V4L2_FIELD_ANY;//帧域
+        format.fmt.pix.field = field;//帧域
         //设置格式
         if(ioctl(cameraFd,VIDIOC_S_FMT,&format) == -1)
         {
@@ -339,6 +347,59 @@ void V4L2Capture::ioctlSetStreamSwitch(bool on)
         ioctl(cameraFd,VIDIOC_STREAMOFF,&type);
     }
 }
+/*
+ *@brief:   获取软解码输出的rgb帧宽度
+ *注:设置了裁剪、镜像、旋转参数时由变换参数决定(旋转90/270度时宽高互换)，否则由setRgbOutputSize()决定，默认为采集宽度
+ *@date:    2026.10.18
+ *@return:  uint:rgb帧宽度
+ */
+uint V4L2Capture::getRgbOutputWidth()
+{
+    if(!rgbOutputTransform.isIdentity())
+    {
+        uint width,height;
+        ColorToRgb24::transformedSize(rgbOutputTransform,pixelWidth,pixelHeight,width,height);
+        return width;
+    }
+    return rgbOutputWidth?rgbOutputWidth:pixelWidth;
+}
+/*
+ *@brief:   获取软解码输出的rgb帧高度
+ *@date:    2026.10.18
+ *@return:  uint:rgb帧高度
+ */
+uint V4L2Capture::getRgbOutputHeight()
+{
+    if(!rgbOutputTransform.isIdentity())
+    {
+        uint width,height;
+        ColorToRgb24::transformedSize(rgbOutputTransform,pixelWidth,pixelHeight,width,height);
+        return height;
+    }
+    return rgbOutputHeight?rgbOutputHeight:pixelHeight;
+}
+/*
+ *@brief:   rgb输出格式对应的QImage格式
+ *注:BGRA8888在小端字节序下与RGB32的存储一致。
+ *@date:    2026.10.18
+ *@param:   format:rgb输出格式
+ *@return:  QImage::Format:QImage格式
+ */
+QImage::Format V4L2Capture::rgbImageFormat(ColorToRgb24::RgbOutputFormat format)
+{
+    switch(format)
+    {
+    case ColorToRgb24::RGB32:
+    case ColorToRgb24::BGRA8888:
+        return QImage::Format_RGB32;
+    case ColorToRgb24::ARGB32_Premultiplied:
+        return QImage::Format_ARGB32_Premultiplied;
+    case ColorToRgb24::RGBX8888:
+        return QImage::Format_RGBX8888;
+    default:
+        return QImage::Format_RGB888;
+    }
+}
 /*
  *@brief:   从输出队列取缓冲帧，转换成rgb24格式的帧
  *注:该函数将内核输出队列的缓冲帧，取出到用户空间(如果需要软解码，则在该函数内部进行格式转换处理)，可以认为是软件
@@ -346,14 +407,23 @@ void V4L2Capture::ioctlSetStreamSwitch(bool on)
  *每40ms以内就得调用该函数处理一次，这也要求该函数内部的处理要尽可能的高效(尤其针对软解码处理)，否则视频帧在界面
  *刷新时就可能显示异常(图像闪烁，旧帧不更新等等)。
  *@date:    2019.08.07
- *@update:  2024.03.07
- *@param:   rgb24FrameAddr:rgb24格式(rgb888)帧的内存地址,该地址的内存空间必须在方法外申请,
- *          如果为NULL,则不进行转换处理，否则在内部进行软解码(耗cpu)转换。
+ *@update:  2026.10.18
+ *@param:   rgb24FrameAddr:rgb帧的内存地址,格式和尺寸由setRgbOutputFormat()、setRgbOutputSize()/setRgbOutputTransform()
+ *          指定(默认rgb888、采集尺寸)，
+ *          该地址的内存空间(输出宽*输出高*ColorToRgb24::bytesPerPixel(format))必须在方法外申请,如果为NULL,则不进行转换处理，否则在内部进行软解码(耗cpu)转换。
  *@param:   originFrameAddr[]:采集的原生视频帧的地址组(mmap内存映射的地址,指针数组，长度>=planes_num)，
  *          内部赋值,NULL则不获取该地址
+ *@param:   lumaFrameAddr:亮度(灰度)帧地址，内部赋值，NULL则不获取。Y平面连续存储且不缩小时为映射内存中的Y平面(零拷贝，
+ *          与originFrameAddr一样在该缓冲帧被驱动再次填充之前有效)，否则为内部双缓冲区；不支持的格式(rgb)赋值为NULL
+ *@param:   stats:帧统计，NULL则不统计。内部先清空，进行软解码时统计输出的rgb帧(在转换过程中累加)，否则只统计原始帧的
+ *          Y分量(按setFrameStatisticsEnabled()设置的抽样步长)
+ *注:开启运动检测且设置了跳过静止帧时，未变化的帧不进行软解码和统计(rgb24FrameAddr的内容保持不变)，可通过isLastFrameChanged()判断
+ *注:隔行帧先反交错(setDeinterlaceMode())，软解码、亮度帧、统计及运动检测使用逐行帧，originFrameAddr为交织帧；ALTERNATE
+ *未开启场频输出时每对场的第一场只交织，同样不进行后续处理
  *@return:  bool:true=成功取出一帧
  */
-bool V4L2Capture::ioctlDequeueBuffers(uchar *rgb24FrameAddr, uchar *originFrameAddr[])
+bool V4L2Capture::ioctlDequeueBuffers(uchar *rgb24FrameAddr, uchar *originFrameAddr[], const uchar **lumaFrameAddr,
+                                      FrameStatistics *stats)
 {
     v4l2_buffer vbuffer;
     memset(&vbuffer,0,sizeof(vbuffer));
@@ -371,46 +441,70 @@ bool V4L2Capture::ioctlDequeueBuffers(uchar *rgb24FrameAddr, uchar *originFrameA
         printf("VIDIOC_DQBUF failed.\n");
         return false;
     }
-    /*根据帧格式和v4l2BufType调用对应得转换处理*/
-    if(pixelFormat == V4L2_PIX_FMT_YUYV)
+    /*根据v4l2BufType获取帧地址，所有支持软件转换的格式统一交由本对象的rgbConverter按格式分发处理*/
+    uchar *frameAddr = (v4l2BufType == V4L2_BUF_TYPE_VIDEO_CAPTURE)?
+                bufferMmapPtr[vbuffer.index].addr:bufferMmapMplanePtr[vbuffer.index].addr[0];
+    /*隔行帧反交错，后续处理都使用逐行帧(progressiveFrame)，原始帧为交织帧(SEQ/ALTERNATE为内部交织后的完整帧)
+     *驱动在每个缓冲帧中给出实际的场格式(ALTERNATE为TOP/BOTTOM)，没有给出时使用协商的场格式*/
+    uchar *progressiveFrame = frameAddr;
+    uchar *interlacedFrame = frameAddr;
+    lastFrameReady = true;
+    if(fieldType == V4L2_FIELD_ALTERNATE)
     {
-        uchar * yuyvFrameAddr = (v4l2BufType == V4L2_BUF_TYPE_VIDEO_CAPTURE)?
-                    bufferMmapPtr[vbuffer.index].addr:bufferMmapMplanePtr[vbuffer.index].addr[0];
-        if(originFrameAddr)
+        progressiveFrame = deinterlacer.processField(pixelFormat,frameAddr,pixelWidth,pixelHeight,
+                                                     vbuffer.field == V4L2_FIELD_BOTTOM);
+        lastFrameReady = (progressiveFrame != NULL);
+        if(deinterlacer.interlacedFrame())
         {
-            originFrameAddr[0] = yuyvFrameAddr;
-        }
-        if(rgb24FrameAddr)
-        {
-            ColorToRgb24::yuyv_to_rgb24_shift(yuyvFrameAddr,rgb24FrameAddr,pixelWidth,pixelHeight);
+            interlacedFrame = deinterlacer.interlacedFrame();
         }
     }
-    else if(pixelFormat == V4L2_PIX_FMT_NV12 || pixelFormat == V4L2_PIX_FMT_NV21)
+    else
     {
-        uchar *nv12_21FrameAddr = (v4l2BufType == V4L2_BUF_TYPE_VIDEO_CAPTURE)?
-                    bufferMmapPtr[vbuffer.index].addr:bufferMmapMplanePtr[vbuffer.index].addr[0];
-        if(originFrameAddr)
+        const uint field = Deinterlacer::isInterlaced(vbuffer.field)?vbuffer.field:fieldType;
+        uchar *frame = Deinterlacer::isInterlaced(field)?
+                    deinterlacer.process(pixelFormat,frameAddr,pixelWidth,pixelHeight,field):NULL;
+        if(frame)
         {
-           originFrameAddr[0] = nv12_21FrameAddr;
-        }
-        if(rgb24FrameAddr)
-        {
-            ColorToRgb24::nv12_21_to_rgb24_shift((pixelFormat == V4L2_PIX_FMT_NV12),
-                                                 nv12_21FrameAddr,rgb24FrameAddr,
-                                                 pixelWidth,pixelHeight);
+            progressiveFrame = frame;
+            interlacedFrame = deinterlacer.interlacedFrame();
         }
     }
-    else if(pixelFormat == V4L2_PIX_FMT_RGB32)
+    if(originFrameAddr)
     {
-        uchar *rgb32FrameAddr = (v4l2BufType == V4L2_BUF_TYPE_VIDEO_CAPTURE)?
-                    bufferMmapPtr[vbuffer.index].addr:bufferMmapMplanePtr[vbuffer.index].addr[0];
-        if(originFrameAddr)
-        {
-            originFrameAddr[0] = rgb32FrameAddr;
-        }
-        if(rgb24FrameAddr)
+        originFrameAddr[0] = interlacedFrame;
+    }
+    if(stats)
+    {
+        stats->reset();
+    }
+    //运动检测(在缩小的亮度图上进行，开销远小于软解码)
+    lastFrameChanged = lastFrameReady;
+    if(lastFrameReady && motionDetectionEnabled)
+    {
+        lastFrameChanged = motionDetector.detect(pixelFormat,progressiveFrame,pixelWidth,pixelHeight).changed ||
+                !motionSkipStaticFrames;
+    }
+    //静止帧跳过软解码和统计
+    if(lastFrameChanged && rgb24FrameAddr && ColorToRgb24::isSupportedFormat(pixelFormat))
+    {
+        convertFrame(progressiveFrame,rgb24FrameAddr,stats);
+    }
+    else if(lastFrameChanged && stats)
+    {
+        ColorToRgb24::frame_statistics(pixelFormat,progressiveFrame,pixelWidth,pixelHeight,*stats,frameStatisticsStep);
+    }
+    if(lumaFrameAddr)
+    {
+        //Y平面连续存储且不缩小时直接使用映射内存(或反交错的输出帧)，否则提取到内部缓冲区(packed格式为SIMD分离)
+        *lumaFrameAddr = (lumaOutputDownsample == 1)?ColorToRgb24::lumaPlane(pixelFormat,progressiveFrame):NULL;
+        if(*lumaFrameAddr == NULL && lastFrameReady)
         {
-            ColorToRgb24::rgb4_to_rgb24(rgb32FrameAddr,rgb24FrameAddr,pixelWidth,pixelHeight);
+            uchar *lumaFrameBuf = nextLumaFrameBuf();
+            if(ColorToRgb24::frame_to_luma(pixelFormat,progressiveFrame,lumaFrameBuf,pixelWidth,pixelHeight,lumaOutputDownsample))
+            {
+                *lumaFrameAddr = lumaFrameBuf;
+            }
         }
     }
     //将取出的缓冲帧重新放回输入队列，实现循环采集数据
@@ -418,6 +512,43 @@ bool V4L2Capture::ioctlDequeueBuffers(uchar *rgb24FrameAddr, uchar *originFrameA
 
     return true;
 }
+/*
+ *@brief:   场频输出时获取最近一次取出的隔行帧的第二场(软解码)
+ *注:需要在ioctlDequeueBuffers()之后、下一次取帧之前调用，第二场的逐行帧在取帧时已经生成(内部缓冲区)，这里只做软解码，
+ *不进行帧统计。为了输出均匀的场频，调用者应在取帧后间隔半帧再显示第二场。
+ *@date:    2026.10.18
+ *@param:   rgb24FrameAddr:rgb帧的内存地址(与ioctlDequeueBuffers()的要求一致)
+ *@return:  bool:true=成功  false=没有第二场(未开启场频输出、非隔行帧、ALTERNATE或静止帧)
+ */
+bool V4L2Capture::fetchSecondField(uchar *rgb24FrameAddr)
+{
+    uchar *frame = deinterlacer.secondField();
+    if(frame == NULL || rgb24FrameAddr == NULL || !lastFrameChanged || !ColorToRgb24::isSupportedFormat(pixelFormat))
+    {
+        return false;
+    }
+    convertFrame(frame,rgb24FrameAddr,NULL);
+    return true;
+}
+/*
+ *@brief:   软解码，按setRgbOutputTransform()/setRgbOutputSize()设置的参数选择转换接口
+ *@date:    2026.10.18
+ *@param:   frame:原始帧(逐行)  rgb24FrameAddr:rgb帧的内存地址  stats:帧统计，NULL则不统计
+ */
+void V4L2Capture::convertFrame(uchar *frame, uchar *rgb24FrameAddr, FrameStatistics *stats)
+{
+    if(!rgbOutputTransform.isIdentity())
+    {
+        rgbConverter.convertTransformed(pixelFormat,frame,rgb24FrameAddr,pixelWidth,pixelHeight,
+                                        rgbOutputTransform,rgbOutputFormat,ycbcrEncoding,isTvRange,stats);
+    }
+    else
+    {
+        rgbConverter.convertScaled(pixelFormat,frame,rgb24FrameAddr,pixelWidth,pixelHeight,
+                                   getRgbOutputWidth(),getRgbOutputHeight(),
+                                   rgbOutputFormat,ycbcrEncoding,isTvRange,stats);
+    }
+}
 /*
  *@brief:   查询设备的基本信息及驱动能力(v4l2_capability)
  * 通常对于一个摄像设备，它的驱动能力一般仅支持视频采集(V4L2_CAP_VIDEO_CAPTURE(单平面)或V4L2_CAP_VIDEO_CAPTURE_MPLANE(多平面))
@@ -560,7 +691,7 @@ void V4L2Capture::ioctlGetStreamParm()
 /*
  *@brief:  获取视频流格式(v4l2_format)，这里主要是视频采集流的帧格式(v4l2_pix_format和v4l2_pix_format_mplane)
  *@date:   2022.08.13
- *@update: 2024.03.06
+ *@update: 2026.10.18
  */
 void V4L2Capture::ioctlGetStreamFmt()
 {
@@ -573,13 +704,17 @@ void V4L2Capture::ioctlGetStreamFmt()
     {
         printf("\nV4L2 Plane pixformat:\n"
                "pix size:%dx%d\t pixelformat:%c%c%c%c\n"
-               "field:%d\t bytesperline:%d\t sizeimage:%d\t colorspace:%d\n",
+               "field:%d\t bytesperline:%d\t sizeimage:%d\t colorspace:%d\n"
+               "ycbcr_enc:%d\t quantization:%d\n",
                format.fmt.pix.width,format.fmt.pix.height,//宽高
                format.fmt.pix.pixelformat&0xFF,(format.fmt.pix.pixelformat>>8)&0xFF,
                (format.fmt.pix.pixelformat>>16)&0xFF,(format.fmt.pix.pixelformat>>24)&0xFF,//帧格式
                format.fmt.pix.field,//场格式
                format.fmt.pix.bytesperline,format.fmt.pix.sizeimage,//每行字节数，图像大小
-               format.fmt.pix.colorspace);//颜色空间
+               format.fmt.pix.colorspace,//颜色空间
+               format.fmt.pix.ycbcr_enc,format.fmt.pix.quantization);//yuv编码标准，量化范围
+        updateColorEncoding(format.fmt.pix.colorspace,format.fmt.pix.ycbcr_enc,format.fmt.pix.quantization);
+        updateField(format.fmt.pix.field,format.fmt.pix.height);
     }
     //多平面视频采集帧格式
     else if(v4l2BufType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
@@ -587,14 +722,17 @@ void V4L2Capture::ioctlGetStreamFmt()
         this->planes_num = format.fmt.pix_mp.num_planes;
         printf("\nV4L2 Mplane pixformat:\n"
                "pix size:%dx%d\t pixelformat:%c%c%c%c\n"
-               "field:%d\t colorspace:%d\n"
+               "field:%d\t colorspace:%d\t ycbcr_enc:%d\t quantization:%d\n"
                "num_planes:%d\n",
                format.fmt.pix_mp.width,format.fmt.pix_mp.height,//宽高
                format.fmt.pix_mp.pixelformat&0xFF,(format.fmt.pix_mp.pixelformat>>8)&0xFF,
                (format.fmt.pix_mp.pixelformat>>16)&0xFF,(format.fmt.pix_mp.pixelformat>>24)&0xFF,//帧格式
                format.fmt.pix_mp.field,//场格式
                format.fmt.pix_mp.colorspace,//颜色空间
+               format.fmt.pix_mp.ycbcr_enc,format.fmt.pix_mp.quantization,//yuv编码标准，量化范围
                format.fmt.pix_mp.num_planes);//多平面的数量
+        updateColorEncoding(format.fmt.pix_mp.colorspace,format.fmt.pix_mp.ycbcr_enc,format.fmt.pix_mp.quantization);
+        updateField(format.fmt.pix_mp.field,format.fmt.pix_mp.height);
         //注:在T517上实测每个平面的信息在VIDIOC_REQBUFS之后才被填充,否则拿到的将是初始化值(0)或者上次设置的值
         for(int i=0;i<format.fmt.pix_mp.num_planes;i++)
         {
@@ -603,6 +741,62 @@ void V4L2Capture::ioctlGetStreamFmt()
         }
     }
 }
+/*
+ *@brief:  根据驱动返回的颜色空间信息确定yuv转rgb的转换标准和量化范围
+ *注:驱动的ycbcr_enc和quantization通常返回DEFAULT(0)，此时需要根据colorspace推导出默认值(规则同内核的V4L2_MAP_*_DEFAULT宏)，
+ *比如V4L2_COLORSPACE_SMPTE170M(标清摄像头常见)对应BT601+TV Range，V4L2_COLORSPACE_REC709对应BT709+TV Range，
+ *V4L2_COLORSPACE_JPEG对应BT601+Full Range。
+ *@date:   2026.10.18
+ *@param:  colorspace:颜色空间(V4L2_COLORSPACE_*)
+ *@param:  ycbcr_enc:yuv编码标准(V4L2_YCBCR_ENC_*)
+ *@param:  quantization:量化范围(V4L2_QUANTIZATION_*)
+ */
+void V4L2Capture::updateColorEncoding(uint colorspace, uint ycbcr_enc, uint quantization)
+{
+    if(ycbcr_enc == V4L2_YCBCR_ENC_DEFAULT)
+    {
+        ycbcr_enc = V4L2_MAP_YCBCR_ENC_DEFAULT(colorspace);
+    }
+    //软解码仅实现了BT601/BT709/BT2020三种转换系数，其他编码(xvYCC、SMPTE240M等)按照最接近的标准处理
+    if(ycbcr_enc == V4L2_YCBCR_ENC_709 || ycbcr_enc == V4L2_YCBCR_ENC_XV709 ||
+            ycbcr_enc == V4L2_YCBCR_ENC_SMPTE240M)
+    {
+        ycbcrEncoding = V4L2_YCBCR_ENC_709;
+    }
+    else if(ycbcr_enc == V4L2_YCBCR_ENC_BT2020 || ycbcr_enc == V4L2_YCBCR_ENC_BT2020_CONST_LUM)
+    {
+        ycbcrEncoding = V4L2_YCBCR_ENC_BT2020;
+    }
+    else
+    {
+        ycbcrEncoding = V4L2_YCBCR_ENC_601;
+    }
+
+    if(quantization == V4L2_QUANTIZATION_DEFAULT)
+    {
+        //RGB格式不涉及yuv转换，按照yuv格式推导量化范围即可
+        quantization = V4L2_MAP_QUANTIZATION_DEFAULT(false,colorspace,ycbcr_enc);
+    }
+    isTvRange = (quantization == V4L2_QUANTIZATION_LIM_RANGE);
+    printf("V4L2 color encoding:ycbcr_enc=%d\t isTvRange=%d\n",ycbcrEncoding,isTvRange);
+}
+/*
+ *@brief:  记录驱动协商的场格式
+ *注:V4L2_FIELD_ALTERNATE时驱动返回的高度为场高，每个缓冲帧只有一场，由反交错模块交织成完整帧后再处理，
+ *所以采集高度记为帧高(场高的两倍)，软解码、亮度帧等的尺寸都以帧高计算。
+ *@date:   2026.10.18
+ *@param:  field:场格式(V4L2_FIELD_*)  height:驱动返回的高度
+ */
+void V4L2Capture::updateField(uint field, uint height)
+{
+    fieldType = field;
+    if(fieldType == V4L2_FIELD_ALTERNATE)
+    {
+        pixelHeight = height*2;
+    }
+    deinterlacer.reset();
+    printf("V4L2 field:%d\t interlaced=%d\n",fieldType,Deinterlacer::isInterlaced(fieldType));
+}
 /*
  *@brief:   释放视频缓冲区的映射内存
  *@date:    2022.8.19
@@ -636,11 +830,12 @@ void V4L2Capture::unMmapBuffers()
  *@brief:   使用select机制自动从输出队列取缓冲帧
  *注：该函数内部是一个while循环，为避免阻塞主线程，外部使用信号触发使其工作在子线程，不要直接调用
  *@date:    2022.8.16
- *@update:  2024.3.8
- *@param:   needRgb24Frame:true=内部将原始帧转换为rgb24格式，并发射对应的信号
+ *@update:  2026.10.18
+ *@param:   needRgb24Frame:true=内部将原始帧转换为rgb格式(由setRgbOutputFormat()指定)，并发射对应的信号
  *@param:   needOriginFrame:true=获取原始帧数据并以信号的形式发射出去
+ *@param:   needLumaFrame:true=获取亮度(灰度)帧并以信号的形式发射出去(零拷贝或SIMD分离，几乎没有额外开销)
  */
-void V4L2Capture::selectCaptureSlot(bool needRgb24Frame, bool needOriginFrame)
+void V4L2Capture::selectCaptureSlot(bool needRgb24Frame, bool needOriginFrame, bool needLumaFrame)
 {
     if(!useSelectCapture)
     {
@@ -648,22 +843,23 @@ void V4L2Capture::selectCaptureSlot(bool needRgb24Frame, bool needOriginFrame)
     }
     if(needRgb24Frame)
     {
-        //双缓冲(避免通过信号发出去的帧数据来不及处理显示而被下一帧数据覆盖)
-        if(selectRgbFrameBuf == NULL)
-        {
-            selectRgbFrameBuf = (uchar *)malloc(pixelWidth*pixelHeight*3);
-        }
-        if(selectRgbFrameBuf2 == NULL)
-        {
-            selectRgbFrameBuf2 = (uchar *)malloc(pixelWidth*pixelHeight*3);
-        }
+        //缓冲区池(外部持有的帧不会被后续帧覆盖)，按照输出尺寸、4字节/像素申请，兼容所有rgb输出格式
+        rgbFramePool.setBufferSize(getRgbOutputWidth()*getRgbOutputHeight()*4);
     }
 
     //存放rgb帧的地址
-    uchar *curRgbFrameBuf = selectRgbFrameBuf;
+    uchar *curRgbFrameBuf = NULL;
     //存放原生帧的地址
     uchar *originFrameAddrVec[VIDEO_MAX_PLANES] = {NULL};
     uchar **originFrameAddr =needOriginFrame?originFrameAddrVec:NULL;
+    //存放亮度帧的地址
+    const uchar *lumaFrame = NULL;
+    const uchar **lumaFrameAddr = needLumaFrame?&lumaFrame:NULL;
+    //帧统计
+    FrameStatistics frameStats;
+    //帧间隔(场频输出时用于确定第二场的发射时间)
+    QElapsedTimer frameTimer;
+    qint64 frameIntervalUs = 0;
     //select机制所需变量
     fd_set fds,tmp_fds;
     struct timeval tv;
@@ -693,44 +889,136 @@ void V4L2Capture::selectCaptureSlot(bool needRgb24Frame, bool needOriginFrame)
         {
             if(needRgb24Frame)
             {
-                //双缓冲交换
-                if(curRgbFrameBuf == selectRgbFrameBuf2)
+                //从缓冲区池取空闲缓冲区，全部被外部持有时这一帧不进行rgb转换(仍然出队，避免驱动队列阻塞)
+                curRgbFrameBuf = rgbFramePool.acquire();
+                if(curRgbFrameBuf == NULL)
                 {
-                    curRgbFrameBuf = selectRgbFrameBuf;
+                    droppedRgbFrames++;
                 }
-                else
+                //获取并处理队列里的缓冲帧
+                if(!ioctlDequeueBuffers(curRgbFrameBuf,originFrameAddr,lumaFrameAddr,
+                                        frameStatisticsEnabled?&frameStats:NULL))
                 {
-                    curRgbFrameBuf = selectRgbFrameBuf2;
+                    rgbFramePool.release(curRgbFrameBuf);
                 }
-                //获取并处理队列里的缓冲帧
-                if(ioctlDequeueBuffers(curRgbFrameBuf,originFrameAddr))
+                else
                 {
                     //qDebug()<<"selectCaptureSlot-start:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
-                    emit captureRgb24FrameSig(curRgbFrameBuf);
+                    frameIntervalUs = frameTimer.isValid()?frameTimer.nsecsElapsed()/1000:0;
+                    frameTimer.start();
+                    if(motionDetectionEnabled && lastFrameReady)
+                    {
+                        emit motionDetectSig(motionDetector.lastResult());
+                    }
+                    if(curRgbFrameBuf && lastFrameChanged)
+                    {
+                        //QImage持有缓冲区，最后一个引用(包括排队信号中的拷贝)释放时归还
+                        QImage rgbImage = wrapRgbFrame(curRgbFrameBuf);
+                        emit captureRgbImageSig(rgbImage);
+                        emit captureRgb24FrameSig(curRgbFrameBuf);
+                    }
+                    else
+                    {
+                        //静止帧没有转换，直接归还缓冲区
+                        rgbFramePool.release(curRgbFrameBuf);
+                    }
                     if(originFrameAddr)
                     {
                         emit captureOriginFrameSig(originFrameAddr);
                     }
+                    if(lumaFrame)
+                    {
+                        emit captureLumaFrameSig(lumaFrame);
+                    }
+                    if(frameStatisticsEnabled && lastFrameChanged)
+                    {
+                        emit frameStatisticsSig(frameStats);
+                    }
+                    //场频输出:第二场与第一场间隔半帧发射(转换第二场的时间计入间隔)
+                    if(lastFrameChanged && deinterlacer.secondField())
+                    {
+                        curRgbFrameBuf = rgbFramePool.acquire();
+                        if(curRgbFrameBuf == NULL)
+                        {
+                            droppedRgbFrames++;
+                        }
+                        else if(fetchSecondField(curRgbFrameBuf))
+                        {
+                            emitSecondField(curRgbFrameBuf,frameIntervalUs/2 - frameTimer.nsecsElapsed()/1000);
+                        }
+                        else
+                        {
+                            rgbFramePool.release(curRgbFrameBuf);
+                        }
+                    }
                 }
             }
             else
             {
                 //获取并处理队列里的缓冲帧
-                if(ioctlDequeueBuffers(NULL,originFrameAddr))
+                if(ioctlDequeueBuffers(NULL,originFrameAddr,lumaFrameAddr,frameStatisticsEnabled?&frameStats:NULL))
                 {
                     //qDebug()<<"selectCaptureSlot-start:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
+                    if(motionDetectionEnabled && lastFrameReady)
+                    {
+                        emit motionDetectSig(motionDetector.lastResult());
+                    }
                     if(originFrameAddr)
                     {
                         emit captureOriginFrameSig(originFrameAddr);
                     }
+                    if(lumaFrame)
+                    {
+                        emit captureLumaFrameSig(lumaFrame);
+                    }
+                    if(frameStatisticsEnabled && lastFrameChanged)
+                    {
+                        emit frameStatisticsSig(frameStats);
+                    }
                 }
             }
         }
     }
 }
+/*
+ *@brief:   获取下一个亮度帧缓冲区(双缓冲，避免通过信号发出去的帧数据来不及处理而被下一帧覆盖)
+ *注:缓冲区大小随亮度帧尺寸(采集尺寸、缩小倍数)变化自动重新申请。
+ *@date:    2026.10.18
+ *@return:  uchar*:缓冲区地址
+ */
+uchar *V4L2Capture::nextLumaFrameBuf()
+{
+    const uint size = getLumaOutputWidth()*getLumaOutputHeight();
+    if(size != lumaFrameBufSize)
+    {
+        for(int i=0;i<2;i++)
+        {
+            free(lumaFrameBuf[i]);
+            lumaFrameBuf[i] = (uchar *)malloc(size);
+        }
+        lumaFrameBufSize = size;
+    }
+    lumaFrameBufIndex ^= 1;
+    return lumaFrameBuf[lumaFrameBufIndex];
+}
+/*
+ *@brief:   将缓冲区池中转换好的rgb帧封装成QImage(不拷贝)
+ *注:缓冲区的归还交由QImage负责，外部可以跨线程持有，直到最后一个引用释放之前都不会被后续帧覆盖。
+ *@date:    2026.10.18
+ *@param:   rgbFrame:rgbFramePool.acquire()取出并已转换的缓冲区
+ *@return:  QImage:rgb帧
+ */
+QImage V4L2Capture::wrapRgbFrame(uchar *rgbFrame)
+{
+    const uint width = getRgbOutputWidth();
+    return rgbFramePool.wrapImage(rgbFrame,width,getRgbOutputHeight(),
+                                  width*ColorToRgb24::bytesPerPixel(rgbOutputFormat),
+                                  rgbImageFormat(rgbOutputFormat));
+}
 /*
  *@brief:   清理select机制申请的相关资源
  *@date:    2022.8.19
+ *@update:  2026.10.18
  */
 void V4L2Capture::clearSelectResource()
 {
@@ -744,13 +1032,43 @@ void V4L2Capture::clearSelectResource()
             selectThread->wait(3000);
         }
     }
-    //释放缓冲帧内存
-    if(selectRgbFrameBuf)
+    //退出第二场的定时发射线程，尚未发射的第二场直接丢弃
+    if(fieldThread)
     {
-        free(selectRgbFrameBuf);
+        fieldThread->quit();
+        fieldThread->wait();
+        delete fieldEmitter;
+        fieldEmitter = NULL;
+        delete fieldThread;
+        fieldThread = NULL;
     }
-    if(selectRgbFrameBuf2)
+    //释放缓冲区池(外部仍持有的帧在归还时释放)
+    rgbFramePool.setBufferSize(0);
+}
+/*
+ *@brief:   场频输出时延时发射第二场的rgb帧
+ *注:采集循环不能等待半帧(会推迟下一个缓冲帧的出队、运动检测和统计，停止采集也会变慢)，第二场交给单独线程中的定时器，
+ *到时间后发射captureRgbImageSig()/captureRgb24FrameSig()(在该线程中发射，直接连接的接收者在该线程中执行)。
+ *QImage持有缓冲区，发射之前不会被后续帧覆盖。
+ *@date:   2026.10.18
+ *@param:   rgbFrame:已经转换好第二场的缓冲区(来自缓冲区池)
+ *@param:   delayUs:距离发射时间的微秒数(<=0时立即发射)
+ */
+void V4L2Capture::emitSecondField(uchar *rgbFrame, qint64 delayUs)
+{
+    if(!fieldThread)
     {
-        free(selectRgbFrameBuf2);
+        fieldThread = new QThread();
+        fieldEmitter = new QObject();
+        fieldEmitter->moveToThread(fieldThread);
+        fieldThread->start(QThread::HighPriority);
     }
+    const QImage rgbImage = wrapRgbFrame(rgbFrame);
+    const int delayMs = int(qMax(delayUs,qint64(0))/1000);
+    QMetaObject::invokeMethod(fieldEmitter,[this,rgbImage,rgbFrame,delayMs](){
+        QTimer::singleShot(delayMs,Qt::PreciseTimer,fieldEmitter,[this,rgbImage,rgbFrame](){
+            emit captureRgbImageSig(rgbImage);
+            emit captureRgb24FrameSig(rgbFrame);
+        });
+    },Qt::QueuedConnection);
 }
@@ -17,6 +17,18 @@
  *  2.2另一种是采用select机制自动取帧，该方式在处理性能跟得上的情况下，取帧速率跟帧率一致，每取完一帧数据
  *以信号的形式对外发送。要使用该方式只需在类构造函数中传递useSelect=true参数，内部会自动创建子线程自动
  *完成取帧处理，外部只需绑定相关信号即可。
+ *3.对于只需要灰度图的分析处理(运动检测、条码识别等)，可以只获取亮度(Y)帧，不进行rgb转换。Y平面连续存储的格式(NV12/NV21/YUV420等)
+ *在不缩小时直接返回映射内存中的Y平面(零拷贝)，packed格式(YUYV等)使用SIMD分离到内部缓冲区，可同时缩小。
+ *4.可以开启帧统计(直方图、均值、过曝/欠曝像素数，用于自动曝光和图像状态监测)：需要rgb帧时在软解码的同时统计输出帧，
+ *否则只统计原始帧的Y分量，都不需要额外遍历rgb帧。
+ *5.对于大部分时间画面静止的场景，可以开启运动检测(MotionDetector)：在缩小的亮度图上按块与参考图比较，静止帧跳过软解码和
+ *rgb帧信号，检测结果(变化掩码、变化比例、变化区域)每帧通过信号发射，供录像、分析等后续处理跳过未变化的帧或区域。
+ *6.模拟摄像头(PAL/NTSC)采集的隔行帧，根据驱动协商的场格式(INTERLACED/SEQ/ALTERNATE)进行反交错(Deinterlacer)，运动检测、
+ *软解码、亮度帧及统计都使用反交错后的逐行帧；原始帧保持交织(ALTERNATE/SEQ为交织后的完整帧)，由V4l2Rendering在着色器中反交错。
+ *Bob/运动自适应模式可开启场频输出，select方式在每个隔行帧之后间隔半帧再发射第二场的rgb帧(PAL 50帧，由单独线程定时发射，
+ *采集循环不等待)。
+ *7.select方式的rgb帧从固定数量的对齐缓冲区池(FrameBufferPool)中取缓冲区转换，以QImage的形式(captureRgbImageSig)发射，不拷贝，
+ *外部持有QImage期间缓冲区不会被后续帧覆盖，最后一个引用释放时自动归还；外部处理不过来占满缓冲区池时丢弃新帧的rgb转换。
  */
 #ifndef V4L2CAPTURE_H
 #define V4L2CAPTURE_H
@@ -34,9 +46,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
+#include "colortorgb24.h"
+#include "framestatistics.h"
+#include "motiondetector.h"
+#include "deinterlacer.h"
+#include "framebufferpool.h"
 
 //缓冲区数量，一般不低于3个，但太多的话按顺序刷新可能会造成视频延迟
 #define BUFFER_COUNT 3
+//select方式rgb帧缓冲区池的缓冲区数量(外部最多可同时持有的帧数)
+#define RGB_FRAME_POOL_COUNT 4
 
 class V4L2Capture:public QObject
 {
@@ -56,23 +75,70 @@ public:
     //设置视频流数据
     void ioctlSetInput(int inputIndex);//设置当前设备输入
     void ioctlSetStreamParm(uint captureMode,uint timeperframe=30);//设置视频流参数
-    void ioctlSetStreamFmt(uint pixelformat,uint width,uint height);//设置视频流格式
+    void ioctlSetStreamFmt(uint pixelformat,uint width,uint height,uint field=V4L2_FIELD_ANY);//设置视频流格式
     //初始化帧缓冲区
     bool ioctlRequestMmapBuffers();//申请并映射视频帧缓冲区到用户空间内存
     //帧采集控制
     void ioctlSetStreamSwitch(bool on);//启动/停止视频帧采集
-    bool ioctlDequeueBuffers(uchar *rgb24FrameAddr,uchar *originFrameAddr[]=NULL);//从输出队列取缓冲帧
+    bool ioctlDequeueBuffers(uchar *rgb24FrameAddr,uchar *originFrameAddr[]=NULL,
+                             const uchar **lumaFrameAddr=NULL,FrameStatistics *stats=NULL);//从输出队列取缓冲帧
+    //获取驱动协商后的颜色编码参数(ioctlSetStreamFmt()之后有效)，可传递给V4l2Rendering保持软/硬解码一致
+    uint getYcbcrEncoding(){return ycbcrEncoding;}//转换标准(V4L2_YCBCR_ENC_*)
+    bool getIsTvRange(){return isTvRange;}//true=TV Range  false=Full Range
+    //软解码输出的rgb帧格式(默认RGB888)，32位格式可直接用于QImage::Format_RGB32等，避免QPixmap::fromImage()再次转换
+    void setRgbOutputFormat(ColorToRgb24::RgbOutputFormat format){rgbOutputFormat = format;}
+    ColorToRgb24::RgbOutputFormat getRgbOutputFormat(){return rgbOutputFormat;}
+    //软解码输出的rgb帧尺寸(用于小窗口预览，在yuv空间缩放后再转换)，0表示与采集尺寸一致
+    void setRgbOutputSize(uint width,uint height){rgbOutputWidth = width;rgbOutputHeight = height;}
+    //软解码输出的裁剪、镜像、旋转参数，与转换一次完成(设置后输出尺寸由变换参数决定，setRgbOutputSize()不再生效)
+    void setRgbOutputTransform(const ColorToRgb24::FrameTransform &transform){rgbOutputTransform = transform;}
+    uint getRgbOutputWidth();
+    uint getRgbOutputHeight();
+    //rgb输出格式对应的QImage格式
+    static QImage::Format rgbImageFormat(ColorToRgb24::RgbOutputFormat format);
+    //select方式因缓冲区池占满而丢弃的rgb帧数(外部持有的帧过多或处理不过来)
+    uint getDroppedRgbFrames(){return droppedRgbFrames;}
+    //软解码的颜色调整参数(每个采集对象独立设置，可在其他线程调用，从下一帧开始生效)
+    void setColorAdjustParam(const double &brightness,const double &contrast,const double &saturation)
+    {rgbConverter.setColorAdjustment(brightness,contrast,saturation);}
+    //软解码的3D LUT颜色分级(在颜色调整之后应用，空指针表示关闭)
+    void setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D){rgbConverter.setColorLut3D(lut3D);}
+    //亮度(灰度)帧的缩小倍数(宽高各除以downsample，盒式滤波)，默认为1，大于1时不再零拷贝
+    void setLumaOutputDownsample(uint downsample){lumaOutputDownsample = downsample?downsample:1;}
+    uint getLumaOutputWidth(){return pixelWidth/lumaOutputDownsample;}
+    uint getLumaOutputHeight(){return pixelHeight/lumaOutputDownsample;}
+    //select取帧时是否统计每一帧(通过frameStatisticsSig()发射)，抽样步长只用于不需要rgb帧时的原始数据统计
+    void setFrameStatisticsEnabled(bool enabled,uint sampleStep=1)
+    {frameStatisticsEnabled = enabled;frameStatisticsStep = sampleStep?sampleStep:1;}
+    //运动检测开关，skipStaticFrames=true时未变化的帧不进行软解码(select方式也不发射rgb帧和帧统计信号)
+    void setMotionDetectionEnabled(bool enabled,bool skipStaticFrames=true)
+    {motionDetectionEnabled = enabled;motionSkipStaticFrames = skipStaticFrames;}
+    //运动检测参数(块尺寸、阈值、缩小倍数等)，需要在开始采集之前设置
+    MotionDetector *getMotionDetector(){return &motionDetector;}
+    bool isLastFrameChanged(){return lastFrameChanged;}//最近一次取出的帧是否变化(未开启运动检测时总为true)
+    //驱动协商的场格式(V4L2_FIELD_*，ioctlSetStreamFmt()之后有效)，ALTERNATE时采集高度为帧高(场高的两倍)
+    uint getField(){return fieldType;}
+    //反交错模式，fieldRate=true时Bob/运动自适应按场频输出(需要调用fetchSecondField()获取第二场，select方式自动发射)
+    void setDeinterlaceMode(Deinterlacer::Mode mode,bool fieldRate=false)
+    {deinterlacer.setMode(mode);deinterlacer.setFieldRate(fieldRate);}
+    //反交错参数(场序、运动阈值)，需要在开始采集之前设置
+    Deinterlacer *getDeinterlacer(){return &deinterlacer;}
+    bool fetchSecondField(uchar *rgb24FrameAddr);//场频输出时获取最近一次取出的隔行帧的第二场(软解码)
 
 signals:
     //向外发射采集到的帧数据信号
     void captureOriginFrameSig(uchar **originFrame);//原始数据帧(pixelFormat,二维长度针对多平面类型的数量，单平面为1)
-    void captureRgb24FrameSig(uchar *rgb24Frame);//转换后的rgb24数据帧,外部可通过QImage进行处理(镜像等)显示
+    void captureRgb24FrameSig(uchar *rgb24Frame);//转换后的rgb数据帧(格式由rgbOutputFormat决定),外部可通过QImage进行处理(镜像等)显示
+    void captureRgbImageSig(const QImage &image);//转换后的rgb帧(封装缓冲区池中的缓冲区，不拷贝，持有期间不会被覆盖)
+    void captureLumaFrameSig(const uchar *lumaFrame);//亮度(灰度)帧，宽高为getLumaOutputWidth()/getLumaOutputHeight()，每行连续存储
+    void frameStatisticsSig(const FrameStatistics &stats);//帧统计(setFrameStatisticsEnabled()开启后每帧发射一次)
+    void motionDetectSig(const MotionDetector::Result &result);//运动检测结果(setMotionDetectionEnabled()开启后每帧发射一次)
 
     //外部调用，用于触发selectCaptureSlot()槽在子线程中执行
-    void selectCaptureSig(bool needRgb24Frame,bool needOriginFrame);
+    void selectCaptureSig(bool needRgb24Frame,bool needOriginFrame,bool needLumaFrame=false);
 
 public slots:
-    void selectCaptureSlot(bool needRgb24Frame,bool needOriginFrame);
+    void selectCaptureSlot(bool needRgb24Frame,bool needOriginFrame,bool needLumaFrame=false);
 
 private:
     //查询设备信息
@@ -82,9 +148,15 @@ private:
     void ioctlEnumFmt();//查询设备支持的帧格式
     void ioctlGetStreamParm();//获取视频流参数
     void ioctlGetStreamFmt();//获取视频流格式
+    void updateColorEncoding(uint colorspace,uint ycbcr_enc,uint quantization);//确定yuv转换标准和量化范围
+    void updateField(uint field,uint height);//记录场格式
+    void convertFrame(uchar *frame,uchar *rgb24FrameAddr,FrameStatistics *stats);//软解码(按输出格式、尺寸、变换参数)
     //资源释放
     void unMmapBuffers();//释放视频缓冲区的映射内存
     void clearSelectResource();//清理select相关的资源
+    uchar *nextLumaFrameBuf();//获取下一个亮度帧缓冲区(双缓冲)
+    QImage wrapRgbFrame(uchar *rgbFrame);//将缓冲区池中转换好的rgb帧封装成QImage
+    void emitSecondField(uchar *rgbFrame,qint64 delayUs);//场频输出:延时发射第二场(不阻塞采集循环)
 
     /*采集设备参数*/
     QString cameraFileName;//设备文件名
@@ -97,12 +169,34 @@ private:
     uint pixelFormat = 0;//采集帧格式
     uint pixelWidth = 720;//像素宽度
     uint pixelHeight = 576;//像素高度
+    uint ycbcrEncoding = V4L2_YCBCR_ENC_601;//yuv转rgb的转换标准(由VIDIOC_G_FMT返回的colorspace/ycbcr_enc确定)
+    bool isTvRange = false;//yuv量化范围(由VIDIOC_G_FMT返回的quantization确定)
+    ColorToRgb24::RgbOutputFormat rgbOutputFormat = ColorToRgb24::RGB888;//软解码输出的rgb帧格式
+    uint rgbOutputWidth = 0;//软解码输出的rgb帧尺寸(0表示与采集尺寸一致)
+    uint rgbOutputHeight = 0;
+    ColorToRgb24::FrameTransform rgbOutputTransform;//软解码输出的裁剪、镜像、旋转参数
+    ColorToRgb24 rgbConverter;//软解码转换对象(持有本采集对象独立的颜色调整参数)
+    uint lumaOutputDownsample = 1;//亮度帧的缩小倍数
+    uchar *lumaFrameBuf[2] = {NULL,NULL};//亮度帧双缓冲(仅在不能零拷贝时使用)
+    uint lumaFrameBufSize = 0;
+    uint lumaFrameBufIndex = 0;
+    bool frameStatisticsEnabled = false;//select取帧时是否统计每一帧
+    uint frameStatisticsStep = 1;//原始数据统计的抽样步长
+    MotionDetector motionDetector;//运动检测
+    bool motionDetectionEnabled = false;
+    bool motionSkipStaticFrames = true;//未变化的帧跳过软解码
+    bool lastFrameChanged = true;//最近一次取出的帧是否变化
+    uint fieldType = V4L2_FIELD_NONE;//驱动协商的场格式
+    Deinterlacer deinterlacer;//反交错
+    bool lastFrameReady = true;//最近一次取出的缓冲帧是否得到完整帧(ALTERNATE未开启场频输出时每对场的第一场只交织)
 
     /*select采集*/
     bool useSelectCapture = false;//是否使用select采集
     QThread *selectThread = NULL;//专用线程
-    uchar *selectRgbFrameBuf = NULL;//双缓冲帧
-    uchar *selectRgbFrameBuf2 = NULL;
+    QThread *fieldThread = NULL;//场频输出第二场的定时发射线程(首次使用时创建)
+    QObject *fieldEmitter = NULL;//运行在fieldThread中的定时器上下文
+    FrameBufferPool rgbFramePool{RGB_FRAME_POOL_COUNT};//rgb帧缓冲区池
+    uint droppedRgbFrames = 0;
 
     /*缓存帧内存映射信息*/
     struct BufferMmap//单平面
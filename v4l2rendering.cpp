@@ -10,8 +10,45 @@
  *@brief:   负责渲染处理V4L2帧数据(基于opengl的api)
  */
 #include "v4l2rendering.h"
+#include "colortorgb24.h"
+#include "colorlut3d.h"
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
+#include <QDebug>
+#include <QThread>
+#include <QtAlgorithms>
+#include <string.h>
+
+//PBO及缓冲区存储相关的宏(部分OpenGL ES头文件中没有定义)
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+#ifndef GL_WAIT_FAILED
+#define GL_WAIT_FAILED 0x911D
+#endif
+
+//着色器程序的特化参数(缓存的key):bit0=颜色调整 bit1=3D LUT bit2~=反交错模式
+#define SHADER_KEY_COLOR_ADJUST 0x1
+#define SHADER_KEY_LUT3D 0x2
+#define SHADER_KEY_DEINTERLACE_SHIFT 2
 
 /*
  *@brief:  构造函数
@@ -24,18 +61,37 @@ V4l2Rendering::V4l2Rendering(uint pixel_format, uint pixel_width, uint pixel_hei
     : QObject(parent),pixelFormat(pixel_format),pixelWidth(pixel_width),pixelHeight(pixel_height),isTVRange(is_tv_range),
     texture1(QOpenGLTexture::Target2D),texture2(QOpenGLTexture::Target2D),texture3(QOpenGLTexture::Target2D)
 {
-
+    for(int i=0;i<UNPACK_BUFFER_COUNT;i++)
+    {
+        unpackBuffers[i] = QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer);
+    }
+    for(int i=0;i<READBACK_BUFFER_COUNT;i++)
+    {
+        readbacks[i].buffer = QOpenGLBuffer(QOpenGLBuffer::PixelPackBuffer);
+        readbacks[i].buffer.setUsagePattern(QOpenGLBuffer::StreamRead);
+    }
 }
 /*
  *@brief:  析构函数，释放资源
  *@date:   2025.08.20
+ *@update: 2026.10.18
  */
 V4l2Rendering::~V4l2Rendering()
 {
-    if(FBO)
+    //结束截图的后台线程(尚未处理的截图直接丢弃)
+    if(readbackThread)
     {
-        delete FBO;
+        readbackThread->quit();
+        readbackThread->wait();
+        delete readbackWorker;
+        delete readbackThread;
     }
+    destroyFBOPool();
+    if(lut3DTexture)
+    {
+        delete lut3DTexture;
+    }
+    destroyShaderPrograms();
 }
 /*
  *@brief:  建立OpenGL的资源和状态
@@ -46,6 +102,7 @@ V4l2Rendering::~V4l2Rendering()
  *一次，不过该操作意味着应用程序中不同的顶层窗口之间也能共享上下文。如果不想这么做，则可以优化initializeGL()函数内部的处理
  *使其支持多次调用，这也是目前采取的方案(关键点是在initTextures()函数中处理纹理对象的销毁和创建)。
  *@date:   2024.05.17
+ *@update: 2026.10.18
  */
 void V4l2Rendering::initializeGL()
 {
@@ -64,27 +121,14 @@ void V4l2Rendering::initializeGL()
     VAO.bind();//将顶点数组对象绑定到opengl绑定点，直到release保存着顶点数据状态的所有修改
     VBO.create();//创建缓存对象(向GPU申请创建)，本质是一段可供使用的GPU内存
     VBO.bind();//绑定到当前顶点缓存区
-    VBO.setUsagePattern(QOpenGLBuffer::StaticDraw);//设置为一次修改，多次使用(坐标不变,变得只是像素点)提高优化效率
-    //顶点数据(顶点坐标(3float[-1.0f-1.0f])+纹理坐标(2float[0.0f-1.0f]))
-    //opengl标准化设备坐标以屏幕中心为原点，坐标在[-1,1]之间。纹理坐标则以左下角为原点，范围为[0,1]
-    //这里纹理坐标的Y方向需要设置成反的,因为纹理坐标以左下角为原点，而显示纹理以左上角为坐标原点
-    float vertices[] = {
-        //顶点坐标            //纹理坐标
-        -1.0f, -1.0f, 0.0f,  0.0f, 1.0f,        //左下
-        1.0f,  -1.0f, 0.0f,  1.0f, 1.0f,        //右下
-        -1.0f, 1.0f,  0.0f,  0.0f, 0.0f,        //左上
-        1.0f,  1.0f,  0.0f,  1.0f, 0.0f         //右上
-    };
-    VBO.allocate(vertices,sizeof(vertices));//分配显存大小，并绑定顶点数据到缓存区
-    //初始化FBO
-    QOpenGLFramebufferObjectFormat fboFormat;
+    VBO.setUsagePattern(QOpenGLBuffer::DynamicDraw);//镜像、旋转参数改变时重新写入，其余时间多次使用
+    //顶点数据(4个顶点，顶点坐标(3float)+纹理坐标(2float))，由镜像、裁剪、旋转参数计算，见updateVertexData()
+    VBO.allocate(4*5*sizeof(float));//分配显存大小
+    updateVertexData();
+    //初始化FBO格式，离屏渲染的FBO在首次使用时按尺寸等级创建(见acquireFBO())
     fboFormat.setAttachment(QOpenGLFramebufferObject::NoAttachment);//2D渲染，不需要深度和模板测试
     fboFormat.setSamples(0);//视频帧非几何渲染，不使用多重采样
-    if(FBO){
-        delete FBO;
-    }
-    //离屏FBO的size设置成原始像素帧size乘以裁剪比例
-    FBO = new QOpenGLFramebufferObject(pixelWidth*cropRectParam.width,pixelHeight*cropRectParam.height,fboFormat);
+    destroyFBOPool();
 
     /* 2.初始化着色器
      * 使用GLSL语言编写的顶点着色器和片段着色器程序，集成了部分yuv格式的转换处理。
@@ -92,8 +136,10 @@ void V4l2Rendering::initializeGL()
     initVertexShader();
     initFragmentShader();
 
-    /*3.初始化纹理*/
+    /*3.初始化纹理及上传帧数据使用的PBO*/
     initTexture();
+    initUnpackBuffers();
+    initReadbackBuffers();
 
     /*4.初始化着色器程序*/
     initShaderProgram();
@@ -114,34 +160,80 @@ void V4l2Rendering::resizeGL(int w, int h)
 }
 /*
  *@brief:  渲染OpenGL场景
+ *注:截图时先将本帧渲染到FBO，支持异步读取时只发起读取(没有空闲的PBO时留到下一帧)，由之后的paintGL()或pollReadback()
+ *取回，否则同步读取。设置了多分辨率输出时每个新帧再渲染一次各层FBO。关闭直接渲染时(离屏转换)只渲染到FBO，不访问默认帧缓冲；
+ *设置了渲染目标(渲染线程模式)时直接渲染到该FBO，函数返回时保持其绑定。
  *@date:   2024.05.17
+ *@update: 2026.10.18
  */
 void V4l2Rendering::paintGL()
 {
-    glClear(GL_COLOR_BUFFER_BIT);//防止叠图
+    if(directRenderEnabled)
+    {
+        if(renderTarget)
+        {
+            renderTarget->bind();
+        }
+        glClear(GL_COLOR_BUFFER_BIT);//防止叠图
+    }
 
+    //取回之前已经完成的截图读取
+    pollReadback();
+    //裁剪区域的过渡动画
+    updateCropAnimation();
     //仅在纹理对象有效(setData)的情况下才绘制纹理
     if(isVaildTexture)
     {
-        if(needCaptureImage && FBO->isValid())
+        const QSize imageSize = captureImageSize();
+        QOpenGLFramebufferObject *FBO = captureImageCount?acquireFBO(imageSize):nullptr;
+        if(FBO)
         {
             //绑定FBO，将本次绘制渲染到帧缓冲对象上
             FBO->bind();
-            glViewport(0,0,pixelWidth*cropRectParam.width,
-                       pixelHeight*cropRectParam.height);//FBO使用帧的原始像素大小乘以裁剪比例，需要调整gl视图
+            glViewport(0,0,imageSize.width(),imageSize.height());//图片只占用FBO左下角的区域(FBO按尺寸等级分配)，需要调整gl视图
             //在FBO上绘制纹理
             paintGLTexture();
-            //将FBO转换成QImage并通过信号发射出去，参数true表示对OpenGL坐标进行翻转到光栅坐标
-            QImage image = FBO->toImage(true);
-            emit captureImageSig(image);
-            //释放FBO绑定，重置采集标识
+            if(isReadbackSupported)
+            {
+                //异步读取到PBO，完成后再取回
+                if(startReadback(imageSize))
+                {
+                    captureImageCount--;
+                }
+            }
+            else
+            {
+                //将FBO转换成QImage并通过信号发射出去，参数true表示对OpenGL坐标进行翻转到光栅坐标(翻转后图片区域位于底部)
+                QImage image = FBO->toImage(true).copy(0,FBO->height()-imageSize.height(),
+                                                       imageSize.width(),imageSize.height());
+                emit captureImageSig(image);
+                captureImageCount--;
+            }
+            //释放FBO绑定
             FBO->release();
-            needCaptureImage = false;
             glViewport(0,0,widgetWidth,widgetHeight);//恢复成组件的视图大小
         }
+        //多分辨率输出(每个新帧一次)
+        if(pyramidFramePending)
+        {
+            pyramidFramePending = false;
+            if(!pyramidSizes.isEmpty())
+            {
+                paintPyramid();
+            }
+        }
         //执行直接渲染到显示组件
-        paintGLTexture();
+        if(directRenderEnabled)
+        {
+            if(renderTarget)
+            {
+                renderTarget->bind();//离屏渲染释放FBO时恢复的是默认帧缓冲
+            }
+            paintGLTexture();
+        }
     }
+    //本次使用的FBO归还到池中(读取已经提交到GPU命令队列，之后复用不影响结果)
+    releaseFBOs();
 }
 /*
  *@brief:  设置镜像调整参数
@@ -162,11 +254,33 @@ void V4l2Rendering::setMirrorParam(const bool &hMirror, const bool &vMirror)
         mirrorParamChanged = true;
     }
 }
+/*
+ *@brief:  设置旋转参数
+ *注:旋转在镜像之后进行，旋转90/270度时画面宽高互换，显示组件的宽高比需要外部相应调整，离屏渲染的Image也会自动互换宽高。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  rotation:顺时针旋转角度(0/90/180/270)，其他值无效
+ *@return: bool:true=设置成功  false=不支持的角度(保持原来的旋转参数)
+ */
+bool V4l2Rendering::setRotationParam(const uint &rotation)
+{
+    if(!isRotationSupported(rotation))
+    {
+        return false;
+    }
+    if(this->rotation != rotation)
+    {
+        this->rotation = rotation;
+        rotationParamChanged = true;
+    }
+    return true;
+}
 /*
  *@brief:  初始化裁剪参数
- *注:该接口如果需要使用，必须在initializeGL()之前调用，即QOpenGLWidget组件显示之前调用，不支持动态调节裁剪参数。
- *之所以不支持动态调节，一是这种需求很少，二是静态设置方便离屏渲染Image的处理，FBO的size可以设置成固定的，不用来回改。
+ *注:裁剪参数只影响顶点的纹理坐标和离屏渲染的图片尺寸，离屏渲染的FBO来自按尺寸等级划分的FBO池，所以支持在任意时刻调用
+ *(运行时调节见setCropRect())，该接口会结束正在进行的裁剪动画。
  *@date:   2025.08.22
+ *@update: 2026.10.18
  *@param:  left_top_x,left_top_y:裁剪区域的左顶点,不可以超过真实图像宽高
  *@param:  width,height:裁剪区域的宽高,不可以超过真实图像宽高
  *@return: bool:true=初始化成功
@@ -178,14 +292,160 @@ bool V4l2Rendering::initCropRectParam(const uint &left_top_x, const uint &left_t
             width <= pixelWidth && height <= pixelHeight)
     {
         //对参数进行归一化处理[0,1]
-        cropRectParam.left_top_x = left_top_x*1.0/pixelWidth;
-        cropRectParam.left_top_y = left_top_y*1.0/pixelHeight;
-        cropRectParam.width = width*1.0/pixelWidth;
-        cropRectParam.height = height*1.0/pixelHeight;
+        cropAnimation.active = false;
+        applyCropRect(QRectF(left_top_x*1.0/pixelWidth,left_top_y*1.0/pixelHeight,
+                             width*1.0/pixelWidth,height*1.0/pixelHeight));
         return true;
     }
     return false;
 }
+/*
+ *@brief:  运行时设置裁剪区域(数字平移/变焦)
+ *注:区域超出画面的部分被截掉，宽高至少为一个像素。duration>0时从当前区域开始在该时长内平滑过渡(缓入缓出)，过渡期间
+ *每次paintGL()按经过的时间插值，调用者需要保持刷新(见isCropAnimating())。
+ *@date:   2026.10.18
+ *@param:  rect:裁剪区域(归一化[0,1]，左上角为原点)
+ *@param:  duration:过渡时长(ms)，0表示立即生效
+ *@return: bool:true=设置成功  false=区域与画面不相交
+ */
+bool V4l2Rendering::setCropRect(const QRectF &rect, int duration)
+{
+    QRectF target = rect.normalized().intersected(QRectF(0,0,1,1));
+    if(target.isEmpty())
+    {
+        return false;
+    }
+    target.setWidth(qMax(target.width(),1.0/pixelWidth));
+    target.setHeight(qMax(target.height(),1.0/pixelHeight));
+    if(duration > 0)
+    {
+        cropAnimation.from = cropRect();
+        cropAnimation.to = target;
+        cropAnimation.duration = duration;
+        cropAnimation.timer.start();
+        cropAnimation.active = true;
+    }
+    else
+    {
+        cropAnimation.active = false;
+        applyCropRect(target);
+    }
+    return true;
+}
+/*
+ *@brief:  数字变焦
+ *注:裁剪区域为画面的1/zoom，中心超出范围时平移到画面内(区域不缩小)。
+ *@date:   2026.10.18
+ *@param:  zoom:放大倍数(>=1，1表示不裁剪)
+ *@param:  center:裁剪区域中心(归一化[0,1]，左上角为原点)
+ *@param:  duration:过渡时长(ms)，0表示立即生效
+ *@return: bool:true=设置成功
+ */
+bool V4l2Rendering::setDigitalZoom(const float &zoom, const QPointF &center, int duration)
+{
+    if(zoom < 1.0f)
+    {
+        return false;
+    }
+    const qreal size = 1.0/zoom;
+    const qreal x = qBound(0.0,center.x() - size/2,1.0 - size);
+    const qreal y = qBound(0.0,center.y() - size/2,1.0 - size);
+    return setCropRect(QRectF(x,y,size,size),duration);
+}
+/*
+ *@brief:  获取当前的裁剪区域
+ *@date:   2026.10.18
+ *@return: QRectF:裁剪区域(归一化[0,1]，左上角为原点)
+ */
+QRectF V4l2Rendering::cropRect()
+{
+    return QRectF(cropRectParam.left_top_x,cropRectParam.left_top_y,
+                  cropRectParam.width,cropRectParam.height);
+}
+/*
+ *@brief:  应用裁剪区域，下次绘制时重新计算顶点数据
+ *@date:   2026.10.18
+ *@param:  rect:裁剪区域(归一化[0,1])
+ */
+void V4l2Rendering::applyCropRect(const QRectF &rect)
+{
+    cropRectParam.left_top_x = rect.x();
+    cropRectParam.left_top_y = rect.y();
+    cropRectParam.width = rect.width();
+    cropRectParam.height = rect.height();
+    cropRectParamChanged = true;
+}
+/*
+ *@brief:  按经过的时间更新裁剪区域的过渡动画
+ *@date:   2026.10.18
+ */
+void V4l2Rendering::updateCropAnimation()
+{
+    if(!cropAnimation.active)
+    {
+        return;
+    }
+    qreal t = qreal(cropAnimation.timer.elapsed())/cropAnimation.duration;
+    if(t >= 1.0)
+    {
+        t = 1.0;
+        cropAnimation.active = false;
+    }
+    t = t*t*(3.0 - 2.0*t);//缓入缓出(smoothstep)
+    const QRectF &from = cropAnimation.from;
+    const QRectF &to = cropAnimation.to;
+    applyCropRect(QRectF(from.x() + (to.x() - from.x())*t,from.y() + (to.y() - from.y())*t,
+                         from.width() + (to.width() - from.width())*t,
+                         from.height() + (to.height() - from.height())*t));
+}
+/*
+ *@brief:  设置yuv颜色编码参数(转换标准和量化范围)
+ *注:该参数通常来自采集模块(V4L2Capture::getYcbcrEncoding()/getIsTvRange())，与软解码保持一致，支持动态调整。
+ *@date:   2026.10.18
+ *@param:  ycbcr_enc:转换标准(V4L2_YCBCR_ENC_601/V4L2_YCBCR_ENC_709/V4L2_YCBCR_ENC_BT2020)
+ *@param:  is_tv_range:true=TV Range   false=FULL Range
+ */
+void V4l2Rendering::setColorEncodingParam(const uint &ycbcr_enc, const bool &is_tv_range)
+{
+    if(ycbcrEncoding != ycbcr_enc || isTVRange != is_tv_range)
+    {
+        ycbcrEncoding = ycbcr_enc;
+        isTVRange = is_tv_range;
+        colorEncodingParamChanged = true;
+    }
+}
+/*
+ *@brief:  获取当前转换标准和量化范围对应的yuv转rgb矩阵
+ *注:TV Range的缩放(y:255/219 uv:255/224)合并到矩阵的列中，着色器中不再需要判断range，偏移见yuvToRgbOffset()。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@return: QMatrix3x3:按行优先排列的转换矩阵，rgb = matrix * (y,u,v) + offset，yuv为纹理采样的原始值[0,1]
+ */
+QMatrix3x3 V4l2Rendering::yuvToRgbMatrix()
+{
+    const YuvToRgbCoef coef = yuvToRgbCoef(ycbcrEncoding);
+    const float ys = isTVRange?255.0f/219.0f:1.0f;
+    const float uvs = isTVRange?255.0f/224.0f:1.0f;
+    const float values[] = {ys, 0.0f,          coef.rv*uvs,
+                            ys, -coef.gu*uvs,  -coef.gv*uvs,
+                            ys, coef.bu*uvs,   0.0f};
+    return QMatrix3x3(values);
+}
+/*
+ *@brief:  获取当前转换标准和量化范围对应的rgb偏移
+ *注:Full Range时为-M*(0,0.5,0.5)，TV Range时为-M*(16/219,16/224+0.5,16/224+0.5)，M为Full Range的转换矩阵。
+ *@date:   2026.10.18
+ *@return: QVector3D:与yuvToRgbMatrix()配合使用的rgb偏移
+ */
+QVector3D V4l2Rendering::yuvToRgbOffset()
+{
+    const YuvToRgbCoef coef = yuvToRgbCoef(ycbcrEncoding);
+    const float y0 = isTVRange?16.0f/219.0f:0.0f;
+    const float uv0 = isTVRange?16.0f/224.0f + 0.5f:0.5f;
+    return QVector3D(-(y0 + coef.rv*uv0),
+                     -(y0 - coef.gu*uv0 - coef.gv*uv0),
+                     -(y0 + coef.bu*uv0));
+}
 /*
  *@brief:  设置颜色调整参数
  *@date:   2025.08.14
@@ -218,11 +478,71 @@ void V4l2Rendering::setColorAdjustParam(const bool &enableColorAdjust, const flo
         colorAdjustParamChanged = true;
     }
 }
+/*
+ *@brief:  设置3D LUT颜色分级
+ *注:LUT在片段着色器的伽马校正之后应用，纹理数据在下一次绘制时(OpenGL上下文中)上传，支持动态切换。
+ *@date:   2026.10.18
+ *@param:  lut3D:已加载的3D LUT，空指针或无效的LUT表示关闭颜色分级
+ */
+void V4l2Rendering::setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D)
+{
+    if(colorLut3D != lut3D)
+    {
+        colorLut3D = lut3D;
+        colorLut3DChanged = true;
+    }
+}
+/*
+ *@brief:  设置反交错参数
+ *注:着色器中的运动自适应没有上一帧，使用梳状检测(当前行同时高于或低于上下两行且差值超过阈值时插值)，阈值与软件实现一致。
+ *@date:   2026.10.18
+ *@param:  mode:反交错模式(Deinterlacer::Mode)
+ *@param:  topFieldFirst:true=顶场优先(PAL)  false=底场优先(NTSC)，可由Deinterlacer::isTopFieldFirst()确定
+ *@param:  fieldRate:true=场频输出(Bob/MotionAdaptive)，每一帧依次显示第一场、第二场
+ */
+void V4l2Rendering::setDeinterlaceParam(const Deinterlacer::Mode &mode, const bool &topFieldFirst, const bool &fieldRate)
+{
+    if(deinterlaceParam.mode != mode || deinterlaceParam.topFieldFirst != topFieldFirst ||
+            deinterlaceParam.fieldRate != fieldRate)
+    {
+        deinterlaceParam.mode = mode;
+        deinterlaceParam.topFieldFirst = topFieldFirst;
+        deinterlaceParam.fieldRate = fieldRate;
+        deinterlaceParamChanged = true;
+    }
+}
+/*
+ *@brief:  是否按场频输出(场频输出参数有效且模式为Bob或MotionAdaptive)
+ *@date:   2026.10.18
+ *@return: bool:true=每一帧需要绘制两次
+ */
+bool V4l2Rendering::isFieldRateOutput()
+{
+    return deinterlaceParam.fieldRate && (deinterlaceParam.mode == Deinterlacer::Bob ||
+                                          deinterlaceParam.mode == Deinterlacer::MotionAdaptive);
+}
+/*
+ *@brief:  场频输出时切换到当前帧的第二场，下一次绘制生效
+ *@date:   2026.10.18
+ *@return: bool:true=已切换，需要重绘  false=未开启场频输出或已经是第二场
+ */
+bool V4l2Rendering::showSecondField()
+{
+    if(!isFieldRateOutput() || currentField != 0)
+    {
+        return false;
+    }
+    currentField = 1;
+    deinterlaceParamChanged = true;
+    return true;
+}
 /*
  *@brief:  更新(渲染)v4l2帧数据
  *注：此处调用QOpenGLTexture的setData时，参数PixelFormat需要与initTexture()中的format保持一致，初期使用Red、RG、RGB、RGBA，
  *后面为了与LuminanceFormat等对应起来，改用Luminance、LuminanceAlpha、RGB、RGBA。
+ *支持PBO时帧数据先拷贝到PBO再更新纹理，纹理的更新由驱动异步完成，不会阻塞到GPU使用完上一帧的纹理。需要在OpenGL上下文中调用。
  *@date:   2024.05.17
+ *@update: 2026.10.18
  *@param:  v4l2FrameData:v4l2帧二维指针(指针数组)，planes根据pixelFormat格式在内部自动确定
  *对于多平面planes每一个元素对应着一个平面(不连续)v4l2FrameData[0]即完整的yuv数据
  */
@@ -234,61 +554,137 @@ void V4l2Rendering::updateV4l2Frame(uchar **v4l2FrameData)
         return;
     }
     isVaildTexture = true;
+    pyramidFramePending = true;
+    //新的一帧从第一场开始显示
+    if(currentField != 0)
+    {
+        currentField = 0;
+        deinterlaceParamChanged = true;
+    }
+    //通过PBO上传:拷贝到PBO后纹理从PBO更新(数据地址为PBO内的偏移)，由驱动异步完成
+    if(pboUploadEnabled && unpackBuffers[0].isCreated())
+    {
+        copyToUnpackBuffer(v4l2FrameData[0]);
+        uploadTextures(nullptr);
+        if(isPboPersistent)
+        {
+            //持久映射的PBO在GPU读取完之前不能再次写入
+            unpackBufferFences[unpackBufferIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+        }
+        unpackBuffers[unpackBufferIndex].release();
+        unpackBufferIndex = (unpackBufferIndex + 1)%UNPACK_BUFFER_COUNT;
+    }
+    else
+    {
+        uploadTextures(v4l2FrameData[0]);
+    }
+}
+/*
+ *@brief:  更新纹理对象的数据
+ *注:绑定了PBO时frameData为PBO内的偏移(nullptr即PBO起始处)，否则为帧数据在内存中的地址。
+ *@date:   2026.10.18
+ *@param:  frameData:完整的帧数据(各平面连续存储)
+ */
+void V4l2Rendering::uploadTextures(const uchar *frameData)
+{
     //one planes格式，设置两个纹理对象数据
     if(pixelFormat == V4L2_PIX_FMT_YUYV ||
             pixelFormat == V4L2_PIX_FMT_YVYU)
     {
         //纹理对象能够根据size自动读取对应字节的数据
-        texture1.setData(QOpenGLTexture::LuminanceAlpha, QOpenGLTexture::UInt8, v4l2FrameData[0],&pixelTransferOptions1);
-        texture2.setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, v4l2FrameData[0],&pixelTransferOptions2);
+        texture1.setData(QOpenGLTexture::LuminanceAlpha, QOpenGLTexture::UInt8, frameData,&pixelTransferOptions1);
+        texture2.setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, frameData,&pixelTransferOptions2);
     }
     //two planes格式，设置两个纹理对象数据
     else if(pixelFormat == V4L2_PIX_FMT_NV12 ||
             pixelFormat == V4L2_PIX_FMT_NV21)
     {
         //纹理对象能够根据size自动读取对应字节的数据
-        texture1.setData(QOpenGLTexture::Luminance, QOpenGLTexture::UInt8, v4l2FrameData[0],&pixelTransferOptions1);
-        texture2.setData(QOpenGLTexture::LuminanceAlpha, QOpenGLTexture::UInt8, v4l2FrameData[0]+pixelWidth*pixelHeight,&pixelTransferOptions2);
+        texture1.setData(QOpenGLTexture::Luminance, QOpenGLTexture::UInt8, frameData,&pixelTransferOptions1);
+        texture2.setData(QOpenGLTexture::LuminanceAlpha, QOpenGLTexture::UInt8, frameData+pixelWidth*pixelHeight,&pixelTransferOptions2);
     }
     //three planes格式，设置三个纹理对象数据
     else if(pixelFormat == V4L2_PIX_FMT_YUV420 ||
             pixelFormat == V4L2_PIX_FMT_YVU420)
     {
         //纹理对象能够根据size自动读取对应字节的数据
-        texture1.setData(QOpenGLTexture::Luminance, QOpenGLTexture::UInt8, v4l2FrameData[0],&pixelTransferOptions1);
-        texture2.setData(QOpenGLTexture::Luminance, QOpenGLTexture::UInt8, v4l2FrameData[0]+pixelWidth*pixelHeight,&pixelTransferOptions2);
-        texture3.setData(QOpenGLTexture::Luminance, QOpenGLTexture::UInt8, v4l2FrameData[0]+pixelWidth*pixelHeight*5/4,&pixelTransferOptions3);
+        texture1.setData(QOpenGLTexture::Luminance, QOpenGLTexture::UInt8, frameData,&pixelTransferOptions1);
+        texture2.setData(QOpenGLTexture::Luminance, QOpenGLTexture::UInt8, frameData+pixelWidth*pixelHeight,&pixelTransferOptions2);
+        texture3.setData(QOpenGLTexture::Luminance, QOpenGLTexture::UInt8, frameData+pixelWidth*pixelHeight*5/4,&pixelTransferOptions3);
+    }
+}
+/*
+ *@brief:  将帧数据拷贝到下一个PBO
+ *注:持久映射时先等待该PBO上一次的栅栏(轮流使用多个PBO，正常情况下GPU早已读取完，不会真正等待)，再直接拷贝到映射地址；
+ *否则先重新分配存储(orphan，驱动为本次写入提供新的内存，不需要等待GPU读取完旧数据)，再映射写入，不支持映射
+ *(glMapBufferRange需要OpenGL 3.0)时在重新分配的同时写入数据。拷贝完成后PBO保持绑定，由调用者更新纹理后释放。
+ *@date:   2026.10.18
+ *@param:  frameData:完整的帧数据(各平面连续存储)
+ */
+void V4l2Rendering::copyToUnpackBuffer(const uchar *frameData)
+{
+    QOpenGLBuffer &unpackBuffer = unpackBuffers[unpackBufferIndex];
+    unpackBuffer.bind();
+    if(isPboPersistent)
+    {
+        GLsync &fence = unpackBufferFences[unpackBufferIndex];
+        if(fence)
+        {
+            glClientWaitSync(fence,GL_SYNC_FLUSH_COMMANDS_BIT,100000000);//最多等待100ms
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+        memcpy(unpackBufferMapped[unpackBufferIndex],frameData,unpackBufferSize);
+        return;
+    }
+    unpackBuffer.allocate(unpackBufferSize);
+    void *mapped = unpackBuffer.mapRange(0,unpackBufferSize,QOpenGLBuffer::RangeWrite|QOpenGLBuffer::RangeInvalidateBuffer);
+    if(mapped == nullptr)
+    {
+        unpackBuffer.allocate(frameData,unpackBufferSize);
+        return;
     }
+    memcpy(mapped,frameData,unpackBufferSize);
+    unpackBuffer.unmap();
+}
+/*
+ *@brief:  获取离屏渲染Image的尺寸(原始像素帧size乘以裁剪比例，旋转90/270度时宽高互换)
+ *注:设置了输出尺寸(setCaptureImageSize())时使用该尺寸，缩小由纹理的线性过滤完成(缩小超过一半时会有一定的混叠)。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@return: QSize:Image尺寸
+ */
+QSize V4l2Rendering::captureImageSize()
+{
+    if(captureOutputSize.isValid() && !captureOutputSize.isEmpty())
+    {
+        return captureOutputSize;
+    }
+    int width = qMax(qRound(pixelWidth*cropRectParam.width),1);
+    int height = qMax(qRound(pixelHeight*cropRectParam.height),1);
+    if(rotation == 90 || rotation == 270)
+    {
+        return QSize(height,width);
+    }
+    return QSize(width,height);
 }
 /*
  *@brief:  初始化顶点着色器
+ *注:镜像、裁剪和旋转已经在CPU端计算到顶点数据中(updateVertexData())，顶点着色器直接传递顶点坐标和纹理坐标。
  *@date:   2024.05.17
+ *@update: 2026.10.18
  */
 void V4l2Rendering::initVertexShader()
 {
     /*顶点着色器，两个输入(顶点坐标(vec3)+纹理坐标(vec2)),其中顶点坐标转成vec4传给内置变量。
-     *若干uniform全局变量(在外部传递镜像参数和裁剪参数)，一个输出(纹理坐标，根据镜像参数将输入的纹理坐标
-     *进行处理后传给该输出)传递给下一个着色器*/
+     *一个输出(纹理坐标)传递给下一个着色器*/
     vertexShader = QString("attribute vec3 aPos;\n"
                            "attribute vec2 aTexCoord;\n"
                            "varying vec2 TexCoord;\n\n"
-                           //镜像参数
-                           "uniform bool hMirror;\n"
-                           "uniform bool vMirror;\n"
-                           //裁剪参数(cropRect[x, y, width, height]为归一化的裁剪区域)
-                           "uniform vec4 cropRect;\n\n"
                            //主函数
                            "void main(){\n"
-                           //纹理坐标镜像处理
-                           "vec2 adjustedTexCoord = aTexCoord;\n\n"
-                           "if(hMirror){adjustedTexCoord.x = 1.0 - adjustedTexCoord.x;}\n"
-                           "if(vMirror){adjustedTexCoord.y = 1.0 - adjustedTexCoord.y;}\n\n"
-                           //顶点坐标裁剪处理，这里使用数学算法重新计算顶点坐标
-                           "float ndcX = (aTexCoord.x - cropRect.x)*(2.0 / cropRect.z) - 1.0;\n"
-                           "float ndcY = (aTexCoord.y - cropRect.y)*(2.0 / cropRect.w) - 1.0;\n"
-                           "gl_Position = vec4(ndcX, -ndcY, 0.0, 1.0);\n"
-                           //"gl_Position = vec4(aPos, 1.0);\n"//不进行裁剪处理时，直接传递顶点坐标
-                           "TexCoord = adjustedTexCoord;\n"
+                           "gl_Position = vec4(aPos, 1.0);\n"
+                           "TexCoord = aTexCoord;\n"
                            "}\n");
 
     //获取当前的glsl版本，声明到着色器中
@@ -323,11 +719,13 @@ void V4l2Rendering::initVertexShader()
 }
 /*
  *@brief:  初始化片段着色器
- *注：此处片段着色器内部使用的YUV转RGB(包括饱和度算法的亮度系数)为BT.709标准的Full range格式的转换公式(如果标识了TV Range，内部会自动
- *将其转换为FULL Range)，根据不同的YUV格式实现不同的处理。
- *实测对于BT.601的数据按照BT.709方式处理和BT.601的方式处理，显示效果没有太大的差距，为了着色器程序的处理性能，此处不再根据全局变量动态区分两
- *种标准，而是均使用BT.709标准处理。
+ *注：此处片段着色器内部使用的YUV转RGB为Full range格式的转换公式(如果标识了TV Range，其缩放和偏移合并到转换矩阵和rgbOffset中)，根据
+ *不同的YUV格式实现不同的处理。转换矩阵通过uniform变量yuv2rgb传递，系数与软解码共用(yuvToRgbCoef())，默认为BT.709标准，可通过
+ *setColorEncodingParam()根据驱动返回的ycbcr_enc切换，矩阵乘法的计算量与标准和range无关，所以不会带来额外的性能损失。
+ *饱和度算法的亮度系数仍固定使用BT.709标准。这里生成的是着色器模板，颜色调整(COLOR_ADJUST)、3D LUT(LUT3D)和反交错模式
+ *(DEINTERLACE_MODE)由createShaderProgram()通过#define特化。
  *@date:   2024.05.17
+ *@update: 2026.10.18
  */
 void V4l2Rendering::initFragmentShader()
 {
@@ -336,20 +734,20 @@ void V4l2Rendering::initFragmentShader()
      *一个输入(TexCoord纹理坐标，来自与顶点着色器的输出);若干个uniform全局变量(包括若干纹理采样器(在外部绑定纹理及通道)和TV Range标志
      *参数(着色器程序默认按照Full Range进行归一化处理，如果是纹理采样输入是TV Range，需要先转换成Full Range)，以及若干颜色调整参数，这
      *些参数在外部传递);一个输出(vec4,片段纹理颜色，低版本为内置的gl_FragColor,高版本需要通过out vec4 FragColor自定义输出);
-     *通过采样器获取对应通道的纹理数据(可以通过插值匹配计算纹理坐标区域各点的值)，根据TV Range标志确定是否转换，然后再通过yuv转rgb公式，通
-     *过矩阵计算对应点的rgb数据输出。最后根据外部设置的颜色调整参数，选择是否对rgb进一步处理(亮度、对比度、饱和度等基础的颜色调节)，以及在图
+     *通过采样器获取对应通道的纹理数据(可以通过插值匹配计算纹理坐标区域各点的值)，然后再通过yuv转rgb公式(已包含range的转换)，通
+     *过矩阵计算对应点的rgb数据输出。最后根据特化的颜色调整开关，选择是否对rgb进一步处理(亮度、对比度、饱和度等基础的颜色调节)，以及在图
      *像输出之前做一次伽马校正，该操作针对人眼感知的明暗处理上效果非常好，比较适合对摄像头采集数据处理，但相对也消耗一些性能。*/
 
     /*one planes格式，需要两个纹理采样器(两通道取y+四通道取uv)*/
     if(pixelFormat == V4L2_PIX_FMT_YUYV || pixelFormat == V4L2_PIX_FMT_YVYU)
     {
         QString tmpShader = QString("varying vec2 TexCoord;\n\n"
-                                    //纹理采样及TV Range转换标志
-                                    "uniform bool isTvRange;\n"
+                                    //纹理采样及转换矩阵(TV Range的缩放和偏移已经合并到矩阵和rgbOffset中)
+                                    "uniform mat3 yuv2rgb;\n"
+                                    "uniform vec3 rgbOffset;\n"
                                     "uniform sampler2D texY;\n"
                                     "uniform sampler2D texUV;\n\n"
                                     //颜色调整参数
-                                    "uniform bool enableColorAdjust;\n"
                                     "uniform float brightness;\n"
                                     "uniform float contrast;\n"
                                     "uniform float saturation;\n\n"
@@ -358,24 +756,16 @@ void V4l2Rendering::initFragmentShader()
                                     //yuv采样转换为rgb
                                     "float y = texture2D(texY, TexCoord).r;\n"
                                     "vec2 uv = texture2D(texUV, TexCoord).ga;\n"
-                                    "if(isTvRange){\n"//TV Range转换为FULL Range
-                                    "y = (y*255.0-16.0)/(235.0-16.0);\n"
-                                    "uv = (uv*255.0-vec2(16.0,16.0))/(240.0-16.0);\n"
-                                    "}\n"
-                                    "uv = uv - vec2(0.5,0.5);\n"
                                     "float u = uv.r;\n"
                                     "float v = uv.g;\n"
-                                    "vec3 yuv = vec3(y, %1, %2);\n"
-                                    "vec3 rgb = mat3(1.0,      1.0,      1.0,"
-                                                    "0.0,      -0.187324,  1.8556,"
-                                                    "1.5748,   -0.468124,   0.0) * yuv;\n\n"
+                                    "vec3 rgb = yuv2rgb * vec3(y, %1, %2) + rgbOffset;\n\n"
                                     //rgb颜色调整
-                                    "if(enableColorAdjust){\n"
+                                    "#ifdef COLOR_ADJUST\n"
                                     "rgb = (rgb - 0.5) * contrast + 0.5;\n"
                                     "vec3 luminanceVec = vec3(dot(rgb, vec3(0.2126, 0.7152, 0.0722)));\n"
                                     "rgb = luminanceVec + (rgb - luminanceVec) * saturation;\n"
                                     "rgb = rgb * brightness;\n"
-                                    "}\n\n"
+                                    "#endif\n\n"
                                     //rgb校正及输出
                                     "rgb = clamp(rgb,0.0,1.0);\n"
                                     "rgb = pow(rgb, vec3(1.0/2.2));\n"//伽马校正
@@ -395,12 +785,12 @@ void V4l2Rendering::initFragmentShader()
     else if(pixelFormat == V4L2_PIX_FMT_NV12 || pixelFormat == V4L2_PIX_FMT_NV21)
     {
         QString tmpShader = QString("varying vec2 TexCoord;\n\n"
-                                    //纹理采样及TV Range转换标志
-                                    "uniform bool isTvRange;\n"
+                                    //纹理采样及转换矩阵(TV Range的缩放和偏移已经合并到矩阵和rgbOffset中)
+                                    "uniform mat3 yuv2rgb;\n"
+                                    "uniform vec3 rgbOffset;\n"
                                     "uniform sampler2D texY;\n"
                                     "uniform sampler2D texUV;\n\n"
                                     //颜色调整参数
-                                    "uniform bool enableColorAdjust;\n"
                                     "uniform float brightness;\n"
                                     "uniform float contrast;\n"
                                     "uniform float saturation;\n\n"
@@ -409,24 +799,16 @@ void V4l2Rendering::initFragmentShader()
                                     //yuv采样转换为rgb
                                     "float y = texture2D(texY, TexCoord).r;\n"
                                     "vec2 uv = texture2D(texUV, TexCoord).ra;\n"
-                                    "if(isTvRange){\n"//TV Range转换为FULL Range
-                                    "y = (y*255.0-16.0)/(235.0-16.0);\n"
-                                    "uv = (uv*255.0-vec2(16.0,16.0))/(240.0-16.0);\n"
-                                    "}\n"
-                                    "uv = uv - vec2(0.5, 0.5);\n"
                                     "float u = uv.r;\n"
                                     "float v = uv.g;\n"
-                                    "vec3 yuv = vec3(y, %1, %2);\n"
-                                    "vec3 rgb = mat3(1.0,      1.0,      1.0,"
-                                                    "0.0,      -0.187324,  1.8556,"
-                                                    "1.5748,   -0.468124,   0.0) * yuv;\n\n"
+                                    "vec3 rgb = yuv2rgb * vec3(y, %1, %2) + rgbOffset;\n\n"
                                     //rgb颜色调整
-                                    "if(enableColorAdjust){\n"
+                                    "#ifdef COLOR_ADJUST\n"
                                     "rgb = (rgb - 0.5) * contrast + 0.5;\n"
                                     "vec3 luminanceVec = vec3(dot(rgb, vec3(0.2126, 0.7152, 0.0722)));\n"
                                     "rgb = luminanceVec + (rgb - luminanceVec) * saturation;\n"
                                     "rgb = rgb * brightness;\n"
-                                    "}\n\n"
+                                    "#endif\n\n"
                                     //rgb校正及输出
                                     "rgb = clamp(rgb,0.0,1.0);\n"
                                     "rgb = pow(rgb, vec3(1.0/2.2));\n"//伽马校正
@@ -446,13 +828,13 @@ void V4l2Rendering::initFragmentShader()
     else if(pixelFormat == V4L2_PIX_FMT_YUV420 || pixelFormat == V4L2_PIX_FMT_YVU420)
     {
         QString tmpShader = QString("varying vec2 TexCoord;\n\n"
-                                    //纹理采样及TV Range转换标志
-                                    "uniform bool isTvRange;\n"
+                                    //纹理采样及转换矩阵(TV Range的缩放和偏移已经合并到矩阵和rgbOffset中)
+                                    "uniform mat3 yuv2rgb;\n"
+                                    "uniform vec3 rgbOffset;\n"
                                     "uniform sampler2D texY;\n"
                                     "uniform sampler2D texU;\n"
                                     "uniform sampler2D texV;\n\n"
                                     //颜色调整参数
-                                    "uniform bool enableColorAdjust;\n"
                                     "uniform float brightness;\n"
                                     "uniform float contrast;\n"
                                     "uniform float saturation;\n\n"
@@ -460,24 +842,16 @@ void V4l2Rendering::initFragmentShader()
                                     "void main(){\n"
                                     //yuv采样转换为rgb
                                     "float y = texture2D(texY, TexCoord).r;\n"
-                                    "float u = texture2D(texU, TexCoord).r - 0.5;\n"
-                                    "float v = texture2D(texV, TexCoord).r - 0.5;\n"
-                                    "if(isTvRange){\n"//TV Range转换为FULL Range
-                                    "y = (y*255.0-16.0)/(235.0-16.0);\n"
-                                    "u = (u*255.0-16.0)/(240.0-16.0);\n"
-                                    "v = (v*255.0-16.0)/(240.0-16.0);\n"
-                                    "}\n"
-                                    "vec3 yuv = vec3(y, %1, %2);\n"
-                                    "vec3 rgb = mat3(1.0,      1.0,      1.0,"
-                                                    "0.0,      -0.187324,  1.8556,"
-                                                    "1.5748,   -0.468124,   0.0) * yuv;\n\n"
+                                    "float u = texture2D(texU, TexCoord).r;\n"
+                                    "float v = texture2D(texV, TexCoord).r;\n"
+                                    "vec3 rgb = yuv2rgb * vec3(y, %1, %2) + rgbOffset;\n\n"
                                     //rgb颜色调整
-                                    "if(enableColorAdjust){\n"
+                                    "#ifdef COLOR_ADJUST\n"
                                     "rgb = (rgb - 0.5) * contrast + 0.5;\n"
                                     "vec3 luminanceVec = vec3(dot(rgb, vec3(0.2126, 0.7152, 0.0722)));\n"
                                     "rgb = luminanceVec + (rgb - luminanceVec) * saturation;\n"
                                     "rgb = rgb * brightness;\n"
-                                    "}\n\n"
+                                    "#endif\n\n"
                                     //rgb校正及输出
                                     "rgb = clamp(rgb,0.0,1.0);\n"
                                     "rgb = pow(rgb, vec3(1.0/2.2));\n"//伽马校正
@@ -502,6 +876,108 @@ void V4l2Rendering::initFragmentShader()
                   .arg((char)((pixelFormat>>24)&0xff));
     }
 
+    /*3D LUT颜色分级，在伽马校正之后作为最后一级处理(lut3DParam:x=格点数N y=atlas列数 zw=atlas像素宽高)
+     *3D纹理由硬件完成三线性插值，格点中心位于(i+0.5)/N，所以需要将[0,1]的rgb映射到[0.5/N,1-0.5/N]；
+     *OpenGL ES 2.0使用2D纹理(atlas)，片内由硬件双线性插值，相邻两个b切片在着色器中线性插值，atlas像素坐标较大，
+     *mediump精度不够，所以支持时使用highp。*/
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    isLut3DTexture3D = !(context->isOpenGLES() && context->format().majorVersion() < 3);
+    QString lut3DShader;
+    if(isLut3DTexture3D)
+    {
+        lut3DShader = QString("#ifdef LUT3D\n"
+                              "uniform sampler3D lut3D;\n"
+                              "uniform vec4 lut3DParam;\n"
+                              "vec3 applyLut3D(vec3 rgb){\n"
+                              "float n = lut3DParam.x;\n"
+                              "return texture3D(lut3D, rgb*((n-1.0)/n) + 0.5/n).rgb;\n"
+                              "}\n"
+                              "#endif\n\n");
+    }
+    else
+    {
+        lut3DShader = QString("#ifdef LUT3D\n"
+                              "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+                              "#define LUT3D_PRECISION highp\n"
+                              "#else\n"
+                              "#define LUT3D_PRECISION mediump\n"
+                              "#endif\n"
+                              "uniform sampler2D lut3D;\n"
+                              "uniform LUT3D_PRECISION vec4 lut3DParam;\n"
+                              "vec3 applyLut3D(vec3 rgb){\n"
+                              "LUT3D_PRECISION float n = lut3DParam.x;\n"
+                              "LUT3D_PRECISION float cols = lut3DParam.y;\n"
+                              "LUT3D_PRECISION float b = rgb.b*(n-1.0);\n"
+                              "LUT3D_PRECISION float z0 = floor(b);\n"
+                              "LUT3D_PRECISION float z1 = min(z0+1.0, n-1.0);\n"
+                              "LUT3D_PRECISION vec2 xy = rgb.rg*(n-1.0) + 0.5;\n"
+                              //b切片z位于atlas的第floor(z/cols)行、第z-行号*cols列
+                              "LUT3D_PRECISION float row0 = floor((z0+0.5)/cols);\n"
+                              "LUT3D_PRECISION float row1 = floor((z1+0.5)/cols);\n"
+                              "LUT3D_PRECISION vec2 pos0 = (vec2(z0-row0*cols, row0)*n + xy)/lut3DParam.zw;\n"
+                              "LUT3D_PRECISION vec2 pos1 = (vec2(z1-row1*cols, row1)*n + xy)/lut3DParam.zw;\n"
+                              "return mix(texture2D(lut3D, pos0).rgb, texture2D(lut3D, pos1).rgb, b-z0);\n"
+                              "}\n"
+                              "#endif\n\n");
+    }
+    fragmentShader.replace("void main(){\n",lut3DShader + "void main(){\n");
+
+    /*反交错，对纹理的采样统一经过deinterlaceSample()，rows为纹理的行数
+     *纹理坐标已经过镜像、裁剪处理，所在的行与原始帧一致，据此判断属于哪一场:Bob和运动自适应的另一场由上下两行采样平均，
+     *线性混合按1:2:1混合三行，运动自适应使用梳状检测(没有上一帧)。采样点位于行中心，垂直方向不会被线性过滤混合。
+     *行号的计算需要较高的精度(mediump在576行时只能精确到半行)，ES支持时纹理坐标使用highp。
+     *反交错模式由DEINTERLACE_MODE特化(与Deinterlacer::Mode的值一致)，关闭时直接采样。*/
+    const QString rowsY = QString::number(pixelHeight) + ".0";
+    const QString rowsUV = (pixelFormat == V4L2_PIX_FMT_YUYV || pixelFormat == V4L2_PIX_FMT_YVYU)?
+                rowsY:QString::number(pixelHeight/2) + ".0";
+    QString deinterlaceShader = QString("uniform float keptField;\n"//保留的场(0=顶场 1=底场)
+                                        "uniform float combThreshold;\n"
+                                        "vec4 deinterlaceSample(sampler2D tex, DEINTERLACE_PRECISION vec2 coord, "
+                                        "DEINTERLACE_PRECISION float rows){\n"
+                                        "#if DEINTERLACE_MODE == 0\n"//0=关闭 1=Bob 2=线性混合 3=运动自适应
+                                        "return texture2D(tex, coord);\n"
+                                        "#else\n"
+                                        "DEINTERLACE_PRECISION float row = floor(coord.y*rows);\n"
+                                        "vec4 cur = texture2D(tex, vec2(coord.x, (row+0.5)/rows));\n"
+                                        "vec4 above = texture2D(tex, vec2(coord.x, (row-0.5)/rows));\n"
+                                        "vec4 below = texture2D(tex, vec2(coord.x, (row+1.5)/rows));\n"
+                                        "#if DEINTERLACE_MODE == 2\n"
+                                        "return (above + 2.0*cur + below)*0.25;\n"
+                                        "#else\n"
+                                        "if(abs(mod(row, 2.0) - keptField) < 0.5){\n"
+                                        "return cur;\n"
+                                        "}\n"
+                                        "vec4 interp = (above + below)*0.5;\n"
+                                        "#if DEINTERLACE_MODE == 1\n"
+                                        "return interp;\n"
+                                        "#else\n"
+                                        //梳状检测:(cur-above)*(cur-below)>阈值^2
+                                        "return mix(cur, interp, step(combThreshold*combThreshold, (cur - above)*(cur - below)));\n"
+                                        "#endif\n"
+                                        "#endif\n"
+                                        "#endif\n"
+                                        "}\n\n");
+    fragmentShader.replace("void main(){\n",deinterlaceShader + "void main(){\n");
+    fragmentShader.replace("texture2D(texY, TexCoord)",QString("deinterlaceSample(texY, TexCoord, %1)").arg(rowsY));
+    fragmentShader.replace("texture2D(texUV, TexCoord)",QString("deinterlaceSample(texUV, TexCoord, %1)").arg(rowsUV));
+    fragmentShader.replace("texture2D(texU, TexCoord)",QString("deinterlaceSample(texU, TexCoord, %1)").arg(rowsUV));
+    fragmentShader.replace("texture2D(texV, TexCoord)",QString("deinterlaceSample(texV, TexCoord, %1)").arg(rowsUV));
+    fragmentShader.replace("varying vec2 TexCoord;","varying DEINTERLACE_PRECISION vec2 TexCoord;");
+    fragmentShader.prepend("#ifdef GL_ES\n"
+                           "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+                           "#define DEINTERLACE_PRECISION highp\n"
+                           "#else\n"
+                           "#define DEINTERLACE_PRECISION mediump\n"
+                           "#endif\n"
+                           "#else\n"
+                           "#define DEINTERLACE_PRECISION\n"//桌面GLSL 1.30以下不支持精度限定符
+                           "#endif\n");
+    fragmentShader.replace("gl_FragColor = vec4(rgb, 1.0);\n",
+                           "#ifdef LUT3D\n"
+                           "rgb = applyLut3D(rgb);\n"
+                           "#endif\n"
+                           "gl_FragColor = vec4(rgb, 1.0);\n");
+
     //获取当前的glsl版本，声明到着色器中
     QString glslVersionStr = QString((const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
     QRegularExpression reg("\\d+[.]\\d+");
@@ -514,9 +990,10 @@ void V4l2Rendering::initFragmentShader()
         //且高版本取消了内置gl_FragColor变量，需要自己定义，texture2D换成了texture
         if(glslVersion >= 130)
         {
-            fragmentShader.prepend("out vec4 FragColor;");
+            fragmentShader.prepend("out vec4 FragColor;\n");
             fragmentShader.replace("varying","in");
             fragmentShader.replace("texture2D","texture");
+            fragmentShader.replace("texture3D","texture");
             fragmentShader.replace("gl_FragColor","FragColor");
         }
 
@@ -525,8 +1002,9 @@ void V4l2Rendering::initFragmentShader()
         {
             if(glslVersion >= 300)
             {
-                //OpenGL ES 3.0及以上加上版本标识ES，并指定精度(ES的特有操作)
-                fragmentShader.prepend(QString("#version %1 es\nprecision mediump float;\n").arg(glslVersion));
+                //OpenGL ES 3.0及以上加上版本标识ES，并指定精度(ES的特有操作，sampler3D没有默认精度)
+                fragmentShader.prepend(QString("#version %1 es\nprecision mediump float;\n"
+                                               "precision mediump sampler3D;\n").arg(glslVersion));
             }
             else
             {
@@ -638,71 +1116,734 @@ void V4l2Rendering::initTexture()
         }
     }
 }
+/*
+ *@brief:  初始化上传帧数据使用的像素解包缓冲区(PBO)
+ *注:PBO需要OpenGL 2.1或OpenGL ES 3.0，不支持或未开启时不创建，帧数据直接上传。支持缓冲区存储(glBufferStorage)时
+ *创建不可变存储并持久映射(一致性映射，写入后不需要刷新)，映射失败时退回每帧映射的方式。
+ *@date:   2026.10.18
+ */
+void V4l2Rendering::initUnpackBuffers()
+{
+    destroyUnpackBuffers();
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    isPboSupported = context->isOpenGLES()?(context->format().majorVersion() >= 3):
+                                           (context->format().version() >= qMakePair(2,1));
+    unpackBufferSize = ColorToRgb24::frameBytes(pixelFormat,pixelWidth,pixelHeight);
+    if(!pboUploadEnabled || !isPboSupported || unpackBufferSize == 0)
+    {
+        return;
+    }
+
+    typedef void (QOPENGLF_APIENTRYP BufferStorageFunc)(GLenum target,GLsizeiptr size,const void *data,GLbitfield flags);
+    BufferStorageFunc bufferStorage = nullptr;
+    if(context->hasExtension("GL_ARB_buffer_storage"))
+    {
+        bufferStorage = (BufferStorageFunc)context->getProcAddress("glBufferStorage");
+    }
+    else if(context->hasExtension("GL_EXT_buffer_storage"))
+    {
+        bufferStorage = (BufferStorageFunc)context->getProcAddress("glBufferStorageEXT");
+    }
+    isPboPersistent = (bufferStorage != nullptr);
+    const GLbitfield mapFlags = GL_MAP_WRITE_BIT|GL_MAP_PERSISTENT_BIT|GL_MAP_COHERENT_BIT;
+    for(int i=0;i<UNPACK_BUFFER_COUNT;i++)
+    {
+        unpackBuffers[i].create();
+        unpackBuffers[i].bind();
+        if(isPboPersistent)
+        {
+            bufferStorage(GL_PIXEL_UNPACK_BUFFER,unpackBufferSize,nullptr,mapFlags);
+            unpackBufferMapped[i] = (uchar *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,0,unpackBufferSize,mapFlags);
+            if(unpackBufferMapped[i] == nullptr)
+            {
+                //持久映射失败，全部重建为普通PBO
+                unpackBuffers[i].release();
+                destroyUnpackBuffers();
+                isPboPersistent = false;
+                i = -1;
+                continue;
+            }
+        }
+        else
+        {
+            unpackBuffers[i].setUsagePattern(QOpenGLBuffer::StreamDraw);
+            unpackBuffers[i].allocate(unpackBufferSize);
+        }
+        unpackBuffers[i].release();
+    }
+}
+/*
+ *@brief:  初始化截图异步读取使用的像素打包缓冲区(PBO)
+ *注:异步读取需要PBO、栅栏(OpenGL 3.2或GL_ARB_sync、OpenGL ES 3.0)以及取回时的映射(glMapBufferRange，OpenGL 3.0或
+ *GL_ARB_map_buffer_range)，不满足时使用同步读取。PBO的存储在读取时按尺寸等级分配(只增不减)。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ */
+void V4l2Rendering::initReadbackBuffers()
+{
+    destroyReadbackBuffers();
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if(context->isOpenGLES())
+    {
+        isReadbackSupported = (context->format().majorVersion() >= 3);
+    }
+    else
+    {
+        const QPair<int,int> version = context->format().version();
+        isReadbackSupported = (version >= qMakePair(3,2) || context->hasExtension("GL_ARB_sync")) &&
+                              (version >= qMakePair(3,0) || context->hasExtension("GL_ARB_map_buffer_range"));
+    }
+    for(int i=0;isReadbackSupported && i<READBACK_BUFFER_COUNT;i++)
+    {
+        if(!readbacks[i].buffer.create())
+        {
+            isReadbackSupported = false;
+        }
+    }
+}
+/*
+ *@brief:  发起一次异步读取(当前绑定的FBO)
+ *注:glReadPixels读取到PBO时立即返回，之后插入栅栏，GPU执行完渲染和拷贝后栅栏完成。PBO按图片的尺寸等级(与FBO池一致)
+ *分配且只增不减，变焦过程中图片尺寸每帧变化也不会重新分配显存。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  imageSize:图片尺寸(FBO尺寸)
+ *@param:  level:-1=截图  其他=多分辨率输出的层级
+ *@return: bool:false=所有PBO都在读取中(连拍过快)，需要下一帧再截图
+ */
+bool V4l2Rendering::startReadback(const QSize &imageSize, int level)
+{
+    Readback &readback = readbacks[readbackIndex];
+    if(readback.fence)
+    {
+        return false;
+    }
+    const QSize sizeClass = fboSizeClass(imageSize);
+    const int bytes = sizeClass.width()*sizeClass.height()*4;
+    readback.buffer.bind();
+    if(readback.buffer.size() < bytes)
+    {
+        readback.buffer.allocate(bytes);
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT,4);//每行4字节/像素，总是对齐的
+    glReadPixels(0,0,imageSize.width(),imageSize.height(),GL_RGBA,GL_UNSIGNED_BYTE,nullptr);
+    readback.buffer.release();
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+    readback.size = imageSize;
+    readback.level = level;
+    readbackIndex = (readbackIndex + 1)%READBACK_BUFFER_COUNT;
+    return true;
+}
+/*
+ *@brief:  把所有空闲的PBO扩大到能容纳指定尺寸(按尺寸等级)
+ *注:多分辨率输出的各层轮流使用共享的PBO，层级与PBO的对应关系每帧都在变化，按最大的一层预先分配后不再重新分配。
+ *正在读取中的PBO不能重新分配，在下一次使用时由startReadback()扩大。
+ *@date:   2026.10.18
+ *@param:  imageSize:图片尺寸
+ */
+void V4l2Rendering::reserveReadbackBuffers(const QSize &imageSize)
+{
+    const QSize sizeClass = fboSizeClass(imageSize);
+    const int bytes = sizeClass.width()*sizeClass.height()*4;
+    for(int i=0;i<READBACK_BUFFER_COUNT;i++)
+    {
+        Readback &readback = readbacks[i];
+        if(!readback.fence && readback.buffer.size() < bytes)
+        {
+            readback.buffer.bind();
+            readback.buffer.allocate(bytes);
+            readback.buffer.release();
+        }
+    }
+}
+/*
+ *@brief:  可以连续发起的异步读取数(从下一次使用的PBO开始连续空闲的PBO数)
+ *@date:   2026.10.18
+ *@return: uint:空闲的PBO数
+ */
+uint V4l2Rendering::freeReadbackCount()
+{
+    uint count = 0;
+    while(count < READBACK_BUFFER_COUNT && !readbacks[(readbackIndex + count)%READBACK_BUFFER_COUNT].fence)
+    {
+        count++;
+    }
+    return count;
+}
+/*
+ *@brief:  是否有尚未取回的截图读取
+ *@date:   2026.10.18
+ *@return: bool:true=有
+ */
+bool V4l2Rendering::hasPendingReadback()
+{
+    for(int i=0;i<READBACK_BUFFER_COUNT;i++)
+    {
+        if(readbacks[i].fence)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+/*
+ *@brief:  取回已经完成的截图读取
+ *注:按发起的顺序检查栅栏(不等待)，遇到未完成的即停止，保证截图按帧的顺序发射。完成的PBO映射后拷贝出数据(一次连续的memcpy)，
+ *翻转和格式转换交给后台线程。需要在OpenGL上下文中调用，没有新帧需要绘制时由外部定时调用。映射失败时退回拷贝，仍然失败
+ *(不会在支持异步读取的上下文中出现)才丢弃该截图并输出错误。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ */
+void V4l2Rendering::pollReadback()
+{
+    for(int i=0;i<READBACK_BUFFER_COUNT;i++)
+    {
+        Readback &readback = readbacks[(readbackIndex + i)%READBACK_BUFFER_COUNT];
+        if(!readback.fence)
+        {
+            continue;
+        }
+        const GLenum status = glClientWaitSync(readback.fence,GL_SYNC_FLUSH_COMMANDS_BIT,0);
+        if(status == GL_TIMEOUT_EXPIRED)
+        {
+            break;
+        }
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+        if(status == GL_WAIT_FAILED)
+        {
+            continue;
+        }
+        const int bytes = readback.size.width()*readback.size.height()*4;
+        readback.buffer.bind();
+        const void *mapped = readback.buffer.mapRange(0,bytes,QOpenGLBuffer::RangeRead);
+        QImage image(readback.size,QImage::Format_RGBA8888);
+        if(mapped)
+        {
+            memcpy(image.bits(),mapped,bytes);
+            readback.buffer.unmap();
+            finishReadback(image,readback.level);
+        }
+        else if(readback.buffer.read(0,image.bits(),bytes))//映射失败时退回拷贝(glGetBufferSubData，仅桌面OpenGL)
+        {
+            finishReadback(image,readback.level);
+        }
+        else
+        {
+            qDebug()<<"pollReadback: map readback buffer failed, image dropped";
+        }
+        readback.buffer.release();
+    }
+}
+/*
+ *@brief:  在后台线程中将读取的图片翻转到光栅坐标(OpenGL以左下角为原点)并转换为Qt原生的32位格式，然后发射截图信号
+ *注:信号在后台线程中发射，连接到GUI对象时自动排队到GUI线程。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  image:PBO中读取的图片(RGBA8888，未翻转)
+ *@param:  level:-1=截图(captureImageSig)  其他=多分辨率输出的层级(pyramidImageSig)
+ */
+void V4l2Rendering::finishReadback(const QImage &image, int level)
+{
+    if(!readbackThread)
+    {
+        readbackThread = new QThread();
+        readbackWorker = new QObject();
+        readbackWorker->moveToThread(readbackThread);
+        readbackThread->start(QThread::LowPriority);
+    }
+    QMetaObject::invokeMethod(readbackWorker,[this,image,level](){
+        QImage rgbImage = image.mirrored(false,true).convertToFormat(QImage::Format_RGB32);
+        if(level < 0)
+        {
+            emit captureImageSig(rgbImage);
+        }
+        else
+        {
+            emit pyramidImageSig(level,rgbImage);
+        }
+    },Qt::QueuedConnection);
+}
+/*
+ *@brief:  设置多分辨率输出的各层尺寸
+ *注:各层按从大到小的顺序设置(例如显示用的原始尺寸、640x360、320x180)，之后每个新帧渲染一次所有层级并异步读取，
+ *通过pyramidImageSig()按层级发射。各层使用FBO池中的FBO(见acquireFBO())。
+ *@date:   2026.10.18
+ *@param:  sizes:各层尺寸(无效尺寸表示截图尺寸captureImageSize())，空表示关闭
+ */
+void V4l2Rendering::setOutputPyramid(const QVector<QSize> &sizes)
+{
+    this->pyramidSizes = sizes;
+}
+/*
+ *@brief:  将当前帧渲染到多分辨率输出的各层FBO并发起读取
+ *注:第一层(以及比上一层大的层)由纹理直接绘制，之后的层支持帧缓冲blit(OpenGL 3.0/OpenGL ES 3.0)时由上一层线性缩小，
+ *逐级缩小相当于mipmap，比从原始纹理直接缩小到很小的尺寸混叠更少，且不需要再执行片段着色器的颜色转换。所有层级在同一次
+ *绘制中提交，各层的读取需要同时发起，空闲的PBO不够时跳过本帧，保证每一帧的各层是完整的。
+ *所有PBO按最大的一层分配(见reserveReadbackBuffers())，层级轮换使用PBO时不会重新分配。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ */
+void V4l2Rendering::paintPyramid()
+{
+    const int levels = pyramidSizes.size();
+    if(isReadbackSupported && freeReadbackCount() < uint(levels))
+    {
+        return;
+    }
+    if(isReadbackSupported)
+    {
+        QSize largest;
+        for(int i=0;i<levels;i++)
+        {
+            QSize size = pyramidSizes.at(i);
+            if(!size.isValid() || size.isEmpty())
+            {
+                size = captureImageSize();
+            }
+            largest = largest.expandedTo(size);
+        }
+        reserveReadbackBuffers(largest);
+    }
+    const bool canBlit = QOpenGLFramebufferObject::hasOpenGLFramebufferBlit();
+    QOpenGLFramebufferObject *source = nullptr;
+    QSize sourceSize;
+    for(int i=0;i<levels;i++)
+    {
+        QSize size = pyramidSizes.at(i);
+        if(!size.isValid() || size.isEmpty())
+        {
+            size = captureImageSize();
+        }
+        //每层使用池中不同的FBO，图片位于FBO左下角
+        QOpenGLFramebufferObject *target = acquireFBO(size);
+        if(!target)
+        {
+            break;
+        }
+        if(canBlit && source && size.width() <= sourceSize.width() && size.height() <= sourceSize.height())
+        {
+            QOpenGLFramebufferObject::blitFramebuffer(target,QRect(QPoint(0,0),size),
+                                                      source,QRect(QPoint(0,0),sourceSize),
+                                                      GL_COLOR_BUFFER_BIT,GL_LINEAR);
+            target->bind();
+        }
+        else
+        {
+            target->bind();
+            glViewport(0,0,size.width(),size.height());
+            paintGLTexture();
+        }
+        if(isReadbackSupported)
+        {
+            startReadback(size,i);
+        }
+        else
+        {
+            emit pyramidImageSig(i,target->toImage(true).copy(0,target->height()-size.height(),
+                                                              size.width(),size.height()));
+        }
+        target->release();
+        source = target;
+        sourceSize = size;
+    }
+    glViewport(0,0,widgetWidth,widgetHeight);//恢复成组件的视图大小
+}
+/*
+ *@brief:  计算FBO的尺寸等级
+ *注:等级为原始尺寸(旋转90/270度时宽高互换)逐级减半，取能容纳该尺寸的最小一级，变焦时图片尺寸连续变化但只会用到少数几个等级，
+ *FBO池的大小因此有上限；大于原始尺寸的输出尺寸单独作为一级。
+ *@date:   2026.10.18
+ *@param:  size:图片尺寸
+ *@return: QSize:FBO尺寸
+ */
+QSize V4l2Rendering::fboSizeClass(const QSize &size)
+{
+    QSize sizeClass(pixelWidth,pixelHeight);
+    if(rotation == 90 || rotation == 270)
+    {
+        sizeClass.transpose();
+    }
+    if(size.width() > sizeClass.width() || size.height() > sizeClass.height())
+    {
+        return size;
+    }
+    while(sizeClass.width() > 1 && sizeClass.height() > 1)
+    {
+        const QSize next((sizeClass.width() + 1)/2,(sizeClass.height() + 1)/2);
+        if(next.width() < size.width() || next.height() < size.height())
+        {
+            break;
+        }
+        sizeClass = next;
+    }
+    return sizeClass;
+}
+/*
+ *@brief:  从FBO池中取出一个能容纳指定尺寸的空闲FBO
+ *注:没有该尺寸等级的空闲FBO时才创建(懒分配)，取出的FBO在本次paintGL()结束时归还(releaseFBOs())。
+ *需要在OpenGL上下文中调用。
+ *@date:   2026.10.18
+ *@param:  size:图片尺寸
+ *@return: QOpenGLFramebufferObject*:FBO，创建失败时为nullptr
+ */
+QOpenGLFramebufferObject *V4l2Rendering::acquireFBO(const QSize &size)
+{
+    const QSize sizeClass = fboSizeClass(size);
+    for(int i=0;i<fboPool.size();i++)
+    {
+        PooledFBO &pooled = fboPool[i];
+        if(!pooled.inUse && pooled.fbo->size() == sizeClass)
+        {
+            pooled.inUse = true;
+            return pooled.fbo;
+        }
+    }
+    PooledFBO pooled;
+    pooled.fbo = new QOpenGLFramebufferObject(sizeClass,fboFormat);
+    if(!pooled.fbo->isValid())
+    {
+        qDebug()<<"V4l2Rendering: create fbo failed"<<sizeClass;
+        delete pooled.fbo;
+        return nullptr;
+    }
+    pooled.inUse = true;
+    fboPool.append(pooled);
+    return pooled.fbo;
+}
+/*
+ *@brief:  归还本次paintGL()中使用的所有FBO
+ *@date:   2026.10.18
+ */
+void V4l2Rendering::releaseFBOs()
+{
+    for(int i=0;i<fboPool.size();i++)
+    {
+        fboPool[i].inUse = false;
+    }
+}
+/*
+ *@brief:  销毁FBO池(需要在创建FBO的上下文中调用)
+ *@date:   2026.10.18
+ */
+void V4l2Rendering::destroyFBOPool()
+{
+    for(int i=0;i<fboPool.size();i++)
+    {
+        delete fboPool.at(i).fbo;
+    }
+    fboPool.clear();
+}
+/*
+ *@brief:  销毁截图读取使用的PBO和栅栏(需要在创建它们的上下文中调用)，尚未取回的截图被丢弃
+ *@date:   2026.10.18
+ */
+void V4l2Rendering::destroyReadbackBuffers()
+{
+    for(int i=0;i<READBACK_BUFFER_COUNT;i++)
+    {
+        if(readbacks[i].fence)
+        {
+            glDeleteSync(readbacks[i].fence);
+            readbacks[i].fence = nullptr;
+        }
+        if(readbacks[i].buffer.isCreated())
+        {
+            readbacks[i].buffer.destroy();
+        }
+    }
+    readbackIndex = 0;
+}
+/*
+ *@brief:  销毁PBO(需要在创建PBO的上下文中调用)
+ *@date:   2026.10.18
+ */
+void V4l2Rendering::destroyUnpackBuffers()
+{
+    for(int i=0;i<UNPACK_BUFFER_COUNT;i++)
+    {
+        if(unpackBufferFences[i])
+        {
+            glDeleteSync(unpackBufferFences[i]);
+            unpackBufferFences[i] = nullptr;
+        }
+        if(unpackBuffers[i].isCreated())
+        {
+            if(unpackBufferMapped[i])
+            {
+                unpackBuffers[i].bind();
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                unpackBuffers[i].release();
+            }
+            unpackBuffers[i].destroy();
+        }
+        unpackBufferMapped[i] = nullptr;
+    }
+    unpackBufferIndex = 0;
+}
 /*
  *@brief:  初始化着色器程序
+ *注:顶点属性使用固定的location(着色器程序链接前通过bindAttributeLocation()绑定)，所有特化的着色器程序共用同一个VAO，
+ *需要在VAO和VBO绑定的状态下调用。
  *@date:   2025.08.20
+ *@update: 2026.10.18
  */
 void V4l2Rendering::initShaderProgram()
 {
-    shaderProgram.removeAllShaders();
-    shaderProgram.addShaderFromSourceCode(QOpenGLShader::Vertex,vertexShader);//附加顶点着色器和片段着色器
-    shaderProgram.addShaderFromSourceCode(QOpenGLShader::Fragment,fragmentShader);
-    shaderProgram.link();//链接着色器
-    shaderProgram.bind();
-    //使用VBO为数据源，设置解析格式,应用到VAO中
-    //第一个参数为VAO的属性名/location位置索引，与顶点着色器的输入变量关联;
-    //因为location需要在着色器中通过layout (location = *)指定，而该语法在glsl 330版本才提供,为了兼容旧版本，此处使用属性名
-    shaderProgram.setAttributeBuffer("aPos", GL_FLOAT, 0, 3, 5 * sizeof(float));
-    shaderProgram.setAttributeBuffer("aTexCoord", GL_FLOAT, 3*sizeof(float), 2, 5 * sizeof(float));
-    //使能VAO指定名称/location位置索引的属性变量,此处使用属性名，原因同上
-    shaderProgram.enableAttributeArray("aPos");//顶点着色器的顶点坐标信息，意味着opengl使用顶点坐标绘制图形
-    shaderProgram.enableAttributeArray("aTexCoord");//顶点着色器的纹理坐标信息，意味着opengl使用纹理坐标来对纹理进行映射，实现纹理贴图效果
-    //为顶点着色器传递初始化的镜像参数
-    shaderProgram.setUniformValue("hMirror",mirrorParam.hMirror);
-    shaderProgram.setUniformValue("vMirror",mirrorParam.vMirror);
-    //为顶点着色器传递初始化的裁剪参数
-    shaderProgram.setUniformValue("cropRect",QVector4D(cropRectParam.left_top_x,cropRectParam.left_top_y,
-                                                       cropRectParam.width,cropRectParam.height));
-    //为片段着色器传递初始化的isTVRange参数和颜色调整参数
-    shaderProgram.setUniformValue("isTvRange",isTVRange);
-    shaderProgram.setUniformValue("enableColorAdjust",colorAdjustParam.enableColorAdjust);
-    shaderProgram.setUniformValue("brightness",colorAdjustParam.brightness);
-    shaderProgram.setUniformValue("contrast",colorAdjustParam.contrast);
-    shaderProgram.setUniformValue("saturation",colorAdjustParam.saturation);
+    destroyShaderPrograms();
+    //使用VBO为数据源，设置解析格式,应用到VAO中(location 0=顶点坐标 1=纹理坐标)
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5*sizeof(float), nullptr);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5*sizeof(float), reinterpret_cast<void *>(3*sizeof(float)));
+    //使能VAO指定location位置索引的属性变量
+    glEnableVertexAttribArray(0);//顶点着色器的顶点坐标信息，意味着opengl使用顶点坐标绘制图形
+    glEnableVertexAttribArray(1);//顶点着色器的纹理坐标信息，意味着opengl使用纹理坐标来对纹理进行映射，实现纹理贴图效果
+    //3D LUT纹理在绘制时(重新)创建
+    colorLut3DChanged = true;
+    selectShaderProgram();
+}
+/*
+ *@brief:  根据当前参数计算着色器程序的特化参数(缓存的key)
+ *@date:   2026.10.18
+ *@return: uint:特化参数
+ */
+uint V4l2Rendering::shaderProgramKey()
+{
+    uint key = uint(deinterlaceParam.mode) << SHADER_KEY_DEINTERLACE_SHIFT;
+    if(colorAdjustParam.enableColorAdjust)
+    {
+        key |= SHADER_KEY_COLOR_ADJUST;
+    }
+    if(lut3DTexture)
+    {
+        key |= SHADER_KEY_LUT3D;
+    }
+    return key;
+}
+/*
+ *@brief:  创建并链接一个特化的着色器程序
+ *注:特化的#define插入到片段着色器的版本头之后，关闭的功能在编译期被去掉，每个像素不再判断uniform分支。
+ *着色器以可缓存的方式附加(Qt5.9及以上)，链接后的程序二进制由Qt保存到磁盘缓存(QStandardPaths::CacheLocation下的qtshadercache)，
+ *缓存的key由着色器源码的哈希以及GL_VENDOR、GL_RENDERER、GL_VERSION组成，驱动升级后自动失效重新编译；之后每次初始化(包括
+ *多个摄像头组件、同一进程内重复初始化时的内存缓存)直接通过glProgramBinary加载，省去编译链接的时间。驱动不支持程序二进制
+ *(GL_NUM_PROGRAM_BINARY_FORMATS为0)、缓存目录不可写或二进制加载失败时，Qt自动退回到从源码编译链接。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ *@param:  key:特化参数
+ *@return: QOpenGLShaderProgram*:着色器程序(链接失败时也返回，绘制结果为空)
+ */
+QOpenGLShaderProgram *V4l2Rendering::createShaderProgram(uint key)
+{
+    QString defines = QString("#define DEINTERLACE_MODE %1\n").arg(key >> SHADER_KEY_DEINTERLACE_SHIFT);
+    if(key & SHADER_KEY_COLOR_ADJUST)
+    {
+        defines += "#define COLOR_ADJUST\n";
+    }
+    if(key & SHADER_KEY_LUT3D)
+    {
+        defines += "#define LUT3D\n";
+    }
+    QString specializedShader = fragmentShader;
+    specializedShader.insert(specializedShader.startsWith("#version")?specializedShader.indexOf('\n')+1:0,defines);
+
+    QOpenGLShaderProgram *program = new QOpenGLShaderProgram();
+    //附加顶点着色器和片段着色器
+#if QT_VERSION >= QT_VERSION_CHECK(5,9,0)
+    program->addCacheableShaderFromSourceCode(QOpenGLShader::Vertex,vertexShader);
+    program->addCacheableShaderFromSourceCode(QOpenGLShader::Fragment,specializedShader);
+#else
+    program->addShaderFromSourceCode(QOpenGLShader::Vertex,vertexShader);
+    program->addShaderFromSourceCode(QOpenGLShader::Fragment,specializedShader);
+#endif
+    //属性变量绑定到固定的location(layout (location = *)语法在glsl 330版本才提供，为了兼容旧版本在链接前绑定)
+    program->bindAttributeLocation("aPos",0);
+    program->bindAttributeLocation("aTexCoord",1);
+    if(!program->link())//链接着色器
+    {
+        qDebug()<<"createShaderProgram: link failed:"<<program->log();
+    }
+    return program;
+}
+/*
+ *@brief:  选择当前参数对应的着色器程序(缓存中没有时创建)
+ *注:切换程序时为新程序传递所有的uniform参数(缓存的程序可能保留着旧的参数)。
+ *@date:   2026.10.18
+ *@return: bool:true=切换了程序(参数已全部传递)
+ */
+bool V4l2Rendering::selectShaderProgram()
+{
+    const uint key = shaderProgramKey();
+    QOpenGLShaderProgram *program = shaderPrograms.value(key,nullptr);
+    if(!program)
+    {
+        program = createShaderProgram(key);
+        shaderPrograms.insert(key,program);
+    }
+    if(program == shaderProgram)
+    {
+        return false;
+    }
+    shaderProgram = program;
+    shaderProgram->bind();
+    setShaderUniforms();
+    return true;
+}
+/*
+ *@brief:  为当前的着色器程序传递所有的uniform参数(程序中不存在的参数被忽略)
+ *@date:   2026.10.18
+ */
+void V4l2Rendering::setShaderUniforms()
+{
+    //纹理采样器绑定到对应的纹理单元(3D LUT固定使用纹理单元3)
+    shaderProgram->setUniformValue("texY", 0);
+    shaderProgram->setUniformValue("texUV", 1);
+    shaderProgram->setUniformValue("texU", 1);
+    shaderProgram->setUniformValue("texV", 2);
+    shaderProgram->setUniformValue("lut3D", 3);
+    //转换矩阵(包含range转换)
+    shaderProgram->setUniformValue("yuv2rgb",yuvToRgbMatrix());
+    shaderProgram->setUniformValue("rgbOffset",yuvToRgbOffset());
+    //颜色调整参数
+    shaderProgram->setUniformValue("brightness",colorAdjustParam.brightness);
+    shaderProgram->setUniformValue("contrast",colorAdjustParam.contrast);
+    shaderProgram->setUniformValue("saturation",colorAdjustParam.saturation);
+    //3D LUT参数
+    shaderProgram->setUniformValue("lut3DParam",lut3DParam);
+    //反交错参数
+    const uint firstField = deinterlaceParam.topFieldFirst?0:1;
+    shaderProgram->setUniformValue("keptField",float(firstField^currentField));
+    shaderProgram->setUniformValue("combThreshold",deinterlaceParam.combThreshold);
+}
+/*
+ *@brief:  销毁缓存的着色器程序(需要在创建它们的上下文中调用)
+ *@date:   2026.10.18
+ */
+void V4l2Rendering::destroyShaderPrograms()
+{
+    qDeleteAll(shaderPrograms);
+    shaderPrograms.clear();
+    shaderProgram = nullptr;
+}
+/*
+ *@brief:  根据镜像、裁剪和旋转参数计算顶点数据，写入VBO
+ *注:与原顶点着色器的算法一致:屏幕坐标先映射到裁剪区域的纹理坐标，纹理坐标再镜像，最后对顶点坐标顺时针旋转。
+ *opengl标准化设备坐标以屏幕中心为原点，坐标在[-1,1]之间；这里的纹理坐标以左上角为原点(与帧数据的行顺序一致)。
+ *该函数会保持VBO的绑定。
+ *@date:   2026.10.18
+ */
+void V4l2Rendering::updateVertexData()
+{
+    //旋转前的四个顶点(三角形带的顺序:左下、右下、左上、右上)
+    const float corners[4][2] = {{-1.0f,-1.0f},{1.0f,-1.0f},{-1.0f,1.0f},{1.0f,1.0f}};
+    float vertices[4*5];
+    for(int i=0;i<4;i++)
+    {
+        const float x = corners[i][0];
+        const float y = corners[i][1];
+        //裁剪
+        float s = cropRectParam.left_top_x + (x + 1.0f)*0.5f*cropRectParam.width;
+        float t = cropRectParam.left_top_y + (1.0f - y)*0.5f*cropRectParam.height;
+        //镜像
+        if(mirrorParam.hMirror)
+        {
+            s = 1.0f - s;
+        }
+        if(mirrorParam.vMirror)
+        {
+            t = 1.0f - t;
+        }
+        //旋转(顺时针)
+        float *vertex = vertices + i*5;
+        vertex[0] = (rotation == 90)?y:(rotation == 180)?-x:(rotation == 270)?-y:x;
+        vertex[1] = (rotation == 90)?-x:(rotation == 180)?-y:(rotation == 270)?x:y;
+        vertex[2] = 0.0f;
+        vertex[3] = s;
+        vertex[4] = t;
+    }
+    VBO.bind();
+    VBO.write(0,vertices,sizeof(vertices));
 }
 /*
  *@brief:  基于着色器程序和VAO的操作流程，绘制纹理
+ *注:颜色调整开关、3D LUT开关和反交错模式改变时切换特化的着色器程序，其他参数改变时只传递uniform。
  *@date:   2025.08.20
+ *@update: 2026.10.18
  */
 void V4l2Rendering::paintGLTexture()
 {
-    //绑定着色器程序和VAO
-    shaderProgram.bind();
+    //绑定VAO
     VAO.bind();
 
-    //为顶点着色器传递新的镜像参数
-    if(mirrorParamChanged)
+    //镜像、旋转、裁剪参数改变时重新计算顶点数据
+    if(mirrorParamChanged || rotationParamChanged || cropRectParamChanged)
+    {
+        updateVertexData();
+
+        mirrorParamChanged = false;
+        rotationParamChanged = false;
+        cropRectParamChanged = false;
+    }
+    //3D LUT改变时重新创建纹理
+    const bool lut3DChanged = colorLut3DChanged;
+    if(colorLut3DChanged)
     {
-        shaderProgram.setUniformValue("hMirror",mirrorParam.hMirror);
-        shaderProgram.setUniformValue("vMirror",mirrorParam.vMirror);
+        updateLut3DTexture();
 
+        colorLut3DChanged = false;
+    }
+    //选择特化的着色器程序，切换了程序时所有参数都已传递
+    if(selectShaderProgram())
+    {
+        colorEncodingParamChanged = false;
         colorAdjustParamChanged = false;
+        deinterlaceParamChanged = false;
+    }
+    else
+    {
+        shaderProgram->bind();
+    }
+    //为片段着色器传递新的颜色编码参数
+    if(colorEncodingParamChanged)
+    {
+        shaderProgram->setUniformValue("yuv2rgb",yuvToRgbMatrix());
+        shaderProgram->setUniformValue("rgbOffset",yuvToRgbOffset());
+
+        colorEncodingParamChanged = false;
     }
     //为片段着色器传递新的颜色调整参数
     if(colorAdjustParamChanged)
     {
-        shaderProgram.setUniformValue("enableColorAdjust",colorAdjustParam.enableColorAdjust);
-        shaderProgram.setUniformValue("brightness",colorAdjustParam.brightness);
-        shaderProgram.setUniformValue("contrast",colorAdjustParam.contrast);
-        shaderProgram.setUniformValue("saturation",colorAdjustParam.saturation);
+        shaderProgram->setUniformValue("brightness",colorAdjustParam.brightness);
+        shaderProgram->setUniformValue("contrast",colorAdjustParam.contrast);
+        shaderProgram->setUniformValue("saturation",colorAdjustParam.saturation);
 
         colorAdjustParamChanged = false;
     }
+    //为片段着色器传递新的反交错参数(场频输出时保留的场随当前场切换)
+    if(deinterlaceParamChanged)
+    {
+        const uint firstField = deinterlaceParam.topFieldFirst?0:1;
+        shaderProgram->setUniformValue("keptField",float(firstField^currentField));
+
+        deinterlaceParamChanged = false;
+    }
+    //为片段着色器传递新的3D LUT参数(更换了相同开关状态的LUT)
+    if(lut3DChanged)
+    {
+        shaderProgram->setUniformValue("lut3DParam",lut3DParam);
+    }
     //绘制纹理
+    if(lut3DTexture)
+    {
+        lut3DTexture->bind(3);
+    }
     drawTexture();
+    if(lut3DTexture)
+    {
+        lut3DTexture->release(3);
+    }
 
     //释放着色器程序和VAO
-    shaderProgram.release();
+    shaderProgram->release();
     VAO.release();
 }
 /*
@@ -721,10 +1862,7 @@ void V4l2Rendering::drawTexture()
         //将纹理对象绑定到对应的纹理单元索引
         texture1.bind(0);
         texture2.bind(1);
-        //绑定片段着色器的采样器到对应的纹理单元(对象)
-        shaderProgram.setUniformValue("texY", 0);
-        shaderProgram.setUniformValue("texUV", 1);
-        //绘制纹理
+        //绘制纹理(片段着色器的采样器在setShaderUniforms()中绑定到对应的纹理单元)
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
         //释放绑定
         texture1.release();
@@ -738,11 +1876,7 @@ void V4l2Rendering::drawTexture()
         texture1.bind(0);
         texture2.bind(1);
         texture3.bind(2);
-        //绑定片段着色器的采样器到对应的纹理单元(对象)
-        shaderProgram.setUniformValue("texY", 0);
-        shaderProgram.setUniformValue("texU", 1);
-        shaderProgram.setUniformValue("texV", 2);
-        //绘制纹理
+        //绘制纹理(片段着色器的采样器在setShaderUniforms()中绑定到对应的纹理单元)
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
         //释放绑定
         texture1.release();
@@ -750,16 +1884,71 @@ void V4l2Rendering::drawTexture()
         texture3.release();
     }
 }
+/*
+ *@brief:  根据当前的3D LUT重新创建纹理对象，并更新片段着色器的相关参数(lut3DParam)
+ *注:LUT数据量很小(65^3也仅1MB左右)，切换LUT时直接重建纹理即可，需要在OpenGL上下文中调用。纹理对象是否存在决定了
+ *是否使用LUT3D特化的着色器程序。
+ *@date:   2026.10.18
+ *@update: 2026.10.18
+ */
+void V4l2Rendering::updateLut3DTexture()
+{
+    if(lut3DTexture)
+    {
+        delete lut3DTexture;
+        lut3DTexture = nullptr;
+    }
+    if(colorLut3D.isNull() || !colorLut3D->isValid())
+    {
+        return;
+    }
+
+    const int size = colorLut3D->size();
+    if(isLut3DTexture3D)
+    {
+        lut3DTexture = new QOpenGLTexture(QOpenGLTexture::Target3D);
+        lut3DTexture->setSize(size,size,size);
+        lut3DTexture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+        lut3DTexture->setMinMagFilters(QOpenGLTexture::Linear, QOpenGLTexture::Linear);
+        lut3DTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
+        lut3DTexture->allocateStorage(QOpenGLTexture::RGBA,QOpenGLTexture::UInt8);
+        lut3DTexture->setData(QOpenGLTexture::RGBA,QOpenGLTexture::UInt8,
+                              colorLut3D->textureData3D().constData());
+        lut3DParam = QVector4D(size,1,size,size);
+    }
+    else
+    {
+        const QSize atlasSize = colorLut3D->atlasSize();
+        lut3DTexture = new QOpenGLTexture(QOpenGLTexture::Target2D);
+        lut3DTexture->setSize(atlasSize.width(),atlasSize.height());
+        lut3DTexture->setFormat(QOpenGLTexture::RGBAFormat);//兼容OpenGL ES 2.0，见initTexture()
+        lut3DTexture->setMinMagFilters(QOpenGLTexture::Linear, QOpenGLTexture::Linear);
+        lut3DTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
+        lut3DTexture->allocateStorage(QOpenGLTexture::RGBA,QOpenGLTexture::UInt8);
+        lut3DTexture->setData(QOpenGLTexture::RGBA,QOpenGLTexture::UInt8,
+                              colorLut3D->textureDataAtlas().constData());
+        lut3DParam = QVector4D(size,colorLut3D->atlasColumns(),atlasSize.width(),atlasSize.height());
+    }
+}
 /*
  *@brief:  销毁OpenGL纹理对象
  *销毁纹理对象必须在创建纹理对象的上下文中，所以将该函数关联QOpenGLContext::aboutToBeDestroyed信号。
  *正常情况下在析构函数中随着QOpenGLContext对象的销毁，OpenGL纹理对象也会跟着销毁，所以不需要单独处理。但是我们的板子遇到了
  *执行两次initializeGL()的情况，且第一次初始化的上下文很快就销毁了，而在该上下文中创建的纹理对象必须通过信号去销毁，否则将导致
- *第二次初始化的上下文无法使用创建好的纹理对象，又无法销毁。
+ *第二次初始化的上下文无法使用创建好的纹理对象，又无法销毁。着色器程序、PBO同理。
  *@date:   2024.05.17
+ *@update: 2026.10.18
  */
 void V4l2Rendering::destroyTexture()
 {
+    destroyUnpackBuffers();
+    destroyReadbackBuffers();
+    destroyShaderPrograms();
+    if(lut3DTexture)
+    {
+        delete lut3DTexture;
+        lut3DTexture = nullptr;
+    }
     if(texture1.isCreated())
     {
        texture1.destroy();
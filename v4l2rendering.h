@@ -8,6 +8,21 @@
  *@author:  缪庆瑞
  *@date:    2024.05.17
  *@brief:   负责渲染处理V4L2帧数据(基于opengl的api)
+ *
+ *帧数据默认通过像素解包缓冲区(PBO)上传:先拷贝到PBO，纹理再从PBO更新，由驱动异步(DMA)完成，GUI线程不再等待GPU
+ *使用完上一帧的纹理。支持缓冲区存储(GL_ARB_buffer_storage/GL_EXT_buffer_storage)时PBO持久映射，每个PBO使用栅栏同步，
+ *否则每帧重新分配PBO的存储(orphan)后映射写入。OpenGL ES 2.0不支持PBO，自动退回直接上传。
+ *截图(离屏渲染到FBO)使用异步读取:glReadPixels读取到像素打包缓冲区(PBO)并插入栅栏，一到两帧之后栅栏完成时再映射取回，
+ *翻转(OpenGL坐标到光栅坐标)和格式转换在后台线程中完成，不会因为同步读取造成画面卡顿；不支持PBO和栅栏(OpenGL 3.2/
+ *OpenGL ES 3.0以下)时退回同步读取(QOpenGLFramebufferObject::toImage())。
+ *片段着色器按颜色调整开关、3D LUT开关和反交错模式通过#define特化(TV Range的缩放和偏移合并到转换矩阵中)，每个像素不再
+ *判断uniform分支；链接好的着色器程序按特化参数缓存，切换设置时只是切换程序。镜像、裁剪和旋转在CPU端计算成顶点数据
+ *(写入VBO)，顶点着色器只是直接传递。
+ *多分辨率输出(金字塔):设置了输出层级(setOutputPyramid())时，每个新帧在一次提交中渲染到多个不同尺寸的FBO(第一层由纹理绘制，
+ *之后的层级支持帧缓冲blit时由上一层线性缩小得到，类似mipmap逐级缩小，减少混叠)，各层分别异步读取后通过pyramidImageSig()
+ *发射，一次纹理上传供显示和多个分析模块使用。
+ *裁剪区域(数字变焦/平移)可以在运行时每帧改变，也可以设置动画时长平滑过渡。离屏渲染(截图、多分辨率输出)使用的FBO来自按尺寸等级
+ *(原始尺寸逐级减半)划分的FBO池，首次使用时创建、之后复用，图片只占用FBO左下角的区域，变焦过程中不会重新分配显存。
  */
 #ifndef V4L2RENDERING_H
 #define V4L2RENDERING_H
@@ -21,6 +36,24 @@
 #include <QOpenGLTexture>
 #include <QOpenGLPixelTransferOptions>
 #include <QOpenGLFramebufferObject>
+#include <QGenericMatrix>
+#include <QVector3D>
+#include <QVector4D>
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include <QRectF>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include "deinterlacer.h"
+
+//像素解包缓冲区(PBO)数量，轮流使用，GPU读取其中一个时CPU写入下一个
+#define UNPACK_BUFFER_COUNT 3
+//截图异步读取使用的像素打包缓冲区(PBO)数量，连拍以及多分辨率输出的所有层级共用
+#define READBACK_BUFFER_COUNT 8
+
+class ColorLut3D;
+class QThread;
 
 class V4l2Rendering : public QObject,protected QOpenGLExtraFunctions
 {
@@ -36,24 +69,79 @@ public:
 
     bool initCropRectParam(const uint &left_top_x,const uint &left_top_y,
                           const uint &width,const uint &height);
-    void setSingleCaptureImage(bool on){this->needCaptureImage = on;}
+    //运行时设置裁剪区域(归一化，左上角为原点)，duration>0时在该时长(ms)内平滑过渡
+    bool setCropRect(const QRectF &rect,int duration=0);
+    //数字变焦:zoom>=1为放大倍数，center为归一化的画面中心
+    bool setDigitalZoom(const float &zoom,const QPointF &center,int duration=0);
+    QRectF cropRect();
+    bool isCropAnimating(){return cropAnimation.active;}
+    void setSingleCaptureImage(bool on){this->captureImageCount = on?qMax(captureImageCount,1u):0;}
+    void setCaptureImageCount(uint count){this->captureImageCount = count;}//连拍:接下来的count帧都截图
+    bool hasPendingReadback();
+    void pollReadback();
     void setMirrorParam(const bool &hMirror,const bool &vMirror);
+    bool setRotationParam(const uint &rotation);
+    //支持的旋转角度(0/90/180/270)，渲染线程模式的宿主在排队之前据此返回设置结果
+    static bool isRotationSupported(uint rotation){return rotation == 0 || rotation == 90 || rotation == 180 || rotation == 270;}
+    void setColorEncodingParam(const uint &ycbcr_enc,const bool &is_tv_range);
     void setColorAdjustParam(const bool &enableColorAdjust,const float &brightness,
                              const float &contrast,const float &saturation);
+    void setColorLut3D(const QSharedPointer<const ColorLut3D> &lut3D);
+    void setDeinterlaceParam(const Deinterlacer::Mode &mode,const bool &topFieldFirst,const bool &fieldRate);
+    bool isFieldRateOutput();
+    bool showSecondField();
+    void setPboUploadEnabled(bool enabled){this->pboUploadEnabled = enabled;}
+    //截图(离屏渲染)的输出尺寸，无效尺寸表示使用原始像素帧size乘以裁剪比例(可用于缩小输出)
+    void setCaptureImageSize(const QSize &size){this->captureOutputSize = size;}
+    //是否渲染到当前的默认帧缓冲(窗口)，无窗口的离屏转换(OffscreenRendering)关闭，只渲染到FBO
+    void setDirectRenderEnabled(bool enabled){this->directRenderEnabled = enabled;}
+    //直接渲染的目标FBO(渲染线程模式)，nullptr表示当前上下文的默认帧缓冲
+    void setRenderTarget(QOpenGLFramebufferObject *target){this->renderTarget = target;}
+    //多分辨率输出的各层尺寸(按从大到小的顺序，无效尺寸表示截图尺寸)，空表示关闭
+    void setOutputPyramid(const QVector<QSize> &sizes);
+    QVector<QSize> outputPyramid(){return pyramidSizes;}
     void updateV4l2Frame(uchar **v4l2FrameData);
 
 signals:
     void captureImageSig(const QImage &image);
+    void pyramidImageSig(uint level,const QImage &image);//多分辨率输出的第level层
 
 private:
     void initVertexShader();
     void initFragmentShader();
     void initTexture();
+    void initUnpackBuffers();
+    void initReadbackBuffers();
     void initShaderProgram();
+    uint shaderProgramKey();
+    QOpenGLShaderProgram *createShaderProgram(uint key);
+    bool selectShaderProgram();
+    void setShaderUniforms();
+    void destroyShaderPrograms();
+    void updateVertexData();
 
     void paintGLTexture();
     void drawTexture();
+    void updateLut3DTexture();
+    void uploadTextures(const uchar *frameData);
+    void copyToUnpackBuffer(const uchar *frameData);
+    void destroyUnpackBuffers();
+    bool startReadback(const QSize &imageSize,int level=-1);
+    void reserveReadbackBuffers(const QSize &imageSize);
+    uint freeReadbackCount();
+    void finishReadback(const QImage &image,int level);
+    void paintPyramid();
+    void applyCropRect(const QRectF &rect);
+    void updateCropAnimation();
+    QSize fboSizeClass(const QSize &size);
+    QOpenGLFramebufferObject *acquireFBO(const QSize &size);
+    void releaseFBOs();
+    void destroyFBOPool();
+    void destroyReadbackBuffers();
     void destroyTexture();
+    QMatrix3x3 yuvToRgbMatrix();
+    QVector3D yuvToRgbOffset();
+    QSize captureImageSize();
 
     uint pixelFormat = 0;//采集帧格式
     uint pixelWidth = 0;//像素宽度
@@ -61,6 +149,8 @@ private:
     uint widgetWidth = 0;//渲染组件宽度
     uint widgetHeight = 0;//渲染组件高度
     bool isTVRange = true;//TV range标识(通常摄像头采集的数据为该类型)
+    uint ycbcrEncoding = V4L2_YCBCR_ENC_709;//yuv转rgb的转换标准(V4L2_YCBCR_ENC_*)
+    bool colorEncodingParamChanged = false;//表示颜色编码参数是否改变
 
     //初始化标识
     bool isInitGl = false;
@@ -68,8 +158,33 @@ private:
     QOpenGLVertexArrayObject VAO;//存储顶点数据的来源与解析方式(管理VBO的状态数据)
     QOpenGLBuffer VBO;//缓存顶点数据(在显存中)
     //帧缓冲对象
-    bool needCaptureImage = false;//表示当前是否需要捕获图像为Image图片
-    QOpenGLFramebufferObject *FBO = nullptr;//用于离屏渲染保存图片
+    uint captureImageCount = 0;//表示接下来需要捕获为Image图片的帧数
+    QSize captureOutputSize;//截图的输出尺寸(无效时使用默认尺寸)
+    bool directRenderEnabled = true;//是否渲染到默认帧缓冲
+    QOpenGLFramebufferObject *renderTarget = nullptr;//直接渲染的目标FBO(不持有)
+    //离屏渲染(截图、多分辨率输出)使用的FBO池，按尺寸等级在首次使用时创建，一次paintGL()中使用的FBO互不相同
+    struct PooledFBO
+    {
+        QOpenGLFramebufferObject *fbo = nullptr;
+        bool inUse = false;
+    };
+    QList<PooledFBO> fboPool;
+    QOpenGLFramebufferObjectFormat fboFormat;
+    //截图的异步读取(按环形顺序使用，fence不为空表示正在读取中)
+    struct Readback
+    {
+        QOpenGLBuffer buffer;
+        GLsync fence = nullptr;
+        QSize size;
+        int level = -1;//-1=截图  其他=多分辨率输出的层级
+    }readbacks[READBACK_BUFFER_COUNT];
+    bool isReadbackSupported = false;//当前上下文是否支持PBO和栅栏
+    uint readbackIndex = 0;//下一次使用的PBO(也是最早的读取)
+    QThread *readbackThread = nullptr;//翻转和格式转换的后台线程(首次截图时创建)
+    QObject *readbackWorker = nullptr;
+    //多分辨率输出
+    QVector<QSize> pyramidSizes;//各层尺寸
+    bool pyramidFramePending = false;//有新帧尚未渲染多分辨率输出(场频输出的第二场不再渲染)
     //纹理对象
     QOpenGLTexture texture1;
     QOpenGLTexture texture2;
@@ -82,19 +197,32 @@ private:
     QOpenGLPixelTransferOptions pixelTransferOptions3;
     //标识纹理对象是否有效(是否setData)
     bool isVaildTexture = false;
+    //像素解包缓冲区(PBO)
+    bool pboUploadEnabled = true;//是否使用PBO上传(不支持时自动退回直接上传)
+    bool isPboSupported = false;//当前上下文是否支持PBO(OpenGL 2.1/OpenGL ES 3.0及以上)
+    bool isPboPersistent = false;//PBO是否持久映射
+    QOpenGLBuffer unpackBuffers[UNPACK_BUFFER_COUNT];
+    uchar *unpackBufferMapped[UNPACK_BUFFER_COUNT] = {nullptr};//持久映射的地址
+    GLsync unpackBufferFences[UNPACK_BUFFER_COUNT] = {nullptr};//持久映射时标识GPU是否已读取完PBO
+    uint unpackBufferIndex = 0;//下一次写入的PBO
+    uint unpackBufferSize = 0;//每个PBO的字节数(一帧数据)
 
     //着色器
     QString vertexShader;//顶点着色器
     QString fragmentShader;//片段着色器
-    QOpenGLShaderProgram shaderProgram;//着色器程序
-    //以下参数会直接传递给顶点着色器程序，由GLSL程序对纹理坐标进行处理，实现镜像效果
+    QOpenGLShaderProgram *shaderProgram = nullptr;//当前使用的着色器程序
+    QHash<uint,QOpenGLShaderProgram *> shaderPrograms;//已链接的着色器程序(按特化参数缓存)
+    //以下参数在CPU端计算成顶点的纹理坐标(写入VBO)，实现镜像效果
     struct MirrorParam
     {
         bool hMirror = true;//水平镜像
         bool vMirror = false;//垂直镜像
     }mirrorParam;
     bool mirrorParamChanged = false;//表示镜像参数是否改变
-    //以下参数会封装成一个4维数组传递给顶点着色器程序，由GLSL程序对顶点坐标进行处理，实现裁剪效果
+    //顺时针旋转角度(0/90/180/270)，在CPU端对顶点坐标进行旋转(在镜像之后)，与软解码的FrameTransform一致
+    uint rotation = 0;
+    bool rotationParamChanged = false;//表示旋转参数是否改变
+    //以下参数在CPU端计算成顶点的纹理坐标(写入VBO)，实现裁剪效果
     struct CropRectParam
     {
         //下面的参数使用归一化数据[0,1]，默认不进行裁剪
@@ -103,7 +231,17 @@ private:
         float width = 1.0;//裁剪区域的宽高
         float height = 1.0;
     }cropRectParam;
-    //以下参数会直接传递给片段着色器程序，由GLSL程序在rgb的基础上进行算法处理，实现基础的颜色调整
+    bool cropRectParamChanged = false;//表示裁剪参数是否改变
+    //裁剪区域的过渡动画(每次paintGL()按经过的时间插值)
+    struct CropAnimation
+    {
+        bool active = false;
+        QRectF from;
+        QRectF to;
+        int duration = 0;//ms
+        QElapsedTimer timer;
+    }cropAnimation;
+    //以下参数会直接传递给片段着色器程序，由GLSL程序在rgb的基础上进行算法处理，实现基础的颜色调整(开关决定使用的特化程序)
     struct ColorAdjustmentParam
     {
         bool enableColorAdjust = false;//是否启用颜色调整
@@ -112,6 +250,24 @@ private:
         float saturation = 1.0;//饱和度调节，典型范围[0.0,2.0]，1.0表示原图，越大色彩越鲜艳，反之色彩越单调
     }colorAdjustParam;
     bool colorAdjustParamChanged = false;//表示颜色调整参数是否改变
+    /*3D LUT颜色分级，在片段着色器的伽马校正之后作为最后一级处理
+     *OpenGL/OpenGL ES 3.0使用3D纹理，OpenGL ES 2.0不支持3D纹理，使用b切片平铺的2D纹理(atlas)，纹理对象在上下文中按需创建*/
+    QSharedPointer<const ColorLut3D> colorLut3D;
+    bool colorLut3DChanged = false;//表示3D LUT是否改变
+    bool isLut3DTexture3D = true;//true=3D纹理  false=2D纹理(atlas)
+    QOpenGLTexture *lut3DTexture = nullptr;
+    QVector4D lut3DParam;//x=格点数N y=atlas列数 zw=atlas像素宽高(3D纹理时为N)
+    /*反交错参数，传递给片段着色器，由着色器按纹理坐标所在的行进行处理(与软件实现Deinterlacer的模式一致)
+     *场频输出时每一帧绘制两次，第二次保留另一场，由外部在半帧之后调用showSecondField()并重绘*/
+    struct DeinterlaceParam
+    {
+        Deinterlacer::Mode mode = Deinterlacer::Off;//反交错模式
+        bool topFieldFirst = true;//场序(PAL顶场优先，NTSC底场优先)
+        bool fieldRate = false;//场频输出(仅Bob和MotionAdaptive有效)
+        float combThreshold = 10/255.0;//运动自适应的梳状检测阈值(归一化)
+    }deinterlaceParam;
+    bool deinterlaceParamChanged = false;//表示反交错参数是否改变
+    uint currentField = 0;//当前显示的场(0=第一场 1=第二场)
 
 };
 
@@ -15,10 +15,18 @@
 //采集帧宽高
 #define FRAME_WIDTH (720)
 #define FRAME_HEIGHT (576)
+//每次点击保存的连拍帧数
+#define SNAPSHOT_BURST_COUNT (1)
 
 VideoDisplayWidget::VideoDisplayWidget(QWidget *parent) :
     QWidget(parent)
 {
+    //保存图片在后台线程中编码，GUI线程只拷贝一次帧数据
+    snapshotService = new SnapshotService(1,8,this);
+    snapshotService->setFormat(SnapshotService::Png);
+    connect(snapshotService,&SnapshotService::snapshotSavedSig,this,[](const QString &fileName,bool success){
+        qDebug()<<"snapshot saved:"<<fileName<<success;
+    });
     //展示视频画面
 #ifdef USE_YUV_RENDERING_WIDGET
     videoOutput = new OpenGLWidget(V4L2_PIX_FMT_NV21,FRAME_WIDTH,FRAME_HEIGHT,true,this);
@@ -31,14 +39,16 @@ VideoDisplayWidget::VideoDisplayWidget(QWidget *parent) :
     //videoOutput->readYuvFileTest("./video/nv21_854x480.yuv",V4L2_PIX_FMT_NV21,FRAME_WIDTH,FRAME_HEIGHT);
     //保存图片
     connect(videoOutput,&OpenGLWidget::captureImageSig,this,[this](const QImage &captureImage){
-        //可以开启一个QtConcurrent线程去处理，避免阻塞主线程影响视频实时渲染刷新
-        captureImage.save(QTime::currentTime().toString("HHmmsszzz")+".png",nullptr,100);
+        //连拍的帧由渲染端连续异步读取，队列满被拒绝时补截一帧
+        if(!snapshotService->submitImage(captureImage) && snapshotService->pendingShots())
+        {
+            videoOutput->setSingleCaptureImage(true);
+        }
     },Qt::QueuedConnection);
 #else
     videoOutput = new PixmapWidget(this);
     videoOutput->setSizePolicy(QSizePolicy::Preferred,QSizePolicy::Preferred);
     videoOutput->setFixedSize(FRAME_WIDTH,FRAME_HEIGHT);
-    ColorToRgb24::setColorAdjustParam(1.4,0.7,1.0);
     //videoOutput->readYuvFileTest("./video/nv21_854x480.yuv",V4L2_PIX_FMT_NV21,FRAME_WIDTH,FRAME_HEIGHT);
 #endif
 
@@ -98,20 +108,19 @@ void VideoDisplayWidget::initSelectCapture()
     v4l2Capture = new V4L2Capture(true,0);//视频采集对象
     initV4l2CaptureDevice();
 #ifdef USE_YUV_RENDERING_WIDGET
-    connect(v4l2Capture,SIGNAL(captureOriginFrameSig(uchar**)),videoOutput,SLOT(updateV4l2FrameSlot(uchar**)));
+    //原始帧在采集线程中直接放入渲染组件的邮箱(只保留最新一帧)，不经过排队信号，GUI线程繁忙时不会堆积过时的帧
+    connect(v4l2Capture,&V4L2Capture::captureOriginFrameSig,videoOutput,[this](uchar **originFrame){
+        videoOutput->postV4l2Frame(originFrame);
+    },Qt::DirectConnection);
 #else
-    connect(v4l2Capture,&V4L2Capture::captureRgb24FrameSig,
-            this,[this](uchar *rgb24Frame){
+    //rgb帧封装在缓冲区池中，部件持有期间不会被后续帧覆盖，绘制时不拷贝
+    connect(v4l2Capture,&V4L2Capture::captureRgbImageSig,
+            this,[this](const QImage &selectImage){
         if(this->isVisible())
         {
-            QImage selectImage(rgb24Frame,FRAME_WIDTH,FRAME_HEIGHT,FRAME_WIDTH*3,QImage::Format_RGB888);
-            videoOutput->setPixmap(QPixmap::fromImage(selectImage));//屏幕显示
+            videoOutput->setImage(selectImage);//屏幕显示
             videoOutput->update();//刷新显示
-            if(isSaveImage)//保存图片
-            {
-                isSaveImage = false;
-                selectImage.save(QTime::currentTime().toString("HHmmsszzz")+".png",nullptr,100);
-            }
+            snapshotService->submitImage(selectImage);//保存图片(有预约时)
         }
     });
 #endif
@@ -138,20 +147,16 @@ void VideoDisplayWidget::initTimerCapture()
         }
     });
 #else
-    timerRgbFrameBuf = (uchar *)malloc(FRAME_WIDTH*FRAME_HEIGHT*3);//为图像帧分配内存空间
-    timerImage = QImage(timerRgbFrameBuf,FRAME_WIDTH,FRAME_HEIGHT,FRAME_WIDTH*3,QImage::Format_RGB888);//根据内存空间创建image图像
+    timerRgbFrameBuf = (uchar *)malloc(FRAME_WIDTH*FRAME_HEIGHT*4);//为图像帧分配内存空间(RGB32)
+    timerImage = QImage(timerRgbFrameBuf,FRAME_WIDTH,FRAME_HEIGHT,FRAME_WIDTH*4,QImage::Format_RGB32);//根据内存空间创建image图像
     timer = new QTimer(this);//定时获取视频帧
     connect(timer,&QTimer::timeout,this,[this](){
         if(this->isVisible())//仅当前界面被展示才获取界面
         {
             v4l2Capture->ioctlDequeueBuffers(timerRgbFrameBuf);//获取一帧RGB格式图片流
-            videoOutput->setPixmap(QPixmap::fromImage(timerImage));//屏幕显示
+            videoOutput->setImage(timerImage);//屏幕显示(与取帧在同一线程，不拷贝)
             videoOutput->update();//刷新显示
-            if(isSaveImage)//保存图片
-            {
-                isSaveImage = false;
-                timerImage.save(QTime::currentTime().toString("HHmmsszzz")+".png",nullptr,100);
-            }
+            snapshotService->submitImage(timerImage);//保存图片(有预约时)
         }
     });
 #endif
@@ -199,15 +204,16 @@ void VideoDisplayWidget::captureBtnClickedSlot()
 }
 /*
  *@brief:  保存当前图片
+ *注:预约SNAPSHOT_BURST_COUNT帧，由SnapshotService在后台线程中编码保存。
  *@author: 缪庆瑞
  *@date:   2022.08.22
+ *@update: 2026.10.18
  */
 void VideoDisplayWidget::saveImageBtnClickedSlot()
 {
+    snapshotService->requestSnapshot(SNAPSHOT_BURST_COUNT);
 #ifdef USE_YUV_RENDERING_WIDGET
-    videoOutput->setSingleCaptureImage(true);
-#else
-    isSaveImage = true;
+    videoOutput->setCaptureImageCount(SNAPSHOT_BURST_COUNT);
 #endif
 }
 /*
@@ -231,6 +237,14 @@ bool VideoDisplayWidget::initV4l2CaptureDevice()
     v4l2Capture->ioctlSetInput(0);
     v4l2Capture->ioctlSetStreamParm(0,25);//T517驱动传递2
     v4l2Capture->ioctlSetStreamFmt(V4L2_PIX_FMT_NV21,FRAME_WIDTH,FRAME_HEIGHT);
+#ifdef USE_YUV_RENDERING_WIDGET
+    /*使用驱动返回的颜色编码参数，与软解码保持一致(软解码在采集模块内部自动使用)*/
+    videoOutput->setColorEncodingParam(v4l2Capture->getYcbcrEncoding(),v4l2Capture->getIsTvRange());
+#else
+    /*软解码直接输出Qt原生的32位格式，绘制时不需要再次转换*/
+    v4l2Capture->setRgbOutputFormat(ColorToRgb24::RGB32);
+    v4l2Capture->setColorAdjustParam(1.4,0.7,1.0);
+#endif
     /*设置完参数后稍作延时，这个在某些设备上很关键，否则可能会出现进程退出的情况*/
     usleep(100000);
     /*申请并映射视频帧缓冲区(必选项)*/
@@ -19,6 +19,7 @@
 #include "pixmapwidget.h"
 #include "openglwidget.h"
 #include "v4l2capture.h"
+#include "snapshotservice.h"
 
 //是否使用yuv渲染器部件，不定义默认用软解码，通过pixmapWidget渲染
 #define USE_YUV_RENDERING_WIDGET
@@ -49,7 +50,7 @@ private:
     QPushButton *quitBtn;//退出程序
 
     V4L2Capture *v4l2Capture = NULL;//视频采集对象
-    bool isSaveImage = false;//是否保存当前图片
+    SnapshotService *snapshotService;//后台保存图片(不阻塞界面)
 
 #ifdef USE_SELECT_CAPTURE
 #else